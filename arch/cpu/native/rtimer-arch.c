@@ -77,10 +77,22 @@ rtimer_arch_schedule(rtimer_clock_t t)
   struct itimerval val;
   rtimer_clock_t c;
 
+#if NATIVE_CONF_MEDIUM
+  /* A zero it_value would disarm the timer, so a deadline in the past
+   * fires as soon as possible. */
+  c = RTIMER_CLOCK_LT(rtimer_arch_now(), t) ? t - rtimer_arch_now() : 0;
+  if(c == 0) {
+    c = 1;
+  }
+
+  val.it_value.tv_sec = c / 1000000;
+  val.it_value.tv_usec = c % 1000000;
+#else /* NATIVE_CONF_MEDIUM */
   c = t - clock_time();
   
   val.it_value.tv_sec = c / CLOCK_SECOND;
   val.it_value.tv_usec = (c % CLOCK_SECOND) * CLOCK_SECOND;
+#endif /* NATIVE_CONF_MEDIUM */
 
   PRINTF("rtimer_arch_schedule time %"PRIu32 " %"PRIu32 " in %ld.%ld seconds\n",
          t, c, (long)val.it_value.tv_sec, (long)val.it_value.tv_usec);
@@ -42,8 +42,35 @@
 
 #include "contiki.h"
 
+#if NATIVE_CONF_MEDIUM
+/* Microsecond rtimer on the host clock shared by all nodes of a
+ * native-medium network (see platform/native/clock.c) */
+#define RTIMER_ARCH_SECOND 1000000UL
+
+#define US_TO_RTIMERTICKS(US)   (US)
+#define RTIMERTICKS_TO_US(T)    (T)
+#define RTIMERTICKS_TO_US_64(T) (T)
+
+uint64_t native_clock_us(void);
+
+#define rtimer_arch_now() ((rtimer_clock_t)native_clock_us())
+
+void medium_radio_busywait(rtimer_clock_t until);
+
+/** \brief Busy-waits sleep on the medium socket instead of spinning, so
+ * that many node processes can share the host CPUs */
+#define RTIMER_BUSYWAIT_UNTIL_ABS(cond, t0, max_time) \
+  ({                                                                \
+    bool c;                                                         \
+    while(!(c = cond) && RTIMER_CLOCK_LT(RTIMER_NOW(), (t0) + (max_time))) { \
+      medium_radio_busywait((t0) + (max_time));                     \
+    }                                                               \
+    c;                                                              \
+  })
+#else /* NATIVE_CONF_MEDIUM */
 #define RTIMER_ARCH_SECOND CLOCK_CONF_SECOND
 
 #define rtimer_arch_now() clock_time()
+#endif /* NATIVE_CONF_MEDIUM */
 
 #endif /* RTIMER_ARCH_H_ */
@@ -73,11 +73,24 @@ extern rf2xx_t RF2XX_DEVICE;
  * done from rtimer interrupt. Keep this disabled for ContikiMAC and NullRDC. */
 #define RF2XX_WITH_TSCH (MAC_CONF_WITH_TSCH)
 
+#ifndef RF2XX_PREPARE_BURST
+/* Burst of frames sent back to back (UPA). With a single FIFO, the burst is kept
+ * as a list of frames and each one is written to the FIFO asynchronously by
+ * rf2xx_wr_transmit while the transmission starts, as with RF2XX_SOFT_PREPARE. */
+#define RF2XX_PREPARE_BURST (MAC_CONF_WITH_TSCH)
+#endif
+
 #define RF2XX_MAX_PAYLOAD 125
 #if RF2XX_SOFT_PREPARE
 static uint8_t tx_buf[RF2XX_MAX_PAYLOAD];
 #endif /* RF2XX_SOFT_PREPARE */
 static uint8_t tx_len;
+#if RF2XX_PREPARE_BURST
+static const void **burst_payloads;
+static const unsigned short *burst_lens;
+static int burst_count;
+static int burst_next;
+#endif /* RF2XX_PREPARE_BURST */
 
 enum rf2xx_state
 {
@@ -118,6 +131,9 @@ static int rf2xx_wr_read(void *, unsigned short);
 static int rf2xx_wr_channel_clear(void);
 static int rf2xx_wr_receiving_packet(void);
 static int rf2xx_wr_pending_packet(void);
+#if RF2XX_PREPARE_BURST
+static int rf2xx_wr_prepare_burst(const void **, const unsigned short *, int);
+#endif /* RF2XX_PREPARE_BURST */
 
 #if WITH_IOTLAB
 static int phy_rssi_dbm;
@@ -224,6 +240,10 @@ rf2xx_wr_prepare(const void *payload, unsigned short payload_len)
 {
     log_debug("radio-rf2xx: rf2xx_wr_prepare %d",payload_len);
 
+#if RF2XX_PREPARE_BURST
+    burst_count = 0;
+#endif /* RF2XX_PREPARE_BURST */
+
     if (payload_len > RF2XX_MAX_PAYLOAD)
     {
         log_error("radio-rf2xx: payload is too big");
@@ -244,6 +264,42 @@ rf2xx_wr_prepare(const void *payload, unsigned short payload_len)
 
 /*---------------------------------------------------------------------------*/
 
+#if RF2XX_PREPARE_BURST
+/** Prepare a burst of frames, each sent by one rf2xx_wr_transmit */
+static int
+rf2xx_wr_prepare_burst(const void **payloads, const unsigned short *payload_lens, int count)
+{
+    int i;
+
+    log_debug("radio-rf2xx: rf2xx_wr_prepare_burst %d", count);
+
+    burst_count = 0;
+    if (count <= 0)
+    {
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (payload_lens[i] > RF2XX_MAX_PAYLOAD)
+        {
+            log_error("radio-rf2xx: payload is too big");
+            tx_len = 0;
+            return 1;
+        }
+    }
+
+    /* Frames are not copied here: the FIFO holds a single frame */
+    burst_payloads = payloads;
+    burst_lens = payload_lens;
+    burst_count = count;
+    burst_next = 0;
+    tx_len = payload_lens[0];
+    return 0;
+}
+#endif /* RF2XX_PREPARE_BURST */
+
+/*---------------------------------------------------------------------------*/
+
 /** Send the packet that has previously been prepared. */
 static int
 rf2xx_wr_transmit(unsigned short transmit_len)
@@ -252,20 +308,49 @@ rf2xx_wr_transmit(unsigned short transmit_len)
 
     log_info("radio-rf2xx: rf2xx_wr_transmit %d", transmit_len);
 
-    if (tx_len != transmit_len)
+#if RF2XX_PREPARE_BURST
+    if (burst_count > 0)
     {
-        log_error("radio-rf2xx: Length is has changed (was %u now %u)",
-                tx_len, transmit_len);
-        return RADIO_TX_ERR;
+        const void *payload = burst_payloads[burst_next];
+
+        tx_len = burst_lens[burst_next];
+        if (++burst_next == burst_count)
+        {
+            burst_count = 0;
+        }
+        if (tx_len != transmit_len)
+        {
+            log_error("radio-rf2xx: Length is has changed (was %u now %u)",
+                    tx_len, transmit_len);
+            burst_count = 0;
+            return RADIO_TX_ERR;
+        }
+
+        /* Asynchronous copy to the FIFO and before starting to transmit */
+        ret = rf2xx_wr_hard_prepare(payload, tx_len, 1);
+        if(ret != 0) {
+          burst_count = 0;
+          return ret;
+        }
     }
+    else
+#endif /* RF2XX_PREPARE_BURST */
+    {
+        if (tx_len != transmit_len)
+        {
+            log_error("radio-rf2xx: Length is has changed (was %u now %u)",
+                    tx_len, transmit_len);
+            return RADIO_TX_ERR;
+        }
 
 #if RF2XX_SOFT_PREPARE
-    /* Asynchronous copy to the FIFO and before starting to transmit */
-    ret = rf2xx_wr_hard_prepare(tx_buf, tx_len, 1);
-    if(ret != 0) {
-      return ret;
-    }
+        /* Asynchronous copy to the FIFO and before starting to transmit */
+        ret = rf2xx_wr_hard_prepare(tx_buf, tx_len, 1);
+        if(ret != 0) {
+          return ret;
+        }
 #endif /* RF2XX_SOFT_PREPARE */
+    }
 
 #ifdef RF2XX_LEDS_ON
     if (transmit_len > 10)
@@ -705,6 +790,9 @@ const struct radio_driver rf2xx_driver =
     .set_value        = set_value,
     .get_object       = get_object,
     .set_object       = set_object,
+#if RF2XX_PREPARE_BURST
+    .prepare_burst    = rf2xx_wr_prepare_burst,
+#endif /* RF2XX_PREPARE_BURST */
  };
 
 /*---------------------------------------------------------------------------*/
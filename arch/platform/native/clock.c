@@ -67,24 +67,47 @@ get_time(clock_timespec_t *spec)
 #endif
 }
 /*---------------------------------------------------------------------------*/
+#if NATIVE_CONF_MEDIUM
+/* The nodes of a native-medium network run in real time on the host
+ * monotonic clock: every process reads the same time without exchanging
+ * anything. */
+uint64_t
+native_clock_us(void)
+{
+  clock_timespec_t ts;
+
+  get_time(&ts);
+
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#endif /* NATIVE_CONF_MEDIUM */
+/*---------------------------------------------------------------------------*/
 clock_time_t
 clock_time(void)
 {
+#if NATIVE_CONF_MEDIUM
+  return native_clock_us() / (1000000 / CLOCK_SECOND);
+#else /* NATIVE_CONF_MEDIUM */
   clock_timespec_t ts;
 
   get_time(&ts);
 
   return ts.tv_sec * CLOCK_SECOND + ts.tv_nsec / (1000000000 / CLOCK_SECOND);
+#endif /* NATIVE_CONF_MEDIUM */
 }
 /*---------------------------------------------------------------------------*/
 unsigned long
 clock_seconds(void)
 {
+#if NATIVE_CONF_MEDIUM
+  return native_clock_us() / 1000000;
+#else /* NATIVE_CONF_MEDIUM */
   clock_timespec_t ts;
 
   get_time(&ts);
 
   return ts.tv_sec;
+#endif /* NATIVE_CONF_MEDIUM */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -66,11 +66,29 @@ typedef unsigned int uip_stats_t;
 #define UIP_CONF_BYTE_ORDER      UIP_LITTLE_ENDIAN
 #endif
 
+#if NATIVE_CONF_MEDIUM
+/* 802.15.4 radio on the native-medium server (make NATIVE_MEDIUM=1):
+ * frames go through 6LoWPAN and the MAC instead of the tun interface */
+#ifndef NETSTACK_CONF_RADIO
+#define NETSTACK_CONF_RADIO   medium_radio_driver
+#endif /* NETSTACK_CONF_RADIO */
+
+/* 1 len byte, 2 bytes CRC */
+#define RADIO_PHY_OVERHEAD         3
+/* 250kbps data rate. One byte = 32us */
+#define RADIO_BYTE_AIR_TIME       32
+#define RADIO_DELAY_BEFORE_TX 0
+#define RADIO_DELAY_BEFORE_RX 0
+#define RADIO_DELAY_BEFORE_DETECT 0
+#endif /* NATIVE_CONF_MEDIUM */
+
 #if NETSTACK_CONF_WITH_IPV6
 
+#if !NATIVE_CONF_MEDIUM
 #ifndef NETSTACK_CONF_NETWORK
 #define NETSTACK_CONF_NETWORK    tun6_net_driver
 #endif
+#endif /* !NATIVE_CONF_MEDIUM */
 
 #ifndef NETSTACK_CONF_RADIO
 #define NETSTACK_CONF_RADIO   nullradio_driver
@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         802.15.4 radio driver for native nodes sharing a radio medium.
+ *         Frames are exchanged with the native-medium server
+ *         (tools/native-medium) over UNIX datagram sockets. The server
+ *         applies per-link PRR and RSSI and reports collisions; this driver
+ *         models channel selection, radio on/off, CCA and frame air time on
+ *         the host clock of platform/native/clock.c.
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/netstack.h"
+#include "net/linkaddr.h"
+#include "sys/energest.h"
+#include "dev/radio.h"
+#include "native-medium-proto.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/select.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "Medium"
+#define LOG_LEVEL LOG_LEVEL_MAIN
+
+#define MEDIUM_RADIO_BUFSIZE 125
+#define MEDIUM_RADIO_RX_QUEUE_LEN 8
+#define MEDIUM_RADIO_CCA_THRESHOLD -95
+#define MEDIUM_RADIO_NOISE_FLOOR -100
+/* Longest host-time sleep of a busy-wait before checking its condition again */
+#define MEDIUM_RADIO_BUSYWAIT_MAX_US 100
+
+#define FRAME_AIR_TIME(len) ((rtimer_clock_t)(((len) + RADIO_PHY_OVERHEAD) * RADIO_BYTE_AIR_TIME))
+
+/* Frames heard on the current channel, oldest first. The radio locks on the
+ * oldest one; later overlapping frames are reported as collisions by the server. */
+struct medium_rx_frame {
+  struct native_medium_msg msg;
+  rtimer_clock_t start;
+  rtimer_clock_t end;
+  uint8_t corrupt;
+};
+static struct medium_rx_frame rx_queue[MEDIUM_RADIO_RX_QUEUE_LEN];
+static int rx_count;
+
+static int medium_fd = -1;
+static struct sockaddr_un medium_addr;
+static uint16_t medium_node_id;
+
+static int radio_is_on;
+static int poll_mode;
+static int send_on_cca;
+static int radio_channel = 26;
+
+static const void *pending_data;
+static unsigned short pending_len;
+
+static rtimer_clock_t last_packet_timestamp;
+static int16_t last_rssi = MEDIUM_RADIO_NOISE_FLOOR;
+
+PROCESS(medium_radio_process, "medium radio process");
+/*---------------------------------------------------------------------------*/
+static void
+rx_queue_pop(void)
+{
+  if(rx_count > 0) {
+    rx_count--;
+    memmove(&rx_queue[0], &rx_queue[1], rx_count * sizeof(rx_queue[0]));
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Fetch the messages of the server. Frames are only kept when they start
+ * while the radio listens on their channel. */
+static void
+medium_poll(void)
+{
+  struct native_medium_msg msg;
+  ssize_t n;
+  int i;
+
+  if(medium_fd < 0) {
+    return;
+  }
+  while((n = recv(medium_fd, &msg, sizeof(msg), MSG_DONTWAIT)) > 0) {
+    if(msg.type == NATIVE_MEDIUM_RX) {
+      if(n < NATIVE_MEDIUM_MSG_LEN(0) || msg.len > MEDIUM_RADIO_BUFSIZE
+         || n < NATIVE_MEDIUM_MSG_LEN(msg.len)) {
+        continue;
+      }
+      if(radio_is_on && msg.channel == radio_channel && rx_count < MEDIUM_RADIO_RX_QUEUE_LEN) {
+        struct medium_rx_frame *f = &rx_queue[rx_count++];
+        memcpy(&f->msg, &msg, n);
+        f->start = (rtimer_clock_t)msg.start_us;
+        f->end = f->start + FRAME_AIR_TIME(msg.len);
+        f->corrupt = 0;
+      }
+    } else if(msg.type == NATIVE_MEDIUM_CORRUPT) {
+      for(i = 0; i < rx_count; i++) {
+        if(rx_queue[i].msg.frame_id == msg.frame_id) {
+          rx_queue[i].corrupt = 1;
+        }
+      }
+    }
+  }
+  /* Drop frames that ended corrupted or that the radio cannot lock on */
+  while(rx_count > 0 && rx_queue[0].corrupt
+        && !RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[0].end)) {
+    rx_queue_pop();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Sleep until a message of the server arrives or for a short while, at
+ * most until 'until'. Used by RTIMER_BUSYWAIT_UNTIL_ABS. */
+void
+medium_radio_busywait(rtimer_clock_t until)
+{
+  fd_set fds;
+  struct timeval tv;
+  rtimer_clock_t now = RTIMER_NOW();
+  rtimer_clock_t wait = RTIMER_CLOCK_LT(now, until) ? until - now : 0;
+
+  if(wait > MEDIUM_RADIO_BUSYWAIT_MAX_US) {
+    wait = MEDIUM_RADIO_BUSYWAIT_MAX_US;
+  }
+  if(medium_fd < 0 || wait == 0) {
+    sched_yield();
+    return;
+  }
+  FD_ZERO(&fds);
+  FD_SET(medium_fd, &fds);
+  tv.tv_sec = 0;
+  tv.tv_usec = wait;
+  select(medium_fd + 1, &fds, NULL, NULL, &tv);
+}
+/*---------------------------------------------------------------------------*/
+static void
+medium_flush(void)
+{
+  medium_poll();
+  rx_count = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+medium_send(struct native_medium_msg *msg)
+{
+  return sendto(medium_fd, msg, NATIVE_MEDIUM_MSG_LEN(msg->len), 0,
+                (struct sockaddr *)&medium_addr, sizeof(medium_addr)) < 0 ? -1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+medium_connect(void)
+{
+  struct sockaddr_un local;
+  struct native_medium_msg msg;
+  struct timeval tv;
+  fd_set fds;
+  const char *path = getenv("NATIVE_MEDIUM_SOCKET");
+
+  if(path == NULL) {
+    path = NATIVE_MEDIUM_SOCKET_DEFAULT;
+  }
+  medium_node_id = (linkaddr_node_addr.u8[LINKADDR_SIZE - 2] << 8)
+                   + linkaddr_node_addr.u8[LINKADDR_SIZE - 1];
+
+  memset(&medium_addr, 0, sizeof(medium_addr));
+  medium_addr.sun_family = AF_UNIX;
+  snprintf(medium_addr.sun_path, sizeof(medium_addr.sun_path), "%s", path);
+
+  memset(&local, 0, sizeof(local));
+  local.sun_family = AF_UNIX;
+  snprintf(local.sun_path, sizeof(local.sun_path), "%s.%u", path, medium_node_id);
+  unlink(local.sun_path);
+
+  medium_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if(medium_fd < 0 || bind(medium_fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+    LOG_ERR("cannot bind %s: %s\n", local.sun_path, strerror(errno));
+    return 0;
+  }
+
+  memset(&msg, 0, sizeof(msg));
+  msg.type = NATIVE_MEDIUM_HELLO;
+  msg.node_id = medium_node_id;
+  if(medium_send(&msg) < 0) {
+    LOG_ERR("no medium at %s: %s\n", path, strerror(errno));
+    return 0;
+  }
+
+  /* Wait for the server, in host time */
+  FD_ZERO(&fds);
+  FD_SET(medium_fd, &fds);
+  tv.tv_sec = 2;
+  tv.tv_usec = 0;
+  if(select(medium_fd + 1, &fds, NULL, NULL, &tv) <= 0
+     || recv(medium_fd, &msg, sizeof(msg), 0) <= 0
+     || msg.type != NATIVE_MEDIUM_WELCOME) {
+    LOG_ERR("no answer from medium at %s\n", path);
+    return 0;
+  }
+
+  LOG_INFO("node %u on medium %s\n", medium_node_id, path);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+radio_on(void)
+{
+  if(!radio_is_on) {
+    /* Frames sent while the radio was off are not heard */
+    medium_flush();
+    radio_is_on = 1;
+    ENERGEST_ON(ENERGEST_TYPE_LISTEN);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+radio_off(void)
+{
+  if(radio_is_on) {
+    /* A frame received before turning off stays readable, frames still
+     * on air are lost */
+    medium_poll();
+    if(rx_count > 0 && !rx_queue[0].corrupt
+       && !RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[0].end)) {
+      rx_count = 1;
+    } else {
+      rx_count = 0;
+    }
+    radio_is_on = 0;
+    ENERGEST_OFF(ENERGEST_TYPE_LISTEN);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+channel_clear(void)
+{
+  int i;
+
+  medium_poll();
+  for(i = 0; i < rx_count; i++) {
+    if(RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[i].end)
+       && rx_queue[i].msg.rssi > MEDIUM_RADIO_CCA_THRESHOLD) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+radio_send(const void *payload, unsigned short payload_len)
+{
+  struct native_medium_msg msg;
+  rtimer_clock_t end;
+  int radio_was_on = radio_is_on;
+
+  if(payload_len == 0 || payload_len > MEDIUM_RADIO_BUFSIZE || medium_fd < 0) {
+    return RADIO_TX_ERR;
+  }
+  if(send_on_cca && !channel_clear()) {
+    return RADIO_TX_COLLISION;
+  }
+
+  if(radio_was_on) {
+    ENERGEST_SWITCH(ENERGEST_TYPE_LISTEN, ENERGEST_TYPE_TRANSMIT);
+  } else {
+    ENERGEST_ON(ENERGEST_TYPE_TRANSMIT);
+  }
+
+  memset(&msg, 0, NATIVE_MEDIUM_MSG_LEN(0));
+  msg.type = NATIVE_MEDIUM_TX;
+  msg.channel = radio_channel;
+  msg.node_id = medium_node_id;
+  msg.len = payload_len;
+  msg.start_us = native_clock_us();
+  memcpy(msg.payload, payload, payload_len);
+  if(medium_send(&msg) < 0) {
+    LOG_ERR("tx failed: %s\n", strerror(errno));
+  }
+
+  /* Half duplex: the radio is busy for the air time and hears nothing */
+  end = (rtimer_clock_t)msg.start_us + FRAME_AIR_TIME(payload_len);
+  while(RTIMER_CLOCK_LT(RTIMER_NOW(), end)) {
+    medium_radio_busywait(end);
+  }
+  medium_flush();
+
+  if(radio_was_on) {
+    ENERGEST_SWITCH(ENERGEST_TYPE_TRANSMIT, ENERGEST_TYPE_LISTEN);
+  } else {
+    ENERGEST_OFF(ENERGEST_TYPE_TRANSMIT);
+  }
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prepare_packet(const void *data, unsigned short len)
+{
+  if(len > MEDIUM_RADIO_BUFSIZE) {
+    return RADIO_TX_ERR;
+  }
+  pending_data = data;
+  pending_len = len;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit_packet(unsigned short len)
+{
+  if(pending_data == NULL || len != pending_len) {
+    return RADIO_TX_ERR;
+  }
+  return radio_send(pending_data, len);
+}
+/*---------------------------------------------------------------------------*/
+static int
+receiving_packet(void)
+{
+  medium_poll();
+  return rx_count > 0
+         && !RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[0].start)
+         && RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[0].end);
+}
+/*---------------------------------------------------------------------------*/
+static int
+pending_packet(void)
+{
+  medium_poll();
+  return rx_count > 0 && !rx_queue[0].corrupt
+         && !RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[0].end);
+}
+/*---------------------------------------------------------------------------*/
+static int
+radio_read(void *buf, unsigned short bufsize)
+{
+  int len;
+
+  if(!pending_packet()) {
+    return 0;
+  }
+  len = rx_queue[0].msg.len;
+  if(bufsize < len) {
+    rx_queue_pop(); /* rx flush */
+    return 0;
+  }
+  memcpy(buf, rx_queue[0].msg.payload, len);
+  last_packet_timestamp = rx_queue[0].start;
+  last_rssi = rx_queue[0].msg.rssi;
+  rx_queue_pop();
+  if(!poll_mode) {
+    packetbuf_set_attr(PACKETBUF_ATTR_RSSI, last_rssi);
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+medium_set_fd(fd_set *rset, fd_set *wset)
+{
+  /* In poll mode the MAC reads the radio from rtimer interrupts only */
+  if(poll_mode || medium_fd < 0) {
+    return 0;
+  }
+  FD_SET(medium_fd, rset);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+medium_handle_fd(fd_set *rset, fd_set *wset)
+{
+  if(!poll_mode && medium_fd >= 0 && FD_ISSET(medium_fd, rset)) {
+    process_poll(&medium_radio_process);
+  }
+}
+static const struct select_callback medium_fd_callback = {
+  medium_set_fd, medium_handle_fd
+};
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(medium_radio_process, ev, data)
+{
+  int len;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+    if(poll_mode) {
+      continue;
+    }
+    packetbuf_clear();
+    len = radio_read(packetbuf_dataptr(), PACKETBUF_SIZE);
+    if(len > 0) {
+      packetbuf_set_datalen(len);
+      NETSTACK_MAC.input();
+    }
+    if(rx_count > 0) {
+      /* A frame is still on air, check again once it is over */
+      process_poll(&medium_radio_process);
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static int
+init(void)
+{
+  if(!medium_connect()) {
+    return 0;
+  }
+  select_set_callback(medium_fd, &medium_fd_callback);
+  process_start(&medium_radio_process, NULL);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_value(radio_param_t param, radio_value_t *value)
+{
+  int i;
+
+  if(value == NULL) {
+    return RADIO_RESULT_INVALID_VALUE;
+  }
+  switch(param) {
+  case RADIO_PARAM_POWER_MODE:
+    *value = radio_is_on ? RADIO_POWER_MODE_ON : RADIO_POWER_MODE_OFF;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_CHANNEL:
+    *value = radio_channel;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RX_MODE:
+    *value = poll_mode ? RADIO_RX_MODE_POLL_MODE : 0;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_TX_MODE:
+    *value = send_on_cca ? RADIO_TX_MODE_SEND_ON_CCA : 0;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RSSI:
+    /* Strongest frame on air on the current channel */
+    medium_poll();
+    *value = MEDIUM_RADIO_NOISE_FLOOR;
+    for(i = 0; i < rx_count; i++) {
+      if(RTIMER_CLOCK_LT(RTIMER_NOW(), rx_queue[i].end) && rx_queue[i].msg.rssi > *value) {
+        *value = rx_queue[i].msg.rssi;
+      }
+    }
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_LAST_RSSI:
+    *value = last_rssi;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_LAST_LINK_QUALITY:
+    /* Rough mapping of RSSI over the sensitivity to 0..255 */
+    *value = last_rssi < MEDIUM_RADIO_NOISE_FLOOR ? 0 :
+             MIN(255, (last_rssi - MEDIUM_RADIO_NOISE_FLOOR) * 4);
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_CHANNEL_MIN:
+    *value = 11;
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_CHANNEL_MAX:
+    *value = 26;
+    return RADIO_RESULT_OK;
+  case RADIO_CONST_MAX_PAYLOAD_LEN:
+    *value = (radio_value_t)MEDIUM_RADIO_BUFSIZE;
+    return RADIO_RESULT_OK;
+  default:
+    return RADIO_RESULT_NOT_SUPPORTED;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_value(radio_param_t param, radio_value_t value)
+{
+  switch(param) {
+  case RADIO_PARAM_POWER_MODE:
+    if(value == RADIO_POWER_MODE_ON) {
+      radio_on();
+      return RADIO_RESULT_OK;
+    }
+    if(value == RADIO_POWER_MODE_OFF) {
+      radio_off();
+      return RADIO_RESULT_OK;
+    }
+    return RADIO_RESULT_INVALID_VALUE;
+  case RADIO_PARAM_CHANNEL:
+    if(value < 11 || value > 26) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    if(value != radio_channel) {
+      /* Frames on the previous channel are lost */
+      medium_flush();
+      radio_channel = value;
+    }
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_RX_MODE:
+    if(value & ~(RADIO_RX_MODE_ADDRESS_FILTER |
+        RADIO_RX_MODE_AUTOACK | RADIO_RX_MODE_POLL_MODE)) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    /* Neither frame filtering nor autoack are supported */
+    if(value & (RADIO_RX_MODE_ADDRESS_FILTER | RADIO_RX_MODE_AUTOACK)) {
+      return RADIO_RESULT_NOT_SUPPORTED;
+    }
+    poll_mode = (value & RADIO_RX_MODE_POLL_MODE) != 0;
+    return RADIO_RESULT_OK;
+  case RADIO_PARAM_TX_MODE:
+    if(value & ~(RADIO_TX_MODE_SEND_ON_CCA)) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    send_on_cca = (value & RADIO_TX_MODE_SEND_ON_CCA) != 0;
+    return RADIO_RESULT_OK;
+  default:
+    return RADIO_RESULT_NOT_SUPPORTED;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_object(radio_param_t param, void *dest, size_t size)
+{
+  if(param == RADIO_PARAM_LAST_PACKET_TIMESTAMP) {
+    if(size != sizeof(rtimer_clock_t) || !dest) {
+      return RADIO_RESULT_INVALID_VALUE;
+    }
+    *(rtimer_clock_t *)dest = last_packet_timestamp;
+    return RADIO_RESULT_OK;
+  }
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver medium_radio_driver =
+{
+    init,
+    prepare_packet,
+    transmit_packet,
+    radio_send,
+    radio_read,
+    channel_clear,
+    receiving_packet,
+    pending_packet,
+    radio_on,
+    radio_off,
+    get_value,
+    set_value,
+    get_object,
+    set_object
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Messages exchanged between native nodes and the native-medium
+ *         server over UNIX datagram sockets. Shared with tools/native-medium,
+ *         so only standard headers are included.
+ */
+
+#ifndef NATIVE_MEDIUM_PROTO_H_
+#define NATIVE_MEDIUM_PROTO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define NATIVE_MEDIUM_SOCKET_DEFAULT "/tmp/native-medium.sock"
+#define NATIVE_MEDIUM_MAX_FRAME_LEN 127
+
+enum native_medium_msg_type {
+  NATIVE_MEDIUM_HELLO,   /* node -> medium: register */
+  NATIVE_MEDIUM_WELCOME, /* medium -> node: registered */
+  NATIVE_MEDIUM_TX,      /* node -> medium: frame on air from start_us */
+  NATIVE_MEDIUM_RX,      /* medium -> node: frame heard by this node */
+  NATIVE_MEDIUM_CORRUPT, /* medium -> node: frame_id collided at this node */
+};
+
+struct native_medium_msg {
+  uint8_t type;
+  uint8_t channel;
+  uint16_t node_id;  /* sender of the frame, or node registering */
+  int16_t rssi;      /* dBm at the receiver */
+  uint16_t len;      /* frame length without FCS */
+  uint32_t frame_id;
+  uint64_t start_us; /* host time of the start of the frame */
+  uint8_t payload[NATIVE_MEDIUM_MAX_FRAME_LEN];
+};
+
+#define NATIVE_MEDIUM_MSG_LEN(len) (offsetof(struct native_medium_msg, payload) + (len))
+
+#endif /* NATIVE_MEDIUM_PROTO_H_ */
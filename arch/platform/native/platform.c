@@ -43,6 +43,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/select.h>
@@ -175,6 +176,10 @@ stdin_handle_fd(fd_set *rset, fd_set *wset)
   if(FD_ISSET(STDIN_FILENO, rset)) {
     if(read(STDIN_FILENO, &c, 1) > 0) {
       input_handler(c);
+    } else {
+      /* End of input (e.g. a node started in the background): stop
+       * watching stdin, it would otherwise be readable forever */
+      select_set_callback(STDIN_FILENO, NULL);
     }
   }
 }
@@ -188,6 +193,16 @@ set_lladdr(void)
 {
   linkaddr_t addr;
 
+#if NATIVE_CONF_MEDIUM
+  /* Each process of a native-medium network is one node */
+  const char *id = getenv("NATIVE_MEDIUM_NODE_ID");
+  if(id != NULL) {
+    unsigned long node = strtoul(id, NULL, 10);
+    mac_addr[6] = (node >> 8) & 0xff;
+    mac_addr[7] = node & 0xff;
+  }
+#endif /* NATIVE_CONF_MEDIUM */
+
   memset(&addr, 0, sizeof(linkaddr_t));
 #if NETSTACK_CONF_WITH_IPV6
   memcpy(addr.u8, mac_addr, sizeof(addr.u8));
@@ -200,7 +215,7 @@ set_lladdr(void)
   linkaddr_set_node_addr(&addr);
 }
 /*---------------------------------------------------------------------------*/
-#if NETSTACK_CONF_WITH_IPV6
+#if NETSTACK_CONF_WITH_IPV6 && !NATIVE_CONF_MEDIUM
 static void
 set_global_address(void)
 {
@@ -278,7 +293,10 @@ platform_init_stage_three()
   process_start(&wpcap_process, NULL);
 #endif
 
+#if !NATIVE_CONF_MEDIUM
+  /* With the medium, addresses and routes come from the routing protocol */
   set_global_address();
+#endif /* !NATIVE_CONF_MEDIUM */
 
 #endif /* NETSTACK_CONF_WITH_IPV6 */
 
@@ -0,0 +1,256 @@
+import argparse
+import sys
+
+# Decodes a node log with binary TSCH records (TSCH_LOG_CONF_BINARY) back into
+# the text lines printed by tsch-log.c, so that the other parse-*.py scripts
+# can be used on the output. Text logs between records are copied as is.
+
+parser = argparse.ArgumentParser()
+parser.add_argument('in_file')
+parser.add_argument('out_file', nargs='?')
+args = parser.parse_args()
+
+REC_SYNC = 0x01
+REC_NBR = 0x02
+REC_TX = 0x03
+REC_RX = 0x04
+REC_UPA = 0x05
+
+F_UNICAST = 0x01
+F_DATA = 0x02
+F_DRIFT = 0x04
+F_APP = 0x08
+F_HK = 0x10
+SEC_SHIFT = 5
+
+F_DEPLOYMENT = 0x01
+
+NO_LINK = 0xff
+NULL_NBR = 0xff
+
+UPA_LINK_TYPES = {1: 'RES T B', 2: 'RES R B', 3: 'RES T U', 4: 'RES R U', 5: 'RES T P', 6: 'RES R P'}
+
+
+def crc16(data):
+    # CRC-16 of os/lib/crc16.c
+    crc = 0
+    for b in data:
+        crc ^= b
+        crc = (crc >> 8) | ((crc << 8) & 0xffff)
+        crc ^= (crc & 0xff00) << 4
+        crc &= 0xffff
+        crc ^= (crc >> 8) >> 4
+        crc ^= (crc & 0xff00) >> 5
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xff and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def u8(self):
+        if self.pos >= len(self.data):
+            raise ValueError('short record')
+        v = self.data[self.pos]
+        self.pos += 1
+        return v
+
+    def varint(self):
+        v = 0
+        shift = 0
+        while True:
+            b = self.u8()
+            v |= (b & 0x7f) << shift
+            shift += 7
+            if b < 0x80:
+                return v
+
+    def svarint(self):
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+
+class Decoder:
+    def __init__(self):
+        self.synced = False
+        self.asn = 0
+        self.node_id = 0
+        self.deployment = False
+        self.nbr = {}
+        self.bad_records = 0
+
+    def lladdr(self, node_id):
+        if node_id is None:
+            return 'LL-NULL'
+        if self.deployment:
+            return 'LL-%04u' % node_id
+        return 'LL-%04x' % node_id
+
+    def nbr_addr(self, index):
+        if index == NULL_NBR:
+            return None
+        if index not in self.nbr:
+            raise ValueError('unknown neighbor')
+        return self.nbr[index]
+
+    def header(self, r):
+        self.asn = (self.asn + r.varint()) & 0xffffffffff
+        asn = '%02x.%08x' % (self.asn >> 32, self.asn & 0xffffffff)
+        handle = r.u8()
+        if handle == NO_LINK:
+            return '[INFO: TSCH-LOG  ] {asn %s link-NULL} ' % asn
+        sf_size = r.varint()
+        burst_count = r.u8()
+        timeslot = r.varint()
+        channel_offset = r.varint()
+        channel = r.u8()
+        return '[INFO: TSCH-LOG  ] {asn %s link %2u %3u %3u %2u %2u ch %2u} ' % (
+            asn, handle, sf_size, burst_count, timeslot, channel_offset, channel)
+
+    def hk(self, r):
+        ack_len = r.u8()
+        unused_offset_time = r.varint()
+        idle_time = r.varint()
+        curr_slot_len = r.varint()
+        num_of_slots_until_idle_time = r.u8()
+        return [ack_len, unused_offset_time, idle_time, curr_slot_len, num_of_slots_until_idle_time]
+
+    def tx(self, r):
+        line = self.header(r)
+        flags = r.u8()
+        dest = self.nbr_addr(r.u8())
+        datalen = r.u8()
+        seqno = r.u8()
+        status = r.svarint()
+        num_tx = r.u8()
+        uc = 1 if flags & F_UNICAST else 0
+        is_data = 1 if flags & F_DATA else 0
+        line += '%s-%u-%u tx ' % ('uc' if uc else 'bc', is_data, flags >> SEC_SHIFT)
+        line += self.lladdr(self.node_id) + '->' + self.lladdr(dest)
+        line += ', len %3u, seq %3u, st %d %2d' % (datalen, seqno, status, num_tx)
+        if flags & F_DRIFT:
+            line += ', dr %3d' % r.svarint()
+        if flags & F_APP:
+            line += ', a_seq %x' % r.varint()
+        if flags & F_HK:
+            hk = self.hk(r)
+            line += ', RES T ' + ' '.join(str(v) for v in [uc, is_data, datalen, status] + hk) + ' HK-T'
+        return line
+
+    def rx(self, r):
+        line = self.header(r)
+        flags = r.u8()
+        src = self.nbr_addr(r.u8())
+        datalen = r.u8()
+        seqno = r.u8()
+        uc = 1 if flags & F_UNICAST else 0
+        is_data = 1 if flags & F_DATA else 0
+        line += '%s-%u-%u rx ' % ('uc' if uc else 'bc', is_data, flags >> SEC_SHIFT)
+        line += self.lladdr(src) + '->' + self.lladdr(self.node_id if uc else None)
+        line += ', len %3u, seq %3u' % (datalen, seqno)
+        line += ', edr %3d' % r.svarint()
+        if flags & F_DRIFT:
+            line += ', dr %3d' % r.svarint()
+        line += ', rssi %3d' % r.svarint()
+        if flags & F_APP:
+            line += ', a_seq %x' % r.varint()
+        if flags & F_HK:
+            hk = self.hk(r)
+            line += ', RES R ' + ' '.join(str(v) for v in [uc, is_data, datalen] + hk) + ' HK-T'
+        return line
+
+    def upa(self, r):
+        line = self.header(r)
+        link_type = r.u8()
+        is_overflowed = r.u8()
+        values = [r.varint() for i in range(13)]
+        line += UPA_LINK_TYPES.get(link_type, '')
+        line += ' ' + ' '.join(str(v) for v in values)
+        if is_overflowed == 1:
+            line += ' !O'
+        return line + ' HK-U'
+
+    def record(self, frame):
+        # Returns the decoded text line, '' for records without output,
+        # None if the frame is not a valid record
+        rec = cobs_decode(frame)
+        if rec is None or len(rec) < 3:
+            return None
+        if crc16(rec[:-2]) != rec[-2] | (rec[-1] << 8):
+            return None
+        r = Reader(rec[:-2])
+        try:
+            rec_type = r.u8()
+            if rec_type == REC_SYNC:
+                self.deployment = (r.u8() & F_DEPLOYMENT) != 0
+                self.asn = r.varint()
+                self.node_id = r.varint()
+                self.nbr = {}
+                self.synced = True
+                return ''
+            if not self.synced:
+                return ''
+            if rec_type == REC_NBR:
+                index = r.u8()
+                self.nbr[index] = r.varint()
+                return ''
+            if rec_type == REC_TX:
+                return self.tx(r)
+            if rec_type == REC_RX:
+                return self.rx(r)
+            if rec_type == REC_UPA:
+                return self.upa(r)
+        except ValueError:
+            pass
+        # The ASN delta chain is broken until the next sync record
+        self.synced = False
+        self.bad_records += 1
+        return ''
+
+
+f = open(args.in_file, 'rb')
+data = f.read()
+f.close()
+
+if args.out_file is not None:
+    out = open(args.out_file, 'w')
+else:
+    out = sys.stdout
+
+decoder = Decoder()
+records = 0
+lost = 0
+# Records are enclosed in 0x00 bytes that never appear in text logs, so every
+# chunk between two 0x00 bytes is either a record or plain text
+for chunk in data.split(b'\x00'):
+    if len(chunk) == 0:
+        continue
+    line = decoder.record(chunk)
+    if line is None:
+        if records > 0 and chunk.count(b'\n') == 0:
+            # Corrupted record (or text cut by a lost byte)
+            lost += 1
+        out.write(chunk.decode('utf-8', errors='ignore'))
+    else:
+        records += 1
+        if len(line) > 0:
+            out.write(line + '\n')
+
+if out is not sys.stdout:
+    out.close()
+print('records', records, 'invalid', lost + decoder.bad_records, file=sys.stderr)
@@ -23,6 +23,12 @@
 #define HCK_DBG_REGULAR_SLOT_DETAIL                0
 #define HCK_DBG_REGULAR_SLOT_TIMING                (0 && HCK_DBG_REGULAR_SLOT_DETAIL)
 
+#define TSCH_CONF_SLOT_PROFILER                    0 /* per-phase slot timing min/avg/max/p99 and overruns, printed with the TSCH logs */
+#define TSCH_CONF_METRICS                          1 /* UPA/SLA efficiency counters and histograms, printed with simple-energest and shown by tsch-metrics */
+#define ETIMER_CONF_WITH_HEAP                      1 /* pending etimers in a pairing heap, instead of a list walked at each poll */
+#define TSCH_CONF_WITH_RX_BATCH                    1 /* single parse of incoming frames, payload-only copy to packetbuf, rx batch counters in the TSCH logs */
+#define LINK_STATS_CONF_INPUT_CACHE                1 /* skip the neighbor lookup for consecutive receptions from the same neighbor */
+
 #define HCK_GET_NODE_ID_FROM_IPADDR(addr)          ((((addr)->u8[14]) << 8) | (addr)->u8[15])
 #define HCK_GET_NODE_ID_FROM_LINKADDR(addr)        ((((addr)->u8[LINKADDR_SIZE - 2]) << 8) | (addr)->u8[LINKADDR_SIZE - 1]) 
 
@@ -202,6 +208,9 @@
  */
 #define MAX_NBR_NODE_NUM                           60
 #define NBR_TABLE_CONF_MAX_NEIGHBORS               (MAX_NBR_NODE_NUM + 2) /* Add 2 for EB and broadcast neighbors in TSCH layer */
+#define NBR_TABLE_CONF_WITH_HASH_INDEX             1 /* hashed link-layer address lookup, 0: walk the list of neighbors */
+#define MEMB_CONF_WITH_BITMAP                      1 /* O(1) memb alloc/free with a bitmap of used blocks, 0: scan the blocks */
+#define MEMB_CONF_WITH_STATS                       1 /* high-water marks of the TSCH packet and queuebuf pools */
 /*---------------------------------------------------------------------------*/
 
 
@@ -211,7 +220,11 @@
  */
 #define UIP_CONF_BUFFER_SIZE                       160 /* ksh */
 #define UIP_CONF_MAX_ROUTES                        (NODE_NUM)
+#define UIP_CONF_DS6_ROUTE_WITH_HASH_INDEX         1 /* hashed lookup of /128 routes, 0: longest-prefix walk of the route list */
 #define SICSLOWPAN_CONF_FRAG                       0
+#define SICSLOWPAN_CONF_AGGREGATION                0 /* UDP packets held behind a frame to the same next hop are sent in one frame; TSCH logs then show the a_seq of the last one only */
+#define SICSLOWPAN_CONF_FLOW_CTX                   0 /* repeated UDP headers to a neighbor are sent once, then as a context id, the RPL option and the UDP checksum; private dispatches, see sicslowpan.h */
+#define SICSLOWPAN_CONF_COMPRESSION                SICSLOWPAN_COMPRESSION_IPHC /* SICSLOWPAN_COMPRESSION_6LORH: paging dispatch and 6LoRH (RFC 8138) before IPHC on routed packets, see tests/08-native-runs/13-sicslowpan-compression */
 /*---------------------------------------------------------------------------*/
 
 
@@ -220,6 +233,7 @@
  * Configure RPL
  */
 #define RPL_CONF_MOP                               RPL_MOP_STORING_NO_MULTICAST
+#define RPL_CONF_WITH_RFC8138                      0 /* 1: the RPL option is sent as an RPI 6LoRH, needs SICSLOWPAN_COMPRESSION_6LORH */
 #if HCK_RPL_FIXED_TOPOLOGY
 #define RPL_CONF_WITH_DAO_ACK                      0
 #else /* HCK_RPL_FIXED_TOPOLOGY */
@@ -246,6 +260,20 @@
  */
 #define QUEUEBUF_CONF_NUM                          16 /* 16 in Orchestra, ALICE, and OST, originally 8 */
 #define TSCH_CONF_MAX_INCOMING_PACKETS             8 /* 8 in OST, originally 4 */
+#define TSCH_QUEUE_CONF_WITH_SHARED_POOL           1 /* neighbor queues share the QUEUEBUF_CONF_NUM packets under quotas */
+#if TSCH_QUEUE_CONF_WITH_SHARED_POOL
+#define TSCH_QUEUE_CONF_POOL_MIN_PER_NEIGHBOR      0 /* packets guaranteed to each neighbor */
+#define TSCH_QUEUE_CONF_POOL_ALPHA                 4 /* borrow while queued < ALPHA * free packets */
+#endif
+#define TSCH_QUEUE_CONF_WITH_CLASSES               1 /* per-neighbor control, latency-sensitive and bulk queues */
+#if TSCH_QUEUE_CONF_WITH_CLASSES
+#if !TSCH_QUEUE_CONF_WITH_SHARED_POOL
+#define TSCH_QUEUE_CONF_NUM_PER_NEIGHBOR           8 /* per class */
+#endif
+#define TSCH_QUEUE_CONF_CLASS_WRR                  0 /* 0: strict priority, 1: weighted round-robin */
+#define TSCH_QUEUE_CONF_CLASS_WEIGHTS              { 4, 2, 1 }
+#define TSCH_QUEUE_CONF_CLASS_LIFETIME             { 0, 0, 0 } /* timeslots, 0: no deadline */
+#endif
 #define IEEE802154_CONF_PANID                      0x58FA //22782 hckim //0x81a5 //ksh
 #define TSCH_CONF_CCA_ENABLED                      1
 //#define TSCH_CONF_AUTOSTART                        0 //ksh
@@ -255,7 +283,10 @@
 #endif /* WITH_SECURITY */
 #define TSCH_NEXT_PRINT_PERIOD                     (1 * 60 * CLOCK_SECOND)
 #define TSCH_LOG_CONF_QUEUE_LEN                    128 // originally 16
+#define TSCH_LOG_CONF_BINARY                       0 /* COBS-framed binary TX/RX logs, decode with ASAP-parsing-files/decode-tsch-log.py */
 #define TSCH_SWAP_TX_RX_PROCESS_PENDING            1 /* swap order of rx_process_pending and tx_process_pending */
+#define TSCH_SCHEDULE_CONF_WITH_INDEX              1 /* timeslot-indexed next active link lookup, 0: linear scan of all slotframes and links */
+#define TSCH_SCHEDULE_CONF_WITH_CMD_RING           1 /* schedule changes of OST queued to the slot operation, 0: through the TSCH lock */
 /*---------------------------------------------------------------------------*/
 
 
@@ -325,7 +356,15 @@
 #define ALICE_PACKET_CELL_MATCHING_ON_THE_FLY      alice_packet_cell_matching_on_the_fly
 #define ALICE_TIME_VARYING_SCHEDULING              alice_time_varying_scheduling
 #define ALICE_EARLY_PACKET_DROP                    0
+#define ALICE_INCREMENTAL_RESCHEDULING             1 // move unicast links to the cells of the next ASFN in place (ignored with A3), see examples/benchmarks/alice-reschedule
+#define ALICE_PACKET_CELL_MATCHING_CACHE           1 // cache Tx cells per neighbor for the current ASFN and RPL neighbor set
+#define ALICE_DBG_PCM_CYCLES                       0 // count packet-cell matching cost in CPU cycles (rtimer ticks without cycle counter)
+#define ALICE_DEFERRED_RESCHEDULING                alice_deferred_rescheduling // prepare the unicast links of the next ASFN from a process, swapped in at the ASFN boundary (comment out to reschedule in the slot operation)
+#ifdef ALICE_DEFERRED_RESCHEDULING
+#define TSCH_SCHEDULE_CONF_MAX_LINKS               (3 + 4 * MAX_NBR_NODE_NUM + 2) /* EB SF: tx/rx, CS SF: one link, UC SF and its shadow: tx/rx for each node + 2 for spare */
+#else
 #define TSCH_SCHEDULE_CONF_MAX_LINKS               (3 + 2 * MAX_NBR_NODE_NUM + 2) /* EB SF: tx/rx, CS SF: one link, UC SF: tx/rx for each node + 2 for spare */
+#endif
 #define ENABLE_ALICE_PACKET_CELL_MATCHING_LOG      0
 #define ENABLE_ALICE_EARLY_PACKET_DROP_LOG         0
 #undef ENABLE_LOG_TSCH_LINK_ADD_REMOVE
@@ -354,7 +393,8 @@
 #define WITH_OST_LOG_SCH                           0
 #define WITH_OST_TODO                              0 /* check ost_pigg1 of EB later */
 
-#define OST_N_SELECTION_PERIOD                     15 // related to OST_N_MAX: Min. traffic load = 1 / (OST_N_SELECTION_PERIOD * 100) pkt/slot (when num_tx = 1). 
+#define OST_N_SELECTION_PERIOD                     15 // related to OST_N_MAX: Min. traffic load = 1 / (OST_N_SELECTION_PERIOD * slots per second) pkt/slot (when num_tx = 1). 
+#define OST_TX_LOAD_EWMA_ALPHA                     4 // weight (in 1/8) of the last period when the traffic load decreases, 8: no smoothing
 #define OST_N_MAX                                  8 // max t_offset 65535-1, 65535 is used for no-allocation
 #define OST_MORE_UNDER_PROVISION                   1 // more allocation 2^OST_MORE_UNDER_PROVISION times than under-provision
 #define OST_N_OFFSET_NEW_TX_REQUEST                100 // Maybe used for denial message
@@ -441,6 +481,7 @@
 #define A3_RX_INCREASE_THRESH                      (0.65)
 #define A3_RX_DECREASE_THRESH                      (0.29)
 #define A3_MAX_ERR_PROB                            (0.5)
+#define TSCH_A3_CONF_FIXED_POINT                   1 /* Q15 rates with integer arithmetic only, 0: double */
 
 #define A3_DBG                                     1
 #define A3_DBG_VALUE                               0
@@ -475,6 +516,10 @@
 #define UPA_TRIPLE_CCA                             1
 #define UPA_RX_SLOT_POLICY                         1 /* 0: no policy, 1: max gain, 2: max pkts w/ gain */
 #define UPA_NO_ETX_UPDATE_FROM_PACKETS_IN_BATCH    0
+#define UPA_MEMOIZED_SLOT_UTILITY                  1 /* per-packet running sums of Tx durations */
+#define UPA_BURST_ASSEMBLY                         0 /* 1: stamp all frames of a batch before the first Tx, for a shorter UPA_CONF_TS_TX_OFFSET_2 with prepare_burst (iotlab only, not cc2538) */
+#define UPA_RADIO_PREPARE_BURST                    (1 && UPA_BURST_ASSEMBLY) /* hand the batch to radio.prepare_burst() if any */
+#define UPA_CONF_TS_TX_OFFSET_2                    1000 /* us, same on all nodes */
 
 #define UPA_DBG_ESSENTIAL                          1
 #define UPA_DBG_OPERATION                          0
@@ -521,6 +566,14 @@
 #define SLA_SHIFT_BITS                             3
 
 #define SLA_OBSERVATION_WINDOWS                    1
+#define SLA_QUANTILE_ESTIMATOR                     1 /* 0: quantized histogram, 1: streaming P-square estimator (byte resolution) */
+#define SLA_QUANTILE_DECAY                         50 /* P-square: percent of weight kept by past windows at each determination */
+
+#define SLA_PER_SLOTFRAME_TIMESLOT_LENGTH          1 /* own timeslot length for the common shared cell, see tests/08-native-runs/14-sla-timeslots */
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+#define SLA_COMMON_SF_PERIOD                       ORCHESTRA_CONF_COMMON_SHARED_PERIOD
+#define SLA_COMMON_SF_TIMESLOT                     0 /* common shared cell of all nodes */
+#endif
 #define SLA_FRAME_LEN_QUANTIZED_LEVELS             ((((SLA_MAX_FRAME_LEN - 1) >> SLA_SHIFT_BITS) + 1) + 1)
 #define SLA_ACK_LEN_QUANTIZED_LEVELS               ((((SLA_MAX_ACK_LEN - 1) >> SLA_SHIFT_BITS) + 1) + 1)
 
@@ -0,0 +1,29 @@
+import argparse
+import random
+
+# Generates a synthetic trace for sla-replay: per window, broadcast (EB/DIO),
+# unicast data and ACK lengths (including RADIO_PHY_OVERHEAD), with the
+# application payload changing every few windows
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--windows', type=int, default=24)
+parser.add_argument('--frames', type=int, default=600)
+parser.add_argument('--seed', type=int, default=1)
+args = parser.parse_args()
+
+random.seed(args.seed)
+
+payload_phases = [20, 20, 60, 60, 35, 90]
+
+for w in range(args.windows):
+    payload = payload_phases[(w // 4) % len(payload_phases)]
+    for i in range(args.frames):
+        r = random.random()
+        if r < 0.15:
+            print('bc', random.choice([38, 41, 45, 52, 98]))
+        else:
+            uc_len = min(128, 36 + payload + random.randint(-3, 3) + (random.random() < 0.05) * 20)
+            print('uc', uc_len)
+            if random.random() < 0.9:
+                print('ack', random.choice([20, 22, 22, 22, 24]))
+    print('det')
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Replays a trace of frame/ACK lengths through the SLA length determination
+ * of the coordinator, with the quantized histogram and with the streaming
+ * P-square estimator (tsch-sla-quantile.c), and reports per window the
+ * resulting timeslot length, the airtime reserved but not used by the
+ * frames/ACKs of the window, and the number of frames/ACKs longer than
+ * the reference length.
+ *
+ * Trace format, one entry per line (lengths include RADIO_PHY_OVERHEAD):
+ *   bc <len>   broadcast frame
+ *   uc <len>   unicast frame
+ *   ack <len>  ACK
+ *   det        end of an observation window (SLA determination)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "net/mac/tsch/tsch-sla-quantile.h"
+
+/* Defaults of examples/ASAP/project-conf.h and tsch-timeslot-timing.c (10 ms, no UPA) */
+#define SLA_K_TH_PERCENTILE 90
+#define SLA_SHIFT_BITS 3
+#define SLA_QUANTILE_DECAY 50
+#define SLA_MAX_FRAME_LEN 128
+#define SLA_MAX_ACK_LEN 70
+#define SLA_CALCULATE_DURATION(len) (32 * (5 + (len)))
+#define TS_TIMESLOT_LENGTH 10000
+#define TS_MAX_TX 4256
+#define TS_MAX_ACK 2400
+#define TS_TX_ACK_DELAY 1000
+
+#define LEVELS ((((SLA_MAX_FRAME_LEN - 1) >> SLA_SHIFT_BITS) + 1) + 1)
+#define MAX_WINDOW_SAMPLES 65536
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+enum { BC, UC, ACK, KINDS };
+
+/* Quantized histogram of the current window, as in tsch.c */
+struct histogram {
+  uint16_t levels[LEVELS];
+  uint16_t count;
+};
+
+/* Reference lengths and outcome of one estimation method */
+struct method {
+  const char *name;
+  int ref[KINDS];
+  uint32_t wasted_us;
+  uint32_t overflows;
+  uint64_t total_wasted_us;
+  uint64_t total_overflows;
+  uint64_t total_timeslot_length;
+};
+
+static const int max_len[KINDS] = { SLA_MAX_FRAME_LEN, SLA_MAX_FRAME_LEN, SLA_MAX_ACK_LEN };
+static const char *kind_names[KINDS] = { "bc", "uc", "ack" };
+
+static struct histogram histograms[KINDS];
+static struct sla_quantile estimators[KINDS];
+static struct method methods[2] = { { "hist" }, { "p2" } };
+
+/* Samples of the current window, to evaluate the references in use */
+static uint8_t window_kind[MAX_WINDOW_SAMPLES];
+static uint8_t window_len[MAX_WINDOW_SAMPLES];
+static int window_samples;
+
+/*---------------------------------------------------------------------------*/
+static int
+histogram_get(const struct histogram *h, int curr_ref)
+{
+  uint16_t ref_count = h->count * (100 - SLA_K_TH_PERCENTILE) / 100;
+  uint16_t accum_count = 0;
+  int i;
+
+  for(i = LEVELS - 1; i >= 0; i--) {
+    accum_count += h->levels[i];
+    if(accum_count != 0 && accum_count > ref_count) {
+      return i << SLA_SHIFT_BITS;
+    }
+  }
+  return curr_ref;
+}
+/*---------------------------------------------------------------------------*/
+static int
+timeslot_length(const int ref[KINDS])
+{
+  int bc = MIN(SLA_CALCULATE_DURATION(ref[BC]), TS_MAX_TX);
+  int uc = MIN(SLA_CALCULATE_DURATION(ref[UC]), TS_MAX_TX)
+    + TS_TX_ACK_DELAY + MIN(SLA_CALCULATE_DURATION(ref[ACK]), TS_MAX_ACK);
+  int max_tx_duration = TS_MAX_TX + TS_TX_ACK_DELAY + TS_MAX_ACK;
+  return TS_TIMESLOT_LENGTH - (max_tx_duration - MAX(bc, uc));
+}
+/*---------------------------------------------------------------------------*/
+static void
+evaluate_window(struct method *m)
+{
+  int i;
+
+  m->wasted_us = 0;
+  m->overflows = 0;
+  for(i = 0; i < window_samples; i++) {
+    int ref = m->ref[window_kind[i]];
+    if(window_len[i] <= ref) {
+      m->wasted_us += SLA_CALCULATE_DURATION(ref) - SLA_CALCULATE_DURATION(window_len[i]);
+    } else {
+      m->overflows++;
+    }
+  }
+  m->total_wasted_us += m->wasted_us;
+  m->total_overflows += m->overflows;
+  m->total_timeslot_length += timeslot_length(m->ref);
+}
+/*---------------------------------------------------------------------------*/
+static void
+determine(int window)
+{
+  int k, m;
+
+  for(m = 0; m < 2; m++) {
+    evaluate_window(&methods[m]);
+  }
+  printf("%d\t%d", window, window_samples);
+  for(m = 0; m < 2; m++) {
+    printf("\t%d\t%u\t%u", timeslot_length(methods[m].ref),
+           methods[m].wasted_us, methods[m].overflows);
+  }
+  printf("\n");
+
+  /* Next references, used during the next window */
+  for(k = 0; k < KINDS; k++) {
+    int len = sla_quantile_get(&estimators[k]);
+    methods[0].ref[k] = histogram_get(&histograms[k], methods[0].ref[k]);
+    if(len >= 0) {
+      methods[1].ref[k] = MIN(len, max_len[k]);
+    }
+    sla_quantile_decay(&estimators[k], SLA_QUANTILE_DECAY);
+    memset(&histograms[k], 0, sizeof(histograms[k]));
+  }
+  window_samples = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  FILE *f = argc > 1 ? fopen(argv[1], "r") : stdin;
+  char kind_str[8];
+  int len;
+  int k, m;
+  int window = 0;
+
+  if(f == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  for(k = 0; k < KINDS; k++) {
+    sla_quantile_init(&estimators[k], SLA_K_TH_PERCENTILE);
+    for(m = 0; m < 2; m++) {
+      methods[m].ref[k] = max_len[k];
+    }
+  }
+
+  printf("win\tsamples\thist_ts\thist_waste\thist_ovf\tp2_ts\tp2_waste\tp2_ovf\n");
+  while(fscanf(f, "%7s", kind_str) == 1) {
+    if(strcmp(kind_str, "det") == 0) {
+      determine(window++);
+      continue;
+    }
+    if(fscanf(f, "%d", &len) != 1 || len <= 0) {
+      fprintf(stderr, "bad trace entry %s\n", kind_str);
+      return 1;
+    }
+    for(k = 0; k < KINDS && strcmp(kind_str, kind_names[k]) != 0; k++);
+    if(k == KINDS) {
+      fprintf(stderr, "bad trace entry %s\n", kind_str);
+      return 1;
+    }
+    len = MIN(len, max_len[k]);
+    histograms[k].levels[((len - 1) >> SLA_SHIFT_BITS) + 1]++;
+    histograms[k].count++;
+    sla_quantile_add(&estimators[k], len);
+    if(window_samples < MAX_WINDOW_SAMPLES) {
+      window_kind[window_samples] = k;
+      window_len[window_samples] = len;
+      window_samples++;
+    }
+  }
+  if(window_samples > 0) {
+    determine(window++);
+  }
+
+  printf("total");
+  for(m = 0; m < 2; m++) {
+    printf("\t%s avg_ts %.1f waste %llu ovf %llu", methods[m].name,
+           window > 0 ? (double)methods[m].total_timeslot_length / window : 0.0,
+           (unsigned long long)methods[m].total_wasted_us,
+           (unsigned long long)methods[m].total_overflows);
+  }
+  printf("\n");
+
+  if(f != stdin) {
+    fclose(f);
+  }
+  return 0;
+}
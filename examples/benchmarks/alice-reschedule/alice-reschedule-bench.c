@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Microbenchmark of the ALICE unicast slotframe rescheduling at an ASFN
+ * rollover with 1 to 64 children: full rebuild (all links removed and added
+ * again) and in-place rescheduling (ALICE_INCREMENTAL_RESCHEDULING), in ns
+ * and rtimer ticks per rescheduling. Also checks that both give the same
+ * links. TSCH does not run: the radio is the null radio.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/mac/tsch/tsch.h"
+#include "orchestra.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RESCHEDULES 20000UL
+
+void alice_time_varying_scheduling(void);
+
+static const int child_counts[] = { 1, 8, 16, 32, 64 };
+static uint8_t failed;
+
+PROCESS(alice_reschedule_bench_process, "ALICE reschedule bench");
+AUTOSTART_PROCESSES(&alice_reschedule_bench_process);
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* A child is a neighbor with a route to itself */
+static void
+add_child(uint16_t id)
+{
+  uip_lladdr_t lladdr;
+  uip_ipaddr_t lladdr_ip;
+  uip_ipaddr_t addr;
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[sizeof(lladdr) - 2] = id >> 8;
+  lladdr.addr[sizeof(lladdr) - 1] = id & 0xff;
+  uip_ip6addr(&lladdr_ip, 0xfe80, 0, 0, 0, 0, 0, 0, id);
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, id);
+  if(uip_ds6_nbr_add(&lladdr_ip, &lladdr, 1, NBR_REACHABLE,
+                     NBR_TABLE_REASON_UNDEFINED, NULL) == NULL
+     || uip_ds6_route_add(&addr, 128, &lladdr_ip) == NULL) {
+    printf("FAILED: cannot add child %u\n", id);
+    failed = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_slotframe *
+unicast_slotframe(void)
+{
+  return tsch_schedule_get_slotframe_by_handle(ALICE_UNICAST_SF_HANDLE);
+}
+/*---------------------------------------------------------------------------*/
+/* Rebuilds the unicast slotframe from scratch, as when a child is added */
+static void
+reschedule_full(void)
+{
+  unicast_per_neighbor_rpl_storing.child_added(NULL);
+}
+/*---------------------------------------------------------------------------*/
+/* Number of links of the unicast slotframe with the same cell, neighbor
+   and options in the given links */
+static int
+count_same_links(const struct tsch_link *links, int count)
+{
+  struct tsch_link *l;
+  int same = 0;
+  int i;
+
+  for(l = list_head(unicast_slotframe()->links_list); l != NULL; l = list_item_next(l)) {
+    for(i = 0; i < count; i++) {
+      if(links[i].timeslot == l->timeslot && links[i].channel_offset == l->channel_offset
+         && links[i].link_options == l->link_options
+         && linkaddr_cmp(&links[i].addr, &l->addr)) {
+        same++;
+        break;
+      }
+    }
+  }
+  return same;
+}
+/*---------------------------------------------------------------------------*/
+/* The in-place rescheduling gives the links of a full rebuild */
+static void
+check_same_links(int children)
+{
+  static struct tsch_link links[TSCH_SCHEDULE_MAX_LINKS];
+  struct tsch_link *l;
+  int count = 0;
+
+  alice_lastly_scheduled_asfn++;
+  alice_time_varying_scheduling();
+  for(l = list_head(unicast_slotframe()->links_list); l != NULL; l = list_item_next(l)) {
+    links[count++] = *l;
+  }
+  reschedule_full();
+  if(count != list_length(unicast_slotframe()->links_list)
+     || count_same_links(links, count) != count) {
+    printf("FAILED: in-place and full rescheduling differ with %d children\n", children);
+    failed = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Time per rescheduling in ns, and in rtimer ticks */
+static double
+bench(void (*reschedule)(void), double *ticks)
+{
+  uint64_t start = now_ns();
+  rtimer_clock_t start_ticks = RTIMER_NOW();
+  unsigned long i;
+
+  for(i = 0; i < RESCHEDULES; i++) {
+    alice_lastly_scheduled_asfn++;
+    reschedule();
+  }
+  *ticks = (double)RTIMER_CLOCK_DIFF(RTIMER_NOW(), start_ticks) / RESCHEDULES;
+  return (double)(now_ns() - start) / RESCHEDULES;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(alice_reschedule_bench_process, ev, data)
+{
+  double full_ns, in_place_ns;
+  double full_ticks, in_place_ticks;
+  uint16_t id = 1;
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  printf("ALICE unicast rescheduling, %lu rtimer ticks per second\n",
+         (unsigned long)RTIMER_SECOND);
+  printf("children\tlinks\tfull_ns\tin_place_ns\tfull_ticks\tin_place_ticks\n");
+  for(i = 0; i < sizeof(child_counts) / sizeof(child_counts[0]); i++) {
+    for(; id <= child_counts[i]; id++) {
+      add_child(id);
+    }
+    check_same_links(child_counts[i]);
+    full_ns = bench(reschedule_full, &full_ticks);
+    in_place_ns = bench(alice_time_varying_scheduling, &in_place_ticks);
+    printf("%d\t%d\t%.0f\t%.0f\t%.2f\t%.2f\n", child_counts[i],
+           list_length(unicast_slotframe()->links_list),
+           full_ns, in_place_ns, full_ticks, in_place_ticks);
+  }
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  exit(failed);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,40 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define BENCH_MAX_CHILDREN 64
+
+/* TSCH never associates: no radio */
+#define NETSTACK_CONF_RADIO nullradio_driver
+
+/* ALICE as in examples/ASAP, rescheduling in the slot operation */
+#define WITH_ALICE                            1
+#define ORCHESTRA_CONF_RULES                  { &eb_per_time_source, \
+                                                &default_common, \
+                                                &unicast_per_neighbor_rpl_storing }
+#define ORCHESTRA_CONF_UNICAST_SENDER_BASED   1
+#define ORCHESTRA_CONF_EBSF_PERIOD            397
+#define ORCHESTRA_CONF_COMMON_SHARED_PERIOD   17
+#define ORCHESTRA_CONF_UNICAST_PERIOD         20
+#define ALICE_PACKET_CELL_MATCHING_ON_THE_FLY alice_packet_cell_matching_on_the_fly
+#define ALICE_TIME_VARYING_SCHEDULING         alice_time_varying_scheduling
+#define ALICE_INCREMENTAL_RESCHEDULING        1
+#define ALICE_PACKET_CELL_MATCHING_CACHE      1
+#define TSCH_SCHED_EB_SF_HANDLE               0
+#define TSCH_SCHED_COMMON_SF_HANDLE           1
+#define TSCH_SCHED_UNICAST_SF_HANDLE          2
+#define ALICE_COMMON_SF_HANDLE                TSCH_SCHED_COMMON_SF_HANDLE
+#define ALICE_UNICAST_SF_HANDLE               TSCH_SCHED_UNICAST_SF_HANDLE
+
+#define NBR_TABLE_CONF_MAX_NEIGHBORS  (BENCH_MAX_CHILDREN + 2)
+#define UIP_CONF_MAX_ROUTES           BENCH_MAX_CHILDREN
+#define TSCH_SCHEDULE_CONF_MAX_LINKS  (3 + 2 * BENCH_MAX_CHILDREN + 2)
+#define RPL_CONF_MOP                  RPL_MOP_STORING_NO_MULTICAST
+#define HCK_GET_NODE_ID_FROM_LINKADDR(addr) \
+  ((((addr)->u8[LINKADDR_SIZE - 2]) << 8) | (addr)->u8[LINKADDR_SIZE - 1])
+#define RPL_FIRST_MEASURE_PERIOD      (1 * 60)
+#define RPL_NEXT_MEASURE_PERIOD       (1 * 60)
+
+/* The IPv6 stack logs its housekeeping counters */
+#define LOG_HK_ENABLED 1
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Microbenchmark of nbr_table_get_from_lladdr() with 8, 32, 64 and 128
+ * neighbors, for hits and misses, with addresses that only differ in their
+ * last two bytes as on our testbeds. Also checks lookups after neighbors
+ * have been replaced. Build with HASH=0 (list walk) or HASH=1 (hash index),
+ * or run both with 'make run'.
+ */
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LOOKUPS 2000000UL
+
+struct bench_item {
+  uint16_t id;
+};
+
+NBR_TABLE(struct bench_item, bench_table);
+
+static const int fill_levels[] = { 8, 32, 64, 128 };
+static uint8_t failed;
+
+PROCESS(nbr_table_bench_process, "nbr-table bench");
+AUTOSTART_PROCESSES(&nbr_table_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+addr_of_id(linkaddr_t *addr, uint16_t id)
+{
+  int i;
+  for(i = 0; i < LINKADDR_SIZE - 2; i++) {
+    addr->u8[i] = 0x02 + i;
+  }
+  addr->u8[LINKADDR_SIZE - 2] = id >> 8;
+  addr->u8[LINKADDR_SIZE - 1] = id & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Average lookup time in ns, ids picked in [first, first + range) */
+static double
+bench_lookups(uint16_t first, uint16_t range, int expect_found)
+{
+  static linkaddr_t addrs[256];
+  uint64_t start;
+  unsigned long i;
+  int found = 0;
+  uint16_t j;
+
+  for(j = 0; j < range; j++) {
+    addr_of_id(&addrs[j], first + j);
+  }
+  start = now_ns();
+  for(i = 0; i < LOOKUPS; i++) {
+    /* 97 is prime to all ranges: visits the addresses in a scattered order */
+    struct bench_item *item = nbr_table_get_from_lladdr(bench_table, &addrs[(i * 97) % range]);
+    found += item != NULL;
+  }
+  if(found != (expect_found ? LOOKUPS : 0)) {
+    printf("FAILED: %d/%lu lookups found\n", found, LOOKUPS);
+    failed = 1;
+  }
+  return (double)(now_ns() - start) / LOOKUPS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_ids(uint16_t first, uint16_t count, int expect_found)
+{
+  linkaddr_t addr;
+  uint16_t id;
+
+  for(id = first; id < first + count; id++) {
+    struct bench_item *item;
+    addr_of_id(&addr, id);
+    item = nbr_table_get_from_lladdr(bench_table, &addr);
+    if(expect_found ? (item == NULL || item->id != id) : item != NULL) {
+      printf("FAILED: lookup of neighbor %u\n", id);
+      failed = 1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(nbr_table_bench_process, ev, data)
+{
+  linkaddr_t addr;
+  uint16_t id = 1;
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  nbr_table_register(bench_table, NULL);
+
+  printf("nbr-table lookup, hash index %u, max %u neighbors\n",
+         NBR_TABLE_WITH_HASH_INDEX, NBR_TABLE_MAX_NEIGHBORS);
+  printf("neighbors\thit_ns\tmiss_ns\n");
+  for(i = 0; i < sizeof(fill_levels) / sizeof(fill_levels[0]); i++) {
+    for(; id <= fill_levels[i]; id++) {
+      struct bench_item *item;
+      addr_of_id(&addr, id);
+      item = nbr_table_add_lladdr(bench_table, &addr, NBR_TABLE_REASON_UNDEFINED, NULL);
+      if(item == NULL) {
+        printf("FAILED: cannot add neighbor %u\n", id);
+        failed = 1;
+        break;
+      }
+      item->id = id;
+    }
+    printf("%d\t%.1f\t%.1f\n", fill_levels[i],
+           bench_lookups(1, fill_levels[i], 1),
+           bench_lookups(1000, fill_levels[i], 0));
+  }
+
+  /* Table is full: each new neighbor replaces the oldest one */
+  for(id = 1000; id < 1000 + NBR_TABLE_MAX_NEIGHBORS / 2; id++) {
+    struct bench_item *item;
+    addr_of_id(&addr, id);
+    item = nbr_table_add_lladdr(bench_table, &addr, NBR_TABLE_REASON_UNDEFINED, NULL);
+    if(item != NULL) {
+      item->id = id;
+    }
+  }
+  check_ids(1, NBR_TABLE_MAX_NEIGHBORS / 2, 0);
+  check_ids(NBR_TABLE_MAX_NEIGHBORS / 2 + 1, NBR_TABLE_MAX_NEIGHBORS / 2, 1);
+  check_ids(1000, NBR_TABLE_MAX_NEIGHBORS / 2, 1);
+
+  /* Removed items keep their key: they are found again once re-added */
+  for(id = 1000; id < 1010; id++) {
+    addr_of_id(&addr, id);
+    nbr_table_remove(bench_table, nbr_table_get_from_lladdr(bench_table, &addr));
+  }
+  check_ids(1000, 10, 0);
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  exit(failed);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,7 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 128
+#define LINKADDR_CONF_SIZE 8
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,9 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define UIP_CONF_MAX_ROUTES 1000
+#define NBR_TABLE_CONF_MAX_NEIGHBORS 16
+/* The IPv6 stack logs its housekeeping counters */
+#define LOG_HK_ENABLED 1
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Microbenchmark of uip_ds6_route_lookup() with 100, 500 and 1000 /128
+ * routes, in lookups per second for hits and misses, as on a storing-mode
+ * RPL root. Also checks lookups after routes have been removed, by route and
+ * by next hop, and longest-prefix matches with a /64 route, of which it
+ * measures the lookups of addresses without a host route. Build with
+ * HASH=0 (list walk) or HASH=1 (hash index), or run both with 'make run'.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LOOKUPS 200000UL
+#define NEXTHOPS 8
+
+static const int fill_levels[] = { 100, 500, 1000 };
+static uip_ipaddr_t nexthops[NEXTHOPS];
+static uint8_t failed;
+
+PROCESS(route_table_bench_process, "route-table bench");
+AUTOSTART_PROCESSES(&route_table_bench_process);
+/*---------------------------------------------------------------------------*/
+static void
+addr_of_id(uip_ipaddr_t *addr, uint16_t id)
+{
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x0212, 0x7400, 0, id);
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_nexthops(void)
+{
+  uip_lladdr_t lladdr;
+  int i;
+
+  for(i = 0; i < NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr) - 1] = i + 1;
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    if(uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                       NBR_TABLE_REASON_UNDEFINED, NULL) == NULL) {
+      printf("FAILED: cannot add next hop %d\n", i + 1);
+      failed = 1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_route(uint16_t id)
+{
+  uip_ipaddr_t addr;
+
+  addr_of_id(&addr, id);
+  if(uip_ds6_route_add(&addr, 128, &nexthops[id % NEXTHOPS]) == NULL) {
+    printf("FAILED: cannot add route %u\n", id);
+    failed = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Lookups per second, ids picked in [first, first + range) */
+static double
+bench_lookups(uint16_t first, uint16_t range, int expect_found)
+{
+  static uip_ipaddr_t addrs[1000];
+  uint64_t start;
+  unsigned long i;
+  unsigned long found = 0;
+  uint16_t j;
+
+  for(j = 0; j < range; j++) {
+    addr_of_id(&addrs[j], first + j);
+  }
+  start = now_ns();
+  for(i = 0; i < LOOKUPS; i++) {
+    /* 97 is prime to all ranges: visits the addresses in a scattered order */
+    found += uip_ds6_route_lookup(&addrs[(i * 97) % range]) != NULL;
+  }
+  if(found != (expect_found ? LOOKUPS : 0)) {
+    printf("FAILED: %lu/%lu lookups found\n", found, LOOKUPS);
+    failed = 1;
+  }
+  return LOOKUPS * 1e9 / (now_ns() - start);
+}
+/*---------------------------------------------------------------------------*/
+/* Checks that ids in [first, first + count) have a /128 route, or no
+   route when expect_length is 0, or the route of the given prefix length */
+static void
+check_ids(uint16_t first, uint16_t count, uint8_t expect_length)
+{
+  uip_ipaddr_t addr;
+  uint16_t id;
+
+  for(id = first; id < first + count; id++) {
+    uip_ds6_route_t *r;
+    addr_of_id(&addr, id);
+    r = uip_ds6_route_lookup(&addr);
+    if(expect_length == 0 ? r != NULL
+       : (r == NULL || r->length != expect_length
+          || (expect_length == 128 && !uip_ipaddr_cmp(&r->ipaddr, &addr)))) {
+      printf("FAILED: lookup of route %u\n", id);
+      failed = 1;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(route_table_bench_process, ev, data)
+{
+  uip_ipaddr_t addr;
+  uint16_t id = 1;
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  add_nexthops();
+
+  printf("route lookup, hash index %u, max %u routes\n",
+         UIP_DS6_ROUTE_WITH_HASH_INDEX, UIP_DS6_ROUTE_NB);
+  printf("routes\thit_per_s\tmiss_per_s\n");
+  for(i = 0; i < sizeof(fill_levels) / sizeof(fill_levels[0]); i++) {
+    for(; id <= fill_levels[i]; id++) {
+      add_route(id);
+    }
+    printf("%d\t%.0f\t%.0f\n", fill_levels[i],
+           bench_lookups(1, fill_levels[i], 1),
+           bench_lookups(2001, fill_levels[i], 0));
+  }
+
+  /* Removed routes are no longer found, the others still are */
+  for(id = 1; id <= 500; id++) {
+    addr_of_id(&addr, id);
+    uip_ds6_route_rm(uip_ds6_route_lookup(&addr));
+  }
+  check_ids(1, 500, 0);
+  check_ids(501, 500, 128);
+
+  /* Re-added routes are found again, and removing a next hop removes
+     all routes through it */
+  for(id = 1; id <= 500; id++) {
+    add_route(id);
+  }
+  check_ids(1, 1000, 128);
+  uip_ds6_route_rm_by_nexthop(&nexthops[1]);
+  for(id = 1; id <= 1000; id++) {
+    addr_of_id(&addr, id);
+    if((uip_ds6_route_lookup(&addr) != NULL) != (id % NEXTHOPS != 1)) {
+      printf("FAILED: lookup of route %u after next hop removal\n", id);
+      failed = 1;
+    }
+  }
+
+  /* A /64 prefix route matches the addresses without a host route. Note
+     that uip_ds6_route_add() replaces the longest match of a new route if
+     its next hop differs, so the prefix is added last. */
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  if(uip_ds6_route_add(&addr, 64, &nexthops[0]) == NULL) {
+    printf("FAILED: cannot add prefix route\n");
+    failed = 1;
+  }
+  for(id = 1; id <= 1000; id++) {
+    check_ids(id, 1, id % NEXTHOPS == 1 ? 64 : 128);
+  }
+  printf("prefix\t%.0f\n", bench_lookups(2001, 1000, 1));
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  exit(failed);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
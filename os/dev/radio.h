@@ -334,6 +334,15 @@ struct radio_driver {
   radio_result_t (* set_object)(radio_param_t param, const void *src,
                                 size_t size);
 
+  /**
+   * Optional, may be NULL. Prepare a burst of 'count' frames, sent back to
+   * back by 'count' successive calls to transmit() without prepare() in
+   * between. The frames are not copied: they must stay valid until the last
+   * of them has been transmitted. A call to prepare() cancels the burst.
+   * Returns 0 on success.
+   */
+  int (* prepare_burst)(const void **payloads, const unsigned short *payload_lens,
+                        int count);
 };
 
 #endif /* RADIO_H_ */
@@ -47,12 +47,40 @@
 #include "contiki.h"
 #include "lib/memb.h"
 
+#if MEMB_WITH_BITMAP
+/*---------------------------------------------------------------------------*/
+static int
+first_zero_bit(uint32_t word)
+{
+#if defined(__GNUC__)
+  return __builtin_ctz(~word);
+#else /* __GNUC__ */
+  int bit = 0;
+
+  while(word & 1) {
+    word >>= 1;
+    bit++;
+  }
+  return bit;
+#endif /* __GNUC__ */
+}
+#endif /* MEMB_WITH_BITMAP */
 /*---------------------------------------------------------------------------*/
 void
 memb_init(struct memb *m)
 {
+#if MEMB_WITH_BITMAP
+  memset(m->used, 0, ((m->num + 31) / 32) * sizeof(uint32_t));
+#else /* MEMB_WITH_BITMAP */
   memset(m->used, 0, m->num);
+#endif /* MEMB_WITH_BITMAP */
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  m->used_count = 0;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  m->high_water = 0;
+#endif /* MEMB_WITH_STATS */
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,24 +88,80 @@ memb_alloc(struct memb *m)
 {
   int i;
 
+#if MEMB_WITH_BITMAP
+  int w;
+
+  if(m->used_count >= m->num) {
+    return NULL;
+  }
+
+  /* The pool is not full, so the first word with a zero bit holds the
+     lowest free block. The bits past num are never set, but a block
+     index past num is still caught below. */
+  i = -1;
+  for(w = 0; w < (m->num + 31) / 32; ++w) {
+    if(m->used[w] != 0xffffffff) {
+      i = w * 32 + first_zero_bit(m->used[w]);
+      break;
+    }
+  }
+  if(i < 0 || i >= m->num) {
+    return NULL;
+  }
+  m->used[i / 32] |= (uint32_t)1 << (i % 32);
+#else /* MEMB_WITH_BITMAP */
   for(i = 0; i < m->num; ++i) {
     if(m->used[i] == false) {
-      /* If this block was unused, we set the used flag on
-	 and return a pointer to the memory block. */
-      m->used[i] = true;
-      return (void *)((char *)m->mem + (i * m->size));
+      break;
     }
   }
+  if(i == m->num) {
+    /* No free block was found, so we return NULL to indicate failure to
+       allocate block. */
+    return NULL;
+  }
+  /* If this block was unused, we set the used flag on
+     and return a pointer to the memory block. */
+  m->used[i] = true;
+#endif /* MEMB_WITH_BITMAP */
 
-  /* No free block was found, so we return NULL to indicate failure to
-     allocate block. */
-  return NULL;
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  m->used_count++;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  if(m->used_count > m->high_water) {
+    m->high_water = m->used_count;
+  }
+#endif /* MEMB_WITH_STATS */
+  return (void *)((char *)m->mem + (i * m->size));
 }
 /*---------------------------------------------------------------------------*/
 int
 memb_free(struct memb *m, void *ptr)
 {
   int i;
+
+#if MEMB_WITH_BITMAP
+  size_t offset;
+
+  /* The block index follows from the offset of "ptr" in the pool, which
+     must fall on a block boundary. */
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+
+  /* Check the allocation status to detect the double-free error and free
+     the block. */
+  if((m->used[i / 32] & ((uint32_t)1 << (i % 32))) == 0) {
+    return -1;
+  }
+  m->used[i / 32] &= ~((uint32_t)1 << (i % 32));
+#else /* MEMB_WITH_BITMAP */
   char *ptr2;
 
   /* Walk through the list of blocks and try to find the block to
@@ -85,16 +169,25 @@ memb_free(struct memb *m, void *ptr)
   ptr2 = (char *)m->mem;
   for(i = 0; i < m->num; ++i) {
     if(ptr2 == (char *)ptr) {
-      /* We've found the block to which "ptr" points, so we check the allocation
-         status to detect the double-free error and free the block. */
-      if (m->used[i] == false)
-        return -1;
-      m->used[i] = false;
-      return 0;
+      break;
     }
     ptr2 += m->size;
   }
-  return -1;
+  if(i == m->num) {
+    return -1;
+  }
+  /* We've found the block to which "ptr" points, so we check the allocation
+     status to detect the double-free error and free the block. */
+  if(m->used[i] == false) {
+    return -1;
+  }
+  m->used[i] = false;
+#endif /* MEMB_WITH_BITMAP */
+
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  m->used_count--;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -107,6 +200,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  return m->num - m->used_count;
+#else /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
   int i;
   int num_free = 0;
 
@@ -117,5 +213,14 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+}
+/*---------------------------------------------------------------------------*/
+#if MEMB_WITH_STATS
+int
+memb_high_water(struct memb *m)
+{
+  return m->high_water;
 }
+#endif /* MEMB_WITH_STATS */
 /** @} */
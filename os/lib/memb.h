@@ -64,8 +64,31 @@
 #define MEMB_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "sys/cc.h"
 
+/**
+ * Keep the allocation state of the blocks in a bitmap, with a count of
+ * used blocks. memb_alloc() then finds the first free block with a
+ * count-trailing-zeros per 32 blocks, and memb_free() and memb_numfree()
+ * take constant time. Blocks are still allocated lowest index first.
+ */
+#ifdef MEMB_CONF_WITH_BITMAP
+#define MEMB_WITH_BITMAP MEMB_CONF_WITH_BITMAP
+#else /* MEMB_CONF_WITH_BITMAP */
+#define MEMB_WITH_BITMAP 0
+#endif /* MEMB_CONF_WITH_BITMAP */
+
+/**
+ * Keep the maximum number of blocks used at the same time, see
+ * memb_high_water().
+ */
+#ifdef MEMB_CONF_WITH_STATS
+#define MEMB_WITH_STATS MEMB_CONF_WITH_STATS
+#else /* MEMB_CONF_WITH_STATS */
+#define MEMB_WITH_STATS 0
+#endif /* MEMB_CONF_WITH_STATS */
+
 /**
  * Declare a memory block.
  *
@@ -87,18 +110,37 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#if MEMB_WITH_BITMAP
+#define MEMB(name, structure, num) \
+        static uint32_t CC_CONCAT(name,_memb_used)[((num) + 31) / 32]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_used), \
+                                          (void *)CC_CONCAT(name,_memb_mem)}
+#else /* MEMB_WITH_BITMAP */
 #define MEMB(name, structure, num) \
         static bool CC_CONCAT(name,_memb_used)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_used), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
+#endif /* MEMB_WITH_BITMAP */
 
 struct memb {
   unsigned short size;
   unsigned short num;
+#if MEMB_WITH_BITMAP
+  uint32_t *used; /* One bit per block, set if used */
+#else /* MEMB_WITH_BITMAP */
   bool *used;
+#endif /* MEMB_WITH_BITMAP */
   void *mem;
+#if MEMB_WITH_BITMAP || MEMB_WITH_STATS
+  unsigned short used_count;
+#endif /* MEMB_WITH_BITMAP || MEMB_WITH_STATS */
+#if MEMB_WITH_STATS
+  unsigned short high_water;
+#endif /* MEMB_WITH_STATS */
 };
 
 /**
@@ -149,6 +191,18 @@ int memb_inmemb(struct memb *m, void *ptr);
  */
 int  memb_numfree(struct memb *m);
 
+#if MEMB_WITH_STATS
+/**
+ * Get the maximum number of blocks used at the same time since
+ * memb_init() (requires MEMB_CONF_WITH_STATS).
+ *
+ * \param m A set of memory blocks previously declared with MEMB().
+ *
+ * \return The high-water mark of the number of used blocks
+ */
+int memb_high_water(struct memb *m);
+#endif /* MEMB_WITH_STATS */
+
 /** @} */
 /** @} */
 
@@ -73,6 +73,7 @@
 #include "net/netstack.h"
 #include "net/packetbuf.h"
 #include "net/queuebuf.h"
+#include "net/nbr-table.h"
 
 #include "net/routing/routing.h"
 
@@ -81,6 +82,63 @@
 #define LOG_MODULE "6LoWPAN"
 #define LOG_LEVEL LOG_LEVEL_6LOWPAN
 
+/* Aggregation of small packets: an outgoing unicast UDP packet is held while
+ * a frame to the same next hop is waiting in the MAC, and the packets held
+ * are then sent in one frame (SICSLOWPAN_DISPATCH_AGGREGATE). Non-fragmented
+ * packets only, the receiver must support it too. */
+#ifdef SICSLOWPAN_CONF_AGGREGATION
+#define SICSLOWPAN_AGGREGATION SICSLOWPAN_CONF_AGGREGATION
+#else
+#define SICSLOWPAN_AGGREGATION 0
+#endif
+
+/* Maximum time a packet is held for aggregation */
+#ifdef SICSLOWPAN_CONF_AGGREGATION_MAX_DELAY
+#define SICSLOWPAN_AGGREGATION_MAX_DELAY SICSLOWPAN_CONF_AGGREGATION_MAX_DELAY
+#else
+#define SICSLOWPAN_AGGREGATION_MAX_DELAY (CLOCK_SECOND / 2)
+#endif
+
+/* Flow contexts: the compressed headers of a unicast UDP packet are sent
+ * once to a neighbor with SICSLOWPAN_DISPATCH_FLOW_CTX_SET and stored on both
+ * ends. Once that frame is acknowledged, the next packets with the same
+ * headers (same flow, same hop limit) only carry the context, the compressed
+ * RPL option (its sender rank changes often) and the UDP checksum
+ * (SICSLOWPAN_DISPATCH_FLOW_CTX). A receiver that does not have the context,
+ * or has no room to store it, answers with SICSLOWPAN_DISPATCH_FLOW_CTX_NACK
+ * and the sender sets it again; only the packets already queued with the
+ * context are lost. Non-fragmented packets only, the receiver must support
+ * it too. */
+#ifdef SICSLOWPAN_CONF_FLOW_CTX
+#define SICSLOWPAN_FLOW_CTX SICSLOWPAN_CONF_FLOW_CTX
+#else
+#define SICSLOWPAN_FLOW_CTX 0
+#endif
+
+/* Flow contexts per neighbor and direction, up to 16. Each neighbor takes
+ * 2 * SLOTS * (HDR_MAX + 4) + SLOTS + 3 bytes (181 with the defaults), for
+ * up to NBR_TABLE_MAX_NEIGHBORS neighbors */
+#ifdef SICSLOWPAN_CONF_FLOW_CTX_SLOTS
+#define SICSLOWPAN_FLOW_CTX_SLOTS SICSLOWPAN_CONF_FLOW_CTX_SLOTS
+#else
+#define SICSLOWPAN_FLOW_CTX_SLOTS 2
+#endif
+
+/* Longest compressed header kept in a flow context */
+#ifdef SICSLOWPAN_CONF_FLOW_CTX_HDR_MAX
+#define SICSLOWPAN_FLOW_CTX_HDR_MAX SICSLOWPAN_CONF_FLOW_CTX_HDR_MAX
+#else
+#define SICSLOWPAN_FLOW_CTX_HDR_MAX 40
+#endif
+
+/* Packets sent with a flow context before it is set again, for a receiver
+ * that lost it (reboot, neighbor table replacement) to get it back */
+#ifdef SICSLOWPAN_CONF_FLOW_CTX_REFRESH
+#define SICSLOWPAN_FLOW_CTX_REFRESH SICSLOWPAN_CONF_FLOW_CTX_REFRESH
+#else
+#define SICSLOWPAN_FLOW_CTX_REFRESH 32
+#endif
+
 static uint32_t ip_ucast_transmission_count;
 static uint16_t ip_ucast_ok_count;
 static uint16_t ip_ucast_noack_count;
@@ -96,6 +154,32 @@ static uint16_t ip_ucast_udp_ok_count;
 static uint16_t ip_ucast_udp_noack_count;
 static uint16_t ip_ucast_udp_error_count;
 
+/* Compression ratio of routed non-fragmented packets: bytes of IPv6 headers
+ * and bytes of the 6LoWPAN headers they are sent as */
+static uint32_t hc_tx_ip_bytes;
+static uint32_t hc_tx_lowpan_bytes;
+static uint32_t hc_rx_ip_bytes;
+static uint32_t hc_rx_lowpan_bytes;
+
+#if SICSLOWPAN_AGGREGATION
+/* Aggregate frames and the packets in them */
+static uint32_t agg_tx_count;
+static uint32_t agg_tx_packet_count;
+static uint32_t agg_rx_count;
+static uint32_t agg_rx_packet_count;
+#endif
+
+#if SICSLOWPAN_FLOW_CTX
+static uint32_t flow_ctx_tx_set_count;
+static uint32_t flow_ctx_tx_use_count;
+static uint32_t flow_ctx_tx_saved_bytes;
+static uint32_t flow_ctx_rx_set_count;
+static uint32_t flow_ctx_rx_use_count;
+static uint32_t flow_ctx_rx_miss_count;
+static uint32_t flow_ctx_tx_nack_count;
+static uint32_t flow_ctx_rx_nack_count;
+#endif
+
 void reset_log_sicslowpan()
 {
   ip_ucast_transmission_count = 0;
@@ -112,6 +196,29 @@ void reset_log_sicslowpan()
   ip_ucast_udp_ok_count = 0;
   ip_ucast_udp_noack_count = 0;
   ip_ucast_udp_error_count = 0;
+
+  hc_tx_ip_bytes = 0;
+  hc_tx_lowpan_bytes = 0;
+  hc_rx_ip_bytes = 0;
+  hc_rx_lowpan_bytes = 0;
+
+#if SICSLOWPAN_AGGREGATION
+  agg_tx_count = 0;
+  agg_tx_packet_count = 0;
+  agg_rx_count = 0;
+  agg_rx_packet_count = 0;
+#endif
+
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_tx_set_count = 0;
+  flow_ctx_tx_use_count = 0;
+  flow_ctx_tx_saved_bytes = 0;
+  flow_ctx_rx_set_count = 0;
+  flow_ctx_rx_use_count = 0;
+  flow_ctx_rx_miss_count = 0;
+  flow_ctx_tx_nack_count = 0;
+  flow_ctx_rx_nack_count = 0;
+#endif
 }
 
 #define GET16(ptr,index) (((uint16_t)((ptr)[index] << 8)) | ((ptr)[(index) + 1]))
@@ -219,6 +326,25 @@ static int mac_max_payload;
  */
 static uint8_t curr_page;
 
+/**
+ * The hop-by-hop header with the RPL option of the packet being sent or
+ * received as an RPI 6LoRH (RFC 8138), and whether it is elided
+ */
+#define RPI_OPT_LEN 4
+#define RPI_HBH_LEN (2 + 2 + RPI_OPT_LEN)
+static uint8_t rpi_hbh[RPI_HBH_LEN];
+static uint8_t rpi_hbh_elided;
+
+#if SICSLOWPAN_FLOW_CTX
+/**
+ * Position and length in packetbuf of the compressed RPL option of the
+ * packet being sent (RPI 6LoRH, or option data in the hop-by-hop header),
+ * kept out of flow contexts as the sender rank changes often
+ */
+static uint8_t flow_ctx_rpl_pos;
+static uint8_t flow_ctx_rpl_len;
+#endif /* SICSLOWPAN_FLOW_CTX */
+
 /**
  * the result of the last transmitted fragment
  */
@@ -506,8 +632,13 @@ static void
 set_packet_attrs(void)
 {
   int c = 0;
-  /* set protocol in NETWORK_ID */
-  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, UIP_IP_BUF->proto);
+  uint8_t proto;
+  /* set protocol in NETWORK_ID: the upper-layer protocol, after any extension
+   * header (e.g. the RPL hop-by-hop option of data packets) */
+  if(uipbuf_get_last_header(uip_buf, uip_len, &proto) == NULL) {
+    proto = UIP_IP_BUF->proto;
+  }
+  packetbuf_set_attr(PACKETBUF_ATTR_NETWORK_ID, proto);
 
   /* assign values to the channel attribute (port or type + code) */
   if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
@@ -984,6 +1115,13 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
         /* copy the ext-hdr into the hc06 buffer */
         CHECK_BUFFER_SPACE(len);
         memcpy(hc06_ptr, ext_hdr, len);
+#if SICSLOWPAN_FLOW_CTX
+        if(proto == SICSLOWPAN_NHC_ETX_HDR_HBHO && len == RPI_HBH_LEN
+           && hc06_ptr[2] == UIP_EXT_HDR_OPT_RPL && hc06_ptr[3] == RPI_OPT_LEN) {
+          flow_ctx_rpl_pos = hc06_ptr + 4 - packetbuf_ptr;
+          flow_ctx_rpl_len = RPI_OPT_LEN;
+        }
+#endif /* SICSLOWPAN_FLOW_CTX */
         /* modify the len to octets */
         ext_hdr = (struct uip_ext_hdr *) hc06_ptr;
         ext_hdr->len = len - 2; /* Len should be in bytes from len byte*/
@@ -1406,6 +1544,24 @@ uncompress_hdr_iphc(uint8_t *buf, uint16_t ip_len)
 /** @} */
 #endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
 
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Inserts the hop-by-hop header of an RPI 6LoRH after the IPv6
+ * header of a packet
+ * \param buf The packet
+ * \param len The bytes after the IPv6 header, moved after the new header
+ */
+static void
+insert_rpi_hbh(uint8_t *buf, uint16_t len)
+{
+  memmove(buf + UIP_IPH_LEN + RPI_HBH_LEN, buf + UIP_IPH_LEN, len);
+  rpi_hbh[0] = SICSLOWPAN_IP_BUF(buf)->proto;
+  memcpy(buf + UIP_IPH_LEN, rpi_hbh, RPI_HBH_LEN);
+  SICSLOWPAN_IP_BUF(buf)->proto = UIP_PROTO_HBHO;
+  uipbuf_set_len_field(SICSLOWPAN_IP_BUF(buf),
+                       uipbuf_get_len_field(SICSLOWPAN_IP_BUF(buf)) + RPI_HBH_LEN);
+}
+
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
 /*--------------------------------------------------------------------*/
 /**
@@ -1425,7 +1581,88 @@ add_paging_dispatch(uint8_t page)
 static void
 add_6lorh_hdr(void)
 {
-  /* 6LoRH is not implemented yet */
+  struct uip_hbho_hdr *hbh_hdr = (struct uip_hbho_hdr *)UIP_IP_PAYLOAD(0);
+  struct uip_ext_hdr_opt_rpl *rpl_opt = (struct uip_ext_hdr_opt_rpl *)UIP_IP_PAYLOAD(2);
+  uint8_t *lorh = PACKETBUF_6LO_PTR;
+  uint16_t rank;
+  int pos = 2;
+
+  /* RPI 6LoRH, if RPL asked for it and the hop-by-hop header only has the
+   * RPL option */
+  if(!uipbuf_is_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_RPI_6LORH)
+     || UIP_IP_BUF->proto != UIP_PROTO_HBHO
+     || uip_len < UIP_IPH_LEN + RPI_HBH_LEN
+     || hbh_hdr->len != 0
+     || rpl_opt->opt_type != UIP_EXT_HDR_OPT_RPL
+     || rpl_opt->opt_len != RPI_OPT_LEN) {
+    return;
+  }
+
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_rpl_pos = packetbuf_hdr_len;
+#endif /* SICSLOWPAN_FLOW_CTX */
+  lorh[0] = SICSLOWPAN_6LORH_CRITICAL
+    | ((rpl_opt->flags >> 3) & SICSLOWPAN_6LORH_RPI_ORF_MASK);
+  lorh[1] = SICSLOWPAN_6LORH_TYPE_RPI;
+  if(rpl_opt->instance == 0) {
+    lorh[0] |= SICSLOWPAN_6LORH_RPI_I;
+  } else {
+    lorh[pos++] = rpl_opt->instance;
+  }
+  rank = UIP_HTONS(rpl_opt->senderrank);
+  lorh[pos++] = rank >> 8;
+  if((rank & 0xff) == 0) {
+    lorh[0] |= SICSLOWPAN_6LORH_RPI_K;
+  } else {
+    lorh[pos++] = rank & 0xff;
+  }
+  packetbuf_hdr_len += pos;
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_rpl_len = pos;
+#endif /* SICSLOWPAN_FLOW_CTX */
+
+  /* IPHC compresses the packet without the hop-by-hop header */
+  memcpy(rpi_hbh, hbh_hdr, RPI_HBH_LEN);
+  UIP_IP_BUF->proto = hbh_hdr->next;
+  memmove(UIP_IP_PAYLOAD(0), UIP_IP_PAYLOAD(RPI_HBH_LEN),
+          uip_len - UIP_IPH_LEN - RPI_HBH_LEN);
+  uip_len -= RPI_HBH_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  rpi_hbh_elided = 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compresses the headers with IPHC, after the 6LoRH headers on
+ * routed traffic (non link-local)
+ * \param link_destaddr L2 destination address, needed to compress IP dest
+ * \param with_rpi Whether the RPL option may be sent as an RPI 6LoRH
+ * \return 1 if success, else 0
+ */
+static int
+compress_hdr_6lorh(linkaddr_t *link_destaddr, int with_rpi)
+{
+  int ret;
+
+  rpi_hbh_elided = 0;
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_rpl_len = 0;
+#endif /* SICSLOWPAN_FLOW_CTX */
+  if(!uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr)) {
+    add_paging_dispatch(1);
+    if(with_rpi) {
+      add_6lorh_hdr();
+    }
+  }
+
+  ret = compress_hdr_iphc(link_destaddr);
+
+  if(rpi_hbh_elided) {
+    /* Put the hop-by-hop header back, as compressed header */
+    insert_rpi_hbh(uip_buf, uip_len - UIP_IPH_LEN);
+    uip_len += RPI_HBH_LEN;
+    uncomp_hdr_len += RPI_HBH_LEN;
+  }
+  return ret;
 }
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
 
@@ -1447,10 +1684,45 @@ digest_paging_dispatch(void)
 /**
  * \brief Digest 6lorh headers before IPHC
  */
-static void
+static int
 digest_6lorh_hdr(void)
 {
-  /* 6LoRH is not implemented yet */
+  uint8_t *lorh;
+  int pos;
+
+  rpi_hbh_elided = 0;
+  while(packetbuf_hdr_len < packetbuf_datalen()) {
+    lorh = PACKETBUF_6LO_PTR;
+    if((lorh[0] & SICSLOWPAN_6LORH_MASK) != SICSLOWPAN_6LORH_CRITICAL
+       && (lorh[0] & SICSLOWPAN_6LORH_MASK) != SICSLOWPAN_6LORH_ELECTIVE) {
+      /* IPHC follows */
+      break;
+    }
+    if(packetbuf_hdr_len + 2 > packetbuf_datalen()) {
+      return 0;
+    }
+    if((lorh[0] & SICSLOWPAN_6LORH_MASK) == SICSLOWPAN_6LORH_ELECTIVE) {
+      /* Elective 6LoRH, can be skipped */
+      LOG_DBG("input: skipping elective 6LoRH type %u\n", lorh[1]);
+      packetbuf_hdr_len += 2 + (lorh[0] & SICSLOWPAN_6LORH_LEN_MASK);
+    } else if(lorh[1] == SICSLOWPAN_6LORH_TYPE_RPI && !rpi_hbh_elided) {
+      /* RPI 6LoRH, as the hop-by-hop header with the RPL option */
+      pos = 2;
+      rpi_hbh[1] = 0;
+      rpi_hbh[2] = UIP_EXT_HDR_OPT_RPL;
+      rpi_hbh[3] = RPI_OPT_LEN;
+      rpi_hbh[4] = (lorh[0] & SICSLOWPAN_6LORH_RPI_ORF_MASK) << 3;
+      rpi_hbh[5] = (lorh[0] & SICSLOWPAN_6LORH_RPI_I) ? 0 : lorh[pos++];
+      rpi_hbh[6] = lorh[pos++];
+      rpi_hbh[7] = (lorh[0] & SICSLOWPAN_6LORH_RPI_K) ? 0 : lorh[pos++];
+      packetbuf_hdr_len += pos;
+      rpi_hbh_elided = 1;
+    } else {
+      LOG_ERR("input: critical 6LoRH type %u not supported\n", lorh[1]);
+      return 0;
+    }
+  }
+  return packetbuf_hdr_len <= packetbuf_datalen();
 }
 /*--------------------------------------------------------------------*/
 /** \name IPv6 dispatch "compression" function
@@ -1486,6 +1758,383 @@ compress_hdr_ipv6(linkaddr_t *link_destaddr)
 /** \name Input/output functions common to all compression schemes
  * @{                                                                 */
 /*--------------------------------------------------------------------*/
+#if SICSLOWPAN_AGGREGATION
+/* Packets held for aggregation: the dispatch, then the length and the
+ * compressed packet of each */
+static uint8_t agg_buf[PACKETBUF_SIZE];
+static uint16_t agg_len;
+static uint8_t agg_count;
+static int agg_max_payload;
+static linkaddr_t agg_dest;
+/* Packetbuf attributes of the packets held, all equal, for the aggregate frame */
+static struct packetbuf_attr agg_attrs[PACKETBUF_NUM_ATTRS];
+static struct packetbuf_addr agg_addrs[PACKETBUF_NUM_ADDRS];
+static struct ctimer agg_timer;
+/* Unicast frames given to the MAC for a next hop and not sent yet */
+static linkaddr_t agg_inflight_dest;
+static uint8_t agg_inflight;
+
+static void agg_timeout(void *ptr);
+/*--------------------------------------------------------------------*/
+static void
+agg_inflight_add(const linkaddr_t *dest)
+{
+  if(agg_inflight == 0) {
+    linkaddr_copy(&agg_inflight_dest, dest);
+  }
+  if(linkaddr_cmp(dest, &agg_inflight_dest)) {
+    agg_inflight++;
+  }
+}
+/*--------------------------------------------------------------------*/
+static void
+agg_inflight_remove(const linkaddr_t *dest)
+{
+  if(agg_inflight > 0 && linkaddr_cmp(dest, &agg_inflight_dest)) {
+    agg_inflight--;
+    if(agg_count > 0 && linkaddr_cmp(dest, &agg_dest)) {
+      /* The MAC is done with a frame to this next hop: queue the packets
+       * held behind it, from the ctimer process as packetbuf is in use */
+      ctimer_set(&agg_timer, 0, agg_timeout, NULL);
+    }
+  }
+}
+#endif /* SICSLOWPAN_AGGREGATION */
+/*--------------------------------------------------------------------*/
+#if SICSLOWPAN_FLOW_CTX
+#if SICSLOWPAN_FLOW_CTX_SLOTS > 16
+#error SICSLOWPAN_FLOW_CTX_SLOTS must be 16 or less
+#endif
+#if SICSLOWPAN_FLOW_CTX_REFRESH > 254
+#error SICSLOWPAN_FLOW_CTX_REFRESH must be 254 or less
+#endif
+
+/* The compressed headers of a packet, up to the UDP checksum. The id of a
+ * flow context is its generation (4 bits) and its slot (4 bits). The
+ * compressed RPL option in them is not part of the context, it is sent
+ * inline. */
+struct flow_ctx {
+  uint8_t id;
+  uint8_t len; /* 0 if unused */
+  uint8_t rpl_pos;
+  uint8_t rpl_len; /* 0 if no RPL option */
+  uint8_t hdr[SICSLOWPAN_FLOW_CTX_HDR_MAX];
+};
+
+struct flow_ctx_nbr {
+  struct flow_ctx tx[SICSLOWPAN_FLOW_CTX_SLOTS];
+  struct flow_ctx rx[SICSLOWPAN_FLOW_CTX_SLOTS];
+  /* Packets sent with a tx context since it was set, from 1 once the
+   * neighbor acknowledged it */
+  uint8_t tx_uses[SICSLOWPAN_FLOW_CTX_SLOTS];
+  uint8_t tx_next_slot;
+  uint8_t tx_gen;
+  /* Packets still to be sent without a context, after the neighbor had no
+   * room for one */
+  uint8_t tx_off;
+};
+
+#define FLOW_CTX_SLOT(id) ((id) & 0x0f)
+
+/* Reasons of a SICSLOWPAN_DISPATCH_FLOW_CTX_NACK */
+#define FLOW_CTX_NACK_UNKNOWN 0 /* set it again */
+#define FLOW_CTX_NACK_NO_ROOM 1 /* stop using contexts for a while */
+
+/* The NACK to send, from a callback as packetbuf holds the received packet */
+static struct ctimer flow_ctx_nack_timer;
+static linkaddr_t flow_ctx_nack_dest;
+static uint8_t flow_ctx_nack_id;
+static uint8_t flow_ctx_nack_reason;
+
+NBR_TABLE(struct flow_ctx_nbr, flow_ctx_nbrs);
+/*--------------------------------------------------------------------*/
+static struct flow_ctx_nbr *
+flow_ctx_nbr_get(const linkaddr_t *addr)
+{
+  struct flow_ctx_nbr *nbr = nbr_table_get_from_lladdr(flow_ctx_nbrs, addr);
+  if(nbr == NULL) {
+    nbr = nbr_table_add_lladdr(flow_ctx_nbrs, addr, NBR_TABLE_REASON_SICSLOWPAN, NULL);
+  }
+  return nbr;
+}
+/*--------------------------------------------------------------------*/
+static int
+flow_ctx_match(const struct flow_ctx *ctx, const uint8_t *hdr, uint8_t len,
+               uint8_t rpl_pos, uint8_t rpl_len)
+{
+  uint8_t end = rpl_pos + rpl_len;
+
+  return ctx->len == len && ctx->rpl_pos == rpl_pos && ctx->rpl_len == rpl_len
+    && memcmp(ctx->hdr, hdr, rpl_pos) == 0
+    && memcmp(&ctx->hdr[end], &hdr[end], len - end) == 0;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Replaces the compressed headers of the packet in packetbuf by the
+ * flow context the neighbor has for them, or sets a flow context for them
+ * \param dest the link layer destination address of the packet
+ *
+ * The compressed headers must end with the UDP checksum.
+ */
+static void
+flow_ctx_output(const linkaddr_t *dest)
+{
+  struct flow_ctx_nbr *nbr;
+  struct flow_ctx *ctx = NULL;
+  uint8_t *buf = packetbuf_ptr;
+  uint16_t len = packetbuf_datalen();
+  uint8_t hdr_len = packetbuf_hdr_len - 2;
+  uint8_t rpl_pos = flow_ctx_rpl_pos;
+  uint8_t rpl_len = flow_ctx_rpl_len;
+  uint8_t cksum[2];
+  uint8_t i;
+
+  if(packetbuf_hdr_len < 2 || hdr_len > SICSLOWPAN_FLOW_CTX_HDR_MAX
+     || (nbr = flow_ctx_nbr_get(dest)) == NULL) {
+    return;
+  }
+  if(nbr->tx_off > 0) {
+    nbr->tx_off--;
+    return;
+  }
+  if(rpl_len == 0 || rpl_pos < 1 || rpl_pos + rpl_len > hdr_len) {
+    rpl_pos = 0;
+    rpl_len = 0;
+  }
+
+  for(i = 0; i < SICSLOWPAN_FLOW_CTX_SLOTS; i++) {
+    if(flow_ctx_match(&nbr->tx[i], buf, hdr_len, rpl_pos, rpl_len)) {
+      ctx = &nbr->tx[i];
+      break;
+    }
+  }
+
+  if(ctx != NULL && nbr->tx_uses[i] > 0
+     && nbr->tx_uses[i] <= SICSLOWPAN_FLOW_CTX_REFRESH) {
+    /* The neighbor has the headers: keep the RPL option and the UDP
+     * checksum only */
+    cksum[0] = buf[hdr_len];
+    cksum[1] = buf[hdr_len + 1];
+    memmove(&buf[2], &buf[rpl_pos], rpl_len);
+    buf[0] = SICSLOWPAN_DISPATCH_FLOW_CTX;
+    buf[1] = ctx->id;
+    buf[2 + rpl_len] = cksum[0];
+    buf[3 + rpl_len] = cksum[1];
+    memmove(&buf[4 + rpl_len], &buf[packetbuf_hdr_len], len - packetbuf_hdr_len);
+    packetbuf_set_datalen(len - packetbuf_hdr_len + 4 + rpl_len);
+    nbr->tx_uses[i]++;
+    flow_ctx_tx_use_count++;
+    flow_ctx_tx_saved_bytes += packetbuf_hdr_len - 4 - rpl_len;
+    return;
+  }
+
+  if(len + 5 > mac_max_payload) {
+    return;
+  }
+
+  if(ctx == NULL) {
+    /* New headers: replace the oldest context */
+    i = nbr->tx_next_slot;
+    nbr->tx_next_slot = (i + 1) % SICSLOWPAN_FLOW_CTX_SLOTS;
+    nbr->tx_gen = (nbr->tx_gen + 1) & 0x0f;
+    ctx = &nbr->tx[i];
+    ctx->id = (nbr->tx_gen << 4) | i;
+    ctx->len = hdr_len;
+    ctx->rpl_pos = rpl_pos;
+    ctx->rpl_len = rpl_len;
+    memcpy(ctx->hdr, buf, hdr_len);
+    nbr->tx_uses[i] = 0;
+  } else if(nbr->tx_uses[i] > 0) {
+    /* Set again after SICSLOWPAN_FLOW_CTX_REFRESH packets, still in use */
+    nbr->tx_uses[i] = 1;
+  }
+
+  memmove(&buf[5], buf, len);
+  buf[0] = SICSLOWPAN_DISPATCH_FLOW_CTX_SET;
+  buf[1] = ctx->id;
+  buf[2] = hdr_len;
+  buf[3] = rpl_pos;
+  buf[4] = rpl_len;
+  packetbuf_set_datalen(len + 5);
+  /* For packet_sent to know which context the neighbor acknowledged */
+  packetbuf_set_attr(PACKETBUF_ATTR_FLOW_CTX, 0x100 | ctx->id);
+
+  flow_ctx_tx_set_count++;
+  LOG_HK("fctx_tx_set %lu fctx_tx_use %lu fctx_saved %lu fctx_rx_nack %lu |\n",
+         (unsigned long)flow_ctx_tx_set_count, (unsigned long)flow_ctx_tx_use_count,
+         (unsigned long)flow_ctx_tx_saved_bytes, (unsigned long)flow_ctx_rx_nack_count);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Marks the flow context set by the frame in packetbuf as known by
+ * the neighbor if the frame was acknowledged
+ */
+static void
+flow_ctx_sent(const linkaddr_t *dest, int status)
+{
+  packetbuf_attr_t attr = packetbuf_attr(PACKETBUF_ATTR_FLOW_CTX);
+  struct flow_ctx_nbr *nbr;
+  uint8_t i;
+
+  if(status != MAC_TX_OK || attr == 0
+     || (nbr = nbr_table_get_from_lladdr(flow_ctx_nbrs, dest)) == NULL) {
+    return;
+  }
+
+  i = FLOW_CTX_SLOT(attr);
+  /* The context may have been replaced since the frame was queued */
+  if(i < SICSLOWPAN_FLOW_CTX_SLOTS && nbr->tx[i].len > 0
+     && nbr->tx[i].id == (attr & 0xff) && nbr->tx_uses[i] == 0) {
+    nbr->tx_uses[i] = 1;
+  }
+}
+/*--------------------------------------------------------------------*/
+static void
+flow_ctx_nack_send(void *ptr)
+{
+  uint8_t *buf;
+
+  packetbuf_clear();
+  buf = packetbuf_dataptr();
+  buf[0] = SICSLOWPAN_DISPATCH_FLOW_CTX_NACK;
+  buf[1] = flow_ctx_nack_id;
+  buf[2] = flow_ctx_nack_reason;
+  packetbuf_set_datalen(3);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &flow_ctx_nack_dest);
+  NETSTACK_MAC.send(NULL, NULL);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Tells the sender of the packet in packetbuf that its flow context
+ * \p id was not used, unless a NACK is already waiting to be sent
+ */
+static void
+flow_ctx_nack(uint8_t id, uint8_t reason)
+{
+  if(!ctimer_expired(&flow_ctx_nack_timer)) {
+    return;
+  }
+  linkaddr_copy(&flow_ctx_nack_dest, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  flow_ctx_nack_id = id;
+  flow_ctx_nack_reason = reason;
+  ctimer_set(&flow_ctx_nack_timer, 0, flow_ctx_nack_send, NULL);
+  flow_ctx_tx_nack_count++;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Sets again, or stops using for a while, the flow context a
+ * neighbor did not use
+ */
+static void
+flow_ctx_nack_input(const uint8_t *ptr)
+{
+  struct flow_ctx_nbr *nbr;
+  uint8_t i = FLOW_CTX_SLOT(ptr[1]);
+
+  nbr = nbr_table_get_from_lladdr(flow_ctx_nbrs, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  if(nbr == NULL) {
+    return;
+  }
+  if(i < SICSLOWPAN_FLOW_CTX_SLOTS && nbr->tx[i].len > 0
+     && nbr->tx[i].id == ptr[1]) {
+    nbr->tx_uses[i] = 0;
+  }
+  if(ptr[2] == FLOW_CTX_NACK_NO_ROOM) {
+    nbr->tx_off = SICSLOWPAN_FLOW_CTX_REFRESH;
+  }
+  flow_ctx_rx_nack_count++;
+  LOG_WARN("output: flow context 0x%02x not used by the neighbor (%u)\n",
+           ptr[1], ptr[2]);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Stores the flow context set by the packet in packetbuf, or puts
+ * back the compressed headers of a packet sent with a flow context
+ * \return 0 if the packet is to be dropped, 1 otherwise
+ */
+static int
+flow_ctx_input(void)
+{
+  static uint8_t buf[PACKETBUF_SIZE];
+  static struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  static struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t *ptr = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  struct flow_ctx_nbr *nbr;
+  struct flow_ctx *ctx = NULL;
+  uint8_t i;
+
+  if(len == 0 || (ptr[0] != SICSLOWPAN_DISPATCH_FLOW_CTX_SET
+                  && ptr[0] != SICSLOWPAN_DISPATCH_FLOW_CTX
+                  && ptr[0] != SICSLOWPAN_DISPATCH_FLOW_CTX_NACK)) {
+    return 1;
+  }
+  if(ptr[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_NACK) {
+    if(len >= 3) {
+      flow_ctx_nack_input(ptr);
+    }
+    return 0;
+  }
+  i = FLOW_CTX_SLOT(ptr[1]);
+  if(len < 4 || i >= SICSLOWPAN_FLOW_CTX_SLOTS) {
+    LOG_ERR("input: invalid flow context packet\n");
+    return 0;
+  }
+
+  if(ptr[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_SET) {
+    if(len < 5 || ptr[2] > SICSLOWPAN_FLOW_CTX_HDR_MAX || 5 + ptr[2] + 2 > len
+       || ptr[3] + ptr[4] > ptr[2]) {
+      LOG_ERR("input: invalid flow context len %u\n", ptr[2]);
+      return 0;
+    }
+    nbr = flow_ctx_nbr_get(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    if(nbr != NULL) {
+      ctx = &nbr->rx[i];
+      ctx->id = ptr[1];
+      ctx->len = ptr[2];
+      ctx->rpl_pos = ptr[3];
+      ctx->rpl_len = ptr[4];
+      memcpy(ctx->hdr, &ptr[5], ctx->len);
+    } else {
+      /* The packet is complete, but the next ones would be lost */
+      flow_ctx_nack(ptr[1], FLOW_CTX_NACK_NO_ROOM);
+    }
+    flow_ctx_rx_set_count++;
+    LOG_HK("fctx_rx_set %lu fctx_rx_use %lu fctx_rx_miss %lu fctx_tx_nack %lu |\n",
+           (unsigned long)flow_ctx_rx_set_count, (unsigned long)flow_ctx_rx_use_count,
+           (unsigned long)flow_ctx_rx_miss_count, (unsigned long)flow_ctx_tx_nack_count);
+    packetbuf_hdrreduce(5);
+    return 1;
+  }
+
+  nbr = nbr_table_get_from_lladdr(flow_ctx_nbrs, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  if(nbr != NULL && nbr->rx[i].len > 0 && nbr->rx[i].id == ptr[1]) {
+    ctx = &nbr->rx[i];
+  }
+  if(ctx == NULL || len < 4 + ctx->rpl_len
+     || ctx->len + len - 2 - ctx->rpl_len > PACKETBUF_SIZE) {
+    flow_ctx_rx_miss_count++;
+    LOG_WARN("input: unknown flow context 0x%02x, dropping packet\n", ptr[1]);
+    flow_ctx_nack(ptr[1], FLOW_CTX_NACK_UNKNOWN);
+    LOG_HK("fctx_rx_set %lu fctx_rx_use %lu fctx_rx_miss %lu fctx_tx_nack %lu |\n",
+           (unsigned long)flow_ctx_rx_set_count, (unsigned long)flow_ctx_rx_use_count,
+           (unsigned long)flow_ctx_rx_miss_count, (unsigned long)flow_ctx_tx_nack_count);
+    return 0;
+  }
+
+  /* The headers with the RPL option of the packet, then the UDP checksum
+   * and the payload */
+  memcpy(buf, ctx->hdr, ctx->len);
+  memcpy(&buf[ctx->rpl_pos], &ptr[2], ctx->rpl_len);
+  memcpy(&buf[ctx->len], &ptr[2 + ctx->rpl_len], len - 2 - ctx->rpl_len);
+  packetbuf_attr_copyto(attrs, addrs);
+  packetbuf_copyfrom(buf, ctx->len + len - 2 - ctx->rpl_len);
+  packetbuf_attr_copyfrom(attrs, addrs);
+  flow_ctx_rx_use_count++;
+  return 1;
+}
+#endif /* SICSLOWPAN_FLOW_CTX */
+/*--------------------------------------------------------------------*/
 /**
  * Callback function for the MAC packet sent callback
  */
@@ -1505,6 +2154,14 @@ packet_sent(void *ptr, int status, int transmissions)
     return;
   }
 
+#if SICSLOWPAN_AGGREGATION
+  agg_inflight_remove(dest);
+#endif
+
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_sent(dest, status);
+#endif
+
 #if WITH_UPA && UPA_NO_ETX_UPDATE_FROM_PACKETS_IN_BATCH
   int upa_sent_in_batch = 0;
   if(transmissions >= 0xff) {
@@ -1612,6 +2269,12 @@ send_packet(linkaddr_t *dest)
   packetbuf_set_addr(PACKETBUF_ADDR_SENDER,(void*)&uip_lladdr);
 #endif
 
+#if SICSLOWPAN_AGGREGATION
+  if(!linkaddr_cmp(dest, &linkaddr_null)) {
+    agg_inflight_add(dest);
+  }
+#endif
+
   /* Provide a callback function to receive the result of
      a packet transmission. */
   NETSTACK_MAC.send(&packet_sent, NULL);
@@ -1662,6 +2325,143 @@ fragment_copy_payload_and_send(uint16_t uip_offset, linkaddr_t *dest) {
   return 1;
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
+#if SICSLOWPAN_AGGREGATION
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Sends the packets held for aggregation, in an aggregate frame if
+ * there are several of them. packetbuf holds the content of agg_buf.
+ */
+static void
+agg_send(void)
+{
+  uint8_t *data = packetbuf_dataptr();
+
+  ctimer_stop(&agg_timer);
+
+  if(agg_count == 1) {
+    /* A single packet goes without the aggregate dispatch */
+    uint8_t len = data[1];
+    memmove(data, &data[2], len);
+    packetbuf_set_datalen(len);
+  } else {
+    agg_tx_count++;
+    agg_tx_packet_count += agg_count;
+    LOG_HK("agg_tx %lu agg_tx_pkts %lu |\n",
+           (unsigned long)agg_tx_count, (unsigned long)agg_tx_packet_count);
+  }
+  packetbuf_attr_copyfrom(agg_attrs, agg_addrs);
+  LOG_INFO("output: sending %u packets in a frame of len %u\n",
+           agg_count, packetbuf_datalen());
+  agg_count = 0;
+  send_packet(&agg_dest);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Sends the packets held for aggregation. Overwrites packetbuf.
+ */
+static void
+agg_flush(void)
+{
+  if(agg_count == 0) {
+    return;
+  }
+  packetbuf_copyfrom(agg_buf, agg_len);
+  agg_send();
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Checks whether the packet in packetbuf has the packetbuf attributes
+ * of the packets held: max transmissions, flow context, TSCH slotframe and
+ * timeslot, etc. all go once with the aggregate frame.
+ */
+static int
+agg_attrs_match(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < PACKETBUF_NUM_ATTRS; i++) {
+    if(agg_attrs[i].val != packetbuf_attr(i)) {
+      return 0;
+    }
+  }
+  for(i = 0; i < PACKETBUF_NUM_ADDRS; i++) {
+    if(!linkaddr_cmp(&agg_addrs[i].addr, packetbuf_addr(PACKETBUF_ADDR_FIRST + i))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+static void
+agg_timeout(void *ptr)
+{
+  if(ptr != NULL && agg_count > 0
+     && agg_inflight > 0 && linkaddr_cmp(&agg_dest, &agg_inflight_dest)) {
+    /* Held for SICSLOWPAN_AGGREGATION_MAX_DELAY: do not wait for the
+     * frames in the MAC any longer (their callback may be lost) */
+    agg_inflight = 0;
+  }
+  agg_flush();
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Holds the compressed packet in packetbuf if a frame to the same next
+ * hop is waiting in the MAC, sends it otherwise
+ * \param dest the link layer destination address of the packet
+ * \return 1 if success, 0 otherwise
+ */
+static int
+agg_output(linkaddr_t *dest)
+{
+  uint16_t len = packetbuf_datalen();
+
+  if(agg_count > 0 && (!linkaddr_cmp(dest, &agg_dest)
+                       || agg_len + 1 + len > agg_max_payload
+                       || !agg_attrs_match())) {
+    /* Send the packets held first, then come back to this one. It waits in
+     * agg_buf meanwhile, swapped with them, so that no queuebuf is needed */
+    struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+    struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+    uint8_t *data = packetbuf_dataptr();
+    uint16_t i;
+
+    packetbuf_attr_copyto(attrs, addrs);
+    for(i = 0; i < MAX(len, agg_len); i++) {
+      uint8_t b = data[i];
+      data[i] = agg_buf[i];
+      agg_buf[i] = b;
+    }
+    packetbuf_set_datalen(agg_len);
+    agg_send();
+
+    packetbuf_copyfrom(agg_buf, len);
+    packetbuf_attr_copyfrom(attrs, addrs);
+  }
+
+  if(agg_count == 0) {
+    if(agg_inflight == 0 || !linkaddr_cmp(dest, &agg_inflight_dest)
+       || 1 + 1 + len > mac_max_payload) {
+      /* Nothing to wait for, or too large to be aggregated */
+      send_packet(dest);
+      return 1;
+    }
+    agg_buf[0] = SICSLOWPAN_DISPATCH_AGGREGATE;
+    agg_len = 1;
+    agg_max_payload = mac_max_payload;
+    linkaddr_copy(&agg_dest, dest);
+    packetbuf_attr_copyto(agg_attrs, agg_addrs);
+    ctimer_set(&agg_timer, SICSLOWPAN_AGGREGATION_MAX_DELAY, agg_timeout, &agg_timer);
+  }
+
+  agg_buf[agg_len++] = len;
+  memcpy(&agg_buf[agg_len], packetbuf_dataptr(), len);
+  agg_len += len;
+  agg_count++;
+  LOG_INFO("output: holding packet of len %u for aggregation (%u)\n",
+           len, agg_count);
+  return 1;
+}
+#endif /* SICSLOWPAN_AGGREGATION */
 /*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
@@ -1683,6 +2483,9 @@ output(const linkaddr_t *localdest)
   /* init */
   uncomp_hdr_len = 0;
   packetbuf_hdr_len = 0;
+#if SICSLOWPAN_FLOW_CTX
+  flow_ctx_rpl_len = 0;
+#endif /* SICSLOWPAN_FLOW_CTX */
 
   /* reset packetbuf buffer */
   packetbuf_clear();
@@ -1738,12 +2541,11 @@ output(const linkaddr_t *localdest)
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
   /* Add 6LoRH headers before IPHC. Only needed on routed traffic
   (non link-local). */
-  if(!uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr)) {
-    add_paging_dispatch(1);
-    add_6lorh_hdr();
+  if(compress_hdr_6lorh(&dest, 1) == 0) {
+    /* Warning should already be issued by function above */
+    return 0;
   }
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
-#if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC
+#elif SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC
   if(compress_hdr_iphc(&dest) == 0) {
     /* Warning should already be issued by function above */
     return 0;
@@ -1757,6 +2559,18 @@ output(const linkaddr_t *localdest)
   packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
 
   frag_needed = (int)uip_len - (int)uncomp_hdr_len + (int)packetbuf_hdr_len > mac_max_payload;
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH
+  if(frag_needed && rpi_hbh_elided) {
+    /* The RPI 6LoRH is for non-fragmented packets only, compress again
+       with the hop-by-hop header */
+    uncomp_hdr_len = 0;
+    packetbuf_hdr_len = 0;
+    if(compress_hdr_6lorh(&dest, 0) == 0) {
+      return 0;
+    }
+    frag_needed = (int)uip_len - (int)uncomp_hdr_len + (int)packetbuf_hdr_len > mac_max_payload;
+  }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_6LORH */
   LOG_INFO("output: header len %d -> %d, total len %d -> %d, MAC max payload %d, frag_needed %d\n",
             uncomp_hdr_len, packetbuf_hdr_len,
             uip_len, uip_len - uncomp_hdr_len + packetbuf_hdr_len,
@@ -1889,9 +2703,38 @@ output(const linkaddr_t *localdest)
      return 0;
     }
 
+    if(!uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr)
+       && !uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+      hc_tx_ip_bytes += uncomp_hdr_len;
+      hc_tx_lowpan_bytes += packetbuf_hdr_len;
+      LOG_HK("hc_tx_ip %lu hc_tx_6lo %lu |\n",
+             (unsigned long)hc_tx_ip_bytes, (unsigned long)hc_tx_lowpan_bytes);
+    }
+
     memcpy(packetbuf_ptr + packetbuf_hdr_len, (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
            uip_len - uncomp_hdr_len);
     packetbuf_set_datalen(uip_len - uncomp_hdr_len + packetbuf_hdr_len);
+#if SICSLOWPAN_AGGREGATION || SICSLOWPAN_FLOW_CTX
+    if(!linkaddr_cmp(&dest, &linkaddr_null)) {
+      uint8_t proto;
+      uint8_t *last_hdr = uipbuf_get_last_header(uip_buf, uip_len, &proto);
+      if(last_hdr == NULL) {
+        proto = UIP_IP_BUF->proto;
+      }
+#if SICSLOWPAN_FLOW_CTX
+      if(proto == UIP_PROTO_UDP && last_hdr != NULL
+         && last_hdr + UIP_UDPH_LEN == (uint8_t *)UIP_IP_BUF + uncomp_hdr_len) {
+        /* The UDP header was compressed, last */
+        flow_ctx_output(&dest);
+      }
+#endif /* SICSLOWPAN_FLOW_CTX */
+#if SICSLOWPAN_AGGREGATION
+      if(proto == UIP_PROTO_UDP) {
+        return agg_output(&dest);
+      }
+#endif /* SICSLOWPAN_AGGREGATION */
+    }
+#endif /* SICSLOWPAN_AGGREGATION || SICSLOWPAN_FLOW_CTX */
     send_packet(&dest);
   }
   return 1;
@@ -1910,7 +2753,7 @@ output(const linkaddr_t *localdest)
  * (it is a SHALL in the RFC 4944 and should never happen)
  */
 static void
-input(void)
+input_packet(void)
 {
   /* size of the IP packet (read from fragment) */
   uint16_t frag_size = 0;
@@ -1927,8 +2770,12 @@ input(void)
   uint8_t first_fragment = 0, last_fragment = 0;
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
-  /* Update link statistics */
-  link_stats_input_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+#if SICSLOWPAN_FLOW_CTX
+  /* Before anything else, as it may rewrite packetbuf */
+  if(flow_ctx_input() == 0) {
+    return;
+  }
+#endif /* SICSLOWPAN_FLOW_CTX */
 
   /* init */
   uncomp_hdr_len = 0;
@@ -2022,7 +2869,10 @@ input(void)
   digest_paging_dispatch();
   if(curr_page == 1) {
     LOG_INFO("input: page 1, 6LoRH\n");
-    digest_6lorh_hdr();
+    if(digest_6lorh_hdr() == 0) {
+      LOG_ERR("input: packet dropped due to invalid 6LoRH\n");
+      return;
+    }
   } else if (curr_page > 1) {
     LOG_ERR("input: page %u not supported\n", curr_page);
     return;
@@ -2049,6 +2899,24 @@ input(void)
     return;
   }
 
+  if(curr_page == 1 && rpi_hbh_elided) {
+    if(frag_size > 0) {
+      LOG_ERR("input: RPI 6LoRH in a fragment not supported\n");
+      return;
+    }
+    insert_rpi_hbh(buffer, uncomp_hdr_len - UIP_IPH_LEN);
+    uncomp_hdr_len += RPI_HBH_LEN;
+  }
+
+  if(frag_size == 0
+     && !uip_is_addr_linklocal(&SICSLOWPAN_IP_BUF(buffer)->destipaddr)
+     && !uip_is_addr_mcast(&SICSLOWPAN_IP_BUF(buffer)->destipaddr)) {
+    hc_rx_ip_bytes += uncomp_hdr_len;
+    hc_rx_lowpan_bytes += packetbuf_hdr_len;
+    LOG_HK("hc_rx_ip %lu hc_rx_6lo %lu |\n",
+           (unsigned long)hc_rx_ip_bytes, (unsigned long)hc_rx_lowpan_bytes);
+  }
+
 #if SICSLOWPAN_CONF_FRAG
  copypayload:
 #endif /*SICSLOWPAN_CONF_FRAG*/
@@ -2168,6 +3036,64 @@ input(void)
   }
 #endif /* SICSLOWPAN_CONF_FRAG */
 }
+#if SICSLOWPAN_AGGREGATION
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Processes the packets of an aggregate frame, each as if it came
+ * in its own frame
+ */
+static void
+agg_input(void)
+{
+  /* Processing a packet may overwrite packetbuf (e.g. when forwarding it) */
+  static uint8_t buf[PACKETBUF_SIZE];
+  static struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  static struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint16_t len = packetbuf_datalen();
+  uint16_t pos = 1;
+  uint8_t count = 0;
+
+  memcpy(buf, packetbuf_dataptr(), len);
+  packetbuf_attr_copyto(attrs, addrs);
+
+  while(pos < len) {
+    uint8_t packet_len = buf[pos++];
+    if(packet_len == 0 || pos + packet_len > len) {
+      LOG_ERR("input: invalid packet len %u in aggregate frame\n", packet_len);
+      break;
+    }
+    packetbuf_copyfrom(&buf[pos], packet_len);
+    packetbuf_attr_copyfrom(attrs, addrs);
+    input_packet();
+    pos += packet_len;
+    count++;
+  }
+
+  agg_rx_count++;
+  agg_rx_packet_count += count;
+  LOG_HK("agg_rx %lu agg_rx_pkts %lu |\n",
+         (unsigned long)agg_rx_count, (unsigned long)agg_rx_packet_count);
+}
+#endif /* SICSLOWPAN_AGGREGATION */
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Input function called by the MAC layer
+ */
+static void
+input(void)
+{
+  /* Update link statistics */
+  link_stats_input_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+
+#if SICSLOWPAN_AGGREGATION
+  if(packetbuf_datalen() > 0
+     && ((uint8_t *)packetbuf_dataptr())[0] == SICSLOWPAN_DISPATCH_AGGREGATE) {
+    agg_input();
+    return;
+  }
+#endif /* SICSLOWPAN_AGGREGATION */
+  input_packet();
+}
 /** @} */
 
 /*--------------------------------------------------------------------*/
@@ -2177,7 +3103,7 @@ void
 sicslowpan_init(void)
 {
 
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
+#if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC
 /* Preinitialize any address contexts for better header compression
  * (Saves up to 13 bytes per 6lowpan packet)
  * The platform contiki-conf.h file can override this using e.g.
@@ -2219,7 +3145,11 @@ sicslowpan_init(void)
   }
 #endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1 */
 
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC */
+#endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
+
+#if SICSLOWPAN_FLOW_CTX
+  nbr_table_register(flow_ctx_nbrs, NULL);
+#endif /* SICSLOWPAN_FLOW_CTX */
 }
 /*--------------------------------------------------------------------*/
 int
@@ -75,16 +75,45 @@ void reset_log_sicslowpan();
 #define SICSLOWPAN_COMPRESSION_IPV6        0 /* No compression */
 #define SICSLOWPAN_COMPRESSION_IPHC        1 /* RFC 6282 */
 #define SICSLOWPAN_COMPRESSION_6LORH       2 /* RFC 8025 for paging dispatch,
-              * draft-ietf-6lo-routin-dispatch-05 for 6LoRH. 6LoRH is not
-              * implemented yet -- only support for paging dispatch. */
+              * RFC 8138 for 6LoRH. Only the RPI 6LoRH is implemented (the
+              * RPL option), not the SRH and IP-in-IP 6LoRHs. */
 /** @} */
 
 /**
  * \name 6lowpan dispatches
+ *
+ * 0x44 to 0x47 are private: they are in the range RFC 4944 leaves reserved
+ * (0x43 to 0x4f), not assigned by IANA. They are only sent with
+ * SICSLOWPAN_CONF_AGGREGATION or SICSLOWPAN_CONF_FLOW_CTX, both off by
+ * default, and only nodes built with the same option can read them: other
+ * nodes drop them as an unknown dispatch, and sniffers cannot decode them.
+ *
+ * Flow contexts (0x45 to 0x47) keep state on both ends of a link, per
+ * neighbor and per slot, the id of a context being its slot in the low
+ * nibble and a generation in the high nibble. The sender uses a context only
+ * once the MAC acknowledged the FLOW_CTX_SET frame that carries its headers,
+ * and sets it again every SICSLOWPAN_FLOW_CTX_REFRESH packets. A receiver
+ * that lost the context (reboot, neighbor table replacement, missed SET frame
+ * of a newer generation) drops the FLOW_CTX frames of that id and
+ * answers with FLOW_CTX_NACK (reason 0), one NACK at a time; the sender then
+ * sets the context again with its next packet. A receiver with no room for
+ * the neighbor delivers the SET frame and answers reason 1; the sender then
+ * sends its next SICSLOWPAN_FLOW_CTX_REFRESH packets without context. The
+ * packets already queued in the MAC with a lost context are lost, and so are
+ * those sent until the next refresh if the NACK itself is lost.
  * @{
  */
 #define SICSLOWPAN_DISPATCH_IPV6                    0x41 /* 01000001 = 65 */
 #define SICSLOWPAN_DISPATCH_HC1                     0x42 /* 01000010 = 66 */
+#define SICSLOWPAN_DISPATCH_AGGREGATE               0x44 /* 01000100 = 68, reserved in RFC 4944:
+              * several packets in a frame, each after its length (8 bit) */
+#define SICSLOWPAN_DISPATCH_FLOW_CTX_SET            0x45 /* 01000101 = 69, reserved in RFC 4944:
+              * flow context id, header len, position and len of the RPL
+              * option in the header, then the packet */
+#define SICSLOWPAN_DISPATCH_FLOW_CTX                0x46 /* 01000110 = 70, reserved in RFC 4944:
+              * flow context id, RPL option, UDP checksum, then the payload */
+#define SICSLOWPAN_DISPATCH_FLOW_CTX_NACK           0x47 /* 01000111 = 71, reserved in RFC 4944:
+              * flow context id the receiver did not use, reason */
 #define SICSLOWPAN_DISPATCH_IPHC                    0x60 /* 011xxxxx = ... */
 #define SICSLOWPAN_DISPATCH_IPHC_MASK               0xe0
 #define SICSLOWPAN_DISPATCH_FRAG1                   0xc0 /* 11000xxx */
@@ -94,6 +123,23 @@ void reset_log_sicslowpan();
 #define SICSLOWPAN_DISPATCH_PAGING_MASK             0xf0
 /** @} */
 
+/**
+ * \name 6LoRH encoding (RFC 8138), before IPHC in page 1
+ * @{
+ */
+#define SICSLOWPAN_6LORH_CRITICAL                   0x80 /* 100xxxxx, then type */
+#define SICSLOWPAN_6LORH_ELECTIVE                   0xa0 /* 101LLLLL, then type */
+#define SICSLOWPAN_6LORH_MASK                       0xe0
+#define SICSLOWPAN_6LORH_LEN_MASK                   0x1f
+#define SICSLOWPAN_6LORH_TYPE_RPI                   5
+
+/* Flags of the RPI 6LoRH first byte: the O, R and F flags of the RPL option,
+ * then I (instance 0, elided) and K (rank on 1 byte) */
+#define SICSLOWPAN_6LORH_RPI_ORF_MASK               0x1c
+#define SICSLOWPAN_6LORH_RPI_I                      0x02
+#define SICSLOWPAN_6LORH_RPI_K                      0x01
+/** @} */
+
 /** \name HC1 encoding
  * @{
  */
@@ -58,6 +58,9 @@
 #include "lib/assert.h"
 #include "lib/list.h"
 #endif
+#if WITH_A3
+#include "net/mac/tsch/tsch-a3.h"
+#endif
 
 /*--------------------------------------------------*/
 /** \brief Possible states for the nbr cache entries */
@@ -121,22 +124,7 @@ typedef struct uip_ds6_nbr {
 #endif                          /*UIP_CONF_QUEUE_PKT */
 
 #if WITH_A3
-  uint8_t a3_c_num_tx_slot;
-  uint8_t a3_c_num_rx_slot;
-
-  uint8_t a3_c_num_tx_pkt_success;
-  uint8_t a3_c_num_tx_pkt_collision;
-
-  uint8_t a3_c_num_rx_pkt_success;
-  uint8_t a3_c_num_rx_pkt_collision;
-  uint8_t a3_c_num_rx_pkt_idle;
-  uint8_t a3_c_num_rx_pkt_others;
-  uint8_t a3_c_num_rx_pkt_unscheduled;
-
-  double a3_c_tx_attempt_rate_ewma;
-  double a3_c_rx_attempt_rate_ewma;
-
-  double a3_c_tx_success_rate_ewma;
+  struct tsch_a3_state a3_c;
 #endif
 
 #if WITH_OST
@@ -147,6 +135,7 @@ typedef struct uip_ds6_nbr {
   uint16_t ost_nbr_N;            // 1. determined by nbr
   uint16_t ost_nbr_t_offset;     // 2. determined by me
   uint16_t ost_num_tx;           // network-layer
+  uint32_t ost_tx_load;          // smoothed ost_num_tx per slot, see ost_select_N
   uint8_t ost_newly_added;       // newly added
   uint8_t ost_rx_no_path;        // will be delete soon. When it is set, r_nbr and slotframe could not be matched.
   uint8_t ost_my_low_prr;
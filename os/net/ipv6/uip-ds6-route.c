@@ -91,6 +91,38 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_WITH_HASH_INDEX
+/* Hash index of the /128 routes: each slot holds the index of a route in
+   routememb plus one, or 0 if empty. The size is a power of two. */
+#if UIP_DS6_ROUTE_NB <= 16
+#define ROUTE_HASH_SIZE 32
+#elif UIP_DS6_ROUTE_NB <= 32
+#define ROUTE_HASH_SIZE 64
+#elif UIP_DS6_ROUTE_NB <= 64
+#define ROUTE_HASH_SIZE 128
+#elif UIP_DS6_ROUTE_NB <= 128
+#define ROUTE_HASH_SIZE 256
+#elif UIP_DS6_ROUTE_NB <= 256
+#define ROUTE_HASH_SIZE 512
+#elif UIP_DS6_ROUTE_NB <= 512
+#define ROUTE_HASH_SIZE 1024
+#elif UIP_DS6_ROUTE_NB <= 1024
+#define ROUTE_HASH_SIZE 2048
+#else
+#error UIP_DS6_ROUTE_WITH_HASH_INDEX supports up to 1024 routes
+#endif
+
+#if UIP_DS6_ROUTE_NB < 255
+typedef uint8_t route_hash_slot_t;
+#else
+typedef uint16_t route_hash_slot_t;
+#endif
+
+static route_hash_slot_t route_hash[ROUTE_HASH_SIZE];
+/* Number of routes shorter than /128, that are not in the hash index */
+static int num_prefix_routes = 0;
+#endif /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -174,6 +206,10 @@ uip_ds6_route_init(void)
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_WITH_HASH_INDEX
+  memset(route_hash, 0, sizeof(route_hash));
+  num_prefix_routes = 0;
+#endif /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
   LOG_INFO("nbr_tbl_reg: nbr_routes %d\n", nbr_routes->index);
@@ -186,6 +222,93 @@ uip_ds6_route_init(void)
   list_init(notificationlist);
 #endif
 }
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_HASH_INDEX
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+route_from_index(int index)
+{
+  return &((uip_ds6_route_t *)routememb.mem)[index];
+}
+/*---------------------------------------------------------------------------*/
+static int
+index_from_route(const uip_ds6_route_t *r)
+{
+  return r - (uip_ds6_route_t *)routememb.mem;
+}
+/*---------------------------------------------------------------------------*/
+/* Home slot of a destination address in the hash index (FNV-1a, as the
+   addresses of a network often only differ in the low bytes of the IID) */
+static unsigned
+route_hash_slot_of(const uip_ipaddr_t *addr)
+{
+  uint32_t h = 2166136261UL;
+  uint8_t i;
+  for(i = 0; i < sizeof(uip_ipaddr_t); i++) {
+    h = (h ^ addr->u8[i]) * 16777619UL;
+  }
+  return (h ^ (h >> 16)) & (ROUTE_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Add a /128 route to the hash index, once its address is set */
+static void
+route_hash_add(const uip_ds6_route_t *r)
+{
+  unsigned slot = route_hash_slot_of(&r->ipaddr);
+  while(route_hash[slot] != 0) {
+    slot = (slot + 1) & (ROUTE_HASH_SIZE - 1);
+  }
+  route_hash[slot] = index_from_route(r) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a /128 route from the hash index, before it is freed */
+static void
+route_hash_remove(const uip_ds6_route_t *r)
+{
+  unsigned hole = route_hash_slot_of(&r->ipaddr);
+  unsigned slot;
+  unsigned home;
+
+  while(route_hash[hole] != index_from_route(r) + 1) {
+    if(route_hash[hole] == 0) {
+      return;
+    }
+    hole = (hole + 1) & (ROUTE_HASH_SIZE - 1);
+  }
+  route_hash[hole] = 0;
+
+  /* Move back the following entries of the probe sequence that can no
+     longer be reached through the hole */
+  slot = hole;
+  while(1) {
+    slot = (slot + 1) & (ROUTE_HASH_SIZE - 1);
+    if(route_hash[slot] == 0) {
+      return;
+    }
+    home = route_hash_slot_of(&route_from_index(route_hash[slot] - 1)->ipaddr);
+    if(((slot - home) & (ROUTE_HASH_SIZE - 1))
+       >= ((slot - hole) & (ROUTE_HASH_SIZE - 1))) {
+      route_hash[hole] = route_hash[slot];
+      route_hash[slot] = 0;
+      hole = slot;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Get the /128 route to an address from the hash index */
+static uip_ds6_route_t *
+route_hash_lookup(const uip_ipaddr_t *addr)
+{
+  unsigned slot = route_hash_slot_of(addr);
+  while(route_hash[slot] != 0) {
+    uip_ds6_route_t *r = route_from_index(route_hash[slot] - 1);
+    if(uip_ipaddr_cmp(addr, &r->ipaddr)) {
+      return r;
+    }
+    slot = (slot + 1) & (ROUTE_HASH_SIZE - 1);
+  }
+  return NULL;
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_HASH_INDEX */
 #if (UIP_MAX_ROUTES != 0)
 /*---------------------------------------------------------------------------*/
 static uip_lladdr_t *
@@ -281,6 +404,20 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 
   found_route = NULL;
   longestmatch = 0;
+#if UIP_DS6_ROUTE_WITH_HASH_INDEX
+  /* A host route is the longest possible match, and only prefix routes
+     are left to the list walk below */
+  found_route = route_hash_lookup(addr);
+  for(r = found_route == NULL && num_prefix_routes > 0 ? uip_ds6_route_head() : NULL;
+      r != NULL;
+      r = uip_ds6_route_next(r)) {
+    if(r->length < 128 && r->length >= longestmatch &&
+       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+      longestmatch = r->length;
+      found_route = r;
+    }
+  }
+#else /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
   for(r = uip_ds6_route_head();
       r != NULL;
       r = uip_ds6_route_next(r)) {
@@ -294,6 +431,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
 
   if(found_route != NULL) {
     LOG_INFO("Found route: ");
@@ -305,6 +443,9 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     LOG_WARN("No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_WITH_HASH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* With the hash index, the list order only matters for the removal
+     of the least recently used route, and list_remove() walks the list */
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -314,6 +455,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_WITH_HASH_INDEX || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -456,6 +598,13 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_WITH_HASH_INDEX
+  if(length == 128) {
+    route_hash_add(r);
+  } else {
+    num_prefix_routes++;
+  }
+#endif /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -501,6 +650,13 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_HASH_INDEX
+    if(route->length == 128) {
+      route_hash_remove(route);
+    } else {
+      num_prefix_routes--;
+    }
+#endif /* UIP_DS6_ROUTE_WITH_HASH_INDEX */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -111,6 +111,16 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/* Index the /128 host routes by destination with an open-addressing hash
+ * table of at least twice UIP_DS6_ROUTE_NB slots. Lookups then only walk
+ * the route list for the destinations without a host route, and only if
+ * the table holds shorter prefixes. */
+#ifdef UIP_CONF_DS6_ROUTE_WITH_HASH_INDEX
+#define UIP_DS6_ROUTE_WITH_HASH_INDEX UIP_CONF_DS6_ROUTE_WITH_HASH_INDEX
+#else /* UIP_CONF_DS6_ROUTE_WITH_HASH_INDEX */
+#define UIP_DS6_ROUTE_WITH_HASH_INDEX 0
+#endif /* UIP_CONF_DS6_ROUTE_WITH_HASH_INDEX */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
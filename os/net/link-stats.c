@@ -76,6 +76,12 @@ NBR_TABLE(struct link_stats, link_stats);
 /* Called at a period of FRESHNESS_HALF_LIFE */
 struct ctimer periodic_timer;
 
+#if LINK_STATS_INPUT_CACHE
+/* Entry of the last neighbor a packet was received from, NULL if unknown */
+static linkaddr_t last_input_lladdr;
+static struct link_stats *last_input_stats;
+#endif /* LINK_STATS_INPUT_CACHE */
+
 /*---------------------------------------------------------------------------*/
 /* Returns the neighbor's link stats */
 const struct link_stats *
@@ -219,6 +225,31 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
 #endif /* LINK_STATS_ETX_FROM_PACKET_COUNT */
 }
 /*---------------------------------------------------------------------------*/
+#if LINK_STATS_INPUT_CACHE
+/* Called when the entry of a neighbor is evicted from the table */
+static void
+stats_removed(void *item)
+{
+  if(item == last_input_stats) {
+    last_input_stats = NULL;
+  }
+}
+#endif /* LINK_STATS_INPUT_CACHE */
+/*---------------------------------------------------------------------------*/
+static struct link_stats *
+input_stats_from_lladdr(const linkaddr_t *lladdr)
+{
+#if LINK_STATS_INPUT_CACHE
+  if(last_input_stats == NULL || !linkaddr_cmp(lladdr, &last_input_lladdr)) {
+    last_input_stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+    linkaddr_copy(&last_input_lladdr, lladdr);
+  }
+  return last_input_stats;
+#else /* LINK_STATS_INPUT_CACHE */
+  return nbr_table_get_from_lladdr(link_stats, lladdr);
+#endif /* LINK_STATS_INPUT_CACHE */
+}
+/*---------------------------------------------------------------------------*/
 /* Packet input callback. Updates statistics for receptions on a given link */
 void
 link_stats_input_callback(const linkaddr_t *lladdr)
@@ -226,11 +257,14 @@ link_stats_input_callback(const linkaddr_t *lladdr)
   struct link_stats *stats;
   int16_t packet_rssi = packetbuf_attr(PACKETBUF_ATTR_RSSI);
 
-  stats = nbr_table_get_from_lladdr(link_stats, lladdr);
+  stats = input_stats_from_lladdr(lladdr);
   if(stats == NULL) {
     /* Add the neighbor */
     stats = nbr_table_add_lladdr(link_stats, lladdr, NBR_TABLE_REASON_LINK_STATS, NULL);
     if(stats != NULL) {
+#if LINK_STATS_INPUT_CACHE
+      last_input_stats = stats;
+#endif /* LINK_STATS_INPUT_CACHE */
       /* Initialize */
       stats->rssi = packet_rssi;
 #if LINK_STATS_INIT_ETX_FROM_RSSI
@@ -306,13 +340,20 @@ link_stats_reset(void)
     nbr_table_remove(link_stats, stats);
     stats = nbr_table_next(link_stats, stats);
   }
+#if LINK_STATS_INPUT_CACHE
+  last_input_stats = NULL;
+#endif /* LINK_STATS_INPUT_CACHE */
 }
 /*---------------------------------------------------------------------------*/
 /* Initializes link-stats module */
 void
 link_stats_init(void)
 {
+#if LINK_STATS_INPUT_CACHE
+  nbr_table_register(link_stats, stats_removed);
+#else /* LINK_STATS_INPUT_CACHE */
   nbr_table_register(link_stats, NULL);
+#endif /* LINK_STATS_INPUT_CACHE */
   LOG_INFO("nbr_tbl_reg: link_stats %d\n", link_stats->index);
   ctimer_set(&periodic_timer, FRESHNESS_HALF_LIFE, periodic, NULL);
 }
@@ -63,6 +63,15 @@
 #define LINK_STATS_PACKET_COUNTERS           0
 #endif /* LINK_STATS_PACKET_COUNTERS */
 
+/* Keep the entry of the last neighbor a packet was received from, so that
+ * consecutive receptions from the same neighbor (e.g. a batch of frames in
+ * one TSCH slot) skip the neighbor table lookup */
+#ifdef LINK_STATS_CONF_INPUT_CACHE
+#define LINK_STATS_INPUT_CACHE LINK_STATS_CONF_INPUT_CACHE
+#else /* LINK_STATS_CONF_INPUT_CACHE */
+#define LINK_STATS_INPUT_CACHE               0
+#endif /* LINK_STATS_CONF_INPUT_CACHE */
+
 typedef uint16_t link_packet_stat_t;
 
 struct link_packet_counter {
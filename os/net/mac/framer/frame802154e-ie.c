@@ -297,12 +297,23 @@ int
 frame80215e_create_ie_tsch_sla_timeslot_len(uint8_t *buf, int len, 
     struct ieee802154_ies *ies)
 {
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  int ie_len = 4 + 4 * SLA_BC_SF_COUNT; /* 2 * 16 bits, then 2 * 16 bits per broadcast slotframe */
+#else
   int ie_len = 4; /* 2 * 16 bits */
+#endif
   if(len >= 2 + ie_len && ies != NULL) {
     uint16_t sla_curr_timeslot_len = ies->ie_sla_curr_timeslot_len;
     WRITE16(buf+2, sla_curr_timeslot_len);
     uint16_t sla_next_timeslot_len = ies->ie_sla_next_timeslot_len;
     WRITE16(buf+4, sla_next_timeslot_len);
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+    int i;
+    for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+      WRITE16(buf+6+4*i, ies->ie_sla_curr_bc_sf_timeslot_len[i]);
+      WRITE16(buf+8+4*i, ies->ie_sla_next_bc_sf_timeslot_len[i]);
+    }
+#endif
     create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_TSCH_SLA_TIMESLOT_LEN, ie_len);
     return 2 + ie_len;
   } else {
@@ -521,7 +532,11 @@ frame802154e_parse_mlme_short_ie(const uint8_t *buf, int len,
       }
       break;
     case MLME_SHORT_IE_TSCH_SLA_TIMESLOT_LEN: 
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+      if(len == 4 + 4 * SLA_BC_SF_COUNT) {
+#else
       if(len == 4) {
+#endif
         if(ies != NULL) {
           uint16_t sla_curr_timeslot_len = 0;
           READ16(buf, sla_curr_timeslot_len);
@@ -529,6 +544,13 @@ frame802154e_parse_mlme_short_ie(const uint8_t *buf, int len,
           uint16_t sla_next_timeslot_len = 0;
           READ16(buf+2, sla_next_timeslot_len);
           ies->ie_sla_next_timeslot_len = sla_next_timeslot_len;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+          int i;
+          for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+            READ16(buf+4+4*i, ies->ie_sla_curr_bc_sf_timeslot_len[i]);
+            READ16(buf+6+4*i, ies->ie_sla_next_bc_sf_timeslot_len[i]);
+          }
+#endif
         }
         return len;
       }
@@ -81,6 +81,10 @@ struct ieee802154_ies {
   struct tsch_asn_t ie_sla_triggering_asn;
   uint16_t ie_sla_curr_timeslot_len;
   uint16_t ie_sla_next_timeslot_len;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  uint16_t ie_sla_curr_bc_sf_timeslot_len[SLA_BC_SF_COUNT];
+  uint16_t ie_sla_next_bc_sf_timeslot_len[SLA_BC_SF_COUNT];
+#endif
 #endif
   uint8_t ie_tsch_synchronization_offset;
   struct tsch_asn_t ie_asn;
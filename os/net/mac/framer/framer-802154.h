@@ -41,12 +41,18 @@
 
 #include "net/packetbuf.h"
 #include "net/mac/framer/framer.h"
+#include "net/mac/framer/frame802154.h"
 
 /* Setup frame802154_t with use of a specified get_attr */
 void framer_802154_setup_params(packetbuf_attr_t (*get_attr)(uint8_t type),
                                 uint8_t dest_is_broadcast,
                                 frame802154_t *params);
 
+/* Sets the packetbuf attributes and addresses of a frame that is already
+   parsed, with packetbuf holding the frame payload. Returns 0 if the frame
+   is for another PAN, 1 otherwise */
+int framer_802154_set_packetbuf_attr(const frame802154_t *frame);
+
 extern const struct framer framer_802154;
 
 #endif /* FRAMER_802154_H_ */
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         A3 estimator, in double or in Q15 fixed point
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-a3.h"
+
+#if WITH_A3
+
+/* EWMA weight, larger with longer unicast slotframes */
+#define A3_ALPHA_RAW   (0.02 + (double)ORCHESTRA_CONF_UNICAST_PERIOD * 0.001)
+#define A3_ALPHA       (A3_ALPHA_RAW > 0.15 ? 0.15 : A3_ALPHA_RAW)
+/* Added to the weight of the Rx attempt rate when it increases */
+#define A3_ALPHA_PLUS  (A3_ALPHA * 0.2)
+
+/*---------------------------------------------------------------------------*/
+#if TSCH_A3_FIXED_POINT
+/* New EWMA value, rounded to nearest */
+static tsch_a3_rate_t
+ewma(tsch_a3_rate_t avg, tsch_a3_rate_t alpha, tsch_a3_rate_t sample)
+{
+  return ((uint32_t)(TSCH_A3_RATE_ONE - alpha) * avg
+          + (uint32_t)alpha * sample + TSCH_A3_RATE_ONE / 2) >> 15;
+}
+/*---------------------------------------------------------------------------*/
+/* count / slots, at most 1 */
+static tsch_a3_rate_t
+rate_of(uint8_t count, uint8_t slots)
+{
+  if(count >= slots) {
+    return TSCH_A3_RATE_ONE;
+  }
+  return ((uint32_t)count << 15) / slots;
+}
+/*---------------------------------------------------------------------------*/
+/* Rx attempt rate of an ASFN: successes, plus collisions and unscheduled
+ * cells counted at the current rate, over all cells, at most 1 */
+static tsch_a3_rate_t
+rx_attempt_rate_of(const struct tsch_a3_state *s, uint8_t sum_rx)
+{
+  uint32_t num;
+
+  if(sum_rx == 0) {
+    return 0;
+  }
+  num = ((uint32_t)s->num_rx_pkt_success << 15)
+        + (uint32_t)s->rx_attempt_rate_ewma
+          * (s->num_rx_pkt_collision + s->num_rx_pkt_unscheduled);
+  num /= sum_rx;
+  return num > TSCH_A3_RATE_ONE ? TSCH_A3_RATE_ONE : num;
+}
+/*---------------------------------------------------------------------------*/
+/* (attempt - success) / attempt > A3_MAX_ERR_PROB, without division */
+static int
+tx_error_exceeds(const struct tsch_a3_state *s)
+{
+  if(s->tx_attempt_rate_ewma <= s->tx_success_rate_ewma) {
+    return 0;
+  }
+  return (uint32_t)(s->tx_attempt_rate_ewma - s->tx_success_rate_ewma) * TSCH_A3_RATE_ONE
+         > (uint32_t)TSCH_A3_RATE(A3_MAX_ERR_PROB) * s->tx_attempt_rate_ewma;
+}
+/*---------------------------------------------------------------------------*/
+static tsch_a3_rate_t
+rate_double(tsch_a3_rate_t r)
+{
+  return r < 0x8000 ? r << 1 : 0xffff;
+}
+/*---------------------------------------------------------------------------*/
+#else /* TSCH_A3_FIXED_POINT */
+/*---------------------------------------------------------------------------*/
+static tsch_a3_rate_t
+ewma(tsch_a3_rate_t avg, tsch_a3_rate_t alpha, tsch_a3_rate_t sample)
+{
+  return (1 - alpha) * avg + alpha * sample;
+}
+/*---------------------------------------------------------------------------*/
+static tsch_a3_rate_t
+rate_of(uint8_t count, uint8_t slots)
+{
+  double rate = (double)(count) / (double)(slots);
+  return rate > 1 ? 1 : rate;
+}
+/*---------------------------------------------------------------------------*/
+static tsch_a3_rate_t
+rx_attempt_rate_of(const struct tsch_a3_state *s, uint8_t sum_rx)
+{
+  double rate = ((double)s->num_rx_pkt_success
+                 + s->rx_attempt_rate_ewma
+                   * (double)(s->num_rx_pkt_collision + s->num_rx_pkt_unscheduled))
+                / (double)(sum_rx);
+  return rate > 1 ? 1 : rate;
+}
+/*---------------------------------------------------------------------------*/
+static int
+tx_error_exceeds(const struct tsch_a3_state *s)
+{
+  return (s->tx_attempt_rate_ewma - s->tx_success_rate_ewma) / (s->tx_attempt_rate_ewma)
+         > A3_MAX_ERR_PROB;
+}
+/*---------------------------------------------------------------------------*/
+static tsch_a3_rate_t
+rate_double(tsch_a3_rate_t r)
+{
+  return r * 2;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_A3_FIXED_POINT */
+/*---------------------------------------------------------------------------*/
+void
+tsch_a3_init(struct tsch_a3_state *s)
+{
+  s->num_tx_slot = A3_INITIAL_NUM_OF_SLOTS;
+  s->num_rx_slot = A3_INITIAL_NUM_OF_SLOTS;
+
+  s->num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
+  s->num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
+
+  s->num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
+
+  s->tx_attempt_rate_ewma = TSCH_A3_RATE(A3_INITIAL_TX_ATTEMPT_RATE_EWMA);
+  s->rx_attempt_rate_ewma = TSCH_A3_RATE(A3_INITIAL_RX_ATTEMPT_RATE_EWMA);
+
+  s->tx_success_rate_ewma = TSCH_A3_RATE(A3_INITIAL_TX_SUCCESS_RATE_EWMA);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+tsch_a3_update(struct tsch_a3_state *s, struct tsch_a3_update_info *info)
+{
+  const tsch_a3_rate_t alpha = TSCH_A3_RATE(A3_ALPHA);
+  tsch_a3_rate_t dynamic_alpha;
+  tsch_a3_rate_t tx_attempt_new;
+  tsch_a3_rate_t tx_success_new;
+  tsch_a3_rate_t rx_attempt_new;
+  uint8_t sum_tx;
+  uint8_t sum_rx;
+  uint8_t diff_rx;
+  uint8_t actions = 0;
+
+  /* EWMA of 'Tx attempt rate' and 'Tx success rate' */
+  sum_tx = s->num_tx_pkt_success + s->num_tx_pkt_collision;
+  tx_attempt_new = rate_of(sum_tx, s->num_tx_slot);
+  s->tx_attempt_rate_ewma = ewma(s->tx_attempt_rate_ewma, alpha, tx_attempt_new);
+
+  tx_success_new = rate_of(s->num_tx_pkt_success, s->num_tx_slot);
+  s->tx_success_rate_ewma = ewma(s->tx_success_rate_ewma, alpha, tx_success_new);
+
+  /* EWMA of 'Rx attempt rate': the cells without any result were not
+     scheduled in the ASFN */
+  sum_rx = s->num_rx_pkt_success
+           + s->num_rx_pkt_collision
+           + s->num_rx_pkt_idle
+           + s->num_rx_pkt_others;
+  diff_rx = s->num_rx_slot - sum_rx;
+  if(s->num_rx_slot < sum_rx) {
+    diff_rx = 0;
+  }
+  s->num_rx_pkt_unscheduled = diff_rx;
+  sum_rx += diff_rx;
+
+  rx_attempt_new = rx_attempt_rate_of(s, sum_rx);
+  dynamic_alpha = alpha;
+  if(rx_attempt_new > s->rx_attempt_rate_ewma) {
+    dynamic_alpha += TSCH_A3_RATE(A3_ALPHA_PLUS);
+  }
+  s->rx_attempt_rate_ewma = ewma(s->rx_attempt_rate_ewma, dynamic_alpha, rx_attempt_new);
+
+  if(info != NULL) {
+    info->alpha = alpha;
+    info->tx_attempt_new = tx_attempt_new;
+    info->tx_success_new = tx_success_new;
+    info->rx_attempt_new = rx_attempt_new;
+    info->rx_dynamic_alpha = dynamic_alpha;
+    info->tx_attempt_ewma = s->tx_attempt_rate_ewma;
+    info->tx_success_ewma = s->tx_success_rate_ewma;
+    info->rx_attempt_ewma = s->rx_attempt_rate_ewma;
+    info->num_rx_pkt_unscheduled = diff_rx;
+    info->sum_rx = sum_rx;
+  }
+
+#if A3_ALICE1_ORB2_OSB3 != 2 /* O-SB, ALICE */
+  if(tx_error_exceeds(s) && s->num_tx_slot > 1) {
+    s->num_tx_slot /= 2;
+    actions |= TSCH_A3_TX_HALF_COLLISION;
+
+    s->tx_attempt_rate_ewma = TSCH_A3_RATE(A3_INITIAL_TX_ATTEMPT_RATE_EWMA);
+    s->tx_success_rate_ewma = TSCH_A3_RATE(A3_INITIAL_TX_SUCCESS_RATE_EWMA);
+  }
+#endif
+
+  if(actions == 0) {
+    if(s->tx_attempt_rate_ewma > TSCH_A3_RATE(A3_TX_INCREASE_THRESH)
+       && s->num_tx_slot < A3_MAX_ZONE) {
+      s->num_tx_slot *= 2;
+      s->tx_attempt_rate_ewma /= 2;
+      actions |= TSCH_A3_TX_DOUBLE;
+    } else if(s->tx_attempt_rate_ewma < TSCH_A3_RATE(A3_TX_DECREASE_THRESH)
+              && s->num_tx_slot > 1) {
+      s->num_tx_slot /= 2;
+      s->tx_attempt_rate_ewma = rate_double(s->tx_attempt_rate_ewma);
+      actions |= TSCH_A3_TX_HALF;
+    }
+  }
+
+  if(s->rx_attempt_rate_ewma > TSCH_A3_RATE(A3_RX_INCREASE_THRESH)
+     && s->num_rx_slot < A3_MAX_ZONE) {
+    s->num_rx_slot *= 2;
+    s->rx_attempt_rate_ewma /= 2;
+    actions |= TSCH_A3_RX_DOUBLE;
+  } else if(s->rx_attempt_rate_ewma < TSCH_A3_RATE(A3_RX_DECREASE_THRESH)
+            && s->num_rx_slot > 1) {
+    s->num_rx_slot /= 2;
+    s->rx_attempt_rate_ewma = rate_double(s->rx_attempt_rate_ewma);
+    actions |= TSCH_A3_RX_HALF;
+  }
+
+  s->num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
+  s->num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
+
+  s->num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
+  s->num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
+
+  return actions;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* WITH_A3 */
+/** @} */
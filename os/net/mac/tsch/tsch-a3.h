@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         A3 estimator: EWMAs of the Tx attempt, Tx success and Rx attempt
+ *         rates of a neighbor's unicast cells, updated at each unicast
+ *         ASFN, and the resulting doubling/halving of its number of cells.
+ */
+
+#ifndef __TSCH_A3_H__
+#define __TSCH_A3_H__
+
+#include "contiki.h"
+
+/******** Configuration *******/
+
+/* Keep the rates in Q15 fixed point (1.0 is 32768), updated with integer
+ * arithmetic only, instead of double. Targets without FPU otherwise run
+ * soft-float divisions at each unicast ASFN for every neighbor. */
+#ifdef TSCH_A3_CONF_FIXED_POINT
+#define TSCH_A3_FIXED_POINT TSCH_A3_CONF_FIXED_POINT
+#else /* TSCH_A3_CONF_FIXED_POINT */
+#define TSCH_A3_FIXED_POINT 0
+#endif /* TSCH_A3_CONF_FIXED_POINT */
+
+/************ Types ***********/
+
+#if TSCH_A3_FIXED_POINT
+typedef uint16_t tsch_a3_rate_t;
+#define TSCH_A3_RATE_ONE 32768U
+/* Rate of a constant expression, e.g. a threshold, folded at compile time */
+#define TSCH_A3_RATE(x) ((tsch_a3_rate_t)((x) * TSCH_A3_RATE_ONE + 0.5))
+#define TSCH_A3_RATE_TO_DOUBLE(r) ((double)(r) / TSCH_A3_RATE_ONE)
+#else /* TSCH_A3_FIXED_POINT */
+typedef double tsch_a3_rate_t;
+#define TSCH_A3_RATE(x) ((tsch_a3_rate_t)(x))
+#define TSCH_A3_RATE_TO_DOUBLE(r) (r)
+#endif /* TSCH_A3_FIXED_POINT */
+
+/** \brief A3 state of the cells with a neighbor: number of Tx/Rx cells,
+ * results of the cells during the current ASFN and rate estimates */
+struct tsch_a3_state {
+  uint8_t num_tx_slot;
+  uint8_t num_rx_slot;
+
+  uint8_t num_tx_pkt_success;
+  uint8_t num_tx_pkt_collision;
+
+  uint8_t num_rx_pkt_success;
+  uint8_t num_rx_pkt_collision;
+  uint8_t num_rx_pkt_idle;
+  uint8_t num_rx_pkt_unscheduled;
+  uint8_t num_rx_pkt_others;
+
+  tsch_a3_rate_t tx_attempt_rate_ewma;
+  tsch_a3_rate_t rx_attempt_rate_ewma;
+
+  tsch_a3_rate_t tx_success_rate_ewma;
+};
+
+/* Actions taken by an update */
+#define TSCH_A3_TX_HALF_COLLISION 0x01 /* Tx cells halved, too many failures */
+#define TSCH_A3_TX_DOUBLE         0x02
+#define TSCH_A3_TX_HALF           0x04
+#define TSCH_A3_RX_DOUBLE         0x08
+#define TSCH_A3_RX_HALF           0x10
+
+/** \brief Intermediate values of an update, for debug logs */
+struct tsch_a3_update_info {
+  tsch_a3_rate_t alpha;
+  tsch_a3_rate_t tx_attempt_new;
+  tsch_a3_rate_t tx_success_new;
+  tsch_a3_rate_t rx_attempt_new;
+  tsch_a3_rate_t rx_dynamic_alpha;
+  /* Rates before the change of the number of cells */
+  tsch_a3_rate_t tx_attempt_ewma;
+  tsch_a3_rate_t tx_success_ewma;
+  tsch_a3_rate_t rx_attempt_ewma;
+  uint8_t num_rx_pkt_unscheduled;
+  uint8_t sum_rx;
+};
+
+/********** Functions *********/
+
+/**
+ * \brief Reset the A3 state of a neighbor to the initial number of cells
+ * and rates
+ * \param s The A3 state
+ */
+void tsch_a3_init(struct tsch_a3_state *s);
+/**
+ * \brief Update the rates with the results of the ASFN that ended, adapt
+ * the number of cells and clear the results
+ * \param s The A3 state
+ * \param info If not NULL, filled with the intermediate values
+ * \return The actions taken (TSCH_A3_TX_HALF_COLLISION, ...), 0 if none
+ */
+uint8_t tsch_a3_update(struct tsch_a3_state *s, struct tsch_a3_update_info *info);
+
+#endif /* __TSCH_A3_H__ */
+/** @} */
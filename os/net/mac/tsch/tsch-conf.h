@@ -280,6 +280,17 @@
 #define TSCH_MAX_INCOMING_PACKETS 4
 #endif
 
+/* Pass the incoming data frames up without parsing them a second time in
+ * the framer: the header parsed by tsch_rx_process_pending is reused and
+ * only the MAC payload is copied to packetbuf. Consecutive frames from the
+ * same sender (e.g. a UPA batch) are counted as a batch in the TSCH logs.
+ * Relies on framer_802154, the framer of TSCH */
+#ifdef TSCH_CONF_WITH_RX_BATCH
+#define TSCH_WITH_RX_BATCH TSCH_CONF_WITH_RX_BATCH
+#else
+#define TSCH_WITH_RX_BATCH 0
+#endif
+
 /* The maximum number of outgoing packets towards each neighbor
  * Must be power of two to enable atomic ringbuf operations.
  * Note: the total number of outgoing packets in the system (for
@@ -306,6 +317,83 @@
 #endif
 #endif
 
+/* Split each neighbor queue into traffic classes (control, latency-sensitive
+ * data, bulk data), each with its own ringbuf of TSCH_QUEUE_NUM_PER_NEIGHBOR
+ * packets. The slot operation serves the classes by strict priority or by
+ * weighted round-robin, and drops packets past their deadline before Tx. */
+#ifdef TSCH_QUEUE_CONF_WITH_CLASSES
+#define TSCH_QUEUE_WITH_CLASSES TSCH_QUEUE_CONF_WITH_CLASSES
+#else
+#define TSCH_QUEUE_WITH_CLASSES 0
+#endif
+
+/* Traffic classes, in decreasing priority. Packets are classified by their
+ * upper-layer protocol, or by TSCH_CALLBACK_PACKET_CLASS() if defined. */
+#define TSCH_QUEUE_CLASS_CONTROL 0 /* RPL, ND, keepalives, 6P */
+#define TSCH_QUEUE_CLASS_LATENCY 1 /* latency-sensitive data (UDP) */
+#define TSCH_QUEUE_CLASS_BULK    2 /* bulk data (TCP) */
+#if TSCH_QUEUE_WITH_CLASSES
+#define TSCH_QUEUE_NUM_CLASSES   3
+#else
+#define TSCH_QUEUE_NUM_CLASSES   1
+#endif
+
+/* Weighted round-robin among the classes: number of packets dequeued from a
+ * class before moving to the next non-empty one. 0 for strict priority. */
+#ifdef TSCH_QUEUE_CONF_CLASS_WRR
+#define TSCH_QUEUE_CLASS_WRR TSCH_QUEUE_CONF_CLASS_WRR
+#else
+#define TSCH_QUEUE_CLASS_WRR 0
+#endif
+
+#ifdef TSCH_QUEUE_CONF_CLASS_WEIGHTS
+#define TSCH_QUEUE_CLASS_WEIGHTS TSCH_QUEUE_CONF_CLASS_WEIGHTS
+#else
+#define TSCH_QUEUE_CLASS_WEIGHTS { 4, 2, 1 }
+#endif
+
+/* Lifetime of the packets of each class, in timeslots from enqueue.
+ * Packets still queued past their deadline are dropped. 0 for no deadline. */
+#ifdef TSCH_QUEUE_CONF_CLASS_LIFETIME
+#define TSCH_QUEUE_CLASS_LIFETIME TSCH_QUEUE_CONF_CLASS_LIFETIME
+#else
+#define TSCH_QUEUE_CLASS_LIFETIME { 0, 0, 0 }
+#endif
+
+/* Shared packet pool: neighbor queues hold one-byte indices into the global
+ * pool of QUEUEBUF_NUM packets instead of per-neighbor pointer slots, so that
+ * the busiest neighbor (typically the RPL parent) can use the buffers left
+ * idle by the others. A packet is admitted for a neighbor holding fewer than
+ * TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR packets as long as the pool is not empty.
+ * Beyond that, the neighbor borrows from the pool up to
+ * TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR packets, while it holds less than
+ * TSCH_QUEUE_POOL_ALPHA times the number of free packets not reserved for
+ * the minimum of other neighbors (dynamic threshold). */
+#ifdef TSCH_QUEUE_CONF_WITH_SHARED_POOL
+#define TSCH_QUEUE_WITH_SHARED_POOL TSCH_QUEUE_CONF_WITH_SHARED_POOL
+#else
+#define TSCH_QUEUE_WITH_SHARED_POOL 0
+#endif
+
+#ifdef TSCH_QUEUE_CONF_POOL_MIN_PER_NEIGHBOR
+#define TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR TSCH_QUEUE_CONF_POOL_MIN_PER_NEIGHBOR
+#else
+#define TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR 0
+#endif
+
+/* Must not exceed TSCH_QUEUE_NUM_PER_NEIGHBOR */
+#ifdef TSCH_QUEUE_CONF_POOL_MAX_PER_NEIGHBOR
+#define TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR TSCH_QUEUE_CONF_POOL_MAX_PER_NEIGHBOR
+#else
+#define TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR TSCH_QUEUE_NUM_PER_NEIGHBOR
+#endif
+
+#ifdef TSCH_QUEUE_CONF_POOL_ALPHA
+#define TSCH_QUEUE_POOL_ALPHA TSCH_QUEUE_CONF_POOL_ALPHA
+#else
+#define TSCH_QUEUE_POOL_ALPHA 2
+#endif
+
 /* The number of neighbor queues. There are two queues allocated at all times:
  * one for EBs, one for broadcasts. Other queues are for unicast to neighbors */
 #ifdef TSCH_QUEUE_CONF_MAX_NEIGHBOR_QUEUES
@@ -353,6 +441,32 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Look up the next active link through a timeslot index of the schedule
+ * (links sorted by timeslot per slotframe, and a min-heap of slotframes)
+ * instead of scanning all slotframes and links at every slot */
+#ifdef TSCH_SCHEDULE_CONF_WITH_INDEX
+#define TSCH_SCHEDULE_WITH_INDEX TSCH_SCHEDULE_CONF_WITH_INDEX
+#else
+#define TSCH_SCHEDULE_WITH_INDEX 0
+#endif
+
+/* Let processes change the schedule through a command ring applied by the
+ * slot operation between two slots (see tsch_schedule_cmd_*()), instead of
+ * taking the TSCH lock, which busy-waits for the ongoing slot and skips the
+ * slots while it is held. Used by OST for its per-neighbor slotframes */
+#ifdef TSCH_SCHEDULE_CONF_WITH_CMD_RING
+#define TSCH_SCHEDULE_WITH_CMD_RING TSCH_SCHEDULE_CONF_WITH_CMD_RING
+#else
+#define TSCH_SCHEDULE_WITH_CMD_RING 0
+#endif
+
+/* Number of pending schedule commands. Must be power of two */
+#ifdef TSCH_SCHEDULE_CONF_CMD_RING_SIZE
+#define TSCH_SCHEDULE_CMD_RING_SIZE TSCH_SCHEDULE_CONF_CMD_RING_SIZE
+#else
+#define TSCH_SCHEDULE_CMD_RING_SIZE 16
+#endif
+
 /* To include Sixtop Implementation */
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
@@ -50,6 +50,12 @@
 #include "net/mac/tsch/tsch.h"
 #include "lib/ringbufindex.h"
 #include "sys/log.h"
+#if TSCH_LOG_BINARY
+#include "lib/crc16.h"
+#if BUILD_WITH_DEPLOYMENT
+#include "deployment/deployment.h"
+#endif
+#endif
 
 #if WITH_OST
 #include "net/mac/tsch/tsch-log.h"
@@ -75,6 +81,305 @@ static struct tsch_log_t log_array[TSCH_LOG_QUEUE_LEN];
 static int log_dropped = 0;
 static int log_active = 0;
 
+#if TSCH_LOG_BINARY
+/*
+ * Binary log records. Each record is COBS-encoded and enclosed in 0x00
+ * delimiters, so that it can be interleaved with regular text logs:
+ *
+ *   type | body | crc16 (little endian, over type and body)
+ *
+ * Integers are LEB128 varints (zigzag for signed values). TX, RX and UPA
+ * records start with the ASN as a delta from the previous record and the
+ * link (handle 0xff: no link). Addresses are sent as an index, defined by
+ * a NBR record the first time they are used. A SYNC record with the
+ * absolute ASN and own address is sent every TSCH_LOG_BINARY_SYNC_PERIOD
+ * records, and resets the neighbor indices.
+ */
+#define TSCH_LOG_BIN_SYNC       0x01
+#define TSCH_LOG_BIN_NBR        0x02
+#define TSCH_LOG_BIN_TX         0x03
+#define TSCH_LOG_BIN_RX         0x04
+#define TSCH_LOG_BIN_UPA        0x05
+
+/* Flags of TX and RX records */
+#define TSCH_LOG_BIN_F_UNICAST  0x01
+#define TSCH_LOG_BIN_F_DATA     0x02
+#define TSCH_LOG_BIN_F_DRIFT    0x04
+#define TSCH_LOG_BIN_F_APP      0x08
+#define TSCH_LOG_BIN_F_HK       0x10
+#define TSCH_LOG_BIN_SEC_SHIFT  5
+
+/* Flags of SYNC records */
+#define TSCH_LOG_BIN_F_DEPLOYMENT 0x01
+
+#define TSCH_LOG_BIN_NO_LINK    0xff
+#define TSCH_LOG_BIN_NULL_NBR   0xff
+
+#define TSCH_LOG_BIN_MAX_LEN    80
+
+static uint8_t bin_record[TSCH_LOG_BIN_MAX_LEN];
+static uint8_t bin_len;
+static struct tsch_asn_t bin_last_asn;
+static uint8_t bin_since_sync;
+static uint8_t bin_synced;
+static linkaddr_t bin_nbr[TSCH_LOG_BINARY_NBR_NUM];
+static uint8_t bin_nbr_count;
+static uint8_t bin_nbr_next;
+/*---------------------------------------------------------------------------*/
+static void
+bin_put_u8(uint8_t v)
+{
+  if(bin_len < TSCH_LOG_BIN_MAX_LEN) {
+    bin_record[bin_len++] = v;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bin_put_varint(uint64_t v)
+{
+  while(v >= 0x80) {
+    bin_put_u8((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  bin_put_u8(v);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bin_put_svarint(int32_t v)
+{
+  bin_put_varint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+bin_lladdr_id(const linkaddr_t *lladdr)
+{
+#if BUILD_WITH_DEPLOYMENT
+  return deployment_id_from_lladdr(lladdr);
+#elif LINKADDR_SIZE == 8
+  return UIP_HTONS(lladdr->u16[LINKADDR_SIZE/2-1]);
+#else
+  return UIP_HTONS(lladdr->u16);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* COBS-encode the record and print it between two 0x00 delimiters */
+static void
+bin_output(void)
+{
+  uint16_t crc = crc16_data(bin_record, bin_len, 0);
+  uint8_t code_index = 0;
+  uint8_t code;
+  uint8_t i;
+
+  bin_put_u8(crc & 0xff);
+  bin_put_u8(crc >> 8);
+
+  putchar(0);
+  /* Records are shorter than 254 bytes, no need to split blocks */
+  while(code_index <= bin_len) {
+    code = 1;
+    while(code_index + code <= bin_len && bin_record[code_index + code - 1] != 0) {
+      code++;
+    }
+    putchar(code);
+    for(i = 1; i < code; i++) {
+      putchar(bin_record[code_index + i - 1]);
+    }
+    code_index += code;
+  }
+  putchar(0);
+  bin_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bin_sync(const struct tsch_asn_t *asn)
+{
+  bin_len = 0;
+  bin_put_u8(TSCH_LOG_BIN_SYNC);
+#if BUILD_WITH_DEPLOYMENT
+  bin_put_u8(TSCH_LOG_BIN_F_DEPLOYMENT);
+#else
+  bin_put_u8(0);
+#endif
+  bin_put_varint(((uint64_t)asn->ms1b << 32) | asn->ls4b);
+  bin_put_varint(bin_lladdr_id(&linkaddr_node_addr));
+  bin_output();
+  bin_last_asn = *asn;
+  bin_since_sync = 0;
+  bin_synced = 1;
+  bin_nbr_count = 0;
+  bin_nbr_next = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the index of an address, sending a NBR record for new ones.
+ * Must be called before starting the record that uses it. */
+static uint8_t
+bin_nbr_index(const linkaddr_t *lladdr)
+{
+  uint8_t i;
+
+  if(linkaddr_cmp(lladdr, &linkaddr_null)) {
+    return TSCH_LOG_BIN_NULL_NBR;
+  }
+  for(i = 0; i < bin_nbr_count; i++) {
+    if(linkaddr_cmp(lladdr, &bin_nbr[i])) {
+      return i;
+    }
+  }
+  /* Round-robin replacement once all indices are in use */
+  if(bin_nbr_count < TSCH_LOG_BINARY_NBR_NUM) {
+    i = bin_nbr_count++;
+  } else {
+    i = bin_nbr_next;
+    bin_nbr_next = (bin_nbr_next + 1) % TSCH_LOG_BINARY_NBR_NUM;
+  }
+  linkaddr_copy(&bin_nbr[i], lladdr);
+
+  bin_len = 0;
+  bin_put_u8(TSCH_LOG_BIN_NBR);
+  bin_put_u8(i);
+  bin_put_varint(bin_lladdr_id(lladdr));
+  bin_output();
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bin_put_header(uint8_t type, const struct tsch_log_t *log)
+{
+  bin_len = 0;
+  bin_put_u8(type);
+  bin_put_varint(TSCH_ASN_DIFF(log->asn, bin_last_asn));
+  bin_last_asn = log->asn;
+  if(log->link == NULL) {
+    bin_put_u8(TSCH_LOG_BIN_NO_LINK);
+  } else {
+    struct tsch_slotframe *sf = tsch_schedule_get_slotframe_by_handle(log->link->slotframe_handle);
+    bin_put_u8(log->link->slotframe_handle);
+    bin_put_varint(sf ? sf->size.val : 0);
+    bin_put_u8(log->burst_count);
+    bin_put_varint(log->timeslot);
+    bin_put_varint(log->channel_offset);
+    bin_put_u8(log->channel);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+bin_put_hk(uint8_t ack_len, uint16_t unused_offset_time, uint16_t idle_time,
+           uint16_t curr_slot_len, uint8_t num_of_slots_until_idle_time)
+{
+  bin_put_u8(ack_len);
+  bin_put_varint(unused_offset_time);
+  bin_put_varint(idle_time);
+  bin_put_varint(curr_slot_len);
+  bin_put_u8(num_of_slots_until_idle_time);
+}
+/*---------------------------------------------------------------------------*/
+/* Print a TX, RX or UPA log as a binary record */
+static void
+tsch_log_binary_output(struct tsch_log_t *log)
+{
+  uint8_t flags;
+  uint8_t nbr;
+
+  /* Absolute ASN when starting, periodically, and when the ASN goes back
+   * (e.g. after re-association) */
+  if(!bin_synced || bin_since_sync >= TSCH_LOG_BINARY_SYNC_PERIOD
+     || (int32_t)TSCH_ASN_DIFF(log->asn, bin_last_asn) < 0
+     || log->asn.ms1b != bin_last_asn.ms1b) {
+    bin_sync(&log->asn);
+  }
+  bin_since_sync++;
+
+  switch(log->type) {
+    case tsch_log_tx:
+      nbr = bin_nbr_index(&log->tx.dest);
+      flags = (log->tx.sec_level << TSCH_LOG_BIN_SEC_SHIFT)
+        | (nbr != TSCH_LOG_BIN_NULL_NBR ? TSCH_LOG_BIN_F_UNICAST : 0)
+        | (log->tx.is_data ? TSCH_LOG_BIN_F_DATA : 0)
+        | (log->tx.drift_used ? TSCH_LOG_BIN_F_DRIFT : 0)
+#if ENABLE_LOG_TSCH_WITH_APP_FOOTER
+        | (log->tx.app_magic == APP_DATA_MAGIC ? TSCH_LOG_BIN_F_APP : 0)
+#endif
+        | (LOG_HK_ENABLED ? TSCH_LOG_BIN_F_HK : 0);
+      bin_put_header(TSCH_LOG_BIN_TX, log);
+      bin_put_u8(flags);
+      bin_put_u8(nbr);
+      bin_put_u8(log->tx.datalen);
+      bin_put_u8(log->tx.seqno);
+      bin_put_svarint(log->tx.mac_tx_status);
+      bin_put_u8(log->tx.num_tx);
+      if(flags & TSCH_LOG_BIN_F_DRIFT) {
+        bin_put_svarint(log->tx.drift);
+      }
+#if ENABLE_LOG_TSCH_WITH_APP_FOOTER
+      if(flags & TSCH_LOG_BIN_F_APP) {
+        bin_put_varint(log->tx.app_seqno);
+      }
+#endif
+#if LOG_HK_ENABLED
+      bin_put_hk(log->tx.asap_ack_len, log->tx.asap_unused_offset_time,
+                 log->tx.asap_idle_time, log->tx.asap_curr_slot_len,
+                 log->tx.asap_num_of_slots_until_idle_time);
+#endif
+      break;
+    case tsch_log_rx:
+      nbr = bin_nbr_index(&log->rx.src);
+      flags = (log->rx.sec_level << TSCH_LOG_BIN_SEC_SHIFT)
+        | (log->rx.is_unicast ? TSCH_LOG_BIN_F_UNICAST : 0)
+        | (log->rx.is_data ? TSCH_LOG_BIN_F_DATA : 0)
+        | (log->rx.drift_used ? TSCH_LOG_BIN_F_DRIFT : 0)
+#if ENABLE_LOG_TSCH_WITH_APP_FOOTER
+        | (log->rx.app_magic == APP_DATA_MAGIC ? TSCH_LOG_BIN_F_APP : 0)
+#endif
+        | (LOG_HK_ENABLED ? TSCH_LOG_BIN_F_HK : 0);
+      bin_put_header(TSCH_LOG_BIN_RX, log);
+      bin_put_u8(flags);
+      bin_put_u8(nbr);
+      bin_put_u8(log->rx.datalen);
+      bin_put_u8(log->rx.seqno);
+      bin_put_svarint(log->rx.estimated_drift);
+      if(flags & TSCH_LOG_BIN_F_DRIFT) {
+        bin_put_svarint(log->rx.drift);
+      }
+      bin_put_svarint(log->rx.rssi);
+#if ENABLE_LOG_TSCH_WITH_APP_FOOTER
+      if(flags & TSCH_LOG_BIN_F_APP) {
+        bin_put_varint(log->rx.app_seqno);
+      }
+#endif
+#if LOG_HK_ENABLED
+      bin_put_hk(log->rx.asap_ack_len, log->rx.asap_unused_offset_time,
+                 log->rx.asap_idle_time, log->rx.asap_curr_slot_len,
+                 log->rx.asap_num_of_slots_until_idle_time);
+#endif
+      break;
+#if WITH_UPA
+    case upa_log_result:
+      bin_put_header(TSCH_LOG_BIN_UPA, log);
+      bin_put_u8(log->upa_result.upa_link_type);
+      bin_put_u8(log->upa_result.upa_is_overflowed);
+      bin_put_varint(log->upa_result.upa_num_of_reserved_pkts);
+      bin_put_varint(log->upa_result.upa_num_of_successful_pkts);
+      bin_put_varint(log->upa_result.upa_trig_pkt_len);
+      bin_put_varint(log->upa_result.upa_all_pkt_len_same);
+      bin_put_varint(log->upa_result.upa_tot_pkt_len);
+      bin_put_varint(log->upa_result.upa_successful_pkt_len);
+      bin_put_varint(log->upa_result.upa_tot_ack_len);
+      bin_put_varint(log->upa_result.upa_unused_offset_time);
+      bin_put_varint(log->upa_result.upa_idle_time);
+      bin_put_varint(log->upa_result.upa_curr_slot_length);
+      bin_put_varint(log->upa_result.upa_num_of_slots_until_ilde_time);
+      bin_put_varint(log->upa_result.upa_num_of_slots_until_scheduling);
+      bin_put_varint(log->upa_result.upa_num_of_expected_slots);
+      break;
+#endif
+    default:
+      return;
+  }
+  bin_output();
+}
+#endif /* TSCH_LOG_BINARY */
+
 /*---------------------------------------------------------------------------*/
 /* Process pending log messages */
 void
@@ -89,6 +394,11 @@ tsch_log_process_pending(void)
   }
   while((log_index = ringbufindex_peek_get(&log_ringbuf)) != -1) {
     struct tsch_log_t *log = &log_array[log_index];
+#if TSCH_LOG_BINARY
+    if(log->type != tsch_log_message) {
+      tsch_log_binary_output(log);
+    } else
+#endif
     if(log->link == NULL) {
       printf("[INFO: TSCH-LOG  ] {asn %02x.%08lx link-NULL} ", log->asn.ms1b, log->asn.ls4b);
     } else {
@@ -101,6 +411,7 @@ tsch_log_process_pending(void)
     }
     switch(log->type) {
       case tsch_log_tx:
+#if !TSCH_LOG_BINARY
         printf("%s-%u-%u tx ",
                 linkaddr_cmp(&log->tx.dest, &linkaddr_null) ? "bc" : "uc", log->tx.is_data, log->tx.sec_level);
         log_lladdr_compact(&linkaddr_node_addr);
@@ -129,6 +440,7 @@ tsch_log_process_pending(void)
               log->tx.asap_num_of_slots_until_idle_time);
 #endif
         printf("\n");
+#endif /* !TSCH_LOG_BINARY */
 
 #if WITH_OST
         /* unicast packets only */
@@ -176,6 +488,7 @@ tsch_log_process_pending(void)
 #endif
         break;
       case tsch_log_rx:
+#if !TSCH_LOG_BINARY
         printf("%s-%u-%u rx ",
                 log->rx.is_unicast == 0 ? "bc" : "uc", log->rx.is_data, log->rx.sec_level);
         log_lladdr_compact(&log->rx.src);
@@ -205,12 +518,14 @@ tsch_log_process_pending(void)
               log->rx.asap_num_of_slots_until_idle_time);
 #endif
         printf("\n");
+#endif /* !TSCH_LOG_BINARY */
         break;
       case tsch_log_message:
         printf("%s\n", log->message);
         break;
 #if WITH_UPA
       case upa_log_result:
+#if !TSCH_LOG_BINARY
         if(log->upa_result.upa_link_type == 1) {
           printf("RES T B");
         } else if(log->upa_result.upa_link_type == 2) {
@@ -242,6 +557,7 @@ tsch_log_process_pending(void)
           printf(" !O");
         }
         printf(" HK-U\n");
+#endif /* !TSCH_LOG_BINARY */
         break;
 #endif
     }
@@ -62,6 +62,29 @@
 #define TSCH_LOG_QUEUE_LEN 8
 #endif /* TSCH_LOG_CONF_QUEUE_LEN */
 
+/* Print TX/RX/UPA logs as COBS-framed binary records rather than text lines.
+ * Decode on the host with ASAP-parsing-files/decode-tsch-log.py */
+#ifdef TSCH_LOG_CONF_BINARY
+#define TSCH_LOG_BINARY TSCH_LOG_CONF_BINARY
+#else /* TSCH_LOG_CONF_BINARY */
+#define TSCH_LOG_BINARY 0
+#endif /* TSCH_LOG_CONF_BINARY */
+
+/* Number of neighbor indices of the binary log */
+#ifdef TSCH_LOG_CONF_BINARY_NBR_NUM
+#define TSCH_LOG_BINARY_NBR_NUM TSCH_LOG_CONF_BINARY_NBR_NUM
+#else /* TSCH_LOG_CONF_BINARY_NBR_NUM */
+#define TSCH_LOG_BINARY_NBR_NUM 16
+#endif /* TSCH_LOG_CONF_BINARY_NBR_NUM */
+
+/* Number of binary records between two sync records (absolute ASN, own
+ * address, neighbor indices reset), bounds the loss after a corrupted record */
+#ifdef TSCH_LOG_CONF_BINARY_SYNC_PERIOD
+#define TSCH_LOG_BINARY_SYNC_PERIOD TSCH_LOG_CONF_BINARY_SYNC_PERIOD
+#else /* TSCH_LOG_CONF_BINARY_SYNC_PERIOD */
+#define TSCH_LOG_BINARY_SYNC_PERIOD 64
+#endif /* TSCH_LOG_CONF_BINARY_SYNC_PERIOD */
+
 #if (TSCH_LOG_PER_SLOT == 0)
 
 #define tsch_log_init()
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Metrics registry of UPA and SLA efficiency
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-metrics.h"
+#include <string.h>
+
+#if TSCH_METRICS
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "TSCH"
+#define LOG_LEVEL LOG_LEVEL_MAC
+
+/* Histogram buckets: linear (value >> shift), or log2 where bucket b > 0
+ * holds values in [2^(b-1), 2^b) */
+#define HIST_LOG2 0xff
+
+/* Counters and histograms are stored apart, each metric has a slot in
+ * the storage of its type */
+#define METRIC_COUNTER_NUM 6
+#define METRIC_HIST_NUM    4
+
+struct metric_desc {
+  const char *name;
+  enum tsch_metric_type type;
+  uint8_t slot;
+  uint8_t shift;
+};
+
+struct metric_hist {
+  uint32_t count;
+  uint32_t sum;
+  uint32_t min;
+  uint32_t max;
+  uint16_t buckets[TSCH_METRICS_HIST_BUCKETS];
+};
+
+static const struct metric_desc metric_descs[TSCH_METRIC_NUM] = {
+  { "upa_batch_pkts",  TSCH_METRIC_HISTOGRAM, 0, 0 },
+  { "upa_batch_slots", TSCH_METRIC_HISTOGRAM, 1, 0 },
+  { "upa_batch_ok",    TSCH_METRIC_COUNTER,   0, 0 },
+  { "upa_pkts_req",    TSCH_METRIC_COUNTER,   1, 0 },
+  { "upa_pkts_acc",    TSCH_METRIC_COUNTER,   2, 0 },
+  { "ts_len",          TSCH_METRIC_GAUGE,     0, 0 },
+  { "sla_ts_changes",  TSCH_METRIC_COUNTER,   3, 0 },
+  { "sla_reb_events",  TSCH_METRIC_COUNTER,   4, 0 },
+  { "sla_rebs",        TSCH_METRIC_COUNTER,   5, 0 },
+  { "sla_trig_lead",   TSCH_METRIC_HISTOGRAM, 2, HIST_LOG2 },
+  { "sla_trig_lag",    TSCH_METRIC_HISTOGRAM, 3, HIST_LOG2 },
+};
+
+static uint32_t metric_counters[METRIC_COUNTER_NUM];
+static struct metric_hist metric_hists[METRIC_HIST_NUM];
+/*---------------------------------------------------------------------------*/
+static uint8_t
+bucket_of(const struct metric_desc *d, uint32_t v)
+{
+  uint8_t b = 0;
+
+  if(d->shift == HIST_LOG2) {
+    while(v != 0 && b < TSCH_METRICS_HIST_BUCKETS - 1) {
+      v >>= 1;
+      b++;
+    }
+    return b;
+  }
+  v >>= d->shift;
+  return v < TSCH_METRICS_HIST_BUCKETS ? v : TSCH_METRICS_HIST_BUCKETS - 1;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+tsch_metrics_bucket_lower_bound(enum tsch_metric_id id, uint8_t b)
+{
+  if(metric_descs[id].shift == HIST_LOG2) {
+    return b == 0 ? 0 : 1UL << (b - 1);
+  }
+  return (uint32_t)b << metric_descs[id].shift;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_metrics_add(enum tsch_metric_id id, uint32_t v)
+{
+  metric_counters[metric_descs[id].slot] += v;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_metrics_sample(enum tsch_metric_id id, uint32_t v)
+{
+  struct metric_hist *h = &metric_hists[metric_descs[id].slot];
+  uint8_t b;
+  uint8_t i;
+
+  if(h->count == 0 || v < h->min) {
+    h->min = v;
+  }
+  if(v > h->max) {
+    h->max = v;
+  }
+  h->sum += v;
+  h->count++;
+
+  b = bucket_of(&metric_descs[id], v);
+  if(h->buckets[b] == 0xffff) {
+    /* Halve the histogram, which keeps its shape */
+    for(i = 0; i < TSCH_METRICS_HIST_BUCKETS; i++) {
+      h->buckets[i] >>= 1;
+    }
+  }
+  h->buckets[b]++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_metrics_get(enum tsch_metric_id id, struct tsch_metric_summary *s)
+{
+  const struct metric_hist *h = &metric_hists[metric_descs[id].slot];
+
+  memset(s, 0, sizeof(*s));
+  s->type = metric_descs[id].type;
+  switch(s->type) {
+  case TSCH_METRIC_GAUGE:
+    /* The only gauge is the current timeslot length */
+    s->value = tsch_timing_us[tsch_ts_timeslot_length];
+    break;
+  case TSCH_METRIC_HISTOGRAM:
+    s->value = h->count;
+    s->sum = h->sum;
+    s->min = h->min;
+    s->max = h->max;
+    s->buckets = h->buckets;
+    break;
+  default:
+    s->value = metric_counters[metric_descs[id].slot];
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_metrics_name(enum tsch_metric_id id)
+{
+  return id < TSCH_METRIC_NUM ? metric_descs[id].name : "?";
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_metrics_print(void)
+{
+  struct tsch_metric_summary s;
+  uint8_t i;
+  uint8_t b;
+
+  for(i = 0; i < TSCH_METRIC_NUM; i++) {
+    tsch_metrics_get(i, &s);
+    if(s.type != TSCH_METRIC_HISTOGRAM) {
+      LOG_HK("met %s %lu |\n", metric_descs[i].name, (unsigned long)s.value);
+    } else {
+      LOG_HK("met %s n %lu sum %lu min %lu max %lu h",
+             metric_descs[i].name, (unsigned long)s.value, (unsigned long)s.sum,
+             (unsigned long)s.min, (unsigned long)s.max);
+      for(b = 0; b < TSCH_METRICS_HIST_BUCKETS; b++) {
+        LOG_HK_(" %u", s.buckets[b]);
+      }
+      LOG_HK_(" |\n");
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_metrics_reset(void)
+{
+  memset(metric_counters, 0, sizeof(metric_counters));
+  memset(metric_hists, 0, sizeof(metric_hists));
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_METRICS */
+/** @} */
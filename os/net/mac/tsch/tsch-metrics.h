@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Metrics registry: fixed-size counters, gauges and histograms of
+ *         UPA and SLA efficiency, readable at runtime without per-slot logs.
+ */
+
+#ifndef __TSCH_METRICS_H__
+#define __TSCH_METRICS_H__
+
+#include "contiki.h"
+
+/******** Configuration *******/
+
+/* Enable the metrics registry */
+#ifdef TSCH_CONF_METRICS
+#define TSCH_METRICS TSCH_CONF_METRICS
+#else /* TSCH_CONF_METRICS */
+#define TSCH_METRICS 0
+#endif /* TSCH_CONF_METRICS */
+
+/* Number of buckets of each histogram. The last bucket also holds all
+ * larger values. */
+#define TSCH_METRICS_HIST_BUCKETS 16
+
+/************ Types ***********/
+
+/** \brief Metrics of the registry */
+enum tsch_metric_id {
+  /* UPA, Tx side */
+  TSCH_METRIC_UPA_BATCH_PKTS,     /* Histogram: packets per batch, after the triggering packet */
+  TSCH_METRIC_UPA_BATCH_SLOTS,    /* Histogram: timeslots consumed per batch, after the first */
+  TSCH_METRIC_UPA_BATCH_OK,       /* Counter: packets of batches acknowledged */
+  TSCH_METRIC_UPA_PKTS_REQUESTED, /* Counter: packets requested in triggering frames */
+  TSCH_METRIC_UPA_PKTS_ACCEPTED,  /* Counter: packets accepted by the receivers in ACKs */
+  /* SLA */
+  TSCH_METRIC_TIMESLOT_LENGTH,    /* Gauge: current timeslot length (us) */
+  TSCH_METRIC_SLA_TIMESLOT_CHANGES, /* Counter: timeslot lengths applied at triggering ASNs */
+  TSCH_METRIC_SLA_RAPID_EB_EVENTS, /* Counter: rapid EB broadcasting started */
+  TSCH_METRIC_SLA_RAPID_EBS,      /* Counter: EBs enqueued by rapid EB broadcasting */
+  TSCH_METRIC_SLA_TRIG_LEAD,      /* Histogram: timeslots from rapid EB start to the triggering ASN */
+  TSCH_METRIC_SLA_TRIG_LAG,       /* Histogram: timeslots from the triggering ASN to rapid EB stop */
+  TSCH_METRIC_NUM
+};
+
+/** \brief Kinds of metrics */
+enum tsch_metric_type {
+  TSCH_METRIC_COUNTER,
+  TSCH_METRIC_GAUGE,
+  TSCH_METRIC_HISTOGRAM,
+};
+
+/** \brief Summary of a metric. Counters and gauges only set value. */
+struct tsch_metric_summary {
+  enum tsch_metric_type type;
+  uint32_t value; /* Counter or gauge value, number of samples of a histogram */
+  uint32_t sum;
+  uint32_t min;
+  uint32_t max;
+  const uint16_t *buckets;
+};
+
+#if TSCH_METRICS
+
+/********** Functions *********/
+
+/**
+ * \brief Add to a counter
+ */
+void tsch_metrics_add(enum tsch_metric_id id, uint32_t v);
+/**
+ * \brief Add a sample to a histogram
+ */
+void tsch_metrics_sample(enum tsch_metric_id id, uint32_t v);
+/**
+ * \brief Get the summary of a metric
+ * \param id The metric
+ * \param s The summary to fill
+ */
+void tsch_metrics_get(enum tsch_metric_id id, struct tsch_metric_summary *s);
+/**
+ * \brief Get the name of a metric
+ */
+const char *tsch_metrics_name(enum tsch_metric_id id);
+/**
+ * \brief Lower bound of a bucket of a histogram
+ */
+uint32_t tsch_metrics_bucket_lower_bound(enum tsch_metric_id id, uint8_t b);
+/**
+ * \brief Print all metrics to the log
+ */
+void tsch_metrics_print(void);
+/**
+ * \brief Clear all counters and histograms
+ */
+void tsch_metrics_reset(void);
+
+/************ Macros **********/
+
+#define TSCH_METRICS_ADD(id, v) tsch_metrics_add((id), (v))
+#define TSCH_METRICS_SAMPLE(id, v) tsch_metrics_sample((id), (v))
+
+#else /* TSCH_METRICS */
+
+#define tsch_metrics_print()
+#define tsch_metrics_reset()
+#define TSCH_METRICS_ADD(id, v)
+#define TSCH_METRICS_SAMPLE(id, v)
+
+#endif /* TSCH_METRICS */
+
+#endif /* __TSCH_METRICS_H__ */
+/** @} */
@@ -336,6 +336,10 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   ies.ie_sla_triggering_asn = sla_triggering_asn;
   ies.ie_sla_curr_timeslot_len = tsch_timing_us[tsch_ts_timeslot_length];
   ies.ie_sla_next_timeslot_len = sla_next_timeslot_length;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  memcpy(ies.ie_sla_curr_bc_sf_timeslot_len, tsch_bc_sf_timing_us, sizeof(ies.ie_sla_curr_bc_sf_timeslot_len));
+  memcpy(ies.ie_sla_next_bc_sf_timeslot_len, sla_next_bc_sf_timeslot_length, sizeof(ies.ie_sla_next_bc_sf_timeslot_len));
+#endif
 #endif
 
   /* Add TSCH timeslot timing IE. */
@@ -520,6 +524,10 @@ sla_packet_update_eb(uint8_t *buf, int buf_size, uint8_t tsch_sync_ie_offset)
   ies.ie_sla_triggering_asn = sla_triggering_asn;
   ies.ie_sla_curr_timeslot_len = tsch_timing_us[tsch_ts_timeslot_length];
   ies.ie_sla_next_timeslot_len = sla_next_timeslot_length;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  memcpy(ies.ie_sla_curr_bc_sf_timeslot_len, tsch_bc_sf_timing_us, sizeof(ies.ie_sla_curr_bc_sf_timeslot_len));
+  memcpy(ies.ie_sla_next_bc_sf_timeslot_len, sla_next_bc_sf_timeslot_length, sizeof(ies.ie_sla_next_bc_sf_timeslot_len));
+#endif
   uint8_t result_triggering_asn = frame80215e_create_ie_tsch_sla_triggering_asn(buf+tsch_sync_ie_offset+8, buf_size-tsch_sync_ie_offset-8, &ies) != -1;
   uint8_t result_frame_ack_len = frame80215e_create_ie_tsch_sla_timeslot_len(buf+tsch_sync_ie_offset+8+7, buf_size-tsch_sync_ie_offset-8-7, &ies) != -1;
   return result_triggering_asn && result_frame_ack_len;
@@ -65,6 +65,11 @@
 #include "orchestra.h"
 #endif
 
+#if TSCH_QUEUE_WITH_CLASSES
+#include "net/packetbuf.h"
+#include "net/ipv6/uip.h"
+#endif
+
 /* Log configuration */
 #include "sys/log.h"
 #define LOG_MODULE "TSCH Queue"
@@ -75,9 +80,36 @@
 #error TSCH_QUEUE_NUM_PER_NEIGHBOR must be power of two
 #endif
 
+#if TSCH_QUEUE_WITH_SHARED_POOL
+#if QUEUEBUF_NUM > 255
+#error TSCH_QUEUE_WITH_SHARED_POOL requires QUEUEBUF_NUM <= 255
+#endif
+#if TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR > TSCH_QUEUE_NUM_PER_NEIGHBOR
+#error TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR must not exceed TSCH_QUEUE_NUM_PER_NEIGHBOR
+#endif
+#endif
+
 #if WITH_ALICE /* alice implementation */
 #ifdef ALICE_PACKET_CELL_MATCHING_ON_THE_FLY /* alice packet cell matching on the fly */
 int ALICE_PACKET_CELL_MATCHING_ON_THE_FLY(uint16_t *timeslot, uint16_t *channel_offset, const linkaddr_t *rx_linkaddr);
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+int alice_packet_cell_matching_cached(struct tsch_neighbor *n, uint16_t *timeslot, uint16_t *channel_offset, const linkaddr_t *rx_linkaddr);
+#endif
+#endif
+
+#if ALICE_DBG_PCM_CYCLES
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+/* Cortex-M3/M4 (cc2538, iotlab-m3): DWT cycle counter */
+#define ALICE_DBG_CYCLES_INIT() do { \
+    *(volatile uint32_t *)0xE000EDFC |= (1UL << 24); /* DEMCR: TRCENA */ \
+    *(volatile uint32_t *)0xE0001000 |= 1UL; /* DWT_CTRL: CYCCNTENA */ \
+  } while(0)
+#define ALICE_DBG_CYCLES_NOW() (*(volatile uint32_t *)0xE0001004) /* DWT_CYCCNT */
+#else
+/* No cycle counter: rtimer ticks */
+#define ALICE_DBG_CYCLES_INIT()
+#define ALICE_DBG_CYCLES_NOW() ((uint32_t)RTIMER_NOW())
+#endif
 #endif
 #endif
 
@@ -89,10 +121,122 @@ NBR_TABLE(struct tsch_neighbor, tsch_neighbors);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_WITH_SHARED_POOL
+/*---------------------------------------------------------------------------*/
+/* Packet of the shared pool at a given index */
+struct tsch_packet *
+tsch_queue_pool_packet(uint8_t index)
+{
+  return (struct tsch_packet *)packet_memb.mem + index;
+}
+/*---------------------------------------------------------------------------*/
+/* Index of a packet in the shared pool */
+uint8_t
+tsch_queue_pool_index(const struct tsch_packet *p)
+{
+  return p - (const struct tsch_packet *)packet_memb.mem;
+}
+/*---------------------------------------------------------------------------*/
+/* Can a packet to a neighbor be taken from the shared pool without
+ * exceeding its quota? */
+static int
+pool_admit(const struct tsch_neighbor *n)
+{
+  int count = tsch_queue_nbr_packet_count(n);
+  int free_pkts = memb_numfree(&packet_memb);
+  int reserved = 0;
+
+  if(free_pkts == 0) {
+    return 0;
+  }
+  if(count < TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR) {
+    return 1;
+  }
+  if(count >= TSCH_QUEUE_POOL_MAX_PER_NEIGHBOR) {
+    tsch_queue_pool_quota_drop_count++;
+    return 0;
+  }
+
+#if TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR > 0
+  {
+    /* Borrowing: keep the minimum of the other neighbors available. Queues
+     * are emptied from the slot operation, so this is recomputed here rather
+     * than kept as a running count. */
+    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+    while(curr_nbr != NULL) {
+      if(curr_nbr != n) {
+        int curr_count = tsch_queue_nbr_packet_count(curr_nbr);
+        if(curr_count < TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR) {
+          reserved += TSCH_QUEUE_POOL_MIN_PER_NEIGHBOR - curr_count;
+        }
+      }
+      curr_nbr = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, curr_nbr);
+    }
+  }
+#endif
+
+  if(count < TSCH_QUEUE_POOL_ALPHA * (free_pkts - reserved)) {
+    tsch_queue_pool_borrow_count++;
+    return 1;
+  }
+  tsch_queue_pool_quota_drop_count++;
+  return 0;
+}
+#define POOL_ADMIT(n) pool_admit(n)
+#else
+#define POOL_ADMIT(n) 1
+#endif
+
 #if WITH_OST /* OST-01-01: Measure traffic load */
 static struct ctimer ost_select_N_timer;
 #endif
 
+#if TSCH_QUEUE_WITH_CLASSES
+#if TSCH_QUEUE_CLASS_WRR
+static const uint8_t class_weights[TSCH_QUEUE_NUM_CLASSES] = TSCH_QUEUE_CLASS_WEIGHTS;
+#endif
+static const uint16_t class_lifetime[TSCH_QUEUE_NUM_CLASSES] = TSCH_QUEUE_CLASS_LIFETIME;
+
+#ifdef TSCH_CALLBACK_PACKET_CLASS
+uint8_t TSCH_CALLBACK_PACKET_CLASS(void);
+#endif
+
+#define PACKET_CLASS(p) ((p)->tx_class)
+#else
+#define PACKET_CLASS(p) 0
+#endif
+
+#if TSCH_QUEUE_WITH_CLASSES
+/*---------------------------------------------------------------------------*/
+/* Traffic class of the packet in packetbuf */
+static uint8_t
+packet_class(void)
+{
+#ifdef TSCH_CALLBACK_PACKET_CLASS
+  /* The application classifies its own traffic */
+  return TSCH_CALLBACK_PACKET_CLASS();
+#else
+  switch(packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID)) {
+  case UIP_PROTO_UDP:
+    return TSCH_QUEUE_CLASS_LATENCY;
+  case UIP_PROTO_TCP:
+    return TSCH_QUEUE_CLASS_BULK;
+  default:
+    /* ICMPv6 (RPL, ND), and frames without IPv6 payload (EBs, keepalives, 6P) */
+    return TSCH_QUEUE_CLASS_CONTROL;
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Has a packet been queued past its deadline? */
+int
+tsch_queue_packet_expired(const struct tsch_packet *p)
+{
+  return p->has_deadline
+    && (int32_t)TSCH_ASN_DIFF(tsch_current_asn, p->deadline_asn) > 0;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 #if HCK_ORCHESTRA_PACKET_OFFLOADING
 void
@@ -106,31 +250,35 @@ tsch_queue_change_attr_of_packets_in_queue(const struct tsch_neighbor *target_nb
 
   int16_t get_index = 0;
   uint8_t num_elements = 0;
+  uint8_t c;
 
   if(!tsch_is_locked()) {
 #if 0
     tsch_queue_backoff_reset(target_nbr);
 #endif
 
-    get_index = ringbufindex_peek_get(&target_nbr->tx_ringbuf);
-    num_elements = ringbufindex_elements(&target_nbr->tx_ringbuf);
+    for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+      const struct ringbufindex *ringbuf = TSCH_QUEUE_RINGBUF(target_nbr, c);
+      get_index = ringbufindex_peek_get(ringbuf);
+      num_elements = ringbufindex_elements(ringbuf);
 
-    if(get_index == -1) {
-      return;
-    }
-    
-    uint8_t i;
-    for(i = get_index; i < get_index + num_elements; i++) {
-      int16_t index;
-
-      if(i >= ringbufindex_size(&target_nbr->tx_ringbuf)) { /* default size: 16 */
-        index = i - ringbufindex_size(&target_nbr->tx_ringbuf);
-      } else {
-        index = i;  
+      if(get_index == -1) {
+        continue;
       }
 
-      queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
-      queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+      uint8_t i;
+      for(i = get_index; i < get_index + num_elements; i++) {
+        int16_t index;
+
+        if(i >= ringbufindex_size(ringbuf)) { /* default size: 16 */
+          index = i - ringbufindex_size(ringbuf);
+        } else {
+          index = i;
+        }
+
+        queuebuf_update_attr(TSCH_QUEUE_PACKET(target_nbr, c, index)->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
+        queuebuf_update_attr(TSCH_QUEUE_PACKET(target_nbr, c, index)->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+      }
     }
   }
 }
@@ -158,23 +306,27 @@ void
 ost_update_N_of_packets_in_queue(const linkaddr_t *lladdr, uint16_t updated_N)
 {
   struct tsch_neighbor *n = tsch_queue_get_nbr(lladdr);
+  uint8_t c;
   if(n != NULL) {
-    if(!ringbufindex_empty(&n->tx_ringbuf)) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
-      uint8_t num_elements = ringbufindex_elements(&n->tx_ringbuf);
-
-      uint8_t j;
-      for(j = get_index; j < get_index + num_elements; j++) {
-        int8_t index;
-        if(j >= ringbufindex_size(&n->tx_ringbuf)) { /* default size: 16 */
-          index = j - ringbufindex_size(&n->tx_ringbuf);
-        } else {
-          index = j;
-        }
-        uint8_t *packet = (uint8_t *)queuebuf_dataptr(n->tx_array[index]->qb);
+    for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+      struct ringbufindex *ringbuf = TSCH_QUEUE_RINGBUF(n, c);
+      if(!ringbufindex_empty(ringbuf)) {
+        int16_t get_index = ringbufindex_peek_get(ringbuf);
+        uint8_t num_elements = ringbufindex_elements(ringbuf);
+
+        uint8_t j;
+        for(j = get_index; j < get_index + num_elements; j++) {
+          int8_t index;
+          if(j >= ringbufindex_size(ringbuf)) { /* default size: 16 */
+            index = j - ringbufindex_size(ringbuf);
+          } else {
+            index = j;
+          }
+          uint8_t *packet = (uint8_t *)queuebuf_dataptr(TSCH_QUEUE_PACKET(n, c, index)->qb);
 
-        packet[2] = updated_N & 0xff;
-        packet[3] = (updated_N >> 8) & 0xff;
+          packet[2] = updated_N & 0xff;
+          packet[3] = (updated_N >> 8) & 0xff;
+        }
       }
     }
   }
@@ -182,86 +334,136 @@ ost_update_N_of_packets_in_queue(const linkaddr_t *lladdr, uint16_t updated_N)
 #endif
 /*---------------------------------------------------------------------------*/
 #if WITH_OST /* OST-02-01: Select N */
+/* Fractional bits of ost_tx_load, on top of the 2^OST_N_MAX scale */
+#define OST_TX_LOAD_FRAC_BITS 4
+
+/* ASN at the previous N selection, valid if ost_last_asn_valid */
+static struct tsch_asn_t ost_last_asn;
+static uint8_t ost_last_asn_valid;
+/*---------------------------------------------------------------------------*/
+/* Number of slots elapsed since the previous N selection. Counted in ASN,
+   so that it follows the timeslot length changes of SLA, or estimated from
+   the current timeslot length when the ASN is not usable */
+static uint32_t
+ost_elapsed_slots(void)
+{
+  uint32_t estimate = (uint32_t)OST_N_SELECTION_PERIOD * TSCH_SLOTS_PER_SECOND;
+  uint32_t slots = estimate;
+
+  if(tsch_is_associated) {
+    struct tsch_asn_t now;
+    TSCH_ASN_COPY(now, tsch_current_asn);
+    if(ost_last_asn_valid) {
+      slots = TSCH_ASN_DIFF(now, ost_last_asn);
+      /* The ASN was set again by a new association */
+      if(slots == 0 || slots > 4 * estimate) {
+        slots = estimate;
+      }
+    }
+    ost_last_asn = now;
+    ost_last_asn_valid = 1;
+  } else {
+    ost_last_asn_valid = 0;
+  }
+  return slots;
+}
+/*---------------------------------------------------------------------------*/
+/* Updates the traffic load estimate of a neighbor with the packets of the
+   last period: packets per slot, scaled by 2^(OST_N_MAX + FRAC_BITS).
+   A higher load is taken at once, so that N decreases (more cells) without
+   delay; a lower load is smoothed with an EWMA of weight
+   OST_TX_LOAD_EWMA_ALPHA / 8 */
+static void
+ost_update_tx_load(uip_ds6_nbr_t *ds6_nbr, uint32_t slots)
+{
+  uint32_t sample = ((uint32_t)ds6_nbr->ost_num_tx << (OST_N_MAX + OST_TX_LOAD_FRAC_BITS)) / slots;
+
+  if(ds6_nbr->ost_tx_load == OST_TX_LOAD_NONE || sample >= ds6_nbr->ost_tx_load) {
+    ds6_nbr->ost_tx_load = sample;
+  } else {
+    ds6_nbr->ost_tx_load -= (ds6_nbr->ost_tx_load - sample) * OST_TX_LOAD_EWMA_ALPHA / 8;
+  }
+}
+/*---------------------------------------------------------------------------*/
 /* OST select appropriate N according to the traffic load */
 void ost_select_N(void* ptr)
 {
   uip_ds6_nbr_t *ds6_nbr;
+  uint32_t slots;
   uint16_t traffic_load;
   int i;
 
-  /* select N */
+  slots = ost_elapsed_slots();
+
+  /* select N. The traffic load is measured in process context only:
+     the TSCH lock is taken only to change the N of a neighbor */
   ds6_nbr = uip_ds6_nbr_head();
-  if(tsch_get_lock()) {
-    while(ds6_nbr != NULL) {
-      if(ost_is_routing_nbr(ds6_nbr) && ds6_nbr->ost_newly_added == 0) {
-        /* OST assumes that timeslot length is 10 ms */
-        uint16_t num_slots = OST_N_SELECTION_PERIOD * 1000 / 10;
-        /* unit: packet/slot multiplied by 2^OST_N_MAX */
-        traffic_load = (1 << OST_N_MAX) * (ds6_nbr->ost_num_tx) / num_slots;
-
-        for(i = 1; i <= OST_N_MAX; i++) {
-          if((traffic_load >> i) < 1) {
-            uint16_t old_N = ds6_nbr->ost_my_N;
-            uint16_t new_N = (OST_N_MAX - i + 1) - OST_MORE_UNDER_PROVISION;
-
-            if(old_N != new_N) {
-              uint8_t change_N = 0;
-              if(new_N > old_N) { /* increase my_N */
-                ds6_nbr->ost_consecutive_my_N_inc++;
-                if(ds6_nbr->ost_consecutive_my_N_inc >= OST_THRES_CONSEQUTIVE_N_INC) {
-                  ds6_nbr->ost_consecutive_my_N_inc = 0;
-                  change_N = 1;
-                } else {
-                  change_N = 0;
-                }
-              } else { /* decrease my_N */
+  while(ds6_nbr != NULL) {
+    if(ost_is_routing_nbr(ds6_nbr) && ds6_nbr->ost_newly_added == 0) {
+      ost_update_tx_load(ds6_nbr, slots);
+      /* unit: packet/slot multiplied by 2^OST_N_MAX */
+      traffic_load = MIN(ds6_nbr->ost_tx_load >> OST_TX_LOAD_FRAC_BITS, 0xffff);
+
+      for(i = 1; i <= OST_N_MAX; i++) {
+        if((traffic_load >> i) < 1) {
+          uint16_t old_N = ds6_nbr->ost_my_N;
+          uint16_t new_N = (OST_N_MAX - i + 1) - OST_MORE_UNDER_PROVISION;
+
+          if(old_N != new_N) {
+            uint8_t change_N = 0;
+            if(new_N > old_N) { /* increase my_N */
+              ds6_nbr->ost_consecutive_my_N_inc++;
+              if(ds6_nbr->ost_consecutive_my_N_inc >= OST_THRES_CONSEQUTIVE_N_INC) {
                 ds6_nbr->ost_consecutive_my_N_inc = 0;
                 change_N = 1;
+              } else {
+                change_N = 0;
               }
-              
-              if(change_N) {
-                ost_update_N_of_packets_in_queue((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr), new_N);
-                ds6_nbr->ost_my_N = new_N;
-              }
-            } else { /* No change */
+            } else { /* decrease my_N */
               ds6_nbr->ost_consecutive_my_N_inc = 0;
+              change_N = 1;
+            }
+
+            /* Without the lock, the change is tried again next period */
+            if(change_N && tsch_get_lock()) {
+              ost_update_N_of_packets_in_queue((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr), new_N);
+              ds6_nbr->ost_my_N = new_N;
+              tsch_release_lock();
             }
+          } else { /* No change */
+            ds6_nbr->ost_consecutive_my_N_inc = 0;
+          }
 #if WITH_OST_LOG_INFO
-            LOG_INFO("ost sel_N: ");
-            LOG_INFO_LLADDR((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr));
-            LOG_INFO_(" %u -> %u (%u, %u)\n", old_N, ds6_nbr->ost_my_N,
-                    ds6_nbr->ost_num_tx, ds6_nbr->ost_consecutive_my_N_inc);
+          LOG_INFO("ost sel_N: ");
+          LOG_INFO_LLADDR((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr));
+          LOG_INFO_(" %u -> %u (%u, %lu, %u)\n", old_N, ds6_nbr->ost_my_N,
+                  ds6_nbr->ost_num_tx, (unsigned long)slots, ds6_nbr->ost_consecutive_my_N_inc);
 #endif
-            break;
-          }
+          break;
         }
-      } else {
-        /* initialize ost_my_N of newly added nbr */
-        ds6_nbr->ost_my_N = 5;
-        if(ds6_nbr->ost_newly_added == 1) { 
-          ds6_nbr->ost_newly_added = 0;
+      }
+    } else {
+      /* initialize ost_my_N of newly added nbr */
+      ds6_nbr->ost_my_N = 5;
+      ds6_nbr->ost_tx_load = OST_TX_LOAD_NONE;
+      if(ds6_nbr->ost_newly_added == 1) { 
+        ds6_nbr->ost_newly_added = 0;
 #if WITH_OST_LOG_INFO
-          if(ost_is_routing_nbr(ds6_nbr) == 1) {
-            LOG_INFO("ost sel_N: ");
-            LOG_INFO_LLADDR((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr));
-            LOG_INFO_(" new_r_nbr %u\n", ds6_nbr->ost_my_N);
-          }
-#endif
+        if(ost_is_routing_nbr(ds6_nbr) == 1) {
+          LOG_INFO("ost sel_N: ");
+          LOG_INFO_LLADDR((linkaddr_t *)uip_ds6_nbr_get_ll(ds6_nbr));
+          LOG_INFO_(" new_r_nbr %u\n", ds6_nbr->ost_my_N);
         }
+#endif
       }
-
-      ds6_nbr = uip_ds6_nbr_next(ds6_nbr);
     }
 
-    /* Reset all num_tx */
-    ds6_nbr = uip_ds6_nbr_head();
-    while(ds6_nbr != NULL) {
-      ds6_nbr->ost_num_tx = 0;
-      ds6_nbr = uip_ds6_nbr_next(ds6_nbr);
-    }
+    /* Reset num_tx for the next period */
+    ds6_nbr->ost_num_tx = 0;
 
-    tsch_release_lock();
+    ds6_nbr = uip_ds6_nbr_next(ds6_nbr);
   }
+
   ctimer_reset(&ost_select_N_timer);
 }
 /*---------------------------------------------------------------------------*/
@@ -286,6 +488,7 @@ struct tsch_neighbor *
 tsch_queue_add_nbr(const linkaddr_t *addr)
 {
   struct tsch_neighbor *n = NULL;
+  uint8_t c;
   /* If we have an entry for this neighbor already, we simply update it */
   n = tsch_queue_get_nbr(addr);
   if(n == NULL) {
@@ -299,7 +502,9 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
         nbr_table_lock(tsch_neighbors, n);
         /* Initialize neighbor entry */
         memset(n, 0, sizeof(struct tsch_neighbor));
-        ringbufindex_init(&n->tx_ringbuf, TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+          ringbufindex_init(TSCH_QUEUE_RINGBUF(n, c), TSCH_QUEUE_NUM_PER_NEIGHBOR);
+        }
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
         tsch_queue_backoff_reset(n);
@@ -399,20 +604,48 @@ tsch_queue_update_time_source(const linkaddr_t *new_addr)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+/* Is the queue of a traffic class of a neighbor empty? */
+static int
+class_is_empty(const struct tsch_neighbor *n, uint8_t c)
+{
+  return !tsch_is_locked() && n != NULL && ringbufindex_empty(TSCH_QUEUE_RINGBUF(n, c));
+}
+/*---------------------------------------------------------------------------*/
+/* Remove first packet from the queue of a traffic class of a neighbor */
+static struct tsch_packet *
+remove_packet_from_class(struct tsch_neighbor *n, uint8_t c)
+{
+  if(!tsch_is_locked()) {
+    if(n != NULL) {
+      /* Get and remove packet from ringbuf (remove committed through an atomic operation */
+      int16_t get_index = ringbufindex_get(TSCH_QUEUE_RINGBUF(n, c));
+      if(get_index != -1) {
+        return TSCH_QUEUE_PACKET(n, c, get_index);
+      } else {
+        return NULL;
+      }
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 /* Flush a neighbor queue */
 static void
 tsch_queue_flush_nbr_queue(struct tsch_neighbor *n)
 {
-  while(!tsch_queue_is_empty(n)) {
-    struct tsch_packet *p = tsch_queue_remove_packet_from_queue(n);
-    if(p != NULL) {
-      /* Set return status for packet_sent callback */
-      p->ret = MAC_TX_ERR;
-      LOG_WARN("! flushing packet\n");
-      /* Call packet_sent callback */
-      mac_call_sent_callback(p->sent, p->ptr, p->ret, p->transmissions);
-      /* Free packet queuebuf */
-      tsch_queue_free_packet(p);
+  uint8_t c;
+  for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+    while(!class_is_empty(n, c)) {
+      struct tsch_packet *p = remove_packet_from_class(n, c);
+      if(p != NULL) {
+        /* Set return status for packet_sent callback */
+        p->ret = MAC_TX_ERR;
+        LOG_WARN("! flushing packet\n");
+        /* Call packet_sent callback */
+        mac_call_sent_callback(p->sent, p->ptr, p->ret, p->transmissions);
+        /* Free packet queuebuf */
+        tsch_queue_free_packet(p);
+      }
     }
   }
 }
@@ -453,12 +686,18 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
   struct tsch_neighbor *n = NULL;
   int16_t put_index = -1;
   struct tsch_packet *p = NULL;
+#if TSCH_QUEUE_WITH_CLASSES
+  uint8_t c = packet_class();
+#endif
 
 #ifdef TSCH_CALLBACK_PACKET_READY
   /* The scheduler provides a callback which sets the timeslot and other attributes */
   if(TSCH_CALLBACK_PACKET_READY() < 0) {
     /* No scheduled slots for the packet available; drop it early to save queue space. */
     LOG_DBG("tsch_queue_add_packet(): rejected by the scheduler\n");
+#if TSCH_QUEUE_WITH_CLASSES
+    tsch_queue_class_stats[c].qloss++;
+#endif
 
 #if ENABLE_LOG_TSCH_PACKET_ADD_AND_FREE
     global_queued_pkts = tsch_queue_global_packet_count();
@@ -488,8 +727,8 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
 
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
-    if(n != NULL) {
-      put_index = ringbufindex_peek_put(&n->tx_ringbuf);
+    if(n != NULL && POOL_ADMIT(n)) {
+      put_index = ringbufindex_peek_put(TSCH_QUEUE_RINGBUF(n, c));
       if(put_index != -1) {
         p = memb_alloc(&packet_memb);
         if(p != NULL) {
@@ -501,9 +740,23 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
             p->max_transmissions = max_transmissions;
+#if TSCH_QUEUE_WITH_CLASSES
+            p->tx_class = c;
+            p->has_deadline = class_lifetime[c] > 0;
+            if(p->has_deadline) {
+              TSCH_ASN_COPY(p->deadline_asn, tsch_current_asn);
+              TSCH_ASN_INC(p->deadline_asn, class_lifetime[c]);
+            }
+            tsch_queue_class_stats[c].enqueued++;
+#endif
             /* Add to ringbuf (actual add committed through atomic operation) */
-            n->tx_array[put_index] = p;
-            ringbufindex_put(&n->tx_ringbuf);
+            TSCH_QUEUE_SET_PACKET(n, c, put_index, p);
+#if WITH_UPA && UPA_MEMOIZED_SLOT_UTILITY
+            p->upa_tx_duration = TSCH_PACKET_DURATION(queuebuf_datalen(p->qb));
+            n->upa_tx_duration_total[PACKET_CLASS(p)] += p->upa_tx_duration;
+            p->upa_tx_duration_sum = n->upa_tx_duration_total[PACKET_CLASS(p)];
+#endif
+            ringbufindex_put(TSCH_QUEUE_RINGBUF(n, c));
             LOG_DBG("packet is added put_index %u, packet %p\n",
                    put_index, p);
 
@@ -530,6 +783,9 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
     }
   }
   LOG_ERR("! add packet failed: %u %p %d %p %p\n", tsch_is_locked(), n, put_index, p, p ? p->qb : NULL);
+#if TSCH_QUEUE_WITH_CLASSES
+  tsch_queue_class_stats[c].qloss++;
+#endif
 
 #if ENABLE_LOG_TSCH_PACKET_ADD_AND_FREE
   global_queued_pkts = tsch_queue_global_packet_count();
@@ -556,12 +812,36 @@ tsch_queue_global_packet_count(void)
   return QUEUEBUF_NUM - memb_numfree(&packet_memb);
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_WITH_STATS
+/* Returns the maximum number of packets that were in TSCH queues at once */
+int
+tsch_queue_global_packet_high_water(void)
+{
+  return memb_high_water(&packet_memb);
+}
+#endif /* MEMB_WITH_STATS */
+/*---------------------------------------------------------------------------*/
 /* Returns the number of packets currently in the queue */
 int
 tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
 {
   if(n != NULL) {
-    return ringbufindex_elements(&n->tx_ringbuf);
+    int count = 0;
+    uint8_t c;
+    for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+      count += ringbufindex_elements(TSCH_QUEUE_RINGBUF(n, c));
+    }
+    return count;
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the number of packets currently in the queue of the Tx class */
+int
+tsch_queue_nbr_tx_class_packet_count(const struct tsch_neighbor *n)
+{
+  if(n != NULL) {
+    return ringbufindex_elements(TSCH_QUEUE_TX_RINGBUF(n));
   }
   return -1;
 }
@@ -570,16 +850,16 @@ tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
 struct tsch_packet *
 tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
 {
-  if(!tsch_is_locked()) {
-    if(n != NULL) {
-      /* Get and remove packet from ringbuf (remove committed through an atomic operation */
-      int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
-      if(get_index != -1) {
-        return n->tx_array[get_index];
-      } else {
-        return NULL;
-      }
+  if(n != NULL) {
+#if TSCH_QUEUE_WITH_CLASSES && TSCH_QUEUE_CLASS_WRR
+    struct tsch_packet *p = remove_packet_from_class(n, n->tx_class);
+    if(p != NULL && n->tx_class_credit > 0) {
+      n->tx_class_credit--;
     }
+    return p;
+#else
+    return remove_packet_from_class(n, TSCH_QUEUE_TX_CLASS(n));
+#endif
   }
   return NULL;
 }
@@ -811,7 +1091,13 @@ tsch_queue_free_unused_neighbors(void)
 int
 tsch_queue_is_empty(const struct tsch_neighbor *n)
 {
-  return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
+  uint8_t c;
+  for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+    if(!class_is_empty(n, c)) {
+      return 0;
+    }
+  }
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 #if WITH_UPA
@@ -821,7 +1107,7 @@ tsch_queue_upa_get_next_packet_for_nbr(const struct tsch_neighbor *n, uint8_t up
   if(!tsch_is_locked()) {
     uint8_t offset = upa_last_tx_seq;
     if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+      int16_t get_index = ringbufindex_peek_get(TSCH_QUEUE_TX_RINGBUF(n));
 
       if(get_index != -1) {
         /* Even if this is a shared slot,
@@ -832,12 +1118,50 @@ tsch_queue_upa_get_next_packet_for_nbr(const struct tsch_neighbor *n, uint8_t up
          * can be sent in upa slot with different slotframe handle and timeoffset */
         int16_t get_index_with_offset = get_index + offset < TSCH_QUEUE_NUM_PER_NEIGHBOR ? 
                                       get_index + offset : get_index + offset - TSCH_QUEUE_NUM_PER_NEIGHBOR;
-        return n->tx_array[get_index_with_offset];
+        return TSCH_QUEUE_TX_PACKET(n, get_index_with_offset);
       }
     }
   }
   return NULL;
 }
+#if UPA_MEMOIZED_SLOT_UTILITY
+/*---------------------------------------------------------------------------*/
+/* Tx duration of the packets following the head of the queue, up to
+ * upa_last_tx_seq packets, in O(1) from the running sums */
+uint32_t
+tsch_queue_upa_get_tx_duration_sum(const struct tsch_neighbor *n, uint8_t upa_last_tx_seq)
+{
+  if(n != NULL) {
+    int16_t get_index = ringbufindex_peek_get(TSCH_QUEUE_TX_RINGBUF(n));
+    if(get_index != -1) {
+      int16_t get_index_with_offset = get_index + upa_last_tx_seq < TSCH_QUEUE_NUM_PER_NEIGHBOR ?
+                                    get_index + upa_last_tx_seq : get_index + upa_last_tx_seq - TSCH_QUEUE_NUM_PER_NEIGHBOR;
+      return TSCH_QUEUE_TX_PACKET(n, get_index_with_offset)->upa_tx_duration_sum
+        - TSCH_QUEUE_TX_PACKET(n, get_index)->upa_tx_duration_sum;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Recompute the running sums of the queued packets after packets of a batch
+ * were moved within tx_array. The sum of the last queued packet stays the total. */
+void
+tsch_queue_upa_update_tx_duration_sums(struct tsch_neighbor *n)
+{
+  if(n != NULL) {
+    int elements = ringbufindex_elements(TSCH_QUEUE_TX_RINGBUF(n));
+    int16_t get_index = ringbufindex_peek_get(TSCH_QUEUE_TX_RINGBUF(n));
+    uint32_t sum = n->upa_tx_duration_total[TSCH_QUEUE_TX_CLASS(n)];
+    int i;
+    for(i = elements - 1; i >= 0 && get_index != -1; i--) {
+      int16_t index = get_index + i < TSCH_QUEUE_NUM_PER_NEIGHBOR ?
+                      get_index + i : get_index + i - TSCH_QUEUE_NUM_PER_NEIGHBOR;
+      TSCH_QUEUE_TX_PACKET(n, index)->upa_tx_duration_sum = sum;
+      sum -= TSCH_QUEUE_TX_PACKET(n, index)->upa_tx_duration;
+    }
+  }
+}
+#endif
 #endif
 /*---------------------------------------------------------------------------*/
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION && TSCH_DBT_HOLD_CURRENT_NBR
@@ -847,7 +1171,7 @@ tsch_queue_burst_get_next_packet_for_nbr(const struct tsch_neighbor *n)
 {
   if(!tsch_is_locked()) {
     if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+      int16_t get_index = ringbufindex_peek_get(TSCH_QUEUE_TX_RINGBUF(n));
 
       if(get_index != -1) {
         /* Even if this is a shared slot,
@@ -856,7 +1180,7 @@ tsch_queue_burst_get_next_packet_for_nbr(const struct tsch_neighbor *n)
         /* Deactivate TSCH_WITH_LINK_SELECTOR in burst slot 
          * because packets with predefined slotframe handle and timeoffset
          * can be sent in burst slot with different slotframe handle and timeoffset */
-        return n->tx_array[get_index];
+        return TSCH_QUEUE_TX_PACKET(n, get_index);
       }
     }
   }
@@ -864,14 +1188,14 @@ tsch_queue_burst_get_next_packet_for_nbr(const struct tsch_neighbor *n)
 }
 #endif
 /*---------------------------------------------------------------------------*/
-/* Returns the first packet from a neighbor queue */
-struct tsch_packet *
-tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link)
+/* Returns the first packet from the queue of a traffic class of a neighbor */
+static struct tsch_packet *
+get_packet_for_nbr_class(const struct tsch_neighbor *n, uint8_t c, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
     int is_shared_link = link != NULL && link->link_options & LINK_OPTION_SHARED;
     if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+      int16_t get_index = ringbufindex_peek_get(TSCH_QUEUE_RINGBUF(n, c));
       if(get_index != -1 &&
           !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
                                                                     make sure the backoff has expired */
@@ -881,23 +1205,23 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
         if(link->slotframe_handle > SSQ_SCHEDULE_HANDLE_OFFSET && link->link_options == LINK_OPTION_TX) {
           uint16_t target_nbr_id = (link->slotframe_handle - SSQ_SCHEDULE_HANDLE_OFFSET - 1) / 2;
           if(OST_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(n)) == target_nbr_id) {
-            return n->tx_array[get_index];
+            return TSCH_QUEUE_PACKET(n, c, get_index);
           } else {
             return NULL;
           }
         }
 #endif        
 
-        int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
-        int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
+        int packet_attr_slotframe = queuebuf_attr(TSCH_QUEUE_PACKET(n, c, get_index)->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
+        int packet_attr_timeslot = queuebuf_attr(TSCH_QUEUE_PACKET(n, c, get_index)->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
 
 #if WITH_ALICE /* alice implementation */
-        int packet_attr_channel_offset = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_CHANNEL_OFFSET);
+        int packet_attr_channel_offset = queuebuf_attr(TSCH_QUEUE_PACKET(n, c, get_index)->qb, PACKETBUF_ATTR_TSCH_CHANNEL_OFFSET);
 
 #ifdef ALICE_PACKET_CELL_MATCHING_ON_THE_FLY
         if(packet_attr_slotframe == ALICE_UNICAST_SF_HANDLE) {
           linkaddr_t rx_linkaddr;
-          linkaddr_copy(&rx_linkaddr, queuebuf_addr(n->tx_array[get_index]->qb, PACKETBUF_ADDR_RECEIVER));
+          linkaddr_copy(&rx_linkaddr, queuebuf_addr(TSCH_QUEUE_PACKET(n, c, get_index)->qb, PACKETBUF_ADDR_RECEIVER));
           uint16_t packet_timeslot = link->timeslot; /* alice final check */
           uint16_t packet_channel_offset = link->channel_offset; /* alice final check */
 
@@ -905,11 +1229,34 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
           //this function calculates time offset and channel offset 
           //on the basis of the link-level packet destiation (rx_linkaddr) and the current SFID.
           //Decides packet_timeslot and packet_channel_offset, checks rpl neighbor relations.
+#if ALICE_DBG_PCM_CYCLES
+          uint32_t pcm_start_cycles = ALICE_DBG_CYCLES_NOW();
+#endif
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+          /* Cells of this neighbor cached for the current ASFN and RPL neighbor set */
+#if ALICE_EARLY_PACKET_DROP
+          int r = alice_packet_cell_matching_cached((struct tsch_neighbor *)n, &packet_timeslot, &packet_channel_offset, &rx_linkaddr);
+#else
+          alice_packet_cell_matching_cached((struct tsch_neighbor *)n, &packet_timeslot, &packet_channel_offset, &rx_linkaddr);
+#endif
+#else
 #if ALICE_EARLY_PACKET_DROP
           int r = ALICE_PACKET_CELL_MATCHING_ON_THE_FLY(&packet_timeslot, &packet_channel_offset, &rx_linkaddr);
 #else
           ALICE_PACKET_CELL_MATCHING_ON_THE_FLY(&packet_timeslot, &packet_channel_offset, &rx_linkaddr);
 #endif
+#endif
+#if ALICE_DBG_PCM_CYCLES
+          uint32_t pcm_cycles = ALICE_DBG_CYCLES_NOW() - pcm_start_cycles;
+          alice_pcm_call_count++;
+#if !ALICE_PACKET_CELL_MATCHING_CACHE
+          alice_pcm_miss_count++;
+#endif
+          alice_pcm_cycles_sum += pcm_cycles;
+          if(pcm_cycles > alice_pcm_cycles_max) {
+            alice_pcm_cycles_max = pcm_cycles;
+          }
+#endif
 
 #if ENABLE_ALICE_PACKET_CELL_MATCHING_LOG
           TSCH_LOG_ADD(tsch_log_message,
@@ -922,11 +1269,11 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
 #if ALICE_EARLY_PACKET_DROP
           if(r == 0) { //no RPL neighbor --> ALICE EARLY PACKET DROP
             alice_early_packet_drop_count++;
-		        tsch_queue_free_packet(n->tx_array[get_index]);
-            ringbufindex_get(&(((struct tsch_neighbor *)n)->tx_ringbuf));
+		        tsch_queue_free_packet(TSCH_QUEUE_PACKET(n, c, get_index));
+            ringbufindex_get(TSCH_QUEUE_RINGBUF((struct tsch_neighbor *)n, c));
 
 #if ENABLE_ALICE_EARLY_PACKET_DROP_LOG
-            int16_t next_get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+            int16_t next_get_index = ringbufindex_peek_get(TSCH_QUEUE_RINGBUF(n, c));
             TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "ALICE e-p-d %d %d", get_index, next_get_index));
@@ -945,7 +1292,7 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
               return NULL;
             }
           }
-          return n->tx_array[get_index];
+          return TSCH_QUEUE_PACKET(n, c, get_index);
 
         } else { //EB or broadcast slotframe's packet
           if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
@@ -980,11 +1327,51 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
 #endif /* WITH_ALICE */
 
 #endif /* TSCH_WITH_LINK_SELECTOR */
-        return n->tx_array[get_index];
+        return TSCH_QUEUE_PACKET(n, c, get_index);
+      }
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the first packet from a neighbor queue */
+struct tsch_packet *
+tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link)
+{
+#if TSCH_QUEUE_WITH_CLASSES
+  if(!tsch_is_locked() && n != NULL) {
+    struct tsch_neighbor *nbr = (struct tsch_neighbor *)n;
+    uint8_t c = TSCH_QUEUE_CLASS_CONTROL;
+    uint8_t i;
+#if TSCH_QUEUE_CLASS_WRR
+    /* Stay on the current class until its round is over */
+    if(nbr->tx_class_credit > 0 && !class_is_empty(nbr, nbr->tx_class)) {
+      c = nbr->tx_class;
+    } else {
+      c = (nbr->tx_class + 1) % TSCH_QUEUE_NUM_CLASSES;
+    }
+#endif
+    /* The first class (by priority, or in round-robin order) that has
+     * a packet for this link */
+    for(i = 0; i < TSCH_QUEUE_NUM_CLASSES; i++) {
+      struct tsch_packet *p = get_packet_for_nbr_class(nbr, c, link);
+      if(p != NULL) {
+#if TSCH_QUEUE_CLASS_WRR
+        if(c != nbr->tx_class || nbr->tx_class_credit == 0) {
+          /* New round */
+          nbr->tx_class_credit = class_weights[c];
+        }
+#endif
+        nbr->tx_class = c;
+        return p;
       }
+      c = (c + 1) % TSCH_QUEUE_NUM_CLASSES;
     }
   }
   return NULL;
+#else
+  return get_packet_for_nbr_class(n, 0, link);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 /* Returns the head packet from a neighbor queue (from neighbor address) */
@@ -1078,6 +1465,9 @@ tsch_queue_init(void)
   LOG_INFO("nbr_tbl_reg: tsch_neighbors %d\n", tsch_neighbors->index);
 
   memb_init(&packet_memb);
+#if WITH_ALICE && ALICE_DBG_PCM_CYCLES
+  ALICE_DBG_CYCLES_INIT();
+#endif
   /* Add virtual EB and the broadcast neighbors */
   n_eb = tsch_queue_add_nbr(&tsch_eb_address);
   n_broadcast = tsch_queue_add_nbr(&tsch_broadcast_address);
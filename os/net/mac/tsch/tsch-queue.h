@@ -47,6 +47,34 @@
 #include "net/linkaddr.h"
 #include "net/mac/mac.h"
 
+/***** Macros *****/
+
+/* Packet array and ringbuf of traffic class c of a neighbor queue, and of
+ * the class of the packet last returned for Tx by tsch_queue_get_packet_for_nbr().
+ * Without TSCH_QUEUE_WITH_CLASSES, a neighbor has a single queue. */
+#if TSCH_QUEUE_WITH_CLASSES
+#define TSCH_QUEUE_ARRAY(n, c) ((n)->tx_array[c])
+#define TSCH_QUEUE_RINGBUF(n, c) (&(n)->tx_ringbuf[c])
+#define TSCH_QUEUE_TX_CLASS(n) ((n)->tx_class)
+#else
+#define TSCH_QUEUE_ARRAY(n, c) ((n)->tx_array)
+#define TSCH_QUEUE_RINGBUF(n, c) (&(n)->tx_ringbuf)
+#define TSCH_QUEUE_TX_CLASS(n) 0
+#endif
+#define TSCH_QUEUE_TX_RINGBUF(n) TSCH_QUEUE_RINGBUF(n, TSCH_QUEUE_TX_CLASS(n))
+
+/* Packet at index i of the packet array of traffic class c of a neighbor.
+ * With TSCH_QUEUE_WITH_SHARED_POOL, the array holds pool indices. */
+#if TSCH_QUEUE_WITH_SHARED_POOL
+#define TSCH_QUEUE_PACKET(n, c, i) tsch_queue_pool_packet(TSCH_QUEUE_ARRAY(n, c)[i])
+#define TSCH_QUEUE_SET_PACKET(n, c, i, p) (TSCH_QUEUE_ARRAY(n, c)[i] = tsch_queue_pool_index(p))
+#else
+#define TSCH_QUEUE_PACKET(n, c, i) (TSCH_QUEUE_ARRAY(n, c)[i])
+#define TSCH_QUEUE_SET_PACKET(n, c, i, p) (TSCH_QUEUE_ARRAY(n, c)[i] = (p))
+#endif
+#define TSCH_QUEUE_TX_PACKET(n, i) TSCH_QUEUE_PACKET(n, TSCH_QUEUE_TX_CLASS(n), i)
+#define TSCH_QUEUE_TX_SET_PACKET(n, i, p) TSCH_QUEUE_SET_PACKET(n, TSCH_QUEUE_TX_CLASS(n), i, p)
+
 /***** External Variables *****/
 
 /* Broadcast and EB virtual neighbors */
@@ -57,6 +85,10 @@ extern struct tsch_neighbor *n_eb;
 #if WITH_UPA
 int tsch_queue_upa_packet_sent(struct tsch_neighbor *n, struct tsch_packet *p, struct tsch_link *link, uint8_t mac_tx_status);
 struct tsch_packet *tsch_queue_upa_get_next_packet_for_nbr(const struct tsch_neighbor *n, uint8_t upa_last_tx_seq);
+#if UPA_MEMOIZED_SLOT_UTILITY
+uint32_t tsch_queue_upa_get_tx_duration_sum(const struct tsch_neighbor *n, uint8_t upa_last_tx_seq);
+void tsch_queue_upa_update_tx_duration_sums(struct tsch_neighbor *n);
+#endif
 #endif
 
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION && TSCH_DBT_HOLD_CURRENT_NBR
@@ -67,12 +99,20 @@ struct tsch_packet * tsch_queue_burst_get_next_packet_for_nbr(const struct tsch_
 void tsch_queue_drop_packets(struct tsch_neighbor *n);
 #endif
 
+#if TSCH_QUEUE_WITH_SHARED_POOL
+struct tsch_packet *tsch_queue_pool_packet(uint8_t index);
+uint8_t tsch_queue_pool_index(const struct tsch_packet *p);
+#endif
+
 void tsch_queue_reset_except_n_eb(void);
 #if HCK_ORCHESTRA_PACKET_OFFLOADING
 void tsch_queue_change_attr_of_packets_in_queue(const struct tsch_neighbor *target_nbr, 
                                            uint16_t sf_handle, uint16_t timeslot);
 #endif
 #if WITH_OST
+/* No estimate yet in the ost_tx_load of a neighbor */
+#define OST_TX_LOAD_NONE 0xffffffff
+
 struct tsch_neighbor *tsch_queue_get_nbr_from_id(const uint16_t id);
 void ost_update_N_of_packets_in_queue(const linkaddr_t *lladdr, uint16_t updated_N);
 #endif
@@ -118,6 +158,13 @@ struct tsch_packet *tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_tr
  * \return The number of packets currently in all TSCH queues
  */
 int tsch_queue_global_packet_count(void);
+#if MEMB_WITH_STATS
+/**
+ * \brief Returns the maximum number of packets that were in all TSCH queues at once
+ * \return The high-water mark of the TSCH packet pool
+ */
+int tsch_queue_global_packet_high_water(void);
+#endif /* MEMB_WITH_STATS */
 /**
  * \brief Returns the number of packets currently a given neighbor queue (by pointer)
  * \param n The neighbor we are interested in
@@ -125,7 +172,24 @@ int tsch_queue_global_packet_count(void);
  */
 int tsch_queue_nbr_packet_count(const struct tsch_neighbor *n);
 /**
- * \brief Remove first packet from a neighbor queue. The packet is stored in a separate
+ * \brief Returns the number of packets in the queue of the traffic class last
+ * returned for Tx to a given neighbor, i.e. the packets that can follow the
+ * current one in a burst or UPA batch
+ * \param n The neighbor we are interested in
+ * \return The number of packets in the class queue
+ */
+int tsch_queue_nbr_tx_class_packet_count(const struct tsch_neighbor *n);
+#if TSCH_QUEUE_WITH_CLASSES
+/**
+ * \brief Has a packet been queued past its deadline?
+ * \param p The packet
+ * \return 1 if the packet must be dropped before Tx, 0 otherwise
+ */
+int tsch_queue_packet_expired(const struct tsch_packet *p);
+#endif
+/**
+ * \brief Remove first packet from a neighbor queue (from the queue of the traffic
+ * class last returned for Tx). The packet is stored in a separate
  * dequeued packet list, for later processing.
  * \param n The neighbor queue
  * \return The packet that was removed if any, NULL otherwise
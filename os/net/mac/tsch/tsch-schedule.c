@@ -47,11 +47,13 @@
 #include "contiki.h"
 #include "dev/leds.h"
 #include "lib/memb.h"
+#include "lib/ringbufindex.h"
 #include "net/nbr-table.h"
 #include "net/packetbuf.h"
 #include "net/queuebuf.h"
 #include "net/mac/tsch/tsch.h"
 #include "net/mac/framer/frame802154.h"
+#include "sys/int-master.h"
 #include "sys/process.h"
 #include "sys/rtimer.h"
 #include <string.h>
@@ -66,6 +68,10 @@
 #include "net/routing/rpl-classic/rpl.h"
 #endif
 
+#if WITH_ALICE && ALICE_INCREMENTAL_RESCHEDULING
+#include "orchestra.h"
+#endif
+
 /* Log configuration */
 #include "sys/log.h"
 #define LOG_MODULE "TSCH Sched"
@@ -79,15 +85,94 @@ static uint64_t hck_dbg_alice_last_reschedule_asfn = 0;
 #ifdef ALICE_TIME_VARYING_SCHEDULING
 void ALICE_TIME_VARYING_SCHEDULING(); 
 #endif
+#ifdef ALICE_DEFERRED_RESCHEDULING
+void ALICE_DEFERRED_RESCHEDULING();
+#endif
 #endif
 
 /* Pre-allocated space for links */
 MEMB(link_memb, struct tsch_link, TSCH_SCHEDULE_MAX_LINKS);
+/* Handle of the next link added by tsch_schedule_add_link() or a command */
+static int current_link_handle = 0;
 /* Pre-allocated space for slotframes */
 MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_SCHEDULE_WITH_INDEX
+/* Timeslot index of the schedule: the links of each slotframe sorted by timeslot
+ * (a run per slotframe), and a min-heap of slotframes keyed by the ASN of their next link.
+ * Runs are updated as links are added and removed, never rebuilt from the slot operation. */
+static struct tsch_link *index_links[TSCH_SCHEDULE_MAX_LINKS];
+static uint16_t index_len;
+static uint16_t index_slotframe_count;
+static struct tsch_slotframe *index_heap[TSCH_SCHEDULE_MAX_SLOTFRAMES];
+static uint16_t index_heap_len;
+/* Slotframes whose next link is the earliest one, and scratch stack to find them */
+static struct tsch_slotframe *index_candidates[TSCH_SCHEDULE_MAX_SLOTFRAMES];
+static uint16_t index_stack[TSCH_SCHEDULE_MAX_SLOTFRAMES];
+/* ASN of the last lookup: the heap is valid only for later ASNs */
+static struct tsch_asn_t index_last_asn;
+static uint8_t index_heap_is_valid = 0;
+#endif
+
+#ifdef ALICE_DEFERRED_RESCHEDULING
+#if !WITH_ALICE || !defined(ALICE_TIME_VARYING_SCHEDULING) || WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+#error "ALICE_DEFERRED_RESCHEDULING requires ALICE_TIME_VARYING_SCHEDULING, without burst transmission"
+#endif
+/* ALICE: unicast slotframe of the next ASFN, built from a process and swapped
+ * with the unicast slotframe of the schedule at the ASFN boundary. It is not
+ * in the slotframe list, so the slot operation never sees it. */
+static struct tsch_slotframe alice_shadow_sf;
+static uint64_t alice_shadow_asfn;
+#define ALICE_SHADOW_STALE    0 /* To be (re)built */
+#define ALICE_SHADOW_BUILDING 1 /* Being built, possibly interrupted by the slot operation */
+#define ALICE_SHADOW_READY    2 /* Built for alice_shadow_asfn */
+static volatile uint8_t alice_shadow_state = ALICE_SHADOW_STALE;
+uint32_t alice_resched_swap_count;
+uint32_t alice_resched_sync_count;
+uint32_t alice_resched_late_count;
+#endif
+
+#if TSCH_SCHEDULE_WITH_CMD_RING
+#define CMD_ADD_LINK        0
+#define CMD_REMOVE_LINK     1
+#define CMD_MODIFY_LINK     2
+#define CMD_SWAP_SLOTFRAME  3
+#define CMD_SWAP_SLOTFRAME_ADD_LINK 4
+/* A schedule command, 'size' is the size of the slotframe for
+ * CMD_SWAP_SLOTFRAME and CMD_SWAP_SLOTFRAME_ADD_LINK */
+struct tsch_schedule_cmd {
+  uint8_t type;
+  uint8_t link_options;
+  uint8_t link_type;
+  uint16_t handle;
+  uint16_t size;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  linkaddr_t addr;
+};
+static struct ringbufindex cmd_ringbuf;
+static struct tsch_schedule_cmd cmd_array[TSCH_SCHEDULE_CMD_RING_SIZE];
+uint32_t tsch_schedule_cmd_queued_count;
+uint32_t tsch_schedule_cmd_applied_count;
+uint32_t tsch_schedule_cmd_full_count;
+uint32_t tsch_schedule_cmd_failed_count;
+#endif
+
+#if TSCH_SCHEDULE_WITH_INDEX
+/* Links of the shadow slotframe are not in the index */
+#ifdef ALICE_DEFERRED_RESCHEDULING
+#define INDEX_HAS_SLOTFRAME(sf) ((sf) != &alice_shadow_sf)
+#else
+#define INDEX_HAS_SLOTFRAME(sf) 1
+#endif
+static void tsch_schedule_index_add_slotframe(struct tsch_slotframe *sf);
+static void tsch_schedule_index_remove_slotframe(struct tsch_slotframe *sf);
+static void tsch_schedule_index_add_link(struct tsch_slotframe *sf, struct tsch_link *l);
+static void tsch_schedule_index_remove_link(struct tsch_slotframe *sf, struct tsch_link *l);
+#endif
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -110,6 +195,9 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       LIST_STRUCT_INIT(sf, links_list);
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
+#if TSCH_SCHEDULE_WITH_INDEX
+      tsch_schedule_index_add_slotframe(sf);
+#endif
     }
     LOG_INFO("add_slotframe %u %u\n",
            handle, size);
@@ -598,10 +686,23 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
     while((l = list_head(slotframe->links_list))) {
       tsch_schedule_remove_link(slotframe, l);
     }
+#ifdef ALICE_DEFERRED_RESCHEDULING
+    /* The shadow slotframe goes with the unicast slotframe */
+    if(slotframe->handle == ALICE_UNICAST_SF_HANDLE && alice_shadow_sf.links_list != NULL) {
+      while((l = list_head(alice_shadow_sf.links_list))) {
+        tsch_schedule_remove_link(&alice_shadow_sf, l);
+      }
+      alice_shadow_sf.links_list = NULL;
+      alice_shadow_state = ALICE_SHADOW_STALE;
+    }
+#endif
 
     /* Now that the slotframe has no links, remove it. */
     if(tsch_get_lock()) {
       LOG_INFO("remove slotframe %u %u\n", slotframe->handle, slotframe->size.val);
+#if TSCH_SCHEDULE_WITH_INDEX
+      tsch_schedule_index_remove_slotframe(slotframe);
+#endif
       memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
       tsch_release_lock();
@@ -724,7 +825,6 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         LOG_ERR("! add_link memb_alloc failed\n");
         tsch_release_lock();
       } else {
-        static int current_link_handle = 0;
         struct tsch_neighbor *n;
         /* Add the link to the slotframe */
         list_add(slotframe->links_list, l);
@@ -740,6 +840,9 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+#if TSCH_SCHEDULE_WITH_INDEX
+        tsch_schedule_index_add_link(slotframe, l);
+#endif
 
 #if ENABLE_LOG_TSCH_LINK_ADD_REMOVE
         LOG_INFO("add_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
@@ -837,6 +940,15 @@ alice_tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         /* Initialize link */
         l->handle = current_link_handle++;
         
+#if ALICE_INCREMENTAL_RESCHEDULING
+        /* Tx links are hashed as (us, nbr) and Rx links as (nbr, us),
+         * see get_node_timeslot() of the ALICE unicast rule */
+        l->alice_link_options = link_options;
+        l->alice_link_hash = (link_options & LINK_OPTION_TX) ?
+          (uint32_t)ORCHESTRA_LINKADDR_HASH2(&linkaddr_node_addr, nbr_addr) :
+          (uint32_t)ORCHESTRA_LINKADDR_HASH2(nbr_addr, &linkaddr_node_addr);
+#endif
+
         /* alice-implementation */
         alice_tsch_schedule_set_link_option_by_ts_choff(slotframe, timeslot, channel_offset, &link_options);
 
@@ -853,6 +965,9 @@ alice_tsch_schedule_add_link(struct tsch_slotframe *slotframe,
 #if WITH_A3
         linkaddr_copy(&l->a3_nbr_addr, nbr_addr);
 #endif
+#if TSCH_SCHEDULE_WITH_INDEX
+        tsch_schedule_index_add_link(slotframe, l);
+#endif
 
 #if ENABLE_LOG_ALICE_LINK_ADD_REMOVE
         TSCH_LOG_ADD(tsch_log_message,
@@ -923,6 +1038,9 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
       LOG_INFO_("\n");
 #endif /* ENABLE_LOG_TSCH_LINK_ADD_REMOVE */
 
+#if TSCH_SCHEDULE_WITH_INDEX
+      tsch_schedule_index_remove_link(slotframe, l);
+#endif
       list_remove(slotframe->links_list, l);
       memb_free(&link_memb, l);
 
@@ -993,6 +1111,280 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_SCHEDULE_WITH_CMD_RING
+/* Returns the slot of a new command in the ring, NULL if the ring is full */
+static struct tsch_schedule_cmd *
+cmd_ring_peek_put(uint8_t type, uint16_t handle)
+{
+  int16_t put_index = ringbufindex_peek_put(&cmd_ringbuf);
+  if(put_index == -1) {
+    tsch_schedule_cmd_full_count++;
+    return NULL;
+  }
+  cmd_array[put_index].type = type;
+  cmd_array[put_index].handle = handle;
+  return &cmd_array[put_index];
+}
+/*---------------------------------------------------------------------------*/
+/* Hands the command filled after cmd_ring_peek_put() to the slot operation */
+static int
+cmd_ring_put(void)
+{
+  ringbufindex_put(&cmd_ringbuf);
+  tsch_schedule_cmd_queued_count++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_cmd_add_link(uint16_t handle, uint8_t link_options,
+                           enum link_type link_type, const linkaddr_t *address,
+                           uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_schedule_cmd *cmd;
+  if(address == NULL) {
+    address = &linkaddr_null;
+  }
+  if(link_options & LINK_OPTION_TX) {
+    /* The slot operation only looks the neighbor up to update its Tx link
+     * counters. Takes the lock if the neighbor is new. */
+    tsch_queue_add_nbr(address);
+  }
+  cmd = cmd_ring_peek_put(CMD_ADD_LINK, handle);
+  if(cmd == NULL) {
+    return 0;
+  }
+  cmd->link_options = link_options;
+  cmd->link_type = link_type;
+  cmd->timeslot = timeslot;
+  cmd->channel_offset = channel_offset;
+  linkaddr_copy(&cmd->addr, address);
+  return cmd_ring_put();
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_cmd_remove_link(uint16_t handle, uint16_t timeslot,
+                              uint16_t channel_offset)
+{
+  struct tsch_schedule_cmd *cmd = cmd_ring_peek_put(CMD_REMOVE_LINK, handle);
+  if(cmd == NULL) {
+    return 0;
+  }
+  cmd->timeslot = timeslot;
+  cmd->channel_offset = channel_offset;
+  return cmd_ring_put();
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_cmd_modify_link(uint16_t handle, uint8_t link_options,
+                              enum link_type link_type, const linkaddr_t *address,
+                              uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_schedule_cmd *cmd;
+  if(address == NULL) {
+    address = &linkaddr_null;
+  }
+  if(link_options & LINK_OPTION_TX) {
+    tsch_queue_add_nbr(address);
+  }
+  cmd = cmd_ring_peek_put(CMD_MODIFY_LINK, handle);
+  if(cmd == NULL) {
+    return 0;
+  }
+  cmd->link_options = link_options;
+  cmd->link_type = link_type;
+  cmd->timeslot = timeslot;
+  cmd->channel_offset = channel_offset;
+  linkaddr_copy(&cmd->addr, address);
+  return cmd_ring_put();
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_cmd_swap_slotframe(uint16_t handle, uint16_t size)
+{
+  struct tsch_schedule_cmd *cmd = cmd_ring_peek_put(CMD_SWAP_SLOTFRAME, handle);
+  if(cmd == NULL) {
+    return 0;
+  }
+  cmd->size = size;
+  return cmd_ring_put();
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_cmd_swap_slotframe_add_link(uint16_t handle, uint16_t size,
+                                          uint8_t link_options, enum link_type link_type,
+                                          const linkaddr_t *address,
+                                          uint16_t timeslot, uint16_t channel_offset)
+{
+  struct tsch_schedule_cmd *cmd;
+  if(address == NULL) {
+    address = &linkaddr_null;
+  }
+  if(link_options & LINK_OPTION_TX) {
+    tsch_queue_add_nbr(address);
+  }
+  cmd = cmd_ring_peek_put(CMD_SWAP_SLOTFRAME_ADD_LINK, handle);
+  if(cmd == NULL) {
+    return 0;
+  }
+  cmd->size = size;
+  cmd->link_options = link_options;
+  cmd->link_type = link_type;
+  cmd->timeslot = timeslot;
+  cmd->channel_offset = channel_offset;
+  linkaddr_copy(&cmd->addr, address);
+  return cmd_ring_put();
+}
+/*---------------------------------------------------------------------------*/
+/* Updates the Tx link counters of the neighbor of a link. The neighbor was
+ * added when the command was queued. */
+static void
+cmd_update_nbr(const struct tsch_link *l, int delta)
+{
+  if(l->link_options & LINK_OPTION_TX) {
+    struct tsch_neighbor *n = tsch_queue_get_nbr(&l->addr);
+    if(n != NULL) {
+      n->tx_links_count += delta;
+      if(!(l->link_options & LINK_OPTION_SHARED)) {
+        n->dedicated_tx_links_count += delta;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Removes the links at a timeslot and channel offset (all of them if
+ * timeslot is 0xffff), returns the number of links removed */
+static int
+cmd_remove_links(struct tsch_slotframe *slotframe,
+                 uint16_t timeslot, uint16_t channel_offset)
+{
+  int count = 0;
+  struct tsch_link *l = list_head(slotframe->links_list);
+  while(l != NULL) {
+    struct tsch_link *next = list_item_next(l);
+    if(timeslot == 0xffff
+       || (l->timeslot == timeslot && l->channel_offset == channel_offset)) {
+      if(l == current_link) {
+        current_link = NULL;
+      }
+      cmd_update_nbr(l, -1);
+#if TSCH_SCHEDULE_WITH_INDEX
+      tsch_schedule_index_remove_link(slotframe, l);
+#endif
+      list_remove(slotframe->links_list, l);
+      memb_free(&link_memb, l);
+      count++;
+    }
+    l = next;
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Applies a command to the schedule. Called by the slot operation, hence
+ * without the lock and without adding neighbors. Returns 1 if success */
+static int
+cmd_apply(const struct tsch_schedule_cmd *cmd)
+{
+  struct tsch_slotframe *sf = tsch_schedule_get_slotframe_by_handle(cmd->handle);
+  struct tsch_link *l;
+
+  if(cmd->type == CMD_SWAP_SLOTFRAME || cmd->type == CMD_SWAP_SLOTFRAME_ADD_LINK) {
+    if(sf != NULL) {
+      cmd_remove_links(sf, 0xffff, 0);
+      if(cmd->size == 0) {
+#if TSCH_SCHEDULE_WITH_INDEX
+        tsch_schedule_index_remove_slotframe(sf);
+#endif
+        list_remove(slotframe_list, sf);
+        memb_free(&slotframe_memb, sf);
+        sf = NULL;
+      }
+    } else if(cmd->size != 0) {
+      sf = memb_alloc(&slotframe_memb);
+      if(sf == NULL) {
+        return 0;
+      }
+      sf->handle = cmd->handle;
+      LIST_STRUCT_INIT(sf, links_list);
+      list_add(slotframe_list, sf);
+#if TSCH_SCHEDULE_WITH_INDEX
+      tsch_schedule_index_add_slotframe(sf);
+#endif
+    }
+    if(sf != NULL) {
+      TSCH_ASN_DIVISOR_INIT(sf->size, cmd->size);
+    }
+#if TSCH_SCHEDULE_WITH_INDEX
+    /* The slotframe size changed: next ASNs in the heap are outdated */
+    index_heap_is_valid = 0;
+#endif
+    if(cmd->type == CMD_SWAP_SLOTFRAME) {
+      return 1;
+    }
+  }
+
+  if(sf == NULL || cmd->timeslot >= sf->size.val) {
+    return 0;
+  }
+
+  switch(cmd->type) {
+  case CMD_ADD_LINK:
+  case CMD_SWAP_SLOTFRAME_ADD_LINK:
+    /* One link per timeslot and channel offset, as tsch_schedule_add_link() */
+    cmd_remove_links(sf, cmd->timeslot, cmd->channel_offset);
+    l = memb_alloc(&link_memb);
+    if(l == NULL) {
+      return 0;
+    }
+    l->handle = current_link_handle++;
+    l->link_options = cmd->link_options;
+    l->link_type = cmd->link_type;
+    l->slotframe_handle = sf->handle;
+    l->timeslot = cmd->timeslot;
+    l->channel_offset = cmd->channel_offset;
+    l->data = NULL;
+    linkaddr_copy(&l->addr, &cmd->addr);
+    list_add(sf->links_list, l);
+#if TSCH_SCHEDULE_WITH_INDEX
+    tsch_schedule_index_add_link(sf, l);
+#endif
+    cmd_update_nbr(l, 1);
+    return 1;
+  case CMD_REMOVE_LINK:
+    /* Queued without knowing if the link is there: nothing to remove is fine */
+    cmd_remove_links(sf, cmd->timeslot, cmd->channel_offset);
+    return 1;
+  case CMD_MODIFY_LINK:
+    l = tsch_schedule_get_link_by_timeslot(sf, cmd->timeslot, cmd->channel_offset);
+    if(l == NULL) {
+      return 0;
+    }
+    cmd_update_nbr(l, -1);
+    l->link_options = cmd->link_options;
+    l->link_type = cmd->link_type;
+    linkaddr_copy(&l->addr, &cmd->addr);
+    cmd_update_nbr(l, 1);
+    return 1;
+  default:
+    return 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Applies the pending commands, in order */
+static void
+cmd_ring_apply(void)
+{
+  int16_t get_index;
+  while((get_index = ringbufindex_peek_get(&cmd_ringbuf)) != -1) {
+    if(cmd_apply(&cmd_array[get_index])) {
+      tsch_schedule_cmd_applied_count++;
+    } else {
+      tsch_schedule_cmd_failed_count++;
+    }
+    ringbufindex_get(&cmd_ringbuf);
+  }
+}
+#endif /* TSCH_SCHEDULE_WITH_CMD_RING */
+/*---------------------------------------------------------------------------*/
 static struct tsch_link *
 default_tsch_link_comparator(struct tsch_link *a, struct tsch_link *b)
 {
@@ -1005,8 +1397,8 @@ default_tsch_link_comparator(struct tsch_link *a, struct tsch_link *b)
   if(!linkaddr_cmp(&a->addr, &b->addr)) {
     struct tsch_neighbor *an = tsch_queue_get_nbr(&a->addr);
     struct tsch_neighbor *bn = tsch_queue_get_nbr(&b->addr);
-    int a_packet_count = an ? ringbufindex_elements(&an->tx_ringbuf) : 0;
-    int b_packet_count = bn ? ringbufindex_elements(&bn->tx_ringbuf) : 0;
+    int a_packet_count = an ? tsch_queue_nbr_packet_count(an) : 0;
+    int b_packet_count = bn ? tsch_queue_nbr_packet_count(bn) : 0;
     /* Compare the number of packets in the queue */
     return a_packet_count >= b_packet_count ? a : b;
   }
@@ -1016,522 +1408,870 @@ default_tsch_link_comparator(struct tsch_link *a, struct tsch_link *b)
 }
 
 /*---------------------------------------------------------------------------*/
-/* Returns the next active link after a given ASN, and a backup link (for the same ASN, with Rx flag) */
-struct tsch_link *
-tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
-    struct tsch_link **backup_link)
+#if TSCH_SCHEDULE_WITH_INDEX
+static void
+tsch_schedule_index_add_slotframe(struct tsch_slotframe *sf)
 {
-#if WITH_ALICE
-  /*
-   * ALICE: First, derive 'alice_current_asfn', which is the ASFN at the start of the ongoing slot operation
-   * from 'alice_current_asn', which is the ASN at the start of the ongoing slot operation.
-   */
-  uint64_t alice_current_asfn = 0;
-  struct tsch_slotframe *alice_uc_sf = tsch_schedule_get_slotframe_by_handle(ALICE_UNICAST_SF_HANDLE);
-  struct tsch_asn_t temp_asn;
-  TSCH_ASN_COPY(temp_asn, alice_current_asn);
-  uint16_t mod1 = TSCH_ASN_MOD(temp_asn, alice_uc_sf->size);
-  TSCH_ASN_DEC(temp_asn, mod1);
-  alice_current_asfn = TSCH_ASN_DIVISION(temp_asn, alice_uc_sf->size);
-#endif
-
-  uint16_t time_to_curr_best = 0;
-  struct tsch_link *curr_best = NULL;
-  struct tsch_link *curr_backup = NULL; /* Keep a back link in case the current link
-  turns out useless when the time comes. For instance, for a Tx-only link, if there is
-  no outgoing packet in queue. In that case, run the backup link instead. The backup link
-  must have Rx flag set. */
-  if(!tsch_is_locked()) {
-    struct tsch_slotframe *sf = list_head(slotframe_list);
-    /* For each slotframe, look for the earliest occurring link */
-    while(sf != NULL) {
-
-#if WITH_ALICE /* alice implementation */
-#ifdef ALICE_TIME_VARYING_SCHEDULING
-      if(sf->handle == ALICE_UNICAST_SF_HANDLE) {
-        /*
-         * Second, check whether any remaining unicast slotframe link exists after 'alice_current_asn'
-         * within the slotframe of 'alice_current_asfn'.
-         */
-        int alice_remaining_uicast_sf_link_exists = 0;
-
-        uint16_t timeslot = TSCH_ASN_MOD(alice_current_asn, sf->size);
-        struct tsch_link *l = list_head(sf->links_list);
-        while(l != NULL) {
-          /* Check if any link exists after this timeslot in the current unicast slotframe */
-          if(l->timeslot > timeslot) {
-            /* In the current unicast slotframe schedule, the current timeslot is not a last one. */
-            alice_remaining_uicast_sf_link_exists = 1;
-            break;
-          }
-          l = list_item_next(l);
-        }
+  /* Appended to the slotframe list, with an empty run */
+  sf->index_first = index_len;
+  sf->index_count = 0;
+  sf->index_order = index_slotframe_count++;
+}
+/*---------------------------------------------------------------------------*/
+/* To be called before removing a slotframe without links from the slotframe list */
+static void
+tsch_schedule_index_remove_slotframe(struct tsch_slotframe *sf)
+{
+  struct tsch_slotframe *s;
 
-        int alice_remaining_uicast_sf_link_exists_at_tsch_current_asn = 0;
+  for(s = list_item_next(sf); s != NULL; s = list_item_next(s)) {
+    s->index_order--;
+  }
+  index_slotframe_count--;
+  index_heap_is_valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Moves the runs after the first index_count links of a slotframe by 'delta'
+ * positions, to grow or shrink its run. The slot operation may run while a
+ * process updates the index: index_count is increased once the new links are
+ * in the run, and decreased before the removed links are overwritten. */
+static void
+tsch_schedule_index_resize_run(struct tsch_slotframe *sf, int16_t delta)
+{
+  uint16_t end;
+  struct tsch_slotframe *s;
 
-        timeslot = TSCH_ASN_MOD(*asn, sf->size);
-        l = list_head(sf->links_list);
-        while(l != NULL) {
-          /* Check if any link exists after this timeslot in the current unicast slotframe */
-          if(l->timeslot > timeslot) {
-            /* In the current unicast slotframe schedule, the current timeslot is not a last one. */
-            alice_remaining_uicast_sf_link_exists_at_tsch_current_asn = 1;
-            break;
-          }
-          l = list_item_next(l);
-        }
+  if(sf->index_count == 0 && delta > 0) {
+    /* An empty run may lie within another run: start it at the end of the index */
+    sf->index_first = index_len;
+  }
+  end = sf->index_first + sf->index_count;
+  if(delta > 0) {
+    memmove(&index_links[end + delta], &index_links[end],
+            (index_len - end) * sizeof(index_links[0]));
+  } else {
+    memmove(&index_links[end], &index_links[end - delta],
+            (index_len - end + delta) * sizeof(index_links[0]));
+  }
+  for(s = list_head(slotframe_list); s != NULL; s = list_item_next(s)) {
+    if(s != sf && s->index_count > 0 && s->index_first >= end) {
+      s->index_first += delta;
+    }
+  }
+  index_len += delta;
+  index_heap_is_valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Inserts a link in the run of its slotframe, after the links of the same timeslot */
+static void
+tsch_schedule_index_add_link(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  uint16_t low;
+  uint16_t high;
 
-        uint64_t alice_current_asfn_at_tsch_current_asn = 0;
-        struct tsch_asn_t temp_asn_at_tsch_current_asn;
-        TSCH_ASN_COPY(temp_asn_at_tsch_current_asn, *asn);
-        uint16_t mod1_at_tsch_current_asn = TSCH_ASN_MOD(temp_asn_at_tsch_current_asn, sf->size);
-        TSCH_ASN_DEC(temp_asn_at_tsch_current_asn, mod1_at_tsch_current_asn);
-        alice_current_asfn_at_tsch_current_asn = TSCH_ASN_DIVISION(temp_asn_at_tsch_current_asn, sf->size);
+  if(!INDEX_HAS_SLOTFRAME(sf) || index_len >= TSCH_SCHEDULE_MAX_LINKS) {
+    return;
+  }
+  tsch_schedule_index_resize_run(sf, 1);
+  low = sf->index_first;
+  high = sf->index_first + sf->index_count;
+  while(low < high) {
+    uint16_t mid = (low + high) / 2;
+    if(index_links[mid]->timeslot > l->timeslot) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  memmove(&index_links[low + 1], &index_links[low],
+          (sf->index_first + sf->index_count - low) * sizeof(index_links[0]));
+  index_links[low] = l;
+  sf->index_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tsch_schedule_index_remove_link(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  uint16_t low;
+  uint16_t high;
+  uint16_t end;
 
-        /*
-         * Third, if 'alice_remaining_uicast_sf_link_exists' is zero,
-         * there is no more unicast slotframe link within the current ASFN (alice_current_asfn).
-         * Then, re-schedule unicast slotframe for the next ASFN,
-         * only when lastly scheduled ASFN (alice_lastly_scheduled_asfn) is different from
-         * the next ASFN (alice_next_asfn).
-         */
-        if(alice_remaining_uicast_sf_link_exists == 0 
-          || alice_remaining_uicast_sf_link_exists_at_tsch_current_asn == 0
-          || alice_current_asfn_at_tsch_current_asn != alice_current_asfn) {
-          uint64_t alice_next_asfn = 0;
-          struct tsch_asn_t asn_of_next_asfn;
-          TSCH_ASN_COPY(asn_of_next_asfn, alice_current_asn);
-          TSCH_ASN_INC(asn_of_next_asfn, sf->size.val);
-          uint16_t mod2 = TSCH_ASN_MOD(asn_of_next_asfn, sf->size);
-          TSCH_ASN_DEC(asn_of_next_asfn, mod2);
-          alice_next_asfn = TSCH_ASN_DIVISION(asn_of_next_asfn, sf->size);
+  if(!INDEX_HAS_SLOTFRAME(sf)) {
+    return;
+  }
+  end = sf->index_first + sf->index_count;
+  /* First link of the run at the timeslot of the link */
+  low = sf->index_first;
+  high = end;
+  while(low < high) {
+    uint16_t mid = (low + high) / 2;
+    if(index_links[mid]->timeslot < l->timeslot) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  while(low < end && index_links[low] != l) {
+    low++;
+  }
+  if(low == end) {
+    return;
+  }
+  memmove(&index_links[low], &index_links[low + 1],
+          (end - 1 - low) * sizeof(index_links[0]));
+  sf->index_count--;
+  tsch_schedule_index_resize_run(sf, -1);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_index_sort_slotframe(struct tsch_slotframe *sf)
+{
+  uint16_t n;
+  struct tsch_link *l;
 
+  if(!INDEX_HAS_SLOTFRAME(sf)) {
+    return;
+  }
+  /* Insertion sort of the run, in list order for the links of a same timeslot */
+  n = sf->index_first;
+  for(l = list_head(sf->links_list);
+      l != NULL && n < sf->index_first + sf->index_count;
+      l = list_item_next(l)) {
+    uint16_t i = n++;
+    while(i > sf->index_first && index_links[i - 1]->timeslot > l->timeslot) {
+      index_links[i] = index_links[i - 1];
+      i--;
+    }
+    index_links[i] = l;
+  }
+  index_heap_is_valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Slotframes whose links are not kept in the heap, as their next link depends on the ASFN */
+static int
+tsch_schedule_index_is_excluded(const struct tsch_slotframe *sf)
+{
+#if WITH_ALICE && defined(ALICE_TIME_VARYING_SCHEDULING)
+  if(sf->handle == ALICE_UNICAST_SF_HANDLE) {
+    return 1;
+  }
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
-          uint64_t alice_after_next_asfn = 0;
-          struct tsch_asn_t asn_of_after_next_asfn;
-          TSCH_ASN_COPY(asn_of_after_next_asfn, alice_current_asn);
-          TSCH_ASN_INC(asn_of_after_next_asfn, sf->size.val);
-          TSCH_ASN_INC(asn_of_after_next_asfn, sf->size.val);
-          uint16_t mod3 = TSCH_ASN_MOD(asn_of_after_next_asfn, sf->size);
-          TSCH_ASN_DEC(asn_of_after_next_asfn, mod3);
-          alice_after_next_asfn = TSCH_ASN_DIVISION(asn_of_after_next_asfn, sf->size);
-#endif
-
-          if(alice_next_asfn != alice_lastly_scheduled_asfn) {
-            alice_lastly_scheduled_asfn = alice_next_asfn;
-#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
-            alice_next_asfn_of_lastly_scheduled_asfn = alice_after_next_asfn;
+  if(sf->handle == ALICE_AFTER_LASTLY_SCHEDULED_ASFN_SF_HANDLE) {
+    return 1;
+  }
 #endif
+#endif
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the position of the first link of a (non-empty) slotframe after a timeslot,
+ * wrapping around to the start of the slotframe, and the time to this link */
+static uint16_t
+tsch_schedule_index_next(const struct tsch_slotframe *sf, uint16_t timeslot,
+    uint16_t *time_to_timeslot)
+{
+  uint16_t low = sf->index_first;
+  uint16_t high = sf->index_first + sf->index_count;
 
-#if WITH_A3
-            double alpha = 0.02 + ((double)ORCHESTRA_CONF_UNICAST_PERIOD * (double)0.001);
-            if(alpha > 0.15) {
-              alpha = 0.15;
-            }
-            double alphaPlus = alpha * 0.2;
-            double dynamicAlpha = 0;
-
-            static double txIncreaseThresh = A3_TX_INCREASE_THRESH;
-            static double txDecreaseThresh = A3_TX_DECREASE_THRESH;
-            static double rxIncreaseThresh = A3_RX_INCREASE_THRESH;
-            static double rxDecreaseThresh = A3_RX_DECREASE_THRESH;
-
-            static double maxErr = A3_MAX_ERR_PROB;
-
-            uint8_t sumTx = 0;
-            uint8_t sumRx = 0;
-            uint8_t diffRx = 0;
-            double newVal = 0;
+  while(low < high) {
+    uint16_t mid = (low + high) / 2;
+    if(index_links[mid]->timeslot > timeslot) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
 
-            /* Calculate EWMA of 'Tx attempt rate' toward parent */
-            sumTx = a3_p_num_tx_pkt_success + a3_p_num_tx_pkt_collision;
+  if(low == sf->index_first + sf->index_count) {
+    low = sf->index_first;
+    *time_to_timeslot = sf->size.val + index_links[low]->timeslot - timeslot;
+  } else {
+    *time_to_timeslot = index_links[low]->timeslot - timeslot;
+  }
+  return low;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tsch_schedule_index_update_next_asn(struct tsch_slotframe *sf, struct tsch_asn_t *asn)
+{
+  uint16_t time_to_timeslot;
+  tsch_schedule_index_next(sf, TSCH_ASN_MOD(*asn, sf->size), &time_to_timeslot);
+  TSCH_ASN_COPY(sf->index_next_asn, *asn);
+  TSCH_ASN_INC(sf->index_next_asn, time_to_timeslot);
+}
+/*---------------------------------------------------------------------------*/
+/* Next ASNs in the heap are all within one slotframe from the last lookup */
+#define INDEX_HEAP_LESS(a, b) \
+  ((int32_t)TSCH_ASN_DIFF((a)->index_next_asn, (b)->index_next_asn) < 0)
 
-            newVal = (double)(sumTx) / (double)(a3_p_num_tx_slot);
-            if(newVal > 1) {
-              newVal = 1;
-            }
-            a3_p_tx_attempt_rate_ewma = (1 - alpha) * a3_p_tx_attempt_rate_ewma + alpha * newVal;
+static void
+tsch_schedule_index_heap_sift_down(uint16_t i)
+{
+  struct tsch_slotframe *sf = index_heap[i];
 
-#if A3_DBG_VALUE
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_a %u | %u %u %u", 
-                        HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                        a3_p_num_tx_pkt_success, a3_p_num_tx_pkt_collision, a3_p_num_tx_slot);
-            );
-
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_a alpha %.3f", alpha);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_a newVal %.3f", newVal);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_a ewma %.3f", a3_p_tx_attempt_rate_ewma);
-            );
-#endif
-
-            /* Calculate EWMA of 'Tx success rate' toward parent */
-            newVal = (double)(a3_p_num_tx_pkt_success) / (double)(a3_p_num_tx_slot);
-            if(newVal > 1) {
-              newVal = 1;
-            }
-            a3_p_tx_success_rate_ewma = (1 - alpha) * a3_p_tx_success_rate_ewma + alpha * newVal;
+  while(2 * i + 1 < index_heap_len) {
+    uint16_t child = 2 * i + 1;
+    if(child + 1 < index_heap_len && INDEX_HEAP_LESS(index_heap[child + 1], index_heap[child])) {
+      child++;
+    }
+    if(!INDEX_HEAP_LESS(index_heap[child], sf)) {
+      break;
+    }
+    index_heap[i] = index_heap[child];
+    i = child;
+  }
+  index_heap[i] = sf;
+}
+/*---------------------------------------------------------------------------*/
+static void
+tsch_schedule_index_build_heap(struct tsch_asn_t *asn)
+{
+  uint16_t i;
+  struct tsch_slotframe *sf = list_head(slotframe_list);
 
-#if A3_DBG_VALUE
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_s newVal %.3f", newVal);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_t_s ewma %.3f", a3_p_tx_success_rate_ewma);
-            );
-#endif
-
-            /* Calculate EWMA of 'Rx attempt rate' from parent */
-            sumRx = a3_p_num_rx_pkt_success 
-                  + a3_p_num_rx_pkt_collision 
-                  + a3_p_num_rx_pkt_idle 
-                  + a3_p_num_rx_pkt_others;
-            diffRx = (a3_p_num_rx_slot - sumRx); //difference
-            if(a3_p_num_rx_slot < sumRx) { //minus value
-              diffRx = 0;
-            }
-            a3_p_num_rx_pkt_unscheduled = diffRx;
-            sumRx += diffRx;
-
-            newVal = ((double)a3_p_num_rx_pkt_success 
-                      + a3_p_rx_attempt_rate_ewma * (double)(a3_p_num_rx_pkt_collision + a3_p_num_rx_pkt_unscheduled)) 
-                        / (double)(sumRx);
-            if(newVal > 1) {
-              newVal = 1;
-            }
+  index_heap_len = 0;
+  while(sf != NULL) {
+    if(sf->index_count > 0 && !tsch_schedule_index_is_excluded(sf)) {
+      tsch_schedule_index_update_next_asn(sf, asn);
+      index_heap[index_heap_len++] = sf;
+    }
+    sf = list_item_next(sf);
+  }
+  for(i = index_heap_len / 2; i > 0; i--) {
+    tsch_schedule_index_heap_sift_down(i - 1);
+  }
 
-            dynamicAlpha = alpha;
-            if(newVal > a3_p_rx_attempt_rate_ewma) {
-              dynamicAlpha += alphaPlus;
-            }
-            a3_p_rx_attempt_rate_ewma = (1 - dynamicAlpha) * a3_p_rx_attempt_rate_ewma + dynamicAlpha * newVal;
+  index_heap_is_valid = 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Moves the slotframes whose next link is not after the given ASN to their following link */
+static void
+tsch_schedule_index_advance(struct tsch_asn_t *asn)
+{
+  if(!index_heap_is_valid || (int32_t)TSCH_ASN_DIFF(*asn, index_last_asn) < 0) {
+    tsch_schedule_index_build_heap(asn);
+  } else {
+    while(index_heap_len > 0
+          && (int32_t)TSCH_ASN_DIFF(index_heap[0]->index_next_asn, *asn) <= 0) {
+      tsch_schedule_index_update_next_asn(index_heap[0], asn);
+      tsch_schedule_index_heap_sift_down(0);
+    }
+  }
+  TSCH_ASN_COPY(index_last_asn, *asn);
+}
+/*---------------------------------------------------------------------------*/
+/* Collects the slotframes at the top of the heap having the same next ASN
+ * as the root, and returns their number */
+static uint16_t
+tsch_schedule_index_get_earliest(void)
+{
+  uint16_t num_candidates = 0;
+  uint16_t stack_len = 0;
 
-#if A3_DBG_VALUE
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_r_a %u | %u %u %u %u %u | %u", 
-                        HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                        a3_p_num_rx_pkt_success, a3_p_num_rx_pkt_collision, 
-                        a3_p_num_rx_pkt_idle, a3_p_num_rx_pkt_others, 
-                        a3_p_num_rx_pkt_unscheduled, sumRx);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_r_a dalpha %.3f", dynamicAlpha);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_r_a newVal %.3f", newVal);
-            );
-            TSCH_LOG_ADD(tsch_log_message,
-                    snprintf(log->message, sizeof(log->message),
-                        "A3-v p_r_a ewma %.3f", a3_p_rx_attempt_rate_ewma);
-            );
-#endif
-
-            int txChangedFlag = 0;
-
-#if A3_ALICE1_ORB2_OSB3 != 2 //O-SB, ALICE
-            if((a3_p_tx_attempt_rate_ewma - a3_p_tx_success_rate_ewma) / (a3_p_tx_attempt_rate_ewma) > maxErr 
-                && a3_p_num_tx_slot > 1) {
-#if A3_DBG
-              TSCH_LOG_ADD(tsch_log_message,
-                      snprintf(log->message, sizeof(log->message),
-                          "A3-a p_t_half_c %u | %u", 
-                          HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                          a3_p_num_tx_slot);
-              );
-#endif
-              a3_p_num_tx_slot /= 2;
-              txChangedFlag = 1;
-
-              a3_p_tx_attempt_rate_ewma = A3_INITIAL_TX_ATTEMPT_RATE_EWMA;
-              a3_p_tx_success_rate_ewma = A3_INITIAL_TX_SUCCESS_RATE_EWMA;
-            }
+  if(index_heap_len > 0) {
+    index_stack[stack_len++] = 0;
+  }
+  while(stack_len > 0) {
+    uint16_t i = index_stack[--stack_len];
+    if(TSCH_ASN_DIFF(index_heap[i]->index_next_asn, index_heap[0]->index_next_asn) == 0) {
+      index_candidates[num_candidates++] = index_heap[i];
+      if(2 * i + 1 < index_heap_len) {
+        index_stack[stack_len++] = 2 * i + 1;
+      }
+      if(2 * i + 2 < index_heap_len) {
+        index_stack[stack_len++] = 2 * i + 2;
+      }
+    }
+  }
+  return num_candidates;
+}
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
+/*---------------------------------------------------------------------------*/
+/* Compares a link occurring in 'time_to_timeslot' slots against the current best
+ * and backup links, and updates them */
+static void
+tsch_schedule_select_link(struct tsch_link *l, uint16_t time_to_timeslot,
+    struct tsch_link **best, struct tsch_link **backup, uint16_t *time_to_best)
+{
+  uint16_t time_to_curr_best = *time_to_best;
+  struct tsch_link *curr_best = *best;
+  struct tsch_link *curr_backup = *backup;
+
+  if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
+    time_to_curr_best = time_to_timeslot;
+    curr_best = l;
+    curr_backup = NULL;
+  } else if(time_to_timeslot == time_to_curr_best) {
+    struct tsch_link *new_best = NULL;
+    /* Two links are overlapping, we need to select one of them.
+     * By standard: prioritize Tx links first, second by lowest handle */
+    if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+      /* Both or neither links have Tx, select the one with lowest handle */
+      if(l->slotframe_handle != curr_best->slotframe_handle) {
+        if(l->slotframe_handle < curr_best->slotframe_handle) {
+          new_best = l;
+        }
+      } else {
+        /* compare the link against the current best link and return the newly selected one */
+        new_best = TSCH_LINK_COMPARATOR(curr_best, l);
+      }
+
+#if WITH_OST
+      if((curr_best->slotframe_handle == 1) 
+        && (curr_best->link_options & LINK_OPTION_TX) 
+        && (l->slotframe_handle == 2)) {
+        /*
+        Prevent Autonomous unicast Tx from interfering autonomous broadcast Tx/Rx
+        They share the same c_offset in OST
+        Prioritize Autonomous broadcast Tx/Rx to Autonomous unicast Tx
+        */
+        new_best = l;
+      }
 #endif
 
-            if(txChangedFlag == 0) {
-              if(a3_p_tx_attempt_rate_ewma > txIncreaseThresh && a3_p_num_tx_slot < A3_MAX_ZONE) {
-#if A3_DBG
-                TSCH_LOG_ADD(tsch_log_message,
-                        snprintf(log->message, sizeof(log->message),
-                            "A3-a p_t_double %u | %u", 
-                            HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                            a3_p_num_tx_slot);
-                );
-#endif
-                a3_p_num_tx_slot *= 2;
-                a3_p_tx_attempt_rate_ewma /= 2;
-              } else if(a3_p_tx_attempt_rate_ewma < txDecreaseThresh && a3_p_num_tx_slot > 1) {
-#if A3_DBG
-                TSCH_LOG_ADD(tsch_log_message,
-                        snprintf(log->message, sizeof(log->message),
-                            "A3-a p_t_half %u | %u", 
-                            HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                            a3_p_num_tx_slot);
-                );
-#endif
-                a3_p_num_tx_slot /= 2;
-                a3_p_tx_attempt_rate_ewma *= 2;
-              }
-            }
+    } else {
+      /* Select the link that has the Tx option */
+      if(l->link_options & LINK_OPTION_TX) {
+        new_best = l;
+      }
+    }
 
-            if(a3_p_rx_attempt_rate_ewma > rxIncreaseThresh && a3_p_num_rx_slot < A3_MAX_ZONE) {
-#if A3_DBG
-              TSCH_LOG_ADD(tsch_log_message,
-                      snprintf(log->message, sizeof(log->message),
-                          "A3-a p_r_double %u | %u", 
-                          HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                          a3_p_num_rx_slot);
-              );
-#endif
-              a3_p_num_rx_slot *= 2;
-              a3_p_rx_attempt_rate_ewma /= 2;
-            } else if(a3_p_rx_attempt_rate_ewma < rxDecreaseThresh && a3_p_num_rx_slot > 1) {
-#if A3_DBG
-              TSCH_LOG_ADD(tsch_log_message,
-                      snprintf(log->message, sizeof(log->message),
-                          "A3-a p_r_half %u | %u", 
-                          HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(tsch_queue_get_time_source())),
-                          a3_p_num_rx_slot);
-              );
-#endif
-              a3_p_num_rx_slot /= 2;
-              a3_p_rx_attempt_rate_ewma *= 2;
-            }
+#if HCK_APPLY_LATEST_CONTIKI
+    /* Maintain backup_link */
+    /* Check if 'l' best can be used as backup */
+    if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
+      if(curr_backup == NULL || l->slotframe_handle < curr_backup->slotframe_handle) {
+        curr_backup = l;
+      }
+    }
+    /* Check if curr_best can be used as backup */
+    if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
+      if(curr_backup == NULL || curr_best->slotframe_handle < curr_backup->slotframe_handle) {
+        curr_backup = curr_best;
+      }
+    }
+#else
+    /* Maintain backup_link */
+    if(curr_backup == NULL) {
+      /* Check if 'l' best can be used as backup */
+      if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
+        curr_backup = l;
+      }
+      /* Check if curr_best can be used as backup */
+      if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
+        curr_backup = curr_best;
+      }
+    }
+#endif
 
-            a3_p_num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-            a3_p_num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-
-            a3_p_num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-            a3_p_num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-            a3_p_num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
-            a3_p_num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
-            a3_p_num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
-
-            /* Consider child nodes */
-            nbr_table_item_t *item = nbr_table_head(nbr_routes);
-            while(item != NULL) {
-              linkaddr_t *addr = nbr_table_get_lladdr(nbr_routes, item);
-              if(addr != NULL) {
-                uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)addr);
-                if(it != NULL) {
-                  sumTx = it->a3_c_num_tx_pkt_success + it->a3_c_num_tx_pkt_collision;
-
-                  newVal = (double)(sumTx) / (double)(it->a3_c_num_tx_slot);
-                  if(newVal > 1) {
-                    newVal = 1;
-                  }
-                  it->a3_c_tx_attempt_rate_ewma = (1 - alpha) * it->a3_c_tx_attempt_rate_ewma + alpha * newVal;
+    /* Maintain curr_best */
+    if(new_best != NULL) {
+      curr_best = new_best;
+    }
+  }
 
-#if A3_DBG_VALUE
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_a %u | %u %u %u", 
-                              HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                              it->a3_c_num_tx_pkt_success, it->a3_c_num_tx_pkt_collision, it->a3_c_num_tx_slot);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_a alpha %.3f", alpha);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_a newVal %.3f", newVal);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_a ewma %.3f", it->a3_c_tx_attempt_rate_ewma);
-                  );
-#endif
-
-                  newVal = (double)(it->a3_c_num_tx_pkt_success) / (double)(it->a3_c_num_tx_slot);
-                  if(newVal > 1) {
-                    newVal = 1;
-                  }
-                  it->a3_c_tx_success_rate_ewma = (1 - alpha) * it->a3_c_tx_success_rate_ewma + alpha * newVal;
+  *time_to_best = time_to_curr_best;
+  *best = curr_best;
+  *backup = curr_backup;
+}
+/*---------------------------------------------------------------------------*/
+#if WITH_A3
+/* A3: update the cells with the parent ('p') or a child ('c') at the end of
+   an ASFN, and log the values and the actions */
+static void
+a3_update_and_log(char who, const linkaddr_t *addr, struct tsch_a3_state *s)
+{
+#if A3_DBG || A3_DBG_VALUE
+  struct tsch_a3_state before;
+  /* No time source at the root */
+  uint16_t id = addr != NULL ? HCK_GET_NODE_ID_FROM_LINKADDR(addr) : 0;
+#endif
+  struct tsch_a3_update_info info;
+  uint8_t actions;
+#ifdef ALICE_DEFERRED_RESCHEDULING
+  /* Called from the rescheduling process: the slot operation must not
+     update the results of the cells meanwhile */
+  int_master_status_t status = int_master_read_and_disable();
+#endif
 
-#if A3_DBG_VALUE
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_s newVal %.3f", newVal);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_t_s ewma %.3f", it->a3_c_tx_success_rate_ewma);
-                  );
-#endif
-
-                  sumRx = it->a3_c_num_rx_pkt_success 
-                        + it->a3_c_num_rx_pkt_collision  
-                        + it->a3_c_num_rx_pkt_idle 
-                        + it->a3_c_num_rx_pkt_others;
-                  diffRx = (it->a3_c_num_rx_slot - sumRx); // differance
-                  if(it->a3_c_num_rx_slot < sumRx) {
-                    diffRx = 0;
-                  }
-                  it->a3_c_num_rx_pkt_unscheduled = diffRx;
-                  sumRx += diffRx;
-
-                  newVal = ((double)it->a3_c_num_rx_pkt_success 
-                            + it->a3_c_rx_attempt_rate_ewma * (double)(it->a3_c_num_rx_pkt_collision + it->a3_c_num_rx_pkt_unscheduled))
-                              / (double)(sumRx);
-                  if(newVal > 1) {
-                    newVal = 1;
-                  }
-
-                  dynamicAlpha = alpha;
-                  if(newVal > it->a3_c_rx_attempt_rate_ewma) {
-                    dynamicAlpha += alphaPlus;
-                  }
-                  it->a3_c_rx_attempt_rate_ewma = (1 - dynamicAlpha) * it->a3_c_rx_attempt_rate_ewma + dynamicAlpha * newVal;
+#if A3_DBG || A3_DBG_VALUE
+  before = *s;
+#endif
+  actions = tsch_a3_update(s, &info);
+#ifdef ALICE_DEFERRED_RESCHEDULING
+  int_master_status_set(status);
+#endif
 
 #if A3_DBG_VALUE
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_r_a %u | %u %u %u %u %u | %u", 
-                              HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                              it->a3_c_num_rx_pkt_success, it->a3_c_num_rx_pkt_collision, 
-                              it->a3_c_num_rx_pkt_idle, it->a3_c_num_rx_pkt_others, 
-                              it->a3_c_num_rx_pkt_unscheduled, sumRx);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_r_a dalpha %.3f", dynamicAlpha);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_r_a newVal %.3f", newVal);
-                  );
-                  TSCH_LOG_ADD(tsch_log_message,
-                          snprintf(log->message, sizeof(log->message),
-                              "A3-v c_r_a ewma %.3f", it->a3_c_rx_attempt_rate_ewma);
-                  );
-#endif
-
-                  int txChangedForChildFlag = 0;
-
-#if A3_ALICE1_ORB2_OSB3 != 2 //O-SB, ALICE
-                  if((it->a3_c_tx_attempt_rate_ewma - it->a3_c_tx_success_rate_ewma) / (it->a3_c_tx_attempt_rate_ewma) > maxErr 
-                      && it->a3_c_num_tx_slot > 1) {
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_a %u | %u %u %u", who,
+              id,
+              before.num_tx_pkt_success, before.num_tx_pkt_collision, before.num_tx_slot);
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_a alpha %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.alpha));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_a newVal %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.tx_attempt_new));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_a ewma %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.tx_attempt_ewma));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_s newVal %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.tx_success_new));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_t_s ewma %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.tx_success_ewma));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_r_a %u | %u %u %u %u %u | %u", who,
+              id,
+              before.num_rx_pkt_success, before.num_rx_pkt_collision,
+              before.num_rx_pkt_idle, before.num_rx_pkt_others,
+              info.num_rx_pkt_unscheduled, info.sum_rx);
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_r_a dalpha %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.rx_dynamic_alpha));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_r_a newVal %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.rx_attempt_new));
+  );
+  TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+              "A3-v %c_r_a ewma %.3f", who, TSCH_A3_RATE_TO_DOUBLE(info.rx_attempt_ewma));
+  );
+#endif /* A3_DBG_VALUE */
 
 #if A3_DBG
-                    TSCH_LOG_ADD(tsch_log_message,
-                            snprintf(log->message, sizeof(log->message),
-                                "A3-a c_t_half_c %u | %u", 
-                                HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                                it->a3_c_num_tx_slot);
-                    );
+  if(actions & TSCH_A3_TX_HALF_COLLISION) {
+    TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+                "A3-a %c_t_half_c %u | %u", who,
+                id, before.num_tx_slot);
+    );
+  }
+  if(actions & TSCH_A3_TX_DOUBLE) {
+    TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+                "A3-a %c_t_double %u | %u", who,
+                id, before.num_tx_slot);
+    );
+  }
+  if(actions & TSCH_A3_TX_HALF) {
+    TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+                "A3-a %c_t_half %u | %u", who,
+                id, before.num_tx_slot);
+    );
+  }
+  if(actions & TSCH_A3_RX_DOUBLE) {
+    TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+                "A3-a %c_r_double %u | %u", who,
+                id, before.num_rx_slot);
+    );
+  }
+  if(actions & TSCH_A3_RX_HALF) {
+    TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+                "A3-a %c_r_half %u | %u", who,
+                id, before.num_rx_slot);
+    );
+  }
+#else /* A3_DBG */
+  (void)actions;
+#endif /* A3_DBG */
+}
+/*---------------------------------------------------------------------------*/
+/* A3: update the cells with the parent and the child nodes with the results
+   of the ASFN that ended, once per rescheduling */
+void
+alice_a3_update(void)
+{
+  static uint64_t a3_updated_asfn;
+
+  if(a3_updated_asfn == alice_lastly_scheduled_asfn) {
+    return;
+  }
+  a3_updated_asfn = alice_lastly_scheduled_asfn;
+
+  /* Cells with the parent */
+  a3_update_and_log('p', tsch_queue_get_nbr_address(tsch_queue_get_time_source()), &a3_p);
+
+  /* Consider child nodes */
+  nbr_table_item_t *item = nbr_table_head(nbr_routes);
+  while(item != NULL) {
+    linkaddr_t *addr = nbr_table_get_lladdr(nbr_routes, item);
+    if(addr != NULL) {
+      uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)addr);
+      if(it != NULL) {
+        a3_update_and_log('c', addr, &it->a3_c);
+      }
+    }
+
+    item = nbr_table_next(nbr_routes, item);
+  }
+}
+#endif /* WITH_A3 */
+/*---------------------------------------------------------------------------*/
+#ifdef ALICE_DEFERRED_RESCHEDULING
+/* Remove the links of the shadow slotframe */
+static void
+alice_shadow_clear(void)
+{
+  struct tsch_link *l;
+
+  while((l = list_head(alice_shadow_sf.links_list)) != NULL) {
+    tsch_schedule_remove_link(&alice_shadow_sf, l);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Exchange the links of the unicast slotframe and of the shadow slotframe */
+static void
+alice_shadow_swap(struct tsch_slotframe *sf)
+{
+  void *links = sf->links_list_list;
+#if TSCH_SCHEDULE_WITH_INDEX
+  struct tsch_link *l;
+  uint16_t count = list_length(alice_shadow_sf.links_list);
+  uint16_t i;
+
+  /* The shadow links were sorted by alice_shadow_slotframe_commit(): copy them to the run */
+  if(count > sf->index_count) {
+    tsch_schedule_index_resize_run(sf, count - sf->index_count);
+  }
+  i = sf->index_first;
+  for(l = list_head(alice_shadow_sf.links_list); l != NULL; l = list_item_next(l)) {
+    index_links[i++] = l;
+  }
+  i = sf->index_count;
+  sf->index_count = count;
+  if(count < i) {
+    tsch_schedule_index_resize_run(sf, count - i);
+  }
+  index_heap_is_valid = 0;
 #endif
 
-                    it->a3_c_num_tx_slot /= 2;
-                    txChangedForChildFlag = 1;
+  sf->links_list_list = alice_shadow_sf.links_list_list;
+  alice_shadow_sf.links_list_list = links;
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_slotframe *
+alice_shadow_slotframe_begin(void)
+{
+  struct tsch_slotframe *sf;
 
-                    it->a3_c_tx_attempt_rate_ewma = A3_INITIAL_TX_ATTEMPT_RATE_EWMA;
-                    it->a3_c_tx_success_rate_ewma = A3_INITIAL_TX_SUCCESS_RATE_EWMA;
-                  }
+  if(alice_shadow_state != ALICE_SHADOW_STALE) {
+    return NULL;
+  }
+  if(alice_shadow_sf.links_list == NULL) {
+    sf = tsch_schedule_get_slotframe_by_handle(ALICE_UNICAST_SF_HANDLE);
+    if(sf == NULL) {
+      return NULL;
+    }
+    /* Same handle as the unicast slotframe, for the links to be valid once swapped */
+    alice_shadow_sf.handle = sf->handle;
+    alice_shadow_sf.size = sf->size;
+    LIST_STRUCT_INIT(&alice_shadow_sf, links_list);
+  }
+  alice_shadow_state = ALICE_SHADOW_BUILDING;
+  /* Links of the ASFN before the current one */
+  alice_shadow_clear();
+  return &alice_shadow_sf;
+}
+/*---------------------------------------------------------------------------*/
+void
+alice_shadow_slotframe_commit(uint64_t asfn)
+{
+  void *sorted_list = NULL;
+  list_t sorted = (list_t)&sorted_list;
+  struct tsch_link *l;
+
+  if(alice_shadow_state != ALICE_SHADOW_BUILDING) {
+    return;
+  }
+
+  /* Sort the links by timeslot, keeping their order within a timeslot, so
+     that the swap copies them to the index without sorting them */
+  while((l = list_pop(alice_shadow_sf.links_list)) != NULL) {
+    struct tsch_link *prev = NULL;
+    struct tsch_link *m = list_head(sorted);
+    while(m != NULL && m->timeslot <= l->timeslot) {
+      prev = m;
+      m = list_item_next(m);
+    }
+    list_insert(sorted, prev, l);
+  }
+  alice_shadow_sf.links_list_list = sorted_list;
+
+  alice_shadow_asfn = asfn;
+  alice_shadow_state = ALICE_SHADOW_READY;
+}
+/*---------------------------------------------------------------------------*/
+void
+alice_shadow_slotframe_invalidate(void)
+{
+  if(alice_shadow_state == ALICE_SHADOW_READY) {
+    alice_shadow_state = ALICE_SHADOW_STALE;
+  }
+  ALICE_DEFERRED_RESCHEDULING();
+}
+#endif /* ALICE_DEFERRED_RESCHEDULING */
+/*---------------------------------------------------------------------------*/
+#if WITH_ALICE && defined(ALICE_TIME_VARYING_SCHEDULING)
+/* ALICE: re-schedule the unicast slotframe when the current ASFN has no more links */
+static void
+alice_check_time_varying_scheduling(struct tsch_slotframe *sf, struct tsch_asn_t *asn,
+    uint64_t alice_current_asfn)
+{
+  /*
+   * Second, check whether any remaining unicast slotframe link exists after 'alice_current_asn'
+   * within the slotframe of 'alice_current_asfn'.
+   */
+  int alice_remaining_uicast_sf_link_exists = 0;
+  int alice_remaining_uicast_sf_link_exists_at_tsch_current_asn = 0;
+
+#if TSCH_SCHEDULE_WITH_INDEX
+  /* The last link of the slotframe in the index has the largest timeslot */
+  if(sf->index_count > 0) {
+    uint16_t last_timeslot = index_links[sf->index_first + sf->index_count - 1]->timeslot;
+    alice_remaining_uicast_sf_link_exists = last_timeslot > TSCH_ASN_MOD(alice_current_asn, sf->size);
+    alice_remaining_uicast_sf_link_exists_at_tsch_current_asn = last_timeslot > TSCH_ASN_MOD(*asn, sf->size);
+  }
+#else
+  uint16_t timeslot = TSCH_ASN_MOD(alice_current_asn, sf->size);
+  struct tsch_link *l = list_head(sf->links_list);
+  while(l != NULL) {
+    /* Check if any link exists after this timeslot in the current unicast slotframe */
+    if(l->timeslot > timeslot) {
+      /* In the current unicast slotframe schedule, the current timeslot is not a last one. */
+      alice_remaining_uicast_sf_link_exists = 1;
+      break;
+    }
+    l = list_item_next(l);
+  }
+
+  timeslot = TSCH_ASN_MOD(*asn, sf->size);
+  l = list_head(sf->links_list);
+  while(l != NULL) {
+    /* Check if any link exists after this timeslot in the current unicast slotframe */
+    if(l->timeslot > timeslot) {
+      /* In the current unicast slotframe schedule, the current timeslot is not a last one. */
+      alice_remaining_uicast_sf_link_exists_at_tsch_current_asn = 1;
+      break;
+    }
+    l = list_item_next(l);
+  }
 #endif
 
-                  if(txChangedForChildFlag == 0) {
-                    if(it->a3_c_tx_attempt_rate_ewma > txIncreaseThresh && it->a3_c_num_tx_slot < A3_MAX_ZONE) {
+  uint64_t alice_current_asfn_at_tsch_current_asn = 0;
+  struct tsch_asn_t temp_asn_at_tsch_current_asn;
+  TSCH_ASN_COPY(temp_asn_at_tsch_current_asn, *asn);
+  uint16_t mod1_at_tsch_current_asn = TSCH_ASN_MOD(temp_asn_at_tsch_current_asn, sf->size);
+  TSCH_ASN_DEC(temp_asn_at_tsch_current_asn, mod1_at_tsch_current_asn);
+  alice_current_asfn_at_tsch_current_asn = TSCH_ASN_DIVISION(temp_asn_at_tsch_current_asn, sf->size);
 
-#if A3_DBG
-                      TSCH_LOG_ADD(tsch_log_message,
-                              snprintf(log->message, sizeof(log->message),
-                                  "A3-a c_t_double %u | %u", 
-                                  HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                                  it->a3_c_num_tx_slot);
-                      );
+  /*
+   * Third, if 'alice_remaining_uicast_sf_link_exists' is zero,
+   * there is no more unicast slotframe link within the current ASFN (alice_current_asfn).
+   * Then, re-schedule unicast slotframe for the next ASFN,
+   * only when lastly scheduled ASFN (alice_lastly_scheduled_asfn) is different from
+   * the next ASFN (alice_next_asfn).
+   */
+  if(alice_remaining_uicast_sf_link_exists == 0 
+    || alice_remaining_uicast_sf_link_exists_at_tsch_current_asn == 0
+    || alice_current_asfn_at_tsch_current_asn != alice_current_asfn) {
+    uint64_t alice_next_asfn = 0;
+    struct tsch_asn_t asn_of_next_asfn;
+    TSCH_ASN_COPY(asn_of_next_asfn, alice_current_asn);
+    TSCH_ASN_INC(asn_of_next_asfn, sf->size.val);
+    uint16_t mod2 = TSCH_ASN_MOD(asn_of_next_asfn, sf->size);
+    TSCH_ASN_DEC(asn_of_next_asfn, mod2);
+    alice_next_asfn = TSCH_ASN_DIVISION(asn_of_next_asfn, sf->size);
+
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+    uint64_t alice_after_next_asfn = 0;
+    struct tsch_asn_t asn_of_after_next_asfn;
+    TSCH_ASN_COPY(asn_of_after_next_asfn, alice_current_asn);
+    TSCH_ASN_INC(asn_of_after_next_asfn, sf->size.val);
+    TSCH_ASN_INC(asn_of_after_next_asfn, sf->size.val);
+    uint16_t mod3 = TSCH_ASN_MOD(asn_of_after_next_asfn, sf->size);
+    TSCH_ASN_DEC(asn_of_after_next_asfn, mod3);
+    alice_after_next_asfn = TSCH_ASN_DIVISION(asn_of_after_next_asfn, sf->size);
 #endif
 
-                      it->a3_c_num_tx_slot *= 2;
-                      it->a3_c_tx_attempt_rate_ewma /= 2;
-                    } else if(it->a3_c_tx_attempt_rate_ewma < txDecreaseThresh && it->a3_c_num_tx_slot > 1) {
+    if(alice_next_asfn != alice_lastly_scheduled_asfn) {
+#ifdef ALICE_DEFERRED_RESCHEDULING
+      if(alice_shadow_state == ALICE_SHADOW_BUILDING) {
+        /* The process is adding the links of the next ASFN: retry at the
+           next slot rather than modifying the links under it */
+        alice_resched_late_count++;
+        return;
+      }
+      if(alice_shadow_state == ALICE_SHADOW_READY && alice_shadow_asfn != alice_next_asfn) {
+        alice_shadow_state = ALICE_SHADOW_STALE;
+      }
+#endif
+      alice_lastly_scheduled_asfn = alice_next_asfn;
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+      alice_next_asfn_of_lastly_scheduled_asfn = alice_after_next_asfn;
+#endif
 
-#if A3_DBG
-                      TSCH_LOG_ADD(tsch_log_message,
-                              snprintf(log->message, sizeof(log->message),
-                                  "A3-a c_t_half %u | %u", 
-                                  HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                                  it->a3_c_num_tx_slot);
-                      );
+#if WITH_A3 && !defined(ALICE_DEFERRED_RESCHEDULING)
+      alice_a3_update();
 #endif
 
-                      it->a3_c_num_tx_slot /= 2;
-                      it->a3_c_tx_attempt_rate_ewma *= 2;
-                    }
-                  }
+#if HCK_DBG_ALICE_RESCHEDULE_INTERVAL
+      if(hck_dbg_alice_last_reschedule_asfn == 0) {
+        hck_dbg_alice_last_reschedule_asfn = alice_lastly_scheduled_asfn;
+      } else {
+        uint16_t hck_dbg_alice_reschedule_interval = alice_lastly_scheduled_asfn - hck_dbg_alice_last_reschedule_asfn;
+        hck_dbg_alice_last_reschedule_asfn = alice_lastly_scheduled_asfn;
+
+        TSCH_LOG_ADD(tsch_log_message,
+                snprintf(log->message, sizeof(log->message),
+                    "atvs-int %u %llx", hck_dbg_alice_reschedule_interval, alice_current_asfn);
+        );
+      }
+#endif
+#ifdef ALICE_DEFERRED_RESCHEDULING
+      if(alice_shadow_state == ALICE_SHADOW_READY) {
+        alice_shadow_swap(sf);
+        alice_resched_swap_count++;
+      } else {
+        /* No links prepared for this ASFN, e.g. right after a change of the
+           RPL neighbors: reschedule here */
+#if WITH_A3
+        alice_a3_update();
+#endif
+        ALICE_TIME_VARYING_SCHEDULING();
+        alice_resched_sync_count++;
+      }
+      /* The process updates A3 and prepares the links of the following ASFN */
+      alice_shadow_state = ALICE_SHADOW_STALE;
+      ALICE_DEFERRED_RESCHEDULING();
+#else
+      ALICE_TIME_VARYING_SCHEDULING();
+#endif
+    }
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* Returns the next active link after a given ASN, and a backup link (for the same ASN, with Rx flag) */
+struct tsch_link *
+tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
+    struct tsch_link **backup_link)
+{
+#if WITH_ALICE
+  /*
+   * ALICE: First, derive 'alice_current_asfn', which is the ASFN at the start of the ongoing slot operation
+   * from 'alice_current_asn', which is the ASN at the start of the ongoing slot operation.
+   */
+  uint64_t alice_current_asfn = 0;
+  struct tsch_slotframe *alice_uc_sf = tsch_schedule_get_slotframe_by_handle(ALICE_UNICAST_SF_HANDLE);
+  struct tsch_asn_t temp_asn;
+  TSCH_ASN_COPY(temp_asn, alice_current_asn);
+  uint16_t mod1 = TSCH_ASN_MOD(temp_asn, alice_uc_sf->size);
+  TSCH_ASN_DEC(temp_asn, mod1);
+  alice_current_asfn = TSCH_ASN_DIVISION(temp_asn, alice_uc_sf->size);
+#endif
 
-                  if(it->a3_c_rx_attempt_rate_ewma > rxIncreaseThresh && it->a3_c_num_rx_slot < A3_MAX_ZONE) {
+  uint16_t time_to_curr_best = 0;
+  struct tsch_link *curr_best = NULL;
+  struct tsch_link *curr_backup = NULL; /* Keep a back link in case the current link
+  turns out useless when the time comes. For instance, for a Tx-only link, if there is
+  no outgoing packet in queue. In that case, run the backup link instead. The backup link
+  must have Rx flag set. */
+  if(!tsch_is_locked()) {
+#if TSCH_SCHEDULE_WITH_CMD_RING
+    cmd_ring_apply();
+#endif
+#if TSCH_SCHEDULE_WITH_INDEX
+    uint16_t i;
+    uint16_t num_candidates;
 
-#if A3_DBG
-                      TSCH_LOG_ADD(tsch_log_message,
-                              snprintf(log->message, sizeof(log->message),
-                                  "A3-a c_r_double %u | %u", 
-                                  HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                                  it->a3_c_num_rx_slot);
-                      );
+#if WITH_ALICE && defined(ALICE_TIME_VARYING_SCHEDULING)
+    alice_check_time_varying_scheduling(alice_uc_sf, asn, alice_current_asfn);
 #endif
 
-                    it->a3_c_num_rx_slot *= 2;
-                    it->a3_c_rx_attempt_rate_ewma /= 2;
-                  } else if(it->a3_c_rx_attempt_rate_ewma < rxDecreaseThresh && it->a3_c_num_rx_slot > 1) {
+    /* Slotframes having a link at the earliest timeslot after the ASN */
+    tsch_schedule_index_advance(asn);
+    num_candidates = tsch_schedule_index_get_earliest();
+    if(num_candidates > 0) {
+      time_to_curr_best = TSCH_ASN_DIFF(index_heap[0]->index_next_asn, *asn);
+    }
 
-#if A3_DBG
-                      TSCH_LOG_ADD(tsch_log_message,
-                              snprintf(log->message, sizeof(log->message),
-                                  "A3-a c_r_half %u | %u", 
-                                  HCK_GET_NODE_ID_FROM_LINKADDR(addr),
-                                  it->a3_c_num_rx_slot);
-                      );
-#endif
-
-                    it->a3_c_num_rx_slot /= 2;
-                    it->a3_c_rx_attempt_rate_ewma *= 2;
-                  }
-
-                  it->a3_c_num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-                  it->a3_c_num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-
-                  it->a3_c_num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-                  it->a3_c_num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-                  it->a3_c_num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
-                  it->a3_c_num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
-                  it->a3_c_num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
-                }
-              }
+#if WITH_ALICE && defined(ALICE_TIME_VARYING_SCHEDULING)
+    /* ALICE: the unicast slotframe is not in the heap, as its next link depends on the ASFN */
+    uint16_t alice_uc_first = 0;
+    if(alice_uc_sf->index_count > 0) {
+      uint16_t alice_uc_timeslot = TSCH_ASN_MOD(*asn, alice_uc_sf->size);
+      uint16_t alice_uc_time;
+      alice_uc_first = tsch_schedule_index_next(alice_uc_sf, alice_uc_timeslot, &alice_uc_time);
+      if(alice_current_asfn != alice_lastly_scheduled_asfn) {
+        /* Links of the next ASFN after the current timeslot are delayed by a
+         * slotframe (see below), so that the first link of the slotframe comes first */
+        alice_uc_first = alice_uc_sf->index_first;
+        alice_uc_time = alice_uc_sf->size.val + index_links[alice_uc_first]->timeslot - alice_uc_timeslot;
+      }
+      if(num_candidates == 0 || alice_uc_time < time_to_curr_best) {
+        num_candidates = 0;
+        time_to_curr_best = alice_uc_time;
+      }
+      if(alice_uc_time == time_to_curr_best) {
+        index_candidates[num_candidates++] = alice_uc_sf;
+      }
+    }
+#endif
 
-              item = nbr_table_next(nbr_routes, item);
-            }
-#endif /* WITH_A3 */
+    /* Visit the candidate slotframes in list order, as the linear scan does */
+    for(i = 1; i < num_candidates; i++) {
+      struct tsch_slotframe *sf = index_candidates[i];
+      uint16_t j = i;
+      while(j > 0 && index_candidates[j - 1]->index_order > sf->index_order) {
+        index_candidates[j] = index_candidates[j - 1];
+        j--;
+      }
+      index_candidates[j] = sf;
+    }
 
-#if HCK_DBG_ALICE_RESCHEDULE_INTERVAL
-            if(hck_dbg_alice_last_reschedule_asfn == 0) {
-              hck_dbg_alice_last_reschedule_asfn = alice_lastly_scheduled_asfn;
-            } else {
-              uint16_t hck_dbg_alice_reschedule_interval = alice_lastly_scheduled_asfn - hck_dbg_alice_last_reschedule_asfn;
-              hck_dbg_alice_last_reschedule_asfn = alice_lastly_scheduled_asfn;
-
-              TSCH_LOG_ADD(tsch_log_message,
-                      snprintf(log->message, sizeof(log->message),
-                          "atvs-int %u %llx", hck_dbg_alice_reschedule_interval, alice_current_asfn);
-              );
-            }
+    for(i = 0; i < num_candidates; i++) {
+      struct tsch_slotframe *sf = index_candidates[i];
+      uint16_t time_to_timeslot;
+      uint16_t end = sf->index_first + sf->index_count;
+      uint16_t pos = tsch_schedule_index_next(sf, TSCH_ASN_MOD(*asn, sf->size), &time_to_timeslot);
+      uint16_t timeslot;
+#if WITH_ALICE && defined(ALICE_TIME_VARYING_SCHEDULING)
+      if(sf == alice_uc_sf) {
+        pos = alice_uc_first;
+      }
 #endif
-            ALICE_TIME_VARYING_SCHEDULING();
-          }
-        }
+      timeslot = index_links[pos]->timeslot;
+      while(pos < end && index_links[pos]->timeslot == timeslot) {
+        tsch_schedule_select_link(index_links[pos], time_to_curr_best,
+                                  &curr_best, &curr_backup, &time_to_curr_best);
+        pos++;
+      }
+    }
+#else /* TSCH_SCHEDULE_WITH_INDEX */
+    struct tsch_slotframe *sf = list_head(slotframe_list);
+    /* For each slotframe, look for the earliest occurring link */
+    while(sf != NULL) {
+
+#if WITH_ALICE /* alice implementation */
+#ifdef ALICE_TIME_VARYING_SCHEDULING
+      if(sf->handle == ALICE_UNICAST_SF_HANDLE) {
+        alice_check_time_varying_scheduling(sf, asn, alice_current_asfn);
       }
 
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
@@ -1566,83 +2306,14 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
 #endif
 #endif
 
-        if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
-          time_to_curr_best = time_to_timeslot;
-          curr_best = l;
-          curr_backup = NULL;
-        } else if(time_to_timeslot == time_to_curr_best) {
-          struct tsch_link *new_best = NULL;
-          /* Two links are overlapping, we need to select one of them.
-           * By standard: prioritize Tx links first, second by lowest handle */
-          if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
-            /* Both or neither links have Tx, select the one with lowest handle */
-            if(l->slotframe_handle != curr_best->slotframe_handle) {
-              if(l->slotframe_handle < curr_best->slotframe_handle) {
-                new_best = l;
-              }
-            } else {
-              /* compare the link against the current best link and return the newly selected one */
-              new_best = TSCH_LINK_COMPARATOR(curr_best, l);
-            }
-
-#if WITH_OST
-            if((curr_best->slotframe_handle == 1) 
-              && (curr_best->link_options & LINK_OPTION_TX) 
-              && (l->slotframe_handle == 2)) {
-              /*
-              Prevent Autonomous unicast Tx from interfering autonomous broadcast Tx/Rx
-              They share the same c_offset in OST
-              Prioritize Autonomous broadcast Tx/Rx to Autonomous unicast Tx
-              */
-              new_best = l;
-            }
-#endif
-
-          } else {
-            /* Select the link that has the Tx option */
-            if(l->link_options & LINK_OPTION_TX) {
-              new_best = l;
-            }
-          }
-
-#if HCK_APPLY_LATEST_CONTIKI
-          /* Maintain backup_link */
-          /* Check if 'l' best can be used as backup */
-          if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
-            if(curr_backup == NULL || l->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = l;
-            }
-          }
-          /* Check if curr_best can be used as backup */
-          if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
-            if(curr_backup == NULL || curr_best->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = curr_best;
-            }
-          }
-#else
-          /* Maintain backup_link */
-          if(curr_backup == NULL) {
-            /* Check if 'l' best can be used as backup */
-            if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
-              curr_backup = l;
-            }
-            /* Check if curr_best can be used as backup */
-            if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
-              curr_backup = curr_best;
-            }
-          }
-#endif
-
-          /* Maintain curr_best */
-          if(new_best != NULL) {
-            curr_best = new_best;
-          }
-        }
+        tsch_schedule_select_link(l, time_to_timeslot,
+                                  &curr_best, &curr_backup, &time_to_curr_best);
 
         l = list_item_next(l);
       }
       sf = list_item_next(sf);
     }
+#endif /* TSCH_SCHEDULE_WITH_INDEX */
     if(time_offset != NULL) {
       *time_offset = time_to_curr_best;
     }
@@ -1677,6 +2348,14 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+    index_len = 0;
+    index_slotframe_count = 0;
+    index_heap_is_valid = 0;
+#endif
+#if TSCH_SCHEDULE_WITH_CMD_RING
+    ringbufindex_init(&cmd_ringbuf, TSCH_SCHEDULE_CMD_RING_SIZE);
+#endif
     tsch_release_lock();
     return 1;
   } else {
@@ -167,6 +167,125 @@ alice_real_hash5(uint32_t value, uint16_t mod); // ksh: ..
 struct tsch_link * tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
     struct tsch_link **backup_link);
 
+#if TSCH_SCHEDULE_WITH_INDEX
+/**
+ * \brief Sorts again the links of a slotframe in the timeslot index of the schedule.
+ * To be called after modifying their timeslots without removing and adding them again.
+ * \param sf The slotframe
+ */
+void tsch_schedule_index_sort_slotframe(struct tsch_slotframe *sf);
+#endif
+
+#if TSCH_SCHEDULE_WITH_CMD_RING
+/*
+ * Schedule commands: queued by processes (the single producer, as processes
+ * do not preempt each other) and applied by the slot operation (the single
+ * consumer) before it looks up the next active link. They never take the
+ * TSCH lock, so a slotframe changed with commands is not to be changed with
+ * the functions above at the same time. The schedule seen by processes is
+ * behind by the commands not applied yet, i.e. by one slot at most.
+ */
+
+/**
+ * \brief Queues the addition of a link, replacing the link at the same
+ * timeslot and channel offset if any
+ * \param handle The handle of the slotframe (added or swapped before)
+ * \param link_options The link options, as a bitfield (LINK_OPTION_* flags)
+ * \param link_type The link type (advertising, normal)
+ * \param address The link address of the intended destination. Use &tsch_broadcast_address for a slot towards any neighbor
+ * \param timeslot The link timeslot within the slotframe
+ * \param channel_offset The link channel offset
+ * \return 1 if queued, 0 if the command ring is full
+ */
+int tsch_schedule_cmd_add_link(uint16_t handle, uint8_t link_options,
+                               enum link_type link_type, const linkaddr_t *address,
+                               uint16_t timeslot, uint16_t channel_offset);
+
+/**
+ * \brief Queues the removal of the link at a timeslot and channel offset,
+ * if there is one once the commands before are applied
+ * \param handle The handle of the slotframe
+ * \param timeslot The link timeslot within the slotframe
+ * \param channel_offset The link channel offset
+ * \return 1 if queued, 0 if the command ring is full
+ */
+int tsch_schedule_cmd_remove_link(uint16_t handle, uint16_t timeslot,
+                                  uint16_t channel_offset);
+
+/**
+ * \brief Queues a change of the options, type and address of the link at a
+ * timeslot and channel offset
+ * \param handle The handle of the slotframe
+ * \param link_options The new link options
+ * \param link_type The new link type
+ * \param address The new link address
+ * \param timeslot The link timeslot within the slotframe
+ * \param channel_offset The link channel offset
+ * \return 1 if queued, 0 if the command ring is full
+ */
+int tsch_schedule_cmd_modify_link(uint16_t handle, uint8_t link_options,
+                                  enum link_type link_type, const linkaddr_t *address,
+                                  uint16_t timeslot, uint16_t channel_offset);
+
+/**
+ * \brief Queues the replacement of a slotframe by an empty one: its links
+ * are removed and its size is changed. The slotframe is added if it does
+ * not exist, and removed if the size is 0.
+ * \param handle The handle of the slotframe
+ * \param size The new size of the slotframe, 0 to remove it
+ * \return 1 if queued, 0 if the command ring is full
+ */
+int tsch_schedule_cmd_swap_slotframe(uint16_t handle, uint16_t size);
+
+/**
+ * \brief Queues, as one command, the replacement of a slotframe by an empty
+ * one and the addition of a link to it, for the slot operation never to
+ * see the slotframe without the link
+ * \param handle The handle of the slotframe
+ * \param size The new size of the slotframe
+ * \param link_options The link options, as a bitfield (LINK_OPTION_* flags)
+ * \param link_type The link type (advertising, normal)
+ * \param address The link address of the intended destination
+ * \param timeslot The link timeslot within the slotframe
+ * \param channel_offset The link channel offset
+ * \return 1 if queued, 0 if the command ring is full
+ */
+int tsch_schedule_cmd_swap_slotframe_add_link(uint16_t handle, uint16_t size,
+                                              uint8_t link_options, enum link_type link_type,
+                                              const linkaddr_t *address,
+                                              uint16_t timeslot, uint16_t channel_offset);
+#endif
+
+#ifdef ALICE_DEFERRED_RESCHEDULING
+/**
+ * \brief Empties the shadow slotframe, to add the unicast links of the next
+ * ASFN to. To be called from a process, the slot operation never sees it.
+ * \return The shadow slotframe, NULL if it is already built or being built
+ */
+struct tsch_slotframe *alice_shadow_slotframe_begin(void);
+
+/**
+ * \brief Marks the shadow slotframe as built. Its links replace the ones of
+ * the unicast slotframe when the schedule moves to the given ASFN.
+ * \param asfn The ASFN of the links of the shadow slotframe
+ */
+void alice_shadow_slotframe_commit(uint64_t asfn);
+
+/**
+ * \brief Discards the shadow slotframe, e.g. after a change of the RPL
+ * neighbors, and requests a new one
+ */
+void alice_shadow_slotframe_invalidate(void);
+#endif
+
+#if WITH_A3
+/**
+ * \brief A3: updates the cells with the parent and the child nodes with the
+ * results of the ASFN that ended, once per rescheduling
+ */
+void alice_a3_update(void);
+#endif
+
 /**
  * \brief Access the first item in the list of slotframes
  * \return The first slotframe in the schedule if any, NULL otherwise
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Streaming quantile estimator for SLA frame/ACK lengths (P-square algorithm)
+ */
+
+#include "net/mac/tsch/tsch-sla-quantile.h"
+
+/* Desired positions are kept in 1/200 so that increments are integers
+ * for a percentile given in percent */
+#define NP_SCALE 200
+/* Heights are kept in 1/256 bytes */
+#define Q_SHIFT 8
+
+/*---------------------------------------------------------------------------*/
+void
+sla_quantile_init(struct sla_quantile *e, uint8_t percentile)
+{
+  e->percentile = percentile;
+  e->count = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Increments of the desired marker positions for each sample, in 1/200 */
+static uint32_t
+desired_increment(const struct sla_quantile *e, int i)
+{
+  switch(i) {
+  case 0:
+    return 0;
+  case 1:
+    return e->percentile;
+  case 2:
+    return 2 * e->percentile;
+  case 3:
+    return 100 + e->percentile;
+  default:
+    return NP_SCALE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Piecewise-parabolic prediction of the height of marker i moved by d (+1 or -1) */
+static int32_t
+parabolic(const struct sla_quantile *e, int i, int d)
+{
+  int64_t n_prev = e->n[i - 1];
+  int64_t n_curr = e->n[i];
+  int64_t n_next = e->n[i + 1];
+  int64_t num = (n_curr - n_prev + d) * (e->q[i + 1] - e->q[i]) * (n_curr - n_prev)
+    + (n_next - n_curr - d) * (e->q[i] - e->q[i - 1]) * (n_next - n_curr);
+  int64_t den = (n_next - n_curr) * (n_curr - n_prev) * (n_next - n_prev);
+  return e->q[i] + (int32_t)(d * num / den);
+}
+/*---------------------------------------------------------------------------*/
+static int32_t
+linear(const struct sla_quantile *e, int i, int d)
+{
+  return e->q[i] + d * (e->q[i + d] - e->q[i]) / (int32_t)((int32_t)e->n[i + d] - (int32_t)e->n[i]);
+}
+/*---------------------------------------------------------------------------*/
+void
+sla_quantile_add(struct sla_quantile *e, uint8_t len)
+{
+  int32_t x = (int32_t)len << Q_SHIFT;
+  int i, k;
+
+  if(e->count < 5) {
+    /* Keep the first samples sorted in the heights */
+    for(i = e->count; i > 0 && e->q[i - 1] > x; i--) {
+      e->q[i] = e->q[i - 1];
+    }
+    e->q[i] = x;
+    e->count++;
+    if(e->count == 5) {
+      for(i = 0; i < 5; i++) {
+        e->n[i] = i + 1;
+      }
+      e->np[0] = NP_SCALE;
+      e->np[1] = NP_SCALE + 4 * e->percentile;
+      e->np[2] = NP_SCALE + 8 * e->percentile;
+      e->np[3] = 3 * NP_SCALE + 4 * e->percentile;
+      e->np[4] = 5 * NP_SCALE;
+    }
+    return;
+  }
+
+  /* Find the cell of the sample, extending the extreme markers if needed */
+  if(x < e->q[0]) {
+    e->q[0] = x;
+    k = 0;
+  } else if(x >= e->q[4]) {
+    e->q[4] = x;
+    k = 3;
+  } else {
+    for(k = 0; k < 3 && x >= e->q[k + 1]; k++);
+  }
+
+  for(i = k + 1; i < 5; i++) {
+    e->n[i]++;
+  }
+  for(i = 0; i < 5; i++) {
+    e->np[i] += desired_increment(e, i);
+  }
+
+  /* Move the middle markers towards their desired positions */
+  for(i = 1; i < 4; i++) {
+    int32_t d = (int32_t)e->np[i] - (int32_t)(e->n[i] * NP_SCALE);
+    if((d >= NP_SCALE && e->n[i + 1] - e->n[i] > 1)
+       || (d <= -NP_SCALE && e->n[i] - e->n[i - 1] > 1)) {
+      int ds = d > 0 ? 1 : -1;
+      int32_t qp = parabolic(e, i, ds);
+      if(e->q[i - 1] < qp && qp < e->q[i + 1]) {
+        e->q[i] = qp;
+      } else {
+        e->q[i] = linear(e, i, ds);
+      }
+      e->n[i] += ds;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+sla_quantile_get(const struct sla_quantile *e)
+{
+  if(e->count == 0) {
+    return -1;
+  }
+  if(e->count < 5) {
+    /* Nearest rank among the first samples */
+    int rank = (e->percentile * e->count + 99) / 100;
+    if(rank < 1) {
+      rank = 1;
+    }
+    return e->q[rank - 1] >> Q_SHIFT;
+  }
+  /* Round up so that the percentile frame fits */
+  return (e->q[2] + (1 << Q_SHIFT) - 1) >> Q_SHIFT;
+}
+/*---------------------------------------------------------------------------*/
+void
+sla_quantile_decay(struct sla_quantile *e, uint8_t keep_percent)
+{
+  int i;
+
+  if(keep_percent == 0) {
+    e->count = 0;
+    return;
+  }
+  if(e->count < 5 || keep_percent >= 100) {
+    return;
+  }
+
+  /* Shrink positions towards the first marker, keeping heights and order */
+  for(i = 1; i < 5; i++) {
+    uint32_t n = 1 + ((e->n[i] - 1) * keep_percent + 50) / 100;
+    e->n[i] = n > e->n[i - 1] ? n : e->n[i - 1] + 1;
+    e->np[i] = NP_SCALE + (e->np[i] - NP_SCALE) * keep_percent / 100;
+  }
+}
+/** @} */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Streaming quantile estimator for SLA frame/ACK lengths (P-square algorithm,
+ *         R. Jain and I. Chlamtac, 1985), with byte resolution and decay.
+ *         Uses five markers and integer arithmetic only.
+ */
+
+#ifndef __TSCH_SLA_QUANTILE_H__
+#define __TSCH_SLA_QUANTILE_H__
+
+#include <stdint.h>
+
+/** \brief P-square estimator of one percentile */
+struct sla_quantile {
+  int32_t q[5]; /* Marker heights, in 1/256 bytes */
+  uint32_t n[5]; /* Marker positions */
+  uint32_t np[5]; /* Desired marker positions, in 1/200 */
+  uint8_t percentile; /* Estimated percentile (1-99) */
+  uint8_t count; /* Number of samples while less than five (markers not initialized) */
+};
+
+/**
+ * \brief Initialize an estimator
+ * \param e The estimator
+ * \param percentile The percentile to estimate (1-99)
+ */
+void sla_quantile_init(struct sla_quantile *e, uint8_t percentile);
+
+/**
+ * \brief Add a sample to an estimator
+ * \param e The estimator
+ * \param len The sample (frame or ACK length in bytes)
+ */
+void sla_quantile_add(struct sla_quantile *e, uint8_t len);
+
+/**
+ * \brief Get the estimated percentile, rounded up to the byte
+ * \param e The estimator
+ * \return The estimated length in bytes, -1 if there is no sample
+ */
+int sla_quantile_get(const struct sla_quantile *e);
+
+/**
+ * \brief Age the samples seen so far, so that later samples weigh more
+ * \param e The estimator
+ * \param keep_percent Weight kept by past samples: 0 restarts the estimation, 100 keeps all samples
+ */
+void sla_quantile_decay(struct sla_quantile *e, uint8_t keep_percent);
+
+#endif /* __TSCH_SLA_QUANTILE_H__ */
+/** @} */
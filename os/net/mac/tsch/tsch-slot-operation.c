@@ -283,6 +283,15 @@ static uint8_t upa_tx_slot_curr_packet_len;
 static uint8_t upa_tx_slot_b_ack_seen;
 static uint16_t upa_tx_slot_batch_tx_ok_count;
 
+#if UPA_BURST_ASSEMBLY
+/* Frames of the batch, stamped with their in-batch seq before the first Tx.
+ * They point into the queuebufs, nothing is copied. */
+static const void *upa_tx_slot_burst_payload[TSCH_DEQUEUED_ARRAY_SIZE];
+static unsigned short upa_tx_slot_burst_len[TSCH_DEQUEUED_ARRAY_SIZE];
+static uint8_t upa_tx_slot_burst_count;
+static uint8_t upa_tx_slot_burst_preloaded;
+#endif
+
 static rtimer_clock_t upa_tx_slot_trig_ack_start_time;
 static rtimer_clock_t upa_tx_slot_trig_ack_duration;
 static rtimer_clock_t upa_tx_slot_batch_tx_start_time;
@@ -375,6 +384,86 @@ static uint8_t asap_tot_ack_len;
 struct tsch_asn_t tsch_last_valid_asn;
 static rtimer_clock_t volatile last_valid_asn_start;
 /*---------------------------------------------------------------------------*/
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+/* Period of the network-wide cell of the common slotframe.
+ * The timeslot length of an ASN only depends on this cell,
+ * so that all nodes map ASNs to time the same way whatever their own links. */
+#define SLA_ASN_DIVISOR(val) { (val), ((0xffffffff % (val)) + 1) % (val) }
+/* Initialized statically, tsch_calculate_current_asn() may run before the
+ * slot operation starts */
+static struct tsch_asn_divisor_t sla_common_sf_period = SLA_ASN_DIVISOR(SLA_COMMON_SF_PERIOD);
+/*---------------------------------------------------------------------------*/
+/* Broadcast slotframe of a timeslot, from its offset in the common slotframe */
+static uint8_t
+sla_get_bc_sf_of_offset(uint16_t common_sf_ts)
+{
+  return common_sf_ts == SLA_COMMON_SF_TIMESLOT ? SLA_BC_SF_COMMON : SLA_BC_SF_NONE;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+sla_get_bc_sf_of_asn(const struct tsch_asn_t *asn)
+{
+  return sla_get_bc_sf_of_offset(TSCH_ASN_MOD(*asn, sla_common_sf_period));
+}
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+sla_get_timeslot_length_of_bc_sf(uint8_t bc_sf)
+{
+  return bc_sf == SLA_BC_SF_NONE ? tsch_timing[tsch_ts_timeslot_length] : tsch_bc_sf_timing[bc_sf];
+}
+/*---------------------------------------------------------------------------*/
+/* Number of timeslots from asn needed to cover duration (rtimer ticks),
+ * or duration of timeslots from asn (rtimer ticks) if duration is 0 */
+static rtimer_clock_t
+sla_walk_timeslots(const struct tsch_asn_t *asn, uint16_t timeslots, rtimer_clock_t duration)
+{
+  uint16_t common_sf_ts = TSCH_ASN_MOD(*asn, sla_common_sf_period);
+  rtimer_clock_t elapsed = 0;
+  uint16_t passed_timeslots = 0;
+
+  while(duration != 0 ? elapsed < duration : passed_timeslots < timeslots) {
+    elapsed += sla_get_timeslot_length_of_bc_sf(sla_get_bc_sf_of_offset(common_sf_ts));
+    passed_timeslots++;
+    if(++common_sf_ts == sla_common_sf_period.val) {
+      common_sf_ts = 0;
+    }
+  }
+  return duration != 0 ? passed_timeslots : elapsed;
+}
+/*---------------------------------------------------------------------------*/
+/* Duration (rtimer ticks) of the timeslots_before timeslots preceding asn */
+static rtimer_clock_t
+sla_get_duration_of_timeslots_before(const struct tsch_asn_t *asn, uint16_t timeslots_before)
+{
+  struct tsch_asn_t first_asn = *asn;
+  TSCH_ASN_DEC(first_asn, timeslots_before);
+  return sla_walk_timeslots(&first_asn, timeslots_before, 0);
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* Number of timeslots from asn needed to cover duration (rtimer ticks),
+ * with the timeslot length of each ASN */
+uint16_t
+tsch_timeslots_of_duration(const struct tsch_asn_t *asn, rtimer_clock_t duration)
+{
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  return duration == 0 ? 0 : sla_walk_timeslots(asn, 0, duration);
+#else
+  return (duration + tsch_timing[tsch_ts_timeslot_length] - 1) / tsch_timing[tsch_ts_timeslot_length];
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Duration (rtimer ticks) of timeslots from asn */
+rtimer_clock_t
+tsch_duration_of_timeslots(const struct tsch_asn_t *asn, uint16_t timeslots)
+{
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  return sla_walk_timeslots(asn, timeslots, 0);
+#else
+  return timeslots * tsch_timing[tsch_ts_timeslot_length];
+#endif
+}
+/*---------------------------------------------------------------------------*/
 uint64_t
 tsch_calculate_current_asn()
 {
@@ -382,8 +471,8 @@ tsch_calculate_current_asn()
 
   uint64_t last_valid_asn = (uint64_t)(tsch_last_valid_asn.ls4b) + ((uint64_t)(tsch_last_valid_asn.ms1b) << 32);
 
-  uint16_t passed_timeslots = ((RTIMER_CLOCK_DIFF(now, last_valid_asn_start) + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                        / tsch_timing[tsch_ts_timeslot_length]);
+  uint16_t passed_timeslots = tsch_timeslots_of_duration(&tsch_last_valid_asn,
+                                                         RTIMER_CLOCK_DIFF(now, last_valid_asn_start));
 
   return last_valid_asn + passed_timeslots - 1;
 }
@@ -567,8 +656,9 @@ ost_process_rx_matching_slot(frame802154_t* frame)
 }
 #endif /* OST_ON_DEMAND_PROVISION */
 /*---------------------------------------------------------------------------*/
-/* Rx N from Data -> Change Rx schedule */
-void
+/* Rx N from Data -> Change Rx schedule. Returns 0 if the schedule could not
+ * be changed */
+int
 ost_add_rx(uint16_t id, uint16_t N, uint16_t t_offset)
 {
   if(N != 0xffff && t_offset != 0xffff) {
@@ -576,30 +666,47 @@ ost_add_rx(uint16_t id, uint16_t N, uint16_t t_offset)
     uint16_t size = (1 << N);
     uint16_t channel_offset = 3;
 
+#if TSCH_SCHEDULE_WITH_CMD_RING
+    /* The slotframe may exist once the pending commands are applied: replace
+     * it, with its link in the same command */
+    return tsch_schedule_cmd_swap_slotframe_add_link(handle, size, LINK_OPTION_RX,
+                                                     LINK_TYPE_NORMAL, &tsch_broadcast_address,
+                                                     t_offset, channel_offset);
+#else
     if(tsch_schedule_get_slotframe_by_handle(handle) != NULL) {
-      return;
+      return 0;
     }
 
     struct tsch_slotframe *sf;
     sf = tsch_schedule_add_slotframe(handle, size);
 
     if(sf != NULL) {
-      tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL, 
-                            &tsch_broadcast_address, t_offset, channel_offset, 1);
+      if(tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL, 
+                                &tsch_broadcast_address, t_offset, channel_offset, 1) != NULL) {
+        return 1;
+      }
+      tsch_schedule_remove_slotframe(sf);
     }
+    return 0;
+#endif
   }
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void
 ost_remove_rx(uint16_t id)
 {
-  struct tsch_slotframe *rm_sf;
   uint16_t rm_sf_handle = ost_get_rx_sf_handle_from_id(id);
+#if TSCH_SCHEDULE_WITH_CMD_RING
+  tsch_schedule_cmd_swap_slotframe(rm_sf_handle, 0);
+#else
+  struct tsch_slotframe *rm_sf;
   rm_sf = tsch_schedule_get_slotframe_by_handle(rm_sf_handle);
 
   if(rm_sf != NULL) {
     tsch_schedule_remove_slotframe(rm_sf);
   }
+#endif
 }
 #endif
 /*---------------------------------------------------------------------------*/
@@ -893,7 +1000,16 @@ ost_post_process_rx_N(struct input_packet *current_input)
     if(current_input->ost_prN_nbr != NULL) {
       uint16_t nbr_id = OST_NODE_ID_FROM_IPADDR(&(current_input->ost_prN_nbr->ipaddr));
       ost_remove_rx(nbr_id);
-      ost_add_rx(nbr_id, current_input->ost_prN_new_N, current_input->ost_prN_new_t_offset);
+      if(!ost_add_rx(nbr_id, current_input->ost_prN_new_N, current_input->ost_prN_new_t_offset)) {
+        /* Not listening at t_offset: forget the N of the neighbor, for the
+         * next one it sends to install the Rx schedule again */
+        current_input->ost_prN_nbr->ost_nbr_N = 0xffff;
+        current_input->ost_prN_nbr->ost_nbr_t_offset = 0xffff;
+        TSCH_LOG_ADD(tsch_log_message,
+                snprintf(log->message, sizeof(log->message),
+                    "!ost pprN: add rx failed n %u", nbr_id);
+        );
+      }
 
 #if WITH_OST_LOG_INFO
       TSCH_LOG_ADD(tsch_log_message,
@@ -929,30 +1045,35 @@ ost_post_process_rx_N(struct input_packet *current_input)
 void ost_change_queue_select_packet(linkaddr_t *nbr_lladdr, uint16_t handle, uint16_t timeslot)
 {
   struct tsch_neighbor *n = tsch_queue_get_nbr(nbr_lladdr);
+  uint8_t c;
 
   if(!tsch_is_locked() && n !=NULL) {
-    if(!ringbufindex_empty(&n->tx_ringbuf)) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
-      uint8_t num_elements = ringbufindex_elements(&n->tx_ringbuf);
-
-      uint8_t j;
-      for(j = get_index; j < get_index + num_elements; j++) {
-        int16_t index;
+    for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+      struct ringbufindex *ringbuf = TSCH_QUEUE_RINGBUF(n, c);
+      if(!ringbufindex_empty(ringbuf)) {
+        int16_t get_index = ringbufindex_peek_get(ringbuf);
+        uint8_t num_elements = ringbufindex_elements(ringbuf);
+
+        uint8_t j;
+        for(j = get_index; j < get_index + num_elements; j++) {
+          int16_t index;
+
+          if(j >= ringbufindex_size(ringbuf)) {
+            index = j - ringbufindex_size(ringbuf);
+          } else {
+            index = j;
+          }
 
-        if(j >= ringbufindex_size(&n->tx_ringbuf)) {
-          index = j - ringbufindex_size(&n->tx_ringbuf);
-        } else {
-          index = j;
+          ost_set_queuebuf_attr(TSCH_QUEUE_PACKET(n, c, index)->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, handle);
+          ost_set_queuebuf_attr(TSCH_QUEUE_PACKET(n, c, index)->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
         }
-
-        ost_set_queuebuf_attr(n->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, handle);
-        ost_set_queuebuf_attr(n->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
       }
     }
   }
 }
 /*---------------------------------------------------------------------------*/
-void 
+/* Returns 0 if the schedule could not be changed */
+int
 ost_add_tx(linkaddr_t *nbr_lladdr, uint16_t N, uint16_t t_offset)
 {
   if(N != 0xffff && t_offset != 0xffff) {
@@ -961,47 +1082,64 @@ ost_add_tx(linkaddr_t *nbr_lladdr, uint16_t N, uint16_t t_offset)
     uint16_t size = (1 << N);
     uint16_t channel_offset = 3;
 
+#if TSCH_SCHEDULE_WITH_CMD_RING
+    /* The slotframe may exist once the pending commands are applied: replace
+     * it, with its link in the same command */
+    if(!tsch_schedule_cmd_swap_slotframe_add_link(handle, size, LINK_OPTION_TX,
+                                                  LINK_TYPE_NORMAL, &tsch_broadcast_address,
+                                                  t_offset, channel_offset)) {
+      return 0;
+    }
+#else
     struct tsch_slotframe *sf;
-    struct tsch_link *l;
 
     if(tsch_schedule_get_slotframe_by_handle(handle) != NULL) {
-      return;
+      return 0;
     }
 
     sf = tsch_schedule_add_slotframe(handle, size);
+    if(sf == NULL) {
+      return 0;
+    }
+    if(tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, 
+                              &tsch_broadcast_address, t_offset, channel_offset, 1) == NULL) {
+      tsch_schedule_remove_slotframe(sf);
+      return 0;
+    }
+#endif
+    ost_change_queue_select_packet(nbr_lladdr, handle, t_offset);
 
-    if(sf != NULL) {
-      l = tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, 
-                                &tsch_broadcast_address, t_offset, channel_offset, 1);
-      if(l != NULL) {
-        ost_change_queue_select_packet(nbr_lladdr, handle, t_offset);
+    uip_ds6_nbr_t *nbr = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)nbr_lladdr);
+    if(nbr != NULL) {
+      if(nbr->ost_my_low_prr == 1) {
+        ost_update_N_of_packets_in_queue(nbr_lladdr, nbr->ost_my_N);
       }
-      uip_ds6_nbr_t *nbr = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)nbr_lladdr);
-      if(nbr != NULL) {
-        if(nbr->ost_my_low_prr == 1) {
-          ost_update_N_of_packets_in_queue(nbr_lladdr, nbr->ost_my_N);
-        }
 
-        nbr->ost_my_low_prr = 0;
-        nbr->ost_num_tx_mac = 0;
-        nbr->ost_num_tx_succ_mac = 0;
-        nbr->ost_num_consecutive_tx_fail_mac = 0;
-        nbr->ost_consecutive_my_N_inc = 0;
-      }
+      nbr->ost_my_low_prr = 0;
+      nbr->ost_num_tx_mac = 0;
+      nbr->ost_num_tx_succ_mac = 0;
+      nbr->ost_num_consecutive_tx_fail_mac = 0;
+      nbr->ost_consecutive_my_N_inc = 0;
     }
   }
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void 
 ost_remove_tx(linkaddr_t *nbr_lladdr)
 {
   uint16_t id = OST_NODE_ID_FROM_LINKADDR(nbr_lladdr);
-  struct tsch_slotframe *rm_sf;
   uint16_t rm_sf_handle = ost_get_tx_sf_handle_from_id(id);
+#if TSCH_SCHEDULE_WITH_CMD_RING
+  /* The slotframe may be added by a pending command: always remove it */
+  if(tsch_schedule_cmd_swap_slotframe(rm_sf_handle, 0)) {
+#else
+  struct tsch_slotframe *rm_sf;
   rm_sf = tsch_schedule_get_slotframe_by_handle(rm_sf_handle);
 
   if(rm_sf != NULL) {
     tsch_schedule_remove_slotframe(rm_sf);
+#endif
     struct tsch_neighbor *n = tsch_queue_get_nbr(nbr_lladdr);
     if(n != NULL) {
       if(!tsch_queue_is_empty(n)) {
@@ -1324,7 +1462,13 @@ ost_post_process_rx_t_offset(struct tsch_packet *p)
 
       if((p->ost_prt_nbr)->ost_my_installable == 1) {
         if(p->ost_flag_rejected_by_nbr == 0) { /* installable, not rejected (0xffff) */
-          ost_add_tx(nbr_lladdr, (p->ost_prt_nbr)->ost_my_N, p->ost_prt_new_t_offset);
+          if(!ost_add_tx(nbr_lladdr, (p->ost_prt_nbr)->ost_my_N, p->ost_prt_new_t_offset)) {
+            /* Packets stay on the RB or shared slots set by ost_remove_tx */
+            TSCH_LOG_ADD(tsch_log_message,
+                    snprintf(log->message, sizeof(log->message),
+                        "!ost pprT: add tx failed");
+            );
+          }
 #if WITH_OST_LOG_INFO
           uint16_t nbr_id = OST_NODE_ID_FROM_IPADDR(&((p->ost_prt_nbr)->ipaddr));
           TSCH_LOG_ADD(tsch_log_message,
@@ -1398,7 +1542,9 @@ tsch_get_lock(void)
       /* Take the lock if it is free */
       tsch_locked = 1;
       tsch_lock_requested = 0;
+      tsch_lock_count++;
       if(busy_wait) {
+        tsch_lock_wait_count++;
         /* Issue a log whenever we had to busy wait until getting the lock */
         TSCH_LOG_ADD(tsch_log_message,
             snprintf(log->message, sizeof(log->message),
@@ -1408,6 +1554,7 @@ tsch_get_lock(void)
       return 1;
     }
   }
+  tsch_lock_fail_count++;
   TSCH_LOG_ADD(tsch_log_message,
       snprintf(log->message, sizeof(log->message),
                       "!failed to lock");
@@ -1501,6 +1648,7 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
    * because we can not schedule rtimer less than RTIMER_GUARD in the future */
   int missed = check_timer_miss(ref_time, offset - RTIMER_GUARD, now);
   if(missed) {
+    tsch_slot_profiler_overrun();
     TSCH_LOG_ADD(tsch_log_message,
                 snprintf(log->message, sizeof(log->message),
                     "!dl-miss %s %d %d",
@@ -1529,6 +1677,25 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
     } \
   } while(0);
 /*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_CLASSES
+/* Remove an expired packet from its queue and pass it to the upper layer
+ * as a failed transmission. Returns 0 if there is no room to do so. */
+static int
+drop_expired_packet(struct tsch_neighbor *n, struct tsch_packet *p)
+{
+  int16_t dequeued_index = ringbufindex_peek_put(&dequeued_ringbuf);
+  if(dequeued_index == -1) {
+    return 0;
+  }
+  tsch_queue_remove_packet_from_queue(n);
+  p->ret = MAC_TX_ERR;
+  dequeued_array[dequeued_index] = p;
+  ringbufindex_put(&dequeued_ringbuf);
+  tsch_queue_class_stats[p->tx_class].expired++;
+  return 1;
+}
+#endif
+/*---------------------------------------------------------------------------*/
 /* Get EB, broadcast or unicast packet to be sent, and target neighbor. */
 static struct tsch_packet *
 get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
@@ -1536,6 +1703,11 @@ get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **
   struct tsch_packet *p = NULL;
   struct tsch_neighbor *n = NULL;
 
+#if TSCH_QUEUE_WITH_CLASSES
+  do {
+    p = NULL;
+    n = NULL;
+#endif
   /* Is this a Tx link? */
   if(link->link_options & LINK_OPTION_TX) {
     /* is it for advertisement of EB? */
@@ -1557,6 +1729,11 @@ get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **
       }
     }
   }
+#if TSCH_QUEUE_WITH_CLASSES
+    /* Drop the packet if past its deadline rather than waste the cell on it,
+     * and pick the next one */
+  } while(p != NULL && tsch_queue_packet_expired(p) && drop_expired_packet(n, p));
+#endif
   /* return nbr (by reference) */
   if(target_neighbor != NULL) {
     *target_neighbor = n;
@@ -1729,9 +1906,47 @@ upa_calculate_slot_utility(struct tsch_neighbor *curr_nbr,
                                      + tsch_timing[tsch_ts_tx_ack_delay]
                                      + TSCH_PACKET_DURATION(triggering_ack_len);
 
-  upa_all_operation_timeslots = (triggering_slot_operation_duration 
-                                  + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                                / tsch_timing[tsch_ts_timeslot_length];
+#if UPA_MEMOIZED_SLOT_UTILITY
+  /* Tx durations come from the per-neighbor running sums and the number of
+   * timeslots from a running slot boundary: no queue walk and no division.
+   * The boundary moves by the timeslot length of each ASN of the batch. */
+  struct tsch_asn_t upa_slot_asn = tsch_current_asn;
+  rtimer_clock_t upa_slot_boundary = tsch_duration_of_timeslots(&upa_slot_asn, 1);
+  rtimer_clock_t upa_fixed_duration = triggering_slot_operation_duration
+                                    + upa_timing[upa_ts_tx_ack_delay]
+                                    + upa_timing[upa_ts_max_ack]
+                                    + upa_timing[upa_ts_tx_process_b_ack];
+  rtimer_clock_t upa_offsets_duration = 0;
+  rtimer_clock_t upa_expected_operation_duration = 0;
+
+  upa_all_operation_timeslots = 1;
+  while(triggering_slot_operation_duration > upa_slot_boundary) {
+    ++upa_all_operation_timeslots;
+    TSCH_ASN_INC(upa_slot_asn, 1);
+    upa_slot_boundary += tsch_duration_of_timeslots(&upa_slot_asn, 1);
+  }
+  if(upa_all_operation_timeslots > 1) {
+    upa_bitmap_of_slot_utility = upa_bitmap_of_slot_utility | (1 << 0);
+  }
+
+  uint8_t i = 1;
+  for(i = 1; i <= num_of_pkts_to_request; i++) {
+    upa_offsets_duration += (i == 1) ? upa_timing[upa_ts_tx_offset_1] : upa_timing[upa_ts_tx_offset_2];
+    upa_expected_operation_duration = upa_fixed_duration + upa_offsets_duration
+                                    + tsch_queue_upa_get_tx_duration_sum(curr_nbr, i);
+
+    if(upa_expected_operation_duration > upa_slot_boundary) {
+      while(upa_expected_operation_duration > upa_slot_boundary) {
+        ++upa_all_operation_timeslots;
+        TSCH_ASN_INC(upa_slot_asn, 1);
+        upa_slot_boundary += tsch_duration_of_timeslots(&upa_slot_asn, 1);
+      }
+      upa_bitmap_of_slot_utility = upa_bitmap_of_slot_utility | (1 << i);
+    }
+  }
+#else /* UPA_MEMOIZED_SLOT_UTILITY */
+  upa_all_operation_timeslots = tsch_timeslots_of_duration(&tsch_current_asn,
+                                                           triggering_slot_operation_duration);
   if(upa_all_operation_timeslots > 1) {
     upa_bitmap_of_slot_utility = upa_bitmap_of_slot_utility | (1 << 0);
   }
@@ -1762,16 +1977,16 @@ upa_calculate_slot_utility(struct tsch_neighbor *curr_nbr,
                                 + upa_timing[upa_ts_max_ack]
                                 + upa_timing[upa_ts_tx_process_b_ack];
 
-    upa_expected_timeslots = (triggering_slot_operation_duration 
-                                + upa_expected_all_tx_duration 
-                                + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                              / tsch_timing[tsch_ts_timeslot_length];
+    upa_expected_timeslots = tsch_timeslots_of_duration(&tsch_current_asn,
+                                                        triggering_slot_operation_duration
+                                                        + upa_expected_all_tx_duration);
 
     if(upa_expected_timeslots > upa_all_operation_timeslots) {
       upa_all_operation_timeslots = upa_expected_timeslots;
       upa_bitmap_of_slot_utility = upa_bitmap_of_slot_utility | (1 << i);
     }
   }
+#endif /* UPA_MEMOIZED_SLOT_UTILITY */
 
   upa_expected_passed_timeslots_except_first_slot = upa_all_operation_timeslots - 1;
 
@@ -1807,6 +2022,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx0: start of tsch_tx_slot */
   regular_slot_timestamp_tx[0] = RTIMER_NOW();
 #endif
+  TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_START);
 
   /* First check if we have space to store a newly dequeued packet (in case of
    * successful Tx or Drop) */
@@ -1851,6 +2067,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       } else {
         current_packet->sla_is_broadcast = 1;
       }
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+      current_packet->sla_bc_sf = sla_get_bc_sf_of_asn(&tsch_current_asn);
+#endif
 #endif
 
 #if HCK_DBG_REGULAR_SLOT_DETAIL /* Store packet len and do_wait_for_ack */
@@ -1862,9 +2081,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       upa_link_requested = 0;
       
       /* Unicast. More packets in queue for the neighbor? */
-      if(do_wait_for_ack && tsch_queue_nbr_packet_count(current_neighbor) > 1) {
-        /* except for current packet: tsch_queue_nbr_packet_count(current_neighbor) - 1 */
-        int upa_pkts_pending = tsch_queue_nbr_packet_count(current_neighbor) - 1;
+      if(do_wait_for_ack && tsch_queue_nbr_tx_class_packet_count(current_neighbor) > 1) {
+        /* except for current packet: tsch_queue_nbr_tx_class_packet_count(current_neighbor) - 1 */
+        int upa_pkts_pending = tsch_queue_nbr_tx_class_packet_count(current_neighbor) - 1;
         /* consider current packet: ringbufindex_elements(&dequeued_ringbuf) + 1 */
         int upa_empty_space_of_dequeued_ringbuf
             = ((int)TSCH_DEQUEUED_ARRAY_SIZE - 1) - (ringbufindex_elements(&dequeued_ringbuf) + 1) > 0 ?
@@ -1888,6 +2107,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
           uint16_t upa_info_to_request = (upa_pkts_to_request << 8) + upa_bitmap_of_slot_utility;
 #endif /* HCK_ASAP_EVAL_02_UPA_SINGLE_HOP */
           upa_link_requested = 1;
+          TSCH_METRICS_ADD(TSCH_METRIC_UPA_PKTS_REQUESTED, upa_pkts_to_request);
           tsch_packet_set_frame_pending(packet, packet_len);
 
           frame802154_t upa_frame;
@@ -1912,7 +2132,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       burst_link_requested = 0;
       if(do_wait_for_ack
              && tsch_current_burst_count + 1 < TSCH_BURST_MAX_LEN
-             && tsch_queue_nbr_packet_count(current_neighbor) > 1) {
+             && tsch_queue_nbr_tx_class_packet_count(current_neighbor) > 1) {
 
 #if TSCH_DBT_QUEUE_AWARENESS
         /* consider current packet: ringbufindex_elements(&dequeued_ringbuf) + 1 */
@@ -1971,7 +2191,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       frame802154_fcf_t fcf;
       frame802154_parse_fcf((uint8_t *)(packet), &fcf);
 
-      int queued_pkts = ringbufindex_elements(&current_neighbor->tx_ringbuf);
+      int queued_pkts = tsch_queue_nbr_packet_count(current_neighbor);
       uint16_t nbr_id = OST_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(current_neighbor));
 
       if(fcf.ack_required) {
@@ -2078,6 +2298,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx2: after RADIO.prepare() */
         regular_slot_timestamp_tx[2] = RTIMER_NOW();
 #endif
+        TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_PREPARED);
 
 #if TSCH_CCA_ENABLED
         cca_status = 1;
@@ -2181,6 +2402,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx5: after CCA */
         regular_slot_timestamp_tx[5] = RTIMER_NOW();
 #endif
+        TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_CCA_DONE);
 
         /* there is not enough time to turn radio off */
         /*  NETSTACK_RADIO.off(); */
@@ -2202,6 +2424,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx6: before RADIO.transmit() */
           regular_slot_timestamp_tx[6] = RTIMER_NOW();
 #endif
+          TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_FRAME_START);
 
           /* send packet already in radio tx buffer */
           mac_tx_status = NETSTACK_RADIO.transmit(packet_len);
@@ -2209,6 +2432,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx7: after RADIO.transmit() */
           regular_slot_timestamp_tx[7] = RTIMER_NOW();
 #endif
+          TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_FRAME_END);
 
           tx_count++;
           /* Save tx timestamp */
@@ -2283,6 +2507,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx12: ACK start time */
               regular_slot_timestamp_tx[12] = ack_start_time;
 #endif
+              TSCH_SLOT_PROFILER_MARK_AT(TSCH_SLOT_PROF_TX_ACK_START, ack_start_time);
 
               /* Wait for ACK to finish */
               RTIMER_BUSYWAIT_UNTIL_ABS(!NETSTACK_RADIO.receiving_packet(),
@@ -2292,6 +2517,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx13: ACK end time, before turn_radio_off() */
               regular_slot_timestamp_tx[13] = RTIMER_NOW();
 #endif
+              TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_ACK_END);
 
 #if WITH_UPA
               if(upa_link_requested) {
@@ -2388,6 +2614,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                       "upa pol allowed %u", upa_pkts_allowed));
                 }
 #endif
+                if(upa_link_requested) {
+                  TSCH_METRICS_ADD(TSCH_METRIC_UPA_PKTS_ACCEPTED, upa_pkts_allowed);
+                }
                 if(upa_link_requested && upa_pkts_allowed > 0) {
                   upa_link_scheduled = 1;
                   upa_pkts_to_send = upa_pkts_allowed;
@@ -2508,17 +2737,17 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
         if(a3_up1_down2 == 1) { /* Upward */
           if(mac_tx_status == MAC_TX_OK) {
-            a3_p_num_tx_pkt_success++;
+            a3_p.num_tx_pkt_success++;
           } else {
-            a3_p_num_tx_pkt_collision++;
+            a3_p.num_tx_pkt_collision++;
           }
 
         } else { /* Downward */
 #if A3_ALICE1_ORB2_OSB3 == 3 /* O-SB: Records Tx results for all nodes into a single variable */
           if(mac_tx_status == MAC_TX_OK) {
-            a3_p_num_tx_pkt_success++;
+            a3_p.num_tx_pkt_success++;
           } else {
-            a3_p_num_tx_pkt_collision++;
+            a3_p.num_tx_pkt_collision++;
           }
 #else /* ALICE, O-RB: Records Tx results for each node into separate variables */
           if(mac_tx_status == MAC_TX_OK) {
@@ -2526,7 +2755,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
             if(item != NULL) {
               uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)queuebuf_addr(current_packet->qb, PACKETBUF_ADDR_RECEIVER));
               if(it != NULL) {
-                it->a3_c_num_tx_pkt_success++;
+                it->a3_c.num_tx_pkt_success++;
               }
             }
           } else {
@@ -2534,7 +2763,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
             if(item != NULL) {
               uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)queuebuf_addr(current_packet->qb, PACKETBUF_ADDR_RECEIVER));
               if(it != NULL) {
-                it->a3_c_num_tx_pkt_collision++;
+                it->a3_c.num_tx_pkt_collision++;
               }
             }
           }
@@ -2560,6 +2789,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegTx15: after processing ACK */
     regular_slot_timestamp_tx[15] = RTIMER_NOW();
 #endif
+#if WITH_UPA
+    if(!upa_link_scheduled)
+#endif
+    {
+      TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_TX_END);
+    }
 
 #if WITH_UPA
     if(upa_link_scheduled) {
@@ -2574,9 +2809,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
       current_slot_idle_start = RTIMER_NOW();
       current_slot_busy_time = RTIMER_CLOCK_DIFF(current_slot_idle_start, current_slot_start);
-      current_slot_passed_slots = (current_slot_busy_time + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                                  / tsch_timing[tsch_ts_timeslot_length];
-      current_slot_idle_time = current_slot_passed_slots * tsch_timing[tsch_ts_timeslot_length] - current_slot_busy_time;
+      current_slot_passed_slots = tsch_timeslots_of_duration(&tsch_current_asn, current_slot_busy_time);
+      current_slot_idle_time = tsch_duration_of_timeslots(&tsch_current_asn, current_slot_passed_slots)
+                               - current_slot_busy_time;
 
       /* Log every tx attempt */
       TSCH_LOG_ADD(tsch_log_tx,
@@ -2669,6 +2904,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     upa_print_tx_slot_timing = 1;
     upa_tx_slot_timestamp_begin[0] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_TX_START);
 
     upa_tx_slot_trig_packet_len = queuebuf_datalen(current_packet->qb);
     upa_tx_slot_all_packet_len_same = 1;
@@ -2683,20 +2919,52 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       upa_tx_slot_packet_array[i] = NULL;
     }
 
-    int upa_tx_slot_ringbuf_head_index = ringbufindex_peek_get(&current_neighbor->tx_ringbuf);
+    int upa_tx_slot_ringbuf_head_index = ringbufindex_peek_get(TSCH_QUEUE_TX_RINGBUF(current_neighbor));
     for(i = 0; i < upa_pkts_to_send; i++) {
       upa_tx_slot_dequeued_ringbuf_index_array[i] = (upa_tx_slot_ringbuf_head_index + i) < TSCH_QUEUE_NUM_PER_NEIGHBOR ?
                                     (upa_tx_slot_ringbuf_head_index + i) : 
                                     (upa_tx_slot_ringbuf_head_index + i) - TSCH_QUEUE_NUM_PER_NEIGHBOR;
-      upa_tx_slot_packet_array[i] = current_neighbor->tx_array[upa_tx_slot_dequeued_ringbuf_index_array[i]];
+      upa_tx_slot_packet_array[i] = TSCH_QUEUE_TX_PACKET(current_neighbor, upa_tx_slot_dequeued_ringbuf_index_array[i]);
     }
 
     upa_tx_slot_in_batch_seq = 1;
     upa_tx_slot_curr_packet = upa_tx_slot_packet_array[0];
 
+#if UPA_BURST_ASSEMBLY
+    /* Assemble the whole burst before the first Tx: parse and stamp each frame once,
+     * so that the gap between two frames only hands the next frame over to the radio */
+    upa_tx_slot_burst_count = 0;
+    for(i = 0; i < upa_pkts_to_send; i++) {
+      struct tsch_packet *p = upa_tx_slot_packet_array[i];
+      if(p == NULL || p->qb == NULL) {
+        break; /* The Tx loop reports MAC_TX_ERR_FATAL for this seq */
+      }
+      uint8_t *upa_burst_frame = (uint8_t *)queuebuf_dataptr(p->qb);
+      unsigned short upa_burst_frame_len = queuebuf_datalen(p->qb);
+      frame802154_t upa_frame;
+      int upa_hdr_len = frame802154_parse(upa_burst_frame, upa_burst_frame_len, &upa_frame);
+      upa_burst_frame[upa_hdr_len + 2] = (uint8_t)((i + 1) & 0xFF);
+      upa_burst_frame[upa_hdr_len + 3] = (uint8_t)(((i + 1) >> 8) & 0xFF);
+      upa_tx_slot_burst_payload[i] = upa_burst_frame;
+      upa_tx_slot_burst_len[i] = upa_burst_frame_len;
+      upa_tx_slot_burst_count++;
+    }
+
+    /* Radios that can hold the burst take it in one call and load each frame themselves */
+    upa_tx_slot_burst_preloaded = 0;
+#if UPA_RADIO_PREPARE_BURST
+    if(NETSTACK_RADIO.prepare_burst != NULL && upa_tx_slot_burst_count > 0
+       && NETSTACK_RADIO.prepare_burst(upa_tx_slot_burst_payload, upa_tx_slot_burst_len,
+                                       upa_tx_slot_burst_count) == 0) {
+      upa_tx_slot_burst_preloaded = 1;
+    }
+#endif
+#endif
+
 #if UPA_DBG_SLOT_TIMING /* upaTxB1: end of preparing burst */
     upa_tx_slot_timestamp_begin[1] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_TX_BURST_READY);
 
     upa_tx_slot_trig_ack_duration = TSCH_PACKET_DURATION(upa_tx_slot_trig_ack_len);
     upa_tx_slot_batch_tx_start_time = upa_tx_slot_trig_ack_start_time 
@@ -2712,11 +2980,20 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       if(ringbufindex_elements(&dequeued_ringbuf) + upa_tx_slot_in_batch_seq < TSCH_DEQUEUED_ARRAY_SIZE) {
         ++tsch_dequeued_ringbuf_available_count;
 
+#if UPA_BURST_ASSEMBLY
+        if(upa_tx_slot_in_batch_seq > upa_tx_slot_burst_count) {
+#else
         if(upa_tx_slot_curr_packet == NULL || upa_tx_slot_curr_packet->qb == NULL) {
+#endif
           upa_tx_slot_mac_tx_status = MAC_TX_ERR_FATAL;
         } else {
+#if UPA_BURST_ASSEMBLY
+          upa_tx_slot_curr_packet_payload = (void *)upa_tx_slot_burst_payload[upa_tx_slot_in_batch_seq - 1];
+          upa_tx_slot_curr_packet_len = upa_tx_slot_burst_len[upa_tx_slot_in_batch_seq - 1];
+#else
           upa_tx_slot_curr_packet_payload = queuebuf_dataptr(upa_tx_slot_curr_packet->qb);
           upa_tx_slot_curr_packet_len = queuebuf_datalen(upa_tx_slot_curr_packet->qb);
+#endif
 
           if(upa_tx_slot_trig_packet_len != upa_tx_slot_curr_packet_len) {
             upa_tx_slot_all_packet_len_same = 0;
@@ -2724,11 +3001,13 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
           asap_tot_packet_len += upa_tx_slot_curr_packet_len;
 
+#if !UPA_BURST_ASSEMBLY
           frame802154_t upa_frame;
           int upa_hdr_len;
           upa_hdr_len = frame802154_parse((uint8_t *)upa_tx_slot_curr_packet_payload, upa_tx_slot_curr_packet_len, &upa_frame);
           ((uint8_t *)(upa_tx_slot_curr_packet_payload))[upa_hdr_len + 2] = (uint8_t)(upa_tx_slot_in_batch_seq & 0xFF);
           ((uint8_t *)(upa_tx_slot_curr_packet_payload))[upa_hdr_len + 3] = (uint8_t)((upa_tx_slot_in_batch_seq >> 8) & 0xFF);
+#endif
 
 #if UPA_DBG_OPERATION
           uint8_t upa_mac_seqno = ((uint8_t *)(upa_tx_slot_curr_packet_payload))[2];
@@ -2741,7 +3020,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
           upa_tx_slot_timestamp_tx[upa_tx_slot_in_batch_seq - 1][0] = RTIMER_NOW();
 #endif
 
+#if UPA_BURST_ASSEMBLY
+          if(upa_tx_slot_burst_preloaded
+             || NETSTACK_RADIO.prepare(upa_tx_slot_curr_packet_payload, upa_tx_slot_curr_packet_len) == 0) { /* 0 means success */
+#else
           if(NETSTACK_RADIO.prepare(upa_tx_slot_curr_packet_payload, upa_tx_slot_curr_packet_len) == 0) { /* 0 means success */
+#endif
 
 #if UPA_DBG_SLOT_TIMING /* upaTxT1: after RADIO.prepare() */
             upa_tx_slot_timestamp_tx[upa_tx_slot_in_batch_seq - 1][1] = RTIMER_NOW();
@@ -2832,6 +3116,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if UPA_DBG_SLOT_TIMING /* upaTxA0: after while loop */
     upa_tx_slot_timestamp_ack[0] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_TX_FRAMES_END);
 
     upa_tx_slot_prev_start = upa_tx_slot_curr_start;
     upa_tx_slot_prev_offset = upa_tx_slot_curr_offset;
@@ -2880,6 +3165,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if UPA_DBG_SLOT_TIMING /* upaTxA3: ACK end time */
     upa_tx_slot_timestamp_ack[3] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_TX_ACK_END);
 
     upa_b_ack_len = NETSTACK_RADIO.read((void *)upa_b_ackbuf, sizeof(upa_b_ackbuf));
 
@@ -3020,7 +3306,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       for(i = 0; i < upa_pkts_to_send; i++) {
         if(upa_tx_slot_in_queue_array[(upa_pkts_to_send - 1) - i] == 1) {
           uint8_t upa_dest_ringbuf_index = upa_tx_slot_dequeued_ringbuf_index_array[(upa_pkts_to_send - 1) - upa_cursor];
-          current_neighbor->tx_array[upa_dest_ringbuf_index] = upa_tx_slot_packet_array[(upa_pkts_to_send - 1) - i];
+          TSCH_QUEUE_TX_SET_PACKET(current_neighbor, upa_dest_ringbuf_index, upa_tx_slot_packet_array[(upa_pkts_to_send - 1) - i]);
           ++upa_cursor;
           if(upa_num_of_non_zero_in_queue_pkts == upa_cursor) {
             break;
@@ -3029,17 +3315,23 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       }
     }
     int upa_get_ptr_shift = upa_pkts_to_send - upa_num_of_non_zero_in_queue_pkts;
-    ringbufindex_shift_get_ptr(&current_neighbor->tx_ringbuf, upa_get_ptr_shift);
+    ringbufindex_shift_get_ptr(TSCH_QUEUE_TX_RINGBUF(current_neighbor), upa_get_ptr_shift);
+#if UPA_MEMOIZED_SLOT_UTILITY
+    if(upa_num_of_non_zero_in_queue_pkts > 0) {
+      tsch_queue_upa_update_tx_duration_sums(current_neighbor);
+    }
+#endif
 
 #if UPA_DBG_SLOT_TIMING /* upaTxE2: after processing ACK */
     upa_tx_slot_timestamp_end[2] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_TX_END);
 
     current_slot_idle_start = RTIMER_NOW();
     current_slot_busy_time = RTIMER_CLOCK_DIFF(current_slot_idle_start, current_slot_start);
-    current_slot_passed_slots = (current_slot_busy_time + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                                / tsch_timing[tsch_ts_timeslot_length];
-    current_slot_idle_time = current_slot_passed_slots * tsch_timing[tsch_ts_timeslot_length] - current_slot_busy_time;
+    current_slot_passed_slots = tsch_timeslots_of_duration(&tsch_current_asn, current_slot_busy_time);
+    current_slot_idle_time = tsch_duration_of_timeslots(&tsch_current_asn, current_slot_passed_slots)
+                             - current_slot_busy_time;
 
 #if HCK_ASAP_EVAL_02_UPA_SINGLE_HOP && (FIXED_NUM_OF_AGGREGATED_PKTS == 0)
     if(upa_tx_slot_all_packet_len_same == 1 
@@ -3072,7 +3364,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     ost_remove_matching_slot();
   }
   if(current_link->slotframe_handle == 1) { /* RB */
-    int queued_pkts = ringbufindex_elements(&current_neighbor->tx_ringbuf);
+    int queued_pkts = tsch_queue_nbr_packet_count(current_neighbor);
     uint16_t nbr_id = OST_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(current_neighbor));
 
     if(ost_reserved_ssq(nbr_id) && queued_pkts == 0) { /* Tx occurs by RB before reserved ssq Tx */
@@ -3117,6 +3409,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx0: start of tsch_rx_slot */
   regular_slot_timestamp_rx[0] = RTIMER_NOW();
 #endif
+  TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_START);
 
   TSCH_DEBUG_RX_EVENT();
 
@@ -3175,6 +3468,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx2: after tsch_radio_on(), start to listen */
     regular_slot_timestamp_rx[2] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_LISTEN);
 
 #if WITH_UPA || WITH_SLA || WITH_ASAP
     /* To filter out data frames received incorrectly 
@@ -3238,6 +3532,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx3: rx start time */
       regular_slot_timestamp_rx[3] = rx_start_time;
 #endif
+      TSCH_SLOT_PROFILER_MARK_AT(TSCH_SLOT_PROF_RX_FRAME_START, rx_start_time);
 
       /* Wait until packet is received, turn radio off */
       RTIMER_BUSYWAIT_UNTIL_ABS(!NETSTACK_RADIO.receiving_packet(),
@@ -3247,6 +3542,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx4: rx end time, before tsch_radio_off() */
       regular_slot_timestamp_rx[4] = RTIMER_NOW();
 #endif
+      TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_FRAME_END);
 
       tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
@@ -3383,6 +3679,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
             } else {
               current_input->sla_is_broadcast = 1;
             }
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+            current_input->sla_bc_sf = sla_get_bc_sf_of_asn(&tsch_current_asn);
+#endif
 #endif
 
             if(frame.fcf.ack_required) {
@@ -3668,6 +3967,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx9: after RADIO.prepare() */
                 regular_slot_timestamp_rx[9] = RTIMER_NOW();
 #endif
+                TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_ACK_PREPARED);
 
                 current_slot_unused_offset_start = RTIMER_NOW();
 
@@ -3689,6 +3989,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_DBG_REGULAR_SLOT_TIMING /* RegRx11: after RADIO.transmit(), before tsch_radio_off() */
                 regular_slot_timestamp_rx[11] = RTIMER_NOW();
 #endif
+                TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_ACK_END);
 
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
@@ -3743,9 +4044,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
             current_slot_idle_start = RTIMER_NOW();
             current_slot_busy_time = RTIMER_CLOCK_DIFF(current_slot_idle_start, current_slot_start);
-            current_slot_passed_slots = (current_slot_busy_time + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                                        / tsch_timing[tsch_ts_timeslot_length];
-            current_slot_idle_time = current_slot_passed_slots * tsch_timing[tsch_ts_timeslot_length] - current_slot_busy_time;
+            current_slot_passed_slots = tsch_timeslots_of_duration(&tsch_current_asn, current_slot_busy_time);
+            current_slot_idle_time = tsch_duration_of_timeslots(&tsch_current_asn, current_slot_passed_slots)
+                                     - current_slot_busy_time;
 
             /* If the neighbor is known, update its stats */
             if(n != NULL) {
@@ -3883,19 +4184,19 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       && instance->current_dag->preferred_parent != NULL 
       && linkaddr_cmp(rpl_get_parent_lladdr(instance->current_dag->preferred_parent), addr)) {
       if(a3_rx_result == 0) { //idle
-        a3_p_num_rx_pkt_idle++;
+        a3_p.num_rx_pkt_idle++;
       } else if(a3_rx_result == 1) { //success
         /* Above line compared &destination_address with &linkaddr_node_addr 
             Here compare &source_address of packet with neighbor address of current link */
         if(linkaddr_cmp(&source_address, addr)) { //HCK-A3: move this part to above
-          a3_p_num_rx_pkt_success++;
+          a3_p.num_rx_pkt_success++;
         } else {
-          a3_p_num_rx_pkt_others++;
+          a3_p.num_rx_pkt_others++;
         }
       } else if(a3_rx_result == 2) { //others
-        a3_p_num_rx_pkt_others++;
+        a3_p.num_rx_pkt_others++;
       } else {//a3_rx_result == 3 //collision
-        a3_p_num_rx_pkt_collision++;
+        a3_p.num_rx_pkt_collision++;
       }
     /* Link for child */
     } else if(addr != NULL 
@@ -3904,19 +4205,19 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)addr);
       if(it != NULL) {
         if(a3_rx_result == 0) { //idle
-          it->a3_c_num_rx_pkt_idle++;
+          it->a3_c.num_rx_pkt_idle++;
         } else if(a3_rx_result == 1) { //success
           /* Above line compared &destination_address with &linkaddr_node_addr 
             Here compare &source_address of packet with neighbor address of current link */
           if(linkaddr_cmp(&source_address, addr)) {
-            it->a3_c_num_rx_pkt_success++;
+            it->a3_c.num_rx_pkt_success++;
           } else {
-            it->a3_c_num_rx_pkt_others++;
+            it->a3_c.num_rx_pkt_others++;
           }
         } else if(a3_rx_result == 2) { //others
-          it->a3_c_num_rx_pkt_others++;
+          it->a3_c.num_rx_pkt_others++;
         } else {//a3_rx_result ==3 //collision
-          it->a3_c_num_rx_pkt_collision++;
+          it->a3_c.num_rx_pkt_collision++;
         }
       }
     }
@@ -3930,15 +4231,15 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       && instance->current_dag->preferred_parent != NULL 
       && linkaddr_cmp(rpl_get_parent_lladdr(instance->current_dag->preferred_parent), addr)) {
       if(a3_rx_result == 0) { //idle
-          a3_p_num_rx_pkt_idle++;
+          a3_p.num_rx_pkt_idle++;
       } else if(a3_rx_result == 1 || a3_rx_result == 2) { //success
         if(linkaddr_cmp(&source_address, addr)) {
-          a3_p_num_rx_pkt_success++;
+          a3_p.num_rx_pkt_success++;
         } else {
-          a3_p_num_rx_pkt_others++;
+          a3_p.num_rx_pkt_others++;
         }
       } else { //a3_rx_result ==3 //collision
-        a3_p_num_rx_pkt_collision++;
+        a3_p.num_rx_pkt_collision++;
       }
 
     //this link is from children
@@ -3948,15 +4249,15 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)addr);
       if(it != NULL) {
         if(a3_rx_result == 0) { //idle
-          it->a3_c_num_rx_pkt_idle++;
+          it->a3_c.num_rx_pkt_idle++;
         } else if(a3_rx_result == 1 || a3_rx_result == 2) { //success
           if(linkaddr_cmp(&source_address, addr)) {
-            it->a3_c_num_rx_pkt_success++;
+            it->a3_c.num_rx_pkt_success++;
           } else {
-            it->a3_c_num_rx_pkt_others++;
+            it->a3_c.num_rx_pkt_others++;
           }
         } else { //a3_rx_result ==3 //collision
-          it->a3_c_num_rx_pkt_collision++;
+          it->a3_c.num_rx_pkt_collision++;
         }
       }
     }
@@ -3964,12 +4265,20 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
   }
 #endif /* WITH_A3 */
 
+#if WITH_UPA
+  if(!upa_link_scheduled)
+#endif
+  {
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_RX_END);
+  }
+
 #if WITH_UPA
   if(upa_link_scheduled) {
 #if UPA_DBG_SLOT_TIMING /* UPARxB0: start of tsch_upa_rx_slot, before set offset */
     upa_print_rx_slot_timing = 1;
     upa_rx_slot_timestamp_begin[0] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_RX_START);
 
     upa_rx_slot_all_packet_len_same = 1;
 
@@ -3993,6 +4302,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if UPA_DBG_SLOT_TIMING /* UPARxB2: after tsch_radio_on() */
     upa_rx_slot_timestamp_begin[2] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_RX_LISTEN);
 
     upa_rx_slot_last_in_batch_seq = 0;
     upa_rx_slot_b_ack_bitmap = 0;
@@ -4229,6 +4539,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if UPA_DBG_SLOT_TIMING /* UPARxA0: before create ACK */
     upa_rx_slot_timestamp_ack[0] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK_AT(TSCH_SLOT_PROF_UPA_RX_FRAMES_END, upa_rx_slot_all_reception_end);
 
 #if WITH_OST
     upa_rx_slot_b_ack_len = tsch_packet_create_eack(upa_rx_slot_b_ack_buf, sizeof(upa_rx_slot_b_ack_buf),
@@ -4273,18 +4584,20 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if UPA_DBG_SLOT_TIMING /* UPARxE0: after RADIO.transmit() for ACK, before tsch_radio_off() */
     upa_rx_slot_timestamp_end[0] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_RX_ACK_END);
 
     tsch_radio_off(TSCH_RADIO_CMD_ON_FORCE);
 
 #if UPA_DBG_SLOT_TIMING /* UPARxE1: after tsch_radio_off() */
     upa_rx_slot_timestamp_end[1] = RTIMER_NOW();
 #endif
+    TSCH_SLOT_PROFILER_MARK(TSCH_SLOT_PROF_UPA_RX_END);
 
     current_slot_idle_start = RTIMER_NOW();
     current_slot_busy_time = RTIMER_CLOCK_DIFF(current_slot_idle_start, current_slot_start);
-    current_slot_passed_slots = (current_slot_busy_time + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                                / tsch_timing[tsch_ts_timeslot_length];
-    current_slot_idle_time = current_slot_passed_slots * tsch_timing[tsch_ts_timeslot_length] - current_slot_busy_time;
+    current_slot_passed_slots = tsch_timeslots_of_duration(&tsch_current_asn, current_slot_busy_time);
+    current_slot_idle_time = tsch_duration_of_timeslots(&tsch_current_asn, current_slot_passed_slots)
+                             - current_slot_busy_time;
 
     if(current_link->slotframe_handle == TSCH_SCHED_COMMON_SF_HANDLE) {
       tsch_common_sf_upa_rx_ok_count += upa_rx_slot_batch_rx_ok_count;
@@ -4328,8 +4641,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
     if((tsch_current_asn.ls4b == sla_triggering_asn.ls4b) 
         && (tsch_current_asn.ms1b == sla_triggering_asn.ms1b)) {
       uint16_t sla_prev_timeslot_length = tsch_timing_us[tsch_ts_timeslot_length];
-      if(tsch_timing_us[tsch_ts_timeslot_length] != sla_next_timeslot_length) {
+      if(sla_timeslot_length_changes()) {
         sla_apply_next_timeslot_length();
+        TSCH_METRICS_ADD(TSCH_METRIC_SLA_TIMESLOT_CHANGES, 1);
 
 #if SLA_DBG_ESSENTIAL
         TSCH_LOG_ADD(tsch_log_message,
@@ -4356,7 +4670,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
     } else if((int32_t)(TSCH_ASN_DIFF(sla_triggering_asn, tsch_current_asn)) > 0) {
       // SLA-TODO: needs to consider ASN overflow
       if((int32_t)(TSCH_ASN_DIFF(sla_triggering_asn, tsch_current_asn) <= SLA_GUARD_TIME_TIMESLOTS)) {
-        if(tsch_timing_us[tsch_ts_timeslot_length] != sla_next_timeslot_length) {
+        if(sla_timeslot_length_changes()) {
           sla_in_guard_time = 1;
         } else {
           sla_in_guard_time = 0;
@@ -4373,6 +4687,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
     if(upa_schedule_after_upa_link) { /* Successful scheduling after UPA */
       upa_schedule_after_upa_link = 0;
       if(upa_pkts_to_send > 0) {
+        TSCH_METRICS_SAMPLE(TSCH_METRIC_UPA_BATCH_PKTS, upa_pkts_to_send);
+        TSCH_METRICS_SAMPLE(TSCH_METRIC_UPA_BATCH_SLOTS, asap_curr_passed_timeslots_except_first_slot);
+        TSCH_METRICS_ADD(TSCH_METRIC_UPA_BATCH_OK, upa_tx_slot_batch_tx_ok_count);
         if(upa_link_result_case == 1) {
           tsch_common_sf_upa_tx_timeslots += asap_curr_passed_timeslots_except_first_slot;
 #if UPA_DBG_ESSENTIAL
@@ -4531,6 +4848,10 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 #endif
       ) { /* Skip slot operation if there is no link
                                                           or if there is a pending request for getting the lock */
+      if(tsch_locked || tsch_lock_requested) {
+        tsch_lock_skip_count++;
+      }
+
       /* Issue a log whenever skipping a slot */
 
 #if WITH_SLA && SLA_DBG_ESSENTIAL
@@ -4582,6 +4903,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       int is_active_slot;
       TSCH_DEBUG_SLOT_START();
       tsch_in_slot_operation = 1;
+      tsch_slot_profiler_slot_start(current_slot_start);
       /* Measure on-air noise level while TSCH is idle */
       tsch_stats_sample_rssi();
       /* Reset drift correction */
@@ -4885,6 +5207,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 ost_donothing:
 #endif
 
+      tsch_slot_profiler_slot_end(tsch_duration_of_timeslots(&tsch_current_asn, 1));
       TSCH_DEBUG_SLOT_END();
     }
 
@@ -4960,8 +5283,8 @@ ost_donothing:
     if(RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start) == 0) {
       asap_curr_passed_timeslots = 1;
     } else {
-      asap_curr_passed_timeslots = ((RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start) + tsch_timing[tsch_ts_timeslot_length] - 1) 
-                              / tsch_timing[tsch_ts_timeslot_length]);
+      asap_curr_passed_timeslots = tsch_timeslots_of_duration(&tsch_current_asn,
+                                                              RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start));
     }
     asap_curr_passed_timeslots_except_first_slot = asap_curr_passed_timeslots - 1;
 
@@ -4975,7 +5298,7 @@ ost_donothing:
                       snprintf(log->message, sizeof(log->message),
                           "!overflowed ts %u %u %d %d", 
                           RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start), 
-                          tsch_timing[tsch_ts_timeslot_length], 
+                          tsch_duration_of_timeslots(&tsch_current_asn, 1), 
                           asap_curr_passed_timeslots,
                           asap_curr_passed_timeslots_except_first_slot);
       );
@@ -5302,7 +5625,7 @@ ost_donothing:
           asap_curr_slot_start,
           (unsigned)RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start),
           asap_curr_passed_timeslots,
-          asap_curr_passed_timeslots * tsch_timing[tsch_ts_timeslot_length] 
+          tsch_duration_of_timeslots(&tsch_current_asn, asap_curr_passed_timeslots)
             - RTIMER_CLOCK_DIFF(asap_curr_slot_end, asap_curr_slot_start)));
     }
 #endif
@@ -5352,6 +5675,9 @@ ost_donothing:
           ++asap_curr_passed_timeslots_except_first_slot;
 
           if(upa_pkts_to_send > 0) {
+            TSCH_METRICS_SAMPLE(TSCH_METRIC_UPA_BATCH_PKTS, upa_pkts_to_send);
+            TSCH_METRICS_SAMPLE(TSCH_METRIC_UPA_BATCH_SLOTS, asap_curr_passed_timeslots_except_first_slot);
+            TSCH_METRICS_ADD(TSCH_METRIC_UPA_BATCH_OK, upa_tx_slot_batch_tx_ok_count);
             if(upa_link_result_case == 1) {
               tsch_common_sf_upa_tx_timeslots += asap_curr_passed_timeslots_except_first_slot;
 #if UPA_DBG_ESSENTIAL
@@ -5609,7 +5935,11 @@ ost_donothing:
 #endif
 
         /* Time to next wake up */
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+        time_to_next_active_slot = sla_get_duration_of_timeslots_before(&tsch_current_asn, timeslot_diff) + drift_correction;
+#else
         time_to_next_active_slot = timeslot_diff * tsch_timing[tsch_ts_timeslot_length] + drift_correction;
+#endif
 
 #if WITH_ASAP && ASAP_DBG_SLOT_END
         if(upa_link_finished) {
@@ -5676,7 +6006,11 @@ tsch_slot_operation_start(void)
 #endif
 
     /* Time to next wake up */
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+    time_to_next_active_slot = sla_get_duration_of_timeslots_before(&tsch_current_asn, timeslot_diff);
+#else
     time_to_next_active_slot = timeslot_diff * tsch_timing[tsch_ts_timeslot_length];
+#endif
     /* Compensate for the base drift */
     time_to_next_active_slot += tsch_timesync_adaptive_compensate(time_to_next_active_slot);
     /* Update current slot start */
@@ -63,6 +63,16 @@ extern int tsch_current_burst_count;
 /********** Functions *********/
 
 uint64_t tsch_calculate_current_asn();
+/* Number of timeslots from asn needed to cover duration (rtimer ticks),
+ * with the timeslot length of each ASN */
+uint16_t tsch_timeslots_of_duration(const struct tsch_asn_t *asn, rtimer_clock_t duration);
+/* Duration (rtimer ticks) of timeslots from asn */
+rtimer_clock_t tsch_duration_of_timeslots(const struct tsch_asn_t *asn, uint16_t timeslots);
+
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+/* Broadcast slotframe (enum sla_bc_sf) whose network-wide cell is at asn, SLA_BC_SF_NONE if none */
+uint8_t sla_get_bc_sf_of_asn(const struct tsch_asn_t *asn);
+#endif
 
 /**
  * Checks if the TSCH lock is set. Accesses to global structures outside of
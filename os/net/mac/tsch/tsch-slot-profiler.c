@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Slot profiler: per-phase timing statistics of TSCH slots
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-slot-profiler.h"
+#include <string.h>
+
+#if TSCH_SLOT_PROFILER
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "TSCH"
+#define LOG_LEVEL LOG_LEVEL_MAC
+
+/* Histogram buckets, in microseconds: four linear buckets of 16 us below
+ * 64 us, then four buckets per power of two up to 65535 us (bucket width
+ * below 25% of the value) */
+#define PROF_LINEAR_BUCKETS     4
+#define PROF_LINEAR_WIDTH_LOG2  4
+#define PROF_FIRST_OCTAVE       6
+#define PROF_SUB_BUCKETS_LOG2   2
+#define PROF_BUCKET_NUM         (PROF_LINEAR_BUCKETS + (16 - PROF_FIRST_OCTAVE) * (1 << PROF_SUB_BUCKETS_LOG2))
+
+struct prof_phase_stats {
+  uint64_t sum;
+  uint32_t count;
+  uint16_t min;
+  uint16_t max;
+  uint16_t overruns;
+  uint16_t buckets[PROF_BUCKET_NUM];
+};
+
+static struct prof_phase_stats prof_stats[TSCH_SLOT_PROF_PHASE_NUM];
+static uint32_t prof_total_overruns;
+
+/* Phases of the current slot, kept as ticks from the slot start and only
+ * added to the statistics at the end of the slot */
+static rtimer_clock_t prof_slot_start;
+static int32_t prof_mark[TSCH_SLOT_PROF_PHASE_NUM];
+static uint32_t prof_marked;
+static int8_t prof_last_phase = -1;
+
+static const char *const prof_phase_names[TSCH_SLOT_PROF_PHASE_NUM] = {
+  "tx_start", "tx_prepared", "tx_cca_done", "tx_frame_start", "tx_frame_end",
+  "tx_ack_start", "tx_ack_end", "tx_end", "tx_slack",
+  "rx_start", "rx_listen", "rx_frame_start", "rx_frame_end",
+  "rx_ack_prepared", "rx_ack_end", "rx_end", "rx_slack",
+  "upa_tx_start", "upa_tx_burst_ready", "upa_tx_frames_end", "upa_tx_ack_end", "upa_tx_end",
+  "upa_rx_start", "upa_rx_listen", "upa_rx_frames_end", "upa_rx_ack_end", "upa_rx_end",
+};
+
+#if TSCH_SLOT_PROF_PHASE_NUM > 32
+#error The slot profiler supports up to 32 phases
+#endif
+/*---------------------------------------------------------------------------*/
+static uint8_t
+bucket_of(uint16_t us)
+{
+  uint8_t msb = PROF_FIRST_OCTAVE;
+
+  if(us < (1 << PROF_FIRST_OCTAVE)) {
+    return us >> PROF_LINEAR_WIDTH_LOG2;
+  }
+  while((us >> (msb + 1)) != 0) {
+    msb++;
+  }
+  return PROF_LINEAR_BUCKETS
+    + ((msb - PROF_FIRST_OCTAVE) << PROF_SUB_BUCKETS_LOG2)
+    + ((us >> (msb - PROF_SUB_BUCKETS_LOG2)) & ((1 << PROF_SUB_BUCKETS_LOG2) - 1));
+}
+/*---------------------------------------------------------------------------*/
+/* Exclusive upper bound of a bucket */
+static uint32_t
+bucket_upper_bound(uint8_t b)
+{
+  uint8_t msb;
+  uint8_t sub;
+
+  if(b < PROF_LINEAR_BUCKETS) {
+    return (uint32_t)(b + 1) << PROF_LINEAR_WIDTH_LOG2;
+  }
+  msb = PROF_FIRST_OCTAVE + ((b - PROF_LINEAR_BUCKETS) >> PROF_SUB_BUCKETS_LOG2);
+  sub = (b - PROF_LINEAR_BUCKETS) & ((1 << PROF_SUB_BUCKETS_LOG2) - 1);
+  return (1UL << msb) + ((uint32_t)(sub + 1) << (msb - PROF_SUB_BUCKETS_LOG2));
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_sample(struct prof_phase_stats *s, int32_t ticks)
+{
+  uint32_t us = ticks > 0 ? RTIMERTICKS_TO_US(ticks) : 0;
+  uint8_t b;
+  uint8_t i;
+
+  if(us > 0xffff) {
+    us = 0xffff;
+  }
+  if(s->count == 0 || us < s->min) {
+    s->min = us;
+  }
+  if(us > s->max) {
+    s->max = us;
+  }
+  s->sum += us;
+  s->count++;
+
+  b = bucket_of(us);
+  if(s->buckets[b] == 0xffff) {
+    /* Halve the histogram, which keeps its shape */
+    for(i = 0; i < PROF_BUCKET_NUM; i++) {
+      s->buckets[i] >>= 1;
+    }
+  }
+  s->buckets[b]++;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_slot_start(rtimer_clock_t slot_start)
+{
+  prof_slot_start = slot_start;
+  prof_marked = 0;
+  prof_last_phase = -1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_mark(enum tsch_slot_profiler_phase phase, rtimer_clock_t t)
+{
+  prof_mark[phase] = RTIMER_CLOCK_DIFF(t, prof_slot_start);
+  prof_marked |= 1UL << phase;
+  prof_last_phase = phase;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_overrun(void)
+{
+  prof_total_overruns++;
+  if(prof_last_phase >= 0) {
+    prof_stats[prof_last_phase].overruns++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_slack(enum tsch_slot_profiler_phase end, enum tsch_slot_profiler_phase slack,
+          rtimer_clock_t timeslot_length)
+{
+  int32_t ticks;
+
+  if(prof_marked & (1UL << end)) {
+    ticks = (int32_t)timeslot_length - prof_mark[end];
+    if(ticks < 0) {
+      /* The slot operation ran into the next timeslot */
+      prof_stats[slack].overruns++;
+    }
+    add_sample(&prof_stats[slack], ticks);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_slot_end(rtimer_clock_t timeslot_length)
+{
+  uint8_t i;
+
+  add_slack(TSCH_SLOT_PROF_TX_END, TSCH_SLOT_PROF_TX_SLACK, timeslot_length);
+  add_slack(TSCH_SLOT_PROF_RX_END, TSCH_SLOT_PROF_RX_SLACK, timeslot_length);
+
+  for(i = 0; i < TSCH_SLOT_PROF_PHASE_NUM; i++) {
+    if(prof_marked & (1UL << i)) {
+      add_sample(&prof_stats[i], prof_mark[i]);
+    }
+  }
+  prof_marked = 0;
+  prof_last_phase = -1;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_slot_profiler_get(enum tsch_slot_profiler_phase phase, struct tsch_slot_profiler_summary *s)
+{
+  const struct prof_phase_stats *p = &prof_stats[phase];
+  uint32_t total = 0;
+  uint32_t target;
+  uint32_t seen = 0;
+  uint32_t upper;
+  uint8_t i;
+
+  s->count = p->count;
+  s->overruns = p->overruns;
+  if(p->count == 0) {
+    s->min = s->mean = s->max = s->p99 = 0;
+    return 0;
+  }
+  s->min = p->min;
+  s->max = p->max;
+  s->mean = p->sum / p->count;
+
+  /* p99: upper bound of the bucket holding the 99th percentile, or max */
+  for(i = 0; i < PROF_BUCKET_NUM; i++) {
+    total += p->buckets[i];
+  }
+  target = (total * 99 + 99) / 100;
+  s->p99 = p->max;
+  for(i = 0; i < PROF_BUCKET_NUM; i++) {
+    seen += p->buckets[i];
+    if(seen >= target) {
+      upper = bucket_upper_bound(i) - 1;
+      if(upper < s->p99) {
+        s->p99 = upper;
+      }
+      break;
+    }
+  }
+  if(s->p99 < s->min) {
+    s->p99 = s->min;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_slot_profiler_phase_name(enum tsch_slot_profiler_phase phase)
+{
+  return phase < TSCH_SLOT_PROF_PHASE_NUM ? prof_phase_names[phase] : "?";
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+tsch_slot_profiler_total_overruns(void)
+{
+  return prof_total_overruns;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_print(void)
+{
+  struct tsch_slot_profiler_summary s;
+  uint8_t i;
+
+  for(i = 0; i < TSCH_SLOT_PROF_PHASE_NUM; i++) {
+    if(tsch_slot_profiler_get(i, &s)) {
+      LOG_HK("prof %s n %lu min %u avg %u max %u p99 %u ovr %u |\n",
+             prof_phase_names[i], (unsigned long)s.count,
+             s.min, s.mean, s.max, s.p99, s.overruns);
+    }
+  }
+  LOG_HK("prof_ovr %lu |\n", (unsigned long)prof_total_overruns);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_profiler_reset(void)
+{
+  memset(prof_stats, 0, sizeof(prof_stats));
+  prof_total_overruns = 0;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_SLOT_PROFILER */
+/** @} */
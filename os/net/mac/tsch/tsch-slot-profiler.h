@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+ * \file
+ *         Slot profiler: time of named phases from the start of the slot,
+ *         with per-phase min/mean/max/p99 kept in fixed memory, and
+ *         deadline misses (overruns) counted on the phase they follow.
+ */
+
+#ifndef __TSCH_SLOT_PROFILER_H__
+#define __TSCH_SLOT_PROFILER_H__
+
+#include "contiki.h"
+
+/******** Configuration *******/
+
+/* Enable the slot profiler */
+#ifdef TSCH_CONF_SLOT_PROFILER
+#define TSCH_SLOT_PROFILER TSCH_CONF_SLOT_PROFILER
+#else /* TSCH_CONF_SLOT_PROFILER */
+#define TSCH_SLOT_PROFILER 0
+#endif /* TSCH_CONF_SLOT_PROFILER */
+
+/************ Types ***********/
+
+/** \brief Phases of a slot. Each one is the time from the slot start, except
+ * SLACK, the time left from the end of the slot operation to the end of the
+ * timeslot (min is the worst case) */
+enum tsch_slot_profiler_phase {
+  /* Regular Tx slot */
+  TSCH_SLOT_PROF_TX_START,
+  TSCH_SLOT_PROF_TX_PREPARED,
+  TSCH_SLOT_PROF_TX_CCA_DONE,
+  TSCH_SLOT_PROF_TX_FRAME_START,
+  TSCH_SLOT_PROF_TX_FRAME_END,
+  TSCH_SLOT_PROF_TX_ACK_START,
+  TSCH_SLOT_PROF_TX_ACK_END,
+  TSCH_SLOT_PROF_TX_END,
+  TSCH_SLOT_PROF_TX_SLACK,
+  /* Regular Rx slot */
+  TSCH_SLOT_PROF_RX_START,
+  TSCH_SLOT_PROF_RX_LISTEN,
+  TSCH_SLOT_PROF_RX_FRAME_START,
+  TSCH_SLOT_PROF_RX_FRAME_END,
+  TSCH_SLOT_PROF_RX_ACK_PREPARED,
+  TSCH_SLOT_PROF_RX_ACK_END,
+  TSCH_SLOT_PROF_RX_END,
+  TSCH_SLOT_PROF_RX_SLACK,
+  /* UPA Tx slot */
+  TSCH_SLOT_PROF_UPA_TX_START,
+  TSCH_SLOT_PROF_UPA_TX_BURST_READY,
+  TSCH_SLOT_PROF_UPA_TX_FRAMES_END,
+  TSCH_SLOT_PROF_UPA_TX_ACK_END,
+  TSCH_SLOT_PROF_UPA_TX_END,
+  /* UPA Rx slot */
+  TSCH_SLOT_PROF_UPA_RX_START,
+  TSCH_SLOT_PROF_UPA_RX_LISTEN,
+  TSCH_SLOT_PROF_UPA_RX_FRAMES_END,
+  TSCH_SLOT_PROF_UPA_RX_ACK_END,
+  TSCH_SLOT_PROF_UPA_RX_END,
+  TSCH_SLOT_PROF_PHASE_NUM
+};
+
+/** \brief Summary of a phase, in microseconds */
+struct tsch_slot_profiler_summary {
+  uint32_t count;
+  uint16_t min;
+  uint16_t mean;
+  uint16_t max;
+  uint16_t p99;
+  uint16_t overruns;
+};
+
+#if TSCH_SLOT_PROFILER
+
+/********** Functions *********/
+
+/**
+ * \brief Start profiling a slot
+ * \param slot_start The start of the slot
+ */
+void tsch_slot_profiler_slot_start(rtimer_clock_t slot_start);
+/**
+ * \brief Record the time of a phase in the current slot
+ * \param phase The phase
+ * \param t The time the phase was reached
+ */
+void tsch_slot_profiler_mark(enum tsch_slot_profiler_phase phase, rtimer_clock_t t);
+/**
+ * \brief Count a deadline miss, on the last phase reached in the current slot
+ */
+void tsch_slot_profiler_overrun(void);
+/**
+ * \brief End profiling a slot and add its phases to the statistics
+ * \param timeslot_length The length of the timeslot, to compute the slack
+ */
+void tsch_slot_profiler_slot_end(rtimer_clock_t timeslot_length);
+/**
+ * \brief Get the summary of a phase
+ * \param phase The phase
+ * \param s The summary to fill
+ * \return 1 if the phase was reached at least once, 0 otherwise
+ */
+int tsch_slot_profiler_get(enum tsch_slot_profiler_phase phase, struct tsch_slot_profiler_summary *s);
+/**
+ * \brief Get the name of a phase
+ */
+const char *tsch_slot_profiler_phase_name(enum tsch_slot_profiler_phase phase);
+/**
+ * \brief Total number of deadline misses during profiled slots
+ */
+uint32_t tsch_slot_profiler_total_overruns(void);
+/**
+ * \brief Print the summary of all reached phases to the log
+ */
+void tsch_slot_profiler_print(void);
+/**
+ * \brief Clear the statistics
+ */
+void tsch_slot_profiler_reset(void);
+
+/************ Macros **********/
+
+#define TSCH_SLOT_PROFILER_MARK(phase) tsch_slot_profiler_mark((phase), RTIMER_NOW())
+#define TSCH_SLOT_PROFILER_MARK_AT(phase, t) tsch_slot_profiler_mark((phase), (t))
+
+#else /* TSCH_SLOT_PROFILER */
+
+#define tsch_slot_profiler_slot_start(slot_start)
+#define tsch_slot_profiler_overrun()
+#define tsch_slot_profiler_slot_end(timeslot_length)
+#define tsch_slot_profiler_print()
+#define tsch_slot_profiler_reset()
+#define TSCH_SLOT_PROFILER_MARK(phase)
+#define TSCH_SLOT_PROFILER_MARK_AT(phase, t)
+
+#endif /* TSCH_SLOT_PROFILER */
+
+#endif /* __TSCH_SLOT_PROFILER_H__ */
+/** @} */
@@ -44,6 +44,10 @@
 #define LOG_MODULE "TSCH Stats"
 #define LOG_LEVEL LOG_LEVEL_MAC
 
+/*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_CLASSES
+struct tsch_queue_class_stats tsch_queue_class_stats[TSCH_QUEUE_NUM_CLASSES];
+#endif
 /*---------------------------------------------------------------------------*/
 #if TSCH_STATS_ON
 /*---------------------------------------------------------------------------*/
@@ -166,9 +166,30 @@ struct tsch_neighbor_stats {
 
 struct tsch_neighbor; /* Forward declaration */
 
+#if TSCH_QUEUE_WITH_CLASSES
+/* Per traffic class statistics of the neighbor queues (see TSCH_QUEUE_CLASS_*) */
+struct tsch_queue_class_stats {
+  /* packets added to a neighbor queue */
+  uint32_t enqueued;
+  /* packets rejected at enqueue: queue or packet pool full, or no link */
+  uint32_t qloss;
+  /* packets dropped before Tx, past their deadline */
+  uint32_t expired;
+  /* packets passed to the upper layer as sent */
+  uint32_t tx_ok;
+  /* packets passed to the upper layer as failed (including expired) */
+  uint32_t tx_err;
+};
+#endif
+
 
 /************ External variables ***********/
 
+#if TSCH_QUEUE_WITH_CLASSES
+/* Collected regardless of TSCH_STATS_ON */
+extern struct tsch_queue_class_stats tsch_queue_class_stats[TSCH_QUEUE_NUM_CLASSES];
+#endif
+
 #if TSCH_STATS_ON
 
 /* Statistics for the local node */
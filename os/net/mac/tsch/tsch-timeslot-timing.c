@@ -128,11 +128,20 @@ const tsch_timeslot_timing_usec tsch_timeslot_timing_us_10000 = {
 
 #if WITH_UPA
 #define UPA_RX_WAIT 300
+/* Gap before each frame after the first one of a batch. It must be the same on all nodes.
+ * Tx needs 30 ticks when each frame is parsed and prepared in the gap; with UPA_BURST_ASSEMBLY
+ * and a radio implementing prepare_burst it can be cut down to the Rx turnaround. Only
+ * the iotlab rf2xx implements prepare_burst: cc2538 nodes need the default gap. */
+#ifdef UPA_CONF_TS_TX_OFFSET_2
+#define UPA_TS_TX_OFFSET_2 UPA_CONF_TS_TX_OFFSET_2
+#else
+#define UPA_TS_TX_OFFSET_2 1000
+#endif
 const upa_timeslot_timing_usec upa_timeslot_timing_us_10000 = {
    1250, /* upa_ts_tx_offset_1 (41 ticks required) */
    (1250 - (UPA_RX_WAIT / 2)), /* upa_ts_rx_offset_1 */
-   1000, /* upa_ts_tx_offset_2 (30 ticks required, 1000 == 33 ticks) */
-   (1000 - (UPA_RX_WAIT / 2)), /* upa_ts_rx_offset_2 */
+   UPA_TS_TX_OFFSET_2, /* upa_ts_tx_offset_2 (30 ticks required, 1000 == 33 ticks) */
+   (UPA_TS_TX_OFFSET_2 - (UPA_RX_WAIT / 2)), /* upa_ts_rx_offset_2 */
    1050, /* upa_ts_rx_ack_delay */
    1250, /* upa_ts_tx_ack_delay */
   UPA_RX_WAIT, /* upa_ts_rx_wait */
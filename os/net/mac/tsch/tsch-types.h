@@ -67,6 +67,13 @@ struct tsch_link {
   linkaddr_t addr;
 #if WITH_A3
   linkaddr_t a3_nbr_addr;
+#endif
+#if WITH_ALICE && ALICE_INCREMENTAL_RESCHEDULING
+  /* ALICE: link-based hash of (sender, receiver), precomputed once so that
+   * the link can be moved to the cell of the next ASFN in place */
+  uint32_t alice_link_hash;
+  /* ALICE: link options of this link before being merged with overlapping links */
+  uint8_t alice_link_options;
 #endif
   /* Slotframe identifier */
   uint16_t slotframe_handle;
@@ -98,6 +105,15 @@ struct tsch_slotframe {
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
+#if TSCH_SCHEDULE_WITH_INDEX
+  /* Run of the links of this slotframe in the timeslot-sorted link index */
+  uint16_t index_first;
+  uint16_t index_count;
+  /* Position of this slotframe in the slotframe list */
+  uint16_t index_order;
+  /* ASN of the next occurrence of a link of this slotframe */
+  struct tsch_asn_t index_next_asn;
+#endif
 };
 
 /** \brief TSCH packet information */
@@ -110,13 +126,25 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if TSCH_QUEUE_WITH_CLASSES
+  uint8_t tx_class; /* Traffic class, see TSCH_QUEUE_CLASS_* */
+  uint8_t has_deadline; /* Is the packet dropped when still queued after deadline_asn? */
+  struct tsch_asn_t deadline_asn; /* Last ASN the packet may be sent at */
+#endif
 
 #if WITH_SLA
   uint8_t sla_is_broadcast;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  uint8_t sla_bc_sf; /* Broadcast slotframe of the timeslot the packet was sent in */
+#endif
 #endif
 #if WITH_UPA && UPA_NO_ETX_UPDATE_FROM_PACKETS_IN_BATCH
   uint8_t upa_sent_in_batch;
 #endif
+#if WITH_UPA && UPA_MEMOIZED_SLOT_UTILITY
+  uint16_t upa_tx_duration; /* TSCH_PACKET_DURATION of the frame, computed once at enqueue */
+  uint32_t upa_tx_duration_sum; /* Running sum of upa_tx_duration of its class up to this packet */
+#endif
 
 #if WITH_OST
   uip_ds6_nbr_t *ost_prt_nbr;
@@ -128,6 +156,22 @@ struct tsch_packet {
 #endif
 };
 
+#if WITH_ALICE && ALICE_PACKET_CELL_MATCHING_CACHE
+/* ALICE: max number of Tx cells cached per neighbor (A3 allocates up to A3_MAX_ZONE) */
+#if WITH_A3
+#define ALICE_PCM_CACHE_MAX_CELLS A3_MAX_ZONE
+#else
+#define ALICE_PCM_CACHE_MAX_CELLS 1
+#endif
+#endif
+
+#if TSCH_QUEUE_WITH_SHARED_POOL
+/* Index of a packet in the shared pool of QUEUEBUF_NUM packets */
+typedef uint8_t tsch_queue_entry_t;
+#else
+typedef struct tsch_packet *tsch_queue_entry_t;
+#endif
+
 /** \brief TSCH neighbor information */
 struct tsch_neighbor {
   uint8_t is_broadcast; /* is this neighbor a virtual neighbor used for broadcast (of data packets or EBs) */
@@ -137,11 +181,37 @@ struct tsch_neighbor {
   uint8_t last_backoff_window; /* Last CSMA backoff window */
   uint8_t tx_links_count; /* How many links do we have to this neighbor? */
   uint8_t dedicated_tx_links_count; /* How many dedicated links do we have to this neighbor? */
-  /* Array for the ringbuf. Contains pointers to packets.
-   * Its size must be a power of two to allow for atomic put */
-  struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
+#if TSCH_QUEUE_WITH_CLASSES
+  /* One ringbuf per traffic class, accessed through TSCH_QUEUE_PACKET()
+   * and TSCH_QUEUE_RINGBUF() */
+  tsch_queue_entry_t tx_array[TSCH_QUEUE_NUM_CLASSES][TSCH_QUEUE_NUM_PER_NEIGHBOR];
+  struct ringbufindex tx_ringbuf[TSCH_QUEUE_NUM_CLASSES];
+  uint8_t tx_class; /* Class of the packet last returned for Tx */
+  uint8_t tx_class_credit; /* Dequeues left to tx_class in the WRR round */
+#else
+  /* Array for the ringbuf. Contains pointers to packets (indices with
+   * TSCH_QUEUE_WITH_SHARED_POOL). Its size must be a power of two to allow
+   * for atomic put */
+  tsch_queue_entry_t tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
   /* Circular buffer of pointers to packet. */
   struct ringbufindex tx_ringbuf;
+#endif
+#if WITH_ALICE && ALICE_PACKET_CELL_MATCHING_CACHE
+  /* ALICE: Tx cells to this neighbor in the unicast slotframe,
+   * valid for the ASFN and the RPL neighbor set they were computed for */
+  uint64_t alice_pcm_asfn;
+  uint16_t alice_pcm_epoch;
+  uint8_t alice_pcm_is_rpl_nbr;
+  uint8_t alice_pcm_num_cells;
+  uint16_t alice_pcm_timeslot[ALICE_PCM_CACHE_MAX_CELLS];
+  uint16_t alice_pcm_channel_offset[ALICE_PCM_CACHE_MAX_CELLS];
+#endif
+#if WITH_UPA && UPA_MEMOIZED_SLOT_UTILITY
+  /* UPA: running sum of the Tx durations of all packets ever enqueued (per class).
+   * Each queued packet keeps its value right after it was enqueued, so the
+   * Tx duration of any run of queued packets is the difference of two sums. */
+  uint32_t upa_tx_duration_total[TSCH_QUEUE_NUM_CLASSES];
+#endif
 };
 
 /** \brief TSCH timeslot timing elements. Used to index timeslot timing
@@ -183,6 +253,17 @@ enum upa_timeslot_timing_elements {
 #endif
 
 
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+/** \brief SLA: broadcast slotframes whose network-wide cells have their own
+ * timeslot length. All other timeslots use tsch_ts_timeslot_length. Only the
+ * common shared cell is network-wide: EB cells are per time source. */
+enum sla_bc_sf {
+  SLA_BC_SF_COMMON,
+  SLA_BC_SF_COUNT,
+};
+#define SLA_BC_SF_NONE SLA_BC_SF_COUNT
+#endif
+
 /** \brief TSCH timeslot timing elements in rtimer ticks */
 typedef rtimer_clock_t tsch_timeslot_timing_ticks[tsch_ts_elements_count];
 
@@ -204,6 +285,9 @@ struct input_packet {
 
 #if WITH_SLA
   uint8_t sla_is_broadcast;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  uint8_t sla_bc_sf; /* Broadcast slotframe of the timeslot the packet was received in */
+#endif
 #endif
 #if WITH_UPA
   uint8_t upa_received_in_batch;
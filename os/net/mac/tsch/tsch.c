@@ -58,6 +58,10 @@
 #include "lib/random.h"
 #include "net/routing/routing.h"
 
+#if WITH_SLA && SLA_QUANTILE_ESTIMATOR
+#include "net/mac/tsch/tsch-sla-quantile.h"
+#endif
+
 #if TSCH_WITH_SIXTOP
 #include "net/mac/tsch/sixtop/sixtop.h"
 #endif
@@ -87,11 +91,21 @@ static uint16_t sla_observed_bc_frame_count[SLA_OBSERVATION_WINDOWS];
 static uint16_t sla_observed_uc_frame_count[SLA_OBSERVATION_WINDOWS];
 static uint16_t sla_observed_ack_count[SLA_OBSERVATION_WINDOWS];
 static uint16_t sla_max_hop_distance[SLA_OBSERVATION_WINDOWS];
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+/* Frames, unicast frames and longest broadcast frame (includes
+ * RADIO_PHY_OVERHEAD) observed in the network-wide cells of each broadcast slotframe */
+static uint16_t sla_observed_bc_sf_frame_count[SLA_OBSERVATION_WINDOWS][SLA_BC_SF_COUNT];
+static uint16_t sla_observed_bc_sf_uc_frame_count[SLA_OBSERVATION_WINDOWS][SLA_BC_SF_COUNT];
+static uint8_t sla_observed_bc_sf_max_frame_len[SLA_OBSERVATION_WINDOWS][SLA_BC_SF_COUNT];
+#endif
 
 static uint16_t sla_curr_ref_hop_distance = SLA_INITIAL_HOP_DISTANCE;
 
 struct tsch_asn_t sla_triggering_asn;
 uint16_t sla_next_timeslot_length;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+uint16_t sla_next_bc_sf_timeslot_length[SLA_BC_SF_COUNT];
+#endif
 
 /* Used by SLA coordinator */
 static uint8_t sla_curr_ref_bc_frame_len = SLA_MAX_FRAME_LEN; /* Includes RADIO_PHY_OVERHEAD */
@@ -103,6 +117,13 @@ static uint8_t sla_next_ref_ack_len = SLA_MAX_ACK_LEN; /* Includes RADIO_PHY_OVE
 
 static uint16_t sla_eb_packet_qloss_count;
 static uint16_t sla_eb_packet_enqueue_count;
+
+#if SLA_QUANTILE_ESTIMATOR
+/* Streaming estimators of the k-th percentile lengths (include RADIO_PHY_OVERHEAD) */
+static struct sla_quantile sla_bc_frame_len_estimator;
+static struct sla_quantile sla_uc_frame_len_estimator;
+static struct sla_quantile sla_ack_len_estimator;
+#endif
 #endif
 
 /* hckim measure associated cell counts */
@@ -161,6 +182,13 @@ uint16_t tsch_input_ringbuf_available_count;
 uint16_t tsch_dequeued_ringbuf_full_count;
 uint16_t tsch_dequeued_ringbuf_available_count;
 
+/* TSCH lock: locks taken, locks that waited for the end of a slot operation,
+   failures, and slots skipped while the lock was held or requested */
+uint32_t tsch_lock_count;
+uint32_t tsch_lock_wait_count;
+uint32_t tsch_lock_fail_count;
+uint32_t tsch_lock_skip_count;
+
 /* hckim measure cell utilization during association */
 uint32_t tsch_scheduled_eb_sf_cell_count;
 uint32_t tsch_scheduled_common_sf_cell_count;
@@ -248,6 +276,29 @@ uint32_t tsch_ost_pp_sf_upa_rx_timeslots;
 uint16_t alice_early_packet_drop_count;
 #endif
 
+#if TSCH_QUEUE_WITH_SHARED_POOL
+/* Packets admitted above the per-neighbor minimum of the shared pool,
+   and packets dropped by the per-neighbor quota */
+uint32_t tsch_queue_pool_borrow_count;
+uint32_t tsch_queue_pool_quota_drop_count;
+#endif
+
+#if TSCH_WITH_RX_BATCH
+/* Batches of consecutive data frames from the same sender (two frames or
+   more), and the frames in these batches */
+uint32_t tsch_rx_batch_count;
+uint32_t tsch_rx_batch_frame_count;
+#endif
+
+#if WITH_ALICE && ALICE_DBG_PCM_CYCLES
+/* Packet-cell matching calls, cache misses (or lookups without cache) and their cost
+   in CPU cycles (rtimer ticks on platforms without cycle counter) */
+uint32_t alice_pcm_call_count;
+uint32_t alice_pcm_miss_count;
+uint32_t alice_pcm_cycles_sum;
+uint32_t alice_pcm_cycles_max;
+#endif
+
 /*---------------------------------------------------------------------------*/
 void print_log_tsch()
 {
@@ -255,12 +306,82 @@ void print_log_tsch()
   LOG_HK("e_drop %u |\n", alice_early_packet_drop_count);
 #endif
 
+#if WITH_ALICE && ALICE_DBG_PCM_CYCLES
+  LOG_HK("pcm_call %lu pcm_miss %lu pcm_cyc %lu pcm_max %lu |\n",
+          (unsigned long)alice_pcm_call_count,
+          (unsigned long)alice_pcm_miss_count,
+          (unsigned long)alice_pcm_cycles_sum,
+          (unsigned long)alice_pcm_cycles_max);
+#endif
+
+#if TSCH_QUEUE_WITH_CLASSES
+  LOG_HK("qc_enq %lu %lu %lu qc_qloss %lu %lu %lu qc_exp %lu %lu %lu qc_ok %lu %lu %lu qc_err %lu %lu %lu |\n",
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_CONTROL].enqueued,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_LATENCY].enqueued,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_BULK].enqueued,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_CONTROL].qloss,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_LATENCY].qloss,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_BULK].qloss,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_CONTROL].expired,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_LATENCY].expired,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_BULK].expired,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_CONTROL].tx_ok,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_LATENCY].tx_ok,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_BULK].tx_ok,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_CONTROL].tx_err,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_LATENCY].tx_err,
+          (unsigned long)tsch_queue_class_stats[TSCH_QUEUE_CLASS_BULK].tx_err);
+#endif
+
+#if TSCH_QUEUE_WITH_SHARED_POOL
+  LOG_HK("qp_borrow %lu qp_quota %lu |\n",
+          (unsigned long)tsch_queue_pool_borrow_count,
+          (unsigned long)tsch_queue_pool_quota_drop_count);
+#endif
+
+#if TSCH_WITH_RX_BATCH
+  LOG_HK("rx_batch %lu rx_batch_frames %lu |\n",
+          (unsigned long)tsch_rx_batch_count,
+          (unsigned long)tsch_rx_batch_frame_count);
+#endif
+
+#if TSCH_SCHEDULE_WITH_CMD_RING
+  LOG_HK("sched_cmd %lu sched_cmd_ok %lu sched_cmd_full %lu sched_cmd_err %lu |\n",
+          (unsigned long)tsch_schedule_cmd_queued_count,
+          (unsigned long)tsch_schedule_cmd_applied_count,
+          (unsigned long)tsch_schedule_cmd_full_count,
+          (unsigned long)tsch_schedule_cmd_failed_count);
+#endif
+
+#if WITH_ALICE && defined(ALICE_DEFERRED_RESCHEDULING)
+  LOG_HK("resch_swap %lu resch_sync %lu resch_late %lu |\n",
+          (unsigned long)alice_resched_swap_count,
+          (unsigned long)alice_resched_sync_count,
+          (unsigned long)alice_resched_late_count);
+#endif
+
+#if TSCH_SLOT_PROFILER
+  tsch_slot_profiler_print();
+#endif
+
+#if MEMB_WITH_STATS
+  LOG_HK("q_hw %d qbuf_hw %d |\n",
+          tsch_queue_global_packet_high_water(),
+          queuebuf_high_water());
+#endif
+
   LOG_HK("input_full %u input_avail %u dequeued_full %u dequeued_avail %u |\n", 
           tsch_input_ringbuf_full_count, 
           tsch_input_ringbuf_available_count, 
           tsch_dequeued_ringbuf_full_count, 
           tsch_dequeued_ringbuf_available_count);
 
+  LOG_HK("lock %lu lock_wait %lu lock_fail %lu lock_skip %lu |\n",
+          (unsigned long)tsch_lock_count,
+          (unsigned long)tsch_lock_wait_count,
+          (unsigned long)tsch_lock_fail_count,
+          (unsigned long)tsch_lock_skip_count);
+
   //timeslots in current session
   tsch_timeslots_in_current_session = TSCH_ASN_DIFF(tsch_current_asn, tsch_last_asn_associated);
   //timeslots until last session + timeslots in current session
@@ -411,6 +532,14 @@ void print_log_tsch()
 void reset_log_tsch()
 {
   print_log_tsch();
+
+#if TSCH_SLOT_PROFILER
+  tsch_slot_profiler_reset();
+#endif
+
+#if TSCH_METRICS
+  tsch_metrics_reset();
+#endif
   
   tsch_timeslots_until_last_session = 0;
   TSCH_ASN_COPY(tsch_last_asn_associated, tsch_current_asn);
@@ -461,6 +590,11 @@ void reset_log_tsch()
   tsch_dequeued_ringbuf_full_count = 0;
   tsch_dequeued_ringbuf_available_count = 0;
 
+  tsch_lock_count = 0;
+  tsch_lock_wait_count = 0;
+  tsch_lock_fail_count = 0;
+  tsch_lock_skip_count = 0;
+
   /* hckim for measure cell utilization during association */
   tsch_scheduled_eb_sf_cell_count = 0;
   tsch_scheduled_common_sf_cell_count = 0;
@@ -545,6 +679,34 @@ void reset_log_tsch()
 #if WITH_ALICE && ALICE_EARLY_PACKET_DROP
   alice_early_packet_drop_count = 0;
 #endif
+
+#if TSCH_QUEUE_WITH_CLASSES
+  memset(tsch_queue_class_stats, 0, sizeof(tsch_queue_class_stats));
+#endif
+
+#if TSCH_QUEUE_WITH_SHARED_POOL
+  tsch_queue_pool_borrow_count = 0;
+  tsch_queue_pool_quota_drop_count = 0;
+#endif
+
+#if TSCH_WITH_RX_BATCH
+  tsch_rx_batch_count = 0;
+  tsch_rx_batch_frame_count = 0;
+#endif
+
+#if TSCH_SCHEDULE_WITH_CMD_RING
+  tsch_schedule_cmd_queued_count = 0;
+  tsch_schedule_cmd_applied_count = 0;
+  tsch_schedule_cmd_full_count = 0;
+  tsch_schedule_cmd_failed_count = 0;
+#endif
+
+#if WITH_ALICE && ALICE_DBG_PCM_CYCLES
+  alice_pcm_call_count = 0;
+  alice_pcm_miss_count = 0;
+  alice_pcm_cycles_sum = 0;
+  alice_pcm_cycles_max = 0;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 
@@ -576,6 +738,12 @@ uint16_t tsch_timing_us[tsch_ts_elements_count];
 /* TSCH timeslot timing (in rtimer ticks) */
 rtimer_clock_t tsch_timing[tsch_ts_elements_count];
 
+#if WITH_SLA && SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+/* Timeslot length of the network-wide cells of the broadcast slotframes */
+uint16_t tsch_bc_sf_timing_us[SLA_BC_SF_COUNT];
+rtimer_clock_t tsch_bc_sf_timing[SLA_BC_SF_COUNT];
+#endif
+
 #if WITH_UPA
 static const uint16_t *upa_default_timing_us;
 uint16_t upa_timing_us[upa_ts_elements_count];
@@ -643,12 +811,22 @@ PROCESS(tsch_pending_events_process, "pending events process");
 
 /* Other function prototypes */
 static void packet_input(void);
+#if TSCH_WITH_RX_BATCH
+static void packet_input_parsed(struct input_packet *input, frame802154_t *frame, int hdr_len);
+#endif
 
 /*---------------------------------------------------------------------------*/
 #if WITH_SLA /* Coordinator/non-coordinator: rapidly broadcast EB */
 static void
 sla_rapid_eb_broadcast()
 {
+#if TSCH_METRICS
+  if(sla_in_rapid_eb_broadcasting == 0) {
+    int32_t sla_trig_lead = TSCH_ASN_DIFF(sla_triggering_asn, tsch_current_asn);
+    TSCH_METRICS_ADD(TSCH_METRIC_SLA_RAPID_EB_EVENTS, 1);
+    TSCH_METRICS_SAMPLE(TSCH_METRIC_SLA_TRIG_LEAD, sla_trig_lead > 0 ? sla_trig_lead : 0);
+  }
+#endif
   sla_in_rapid_eb_broadcasting = 1;
 
   if(tsch_is_associated && tsch_current_eb_period > 0
@@ -683,6 +861,7 @@ sla_rapid_eb_broadcast()
 
           ++tsch_eb_packet_enqueue_count;
           LOG_HK("eb_enq %u |\n", tsch_eb_packet_enqueue_count);
+          TSCH_METRICS_ADD(TSCH_METRIC_SLA_RAPID_EBS, 1);
 
 #if SLA_DBG_ESSENTIAL
           ++sla_eb_packet_enqueue_count;
@@ -703,6 +882,7 @@ sla_rapid_eb_broadcast()
     /* Call ctimer_stop if triggering_asn passed */
     int32_t sla_asn_diff = TSCH_ASN_DIFF(tsch_current_asn, sla_triggering_asn);
     if(sla_asn_diff >= 0) {
+      TSCH_METRICS_SAMPLE(TSCH_METRIC_SLA_TRIG_LAG, sla_asn_diff);
 #if SLA_DBG_ESSENTIAL
       LOG_HK_SLA("rapid_eb stop c_ts %u n_ts %u\n",
                 tsch_timing_us[tsch_ts_timeslot_length], 
@@ -747,6 +927,9 @@ sla_record_bc_frame_len(int frame_len)
   uint8_t quantized_index = sla_quantize_frame_len_with_radio_phy_overhead(frame_len_with_radio_phy_overhead);
   sla_observed_bc_frame_length[sla_current_window_index][quantized_index] += 1;
   sla_observed_bc_frame_count[sla_current_window_index] += 1;
+#if SLA_QUANTILE_ESTIMATOR
+  sla_quantile_add(&sla_bc_frame_len_estimator, frame_len_with_radio_phy_overhead);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -756,8 +939,26 @@ sla_record_uc_frame_len(int frame_len)
   uint8_t quantized_index = sla_quantize_frame_len_with_radio_phy_overhead(frame_len_with_radio_phy_overhead);
   sla_observed_uc_frame_length[sla_current_window_index][quantized_index] += 1;
   sla_observed_uc_frame_count[sla_current_window_index] += 1;
+#if SLA_QUANTILE_ESTIMATOR
+  sla_quantile_add(&sla_uc_frame_len_estimator, frame_len_with_radio_phy_overhead);
+#endif
 }
 /*---------------------------------------------------------------------------*/
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+static void
+sla_record_bc_sf_frame(uint8_t bc_sf, uint8_t is_broadcast, int frame_len)
+{
+  if(bc_sf != SLA_BC_SF_NONE) {
+    sla_observed_bc_sf_frame_count[sla_current_window_index][bc_sf] += 1;
+    if(!is_broadcast) {
+      sla_observed_bc_sf_uc_frame_count[sla_current_window_index][bc_sf] += 1;
+    } else if(frame_len + RADIO_PHY_OVERHEAD > sla_observed_bc_sf_max_frame_len[sla_current_window_index][bc_sf]) {
+      sla_observed_bc_sf_max_frame_len[sla_current_window_index][bc_sf] = MIN(frame_len + RADIO_PHY_OVERHEAD, 0xff);
+    }
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
 void
 sla_record_ack_len(int ack_len)
 {
@@ -765,19 +966,32 @@ sla_record_ack_len(int ack_len)
   uint8_t quantized_index = sla_quantize_frame_len_with_radio_phy_overhead(ack_len_with_radio_phy_overhead);
   sla_observed_ack_length[sla_current_window_index][quantized_index] += 1;
   sla_observed_ack_count[sla_current_window_index] += 1;
+#if SLA_QUANTILE_ESTIMATOR
+  sla_quantile_add(&sla_ack_len_estimator, ack_len_with_radio_phy_overhead);
+#endif
 }
 #endif
 /*---------------------------------------------------------------------------*/
 #if WITH_SLA /* Coordinator: policy-related functions */
+#if !SLA_QUANTILE_ESTIMATOR
 static uint8_t
 sla_get_frame_len_with_radio_phy_overhead(uint8_t quantized_val)
 {
   return quantized_val << SLA_SHIFT_BITS;
 }
+#endif
 /*---------------------------------------------------------------------------*/
 static int
 sla_calculate_next_ref_bc_frame_len()
 {
+#if SLA_QUANTILE_ESTIMATOR
+  int estimated_len = sla_quantile_get(&sla_bc_frame_len_estimator);
+  if(estimated_len >= 0) {
+    return MIN(estimated_len, SLA_MAX_FRAME_LEN);
+  } else {
+    return sla_curr_ref_bc_frame_len;
+  }
+#else
   int target_index = 0;
 
   uint16_t ref_count 
@@ -797,11 +1011,20 @@ sla_calculate_next_ref_bc_frame_len()
   } else {
     return sla_curr_ref_bc_frame_len;
   }
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static int
 sla_calculate_next_ref_uc_frame_len()
 {
+#if SLA_QUANTILE_ESTIMATOR
+  int estimated_len = sla_quantile_get(&sla_uc_frame_len_estimator);
+  if(estimated_len >= 0) {
+    return MIN(estimated_len, SLA_MAX_FRAME_LEN);
+  } else {
+    return sla_curr_ref_uc_frame_len;
+  }
+#else
   int target_index = 0;
 
   uint16_t ref_count 
@@ -821,11 +1044,20 @@ sla_calculate_next_ref_uc_frame_len()
   } else {
     return sla_curr_ref_uc_frame_len;
   }
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static int
 sla_calculate_next_ref_ack_len()
 {
+#if SLA_QUANTILE_ESTIMATOR
+  int estimated_len = sla_quantile_get(&sla_ack_len_estimator);
+  if(estimated_len >= 0) {
+    return MIN(estimated_len, SLA_MAX_ACK_LEN);
+  } else {
+    return sla_curr_ref_ack_len;
+  }
+#else
   int target_index = 0;
 
   uint16_t ref_count 
@@ -845,6 +1077,7 @@ sla_calculate_next_ref_ack_len()
   } else {
     return sla_curr_ref_ack_len;
   }
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -912,6 +1145,33 @@ sla_calculate_timeslot_length()
   return calculated_timeslot_length;
 }
 /*---------------------------------------------------------------------------*/
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+static uint16_t
+sla_calculate_bc_sf_timeslot_length(uint8_t bc_sf)
+{
+  /* 
+   * Network-wide cells of broadcast slotframes only need time for an ACK
+   * if unicast frames were sent in them: a single one would overrun a cell
+   * without it. Their frame is the longest broadcast frame sent in them,
+   * not the k-th percentile, for the same reason.
+   */
+  if(sla_observed_bc_sf_uc_frame_count[sla_current_window_index][bc_sf] > 0) {
+    return sla_calculate_timeslot_length();
+  }
+
+  uint8_t ref_bc_frame_len = MAX(sla_next_ref_bc_frame_len,
+                                 sla_observed_bc_sf_max_frame_len[sla_current_window_index][bc_sf]);
+  uint16_t ref_bc_tx_duration = MIN(SLA_CALCULATE_DURATION(ref_bc_frame_len), tsch_timing_us[tsch_ts_max_tx]);
+
+  uint16_t max_tx_duration = tsch_timing_us[tsch_ts_max_tx]
+                              + tsch_timing_us[tsch_ts_tx_ack_delay] 
+                              + tsch_timing_us[tsch_ts_max_ack];
+  uint16_t tx_duration_diff = max_tx_duration - ref_bc_tx_duration;
+
+  return tsch_default_timing_us[tsch_ts_timeslot_length] - tx_duration_diff;
+}
+#endif
+/*---------------------------------------------------------------------------*/
 static void
 sla_determine_next_timeslot_length_and_trig_asn()
 {
@@ -943,6 +1203,18 @@ sla_determine_next_timeslot_length_and_trig_asn()
     sla_observed_uc_frame_count[sla_current_window_index] = 0;
     sla_observed_ack_count[sla_current_window_index] = 0;
     sla_max_hop_distance[sla_current_window_index] = 0;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+    for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+      sla_observed_bc_sf_frame_count[sla_current_window_index][i] = 0;
+      sla_observed_bc_sf_uc_frame_count[sla_current_window_index][i] = 0;
+      sla_observed_bc_sf_max_frame_len[sla_current_window_index][i] = 0;
+    }
+#endif
+#if SLA_QUANTILE_ESTIMATOR
+    sla_quantile_decay(&sla_bc_frame_len_estimator, 0);
+    sla_quantile_decay(&sla_uc_frame_len_estimator, 0);
+    sla_quantile_decay(&sla_ack_len_estimator, 0);
+#endif
 
     /* Reset and restart sla_timer */
     ctimer_set(&sla_timer, SLA_DETERMINATION_PERIOD, sla_determine_next_timeslot_length_and_trig_asn, NULL);
@@ -993,8 +1265,20 @@ sla_determine_next_timeslot_length_and_trig_asn()
   sla_next_ref_uc_frame_len = sla_calculate_next_ref_uc_frame_len();
   sla_next_ref_ack_len = sla_calculate_next_ref_ack_len();
 
+#if SLA_QUANTILE_ESTIMATOR
+  /* Age past windows so that the estimators follow traffic changes */
+  sla_quantile_decay(&sla_bc_frame_len_estimator, SLA_QUANTILE_DECAY);
+  sla_quantile_decay(&sla_uc_frame_len_estimator, SLA_QUANTILE_DECAY);
+  sla_quantile_decay(&sla_ack_len_estimator, SLA_QUANTILE_DECAY);
+#endif
+
   /* Calculate sla_next_timeslot_length */
   sla_next_timeslot_length = sla_calculate_timeslot_length();
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    sla_next_bc_sf_timeslot_length[i] = sla_calculate_bc_sf_timeslot_length(i);
+  }
+#endif
 
   /* Calculate triggering asn */
   sla_calculate_triggering_asn();
@@ -1011,10 +1295,21 @@ sla_determine_next_timeslot_length_and_trig_asn()
             sla_next_timeslot_length, 
             (uint64_t)(sla_triggering_asn.ls4b) + ((uint64_t)(sla_triggering_asn.ms1b) << 32),
             sla_curr_ref_hop_distance);
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    LOG_HK_SLA("det bc_sf %u frames %u uc %u max_bc %u c_ts %u n_ts %u\n",
+              i,
+              sla_observed_bc_sf_frame_count[sla_current_window_index][i],
+              sla_observed_bc_sf_uc_frame_count[sla_current_window_index][i],
+              sla_observed_bc_sf_max_frame_len[sla_current_window_index][i],
+              tsch_bc_sf_timing_us[i],
+              sla_next_bc_sf_timeslot_length[i]);
+  }
+#endif
 #endif
 
   /* Only when timeslot length is changed, coordinator starts rapid eb broadcasting. */
-  if(tsch_timing_us[tsch_ts_timeslot_length] != sla_next_timeslot_length) {
+  if(sla_timeslot_length_changes()) {
     if(sla_in_rapid_eb_broadcasting == 0) {
 #if SLA_DBG_ESSENTIAL
       LOG_HK_SLA("det start_rapid_eb c_ts %u n_ts %u\n",
@@ -1040,6 +1335,13 @@ sla_determine_next_timeslot_length_and_trig_asn()
   sla_observed_uc_frame_count[sla_current_window_index] = 0;
   sla_observed_ack_count[sla_current_window_index] = 0;
   sla_max_hop_distance[sla_current_window_index] = 0;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    sla_observed_bc_sf_frame_count[sla_current_window_index][i] = 0;
+    sla_observed_bc_sf_uc_frame_count[sla_current_window_index][i] = 0;
+    sla_observed_bc_sf_max_frame_len[sla_current_window_index][i] = 0;
+  }
+#endif
 
   /* Reset and restart sla_timer */
   ctimer_set(&sla_timer, SLA_DETERMINATION_PERIOD, sla_determine_next_timeslot_length_and_trig_asn, NULL);
@@ -1052,6 +1354,30 @@ sla_apply_next_timeslot_length()
 {
   tsch_timing_us[tsch_ts_timeslot_length] = sla_next_timeslot_length;
   tsch_timing[tsch_ts_timeslot_length] = US_TO_RTIMERTICKS(tsch_timing_us[tsch_ts_timeslot_length]);
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  int i;
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    tsch_bc_sf_timing_us[i] = sla_next_bc_sf_timeslot_length[i];
+    tsch_bc_sf_timing[i] = US_TO_RTIMERTICKS(tsch_bc_sf_timing_us[i]);
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
+int
+sla_timeslot_length_changes()
+{
+  if(tsch_timing_us[tsch_ts_timeslot_length] != sla_next_timeslot_length) {
+    return 1;
+  }
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  int i;
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    if(tsch_bc_sf_timing_us[i] != sla_next_bc_sf_timeslot_length[i]) {
+      return 1;
+    }
+  }
+#endif
+  return 0;
 }
 #endif
 /*---------------------------------------------------------------------------*/
@@ -1146,6 +1472,13 @@ tsch_reset(void)
 #if WITH_SLA /* Coordinator/non-coordinator: initialize SLA variables and timeslot length */
   TSCH_ASN_INIT(sla_triggering_asn, 0, 0);
   sla_next_timeslot_length = tsch_default_timing_us[tsch_ts_timeslot_length];
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    tsch_bc_sf_timing_us[i] = tsch_default_timing_us[tsch_ts_timeslot_length];
+    tsch_bc_sf_timing[i] = US_TO_RTIMERTICKS(tsch_bc_sf_timing_us[i]);
+    sla_next_bc_sf_timeslot_length[i] = tsch_default_timing_us[tsch_ts_timeslot_length];
+  }
+#endif
 
   sla_curr_ref_bc_frame_len = SLA_MAX_FRAME_LEN;
   sla_curr_ref_uc_frame_len = SLA_MAX_FRAME_LEN;
@@ -1454,7 +1787,11 @@ eb_input(struct input_packet *current_input)
       uint64_t curr_eb_rx_asn = (uint64_t)(current_input->rx_asn.ls4b) + ((uint64_t)(current_input->rx_asn.ms1b) << 32);
       uint64_t curr_eb_ie_asn = (uint64_t)(eb_ies.ie_asn.ls4b) + ((uint64_t)(eb_ies.ie_asn.ms1b) << 32);
 
-      if(tsch_timing_us[tsch_ts_timeslot_length] != eb_ies.ie_sla_curr_timeslot_len) {
+      if(tsch_timing_us[tsch_ts_timeslot_length] != eb_ies.ie_sla_curr_timeslot_len
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+        || memcmp(tsch_bc_sf_timing_us, eb_ies.ie_sla_curr_bc_sf_timeslot_len, sizeof(tsch_bc_sf_timing_us)) != 0
+#endif
+        ) {
 #if SLA_DBG_ESSENTIAL
         LOG_HK_SLA("eb_input invalid rx_asn %llx ie_asn %llx c_ts %u n_ts %u\n",
                 curr_eb_rx_asn,
@@ -1470,6 +1807,9 @@ eb_input(struct input_packet *current_input)
          */
         sla_triggering_asn = eb_ies.ie_sla_triggering_asn;
         sla_next_timeslot_length = eb_ies.ie_sla_next_timeslot_len;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+        memcpy(sla_next_bc_sf_timeslot_length, eb_ies.ie_sla_next_bc_sf_timeslot_len, sizeof(sla_next_bc_sf_timeslot_length));
+#endif
 
 #if SLA_DBG_ESSENTIAL
         LOG_HK_SLA("eb_input valid rx_asn %llx ie_asn %llx valid c_ts %u n_ts %u t_asn %llx \n", 
@@ -1480,7 +1820,7 @@ eb_input(struct input_packet *current_input)
                 (uint64_t)(sla_triggering_asn.ls4b) + ((uint64_t)(sla_triggering_asn.ms1b) << 32));
 #endif
 
-        if(tsch_timing_us[tsch_ts_timeslot_length] != sla_next_timeslot_length) {
+        if(sla_timeslot_length_changes()) {
           if(sla_in_rapid_eb_broadcasting == 0) {
 #if SLA_DBG_ESSENTIAL
             LOG_HK_SLA("eb_input start_rapid_eb c_ts %u n_ts %u\n",
@@ -1501,6 +1841,10 @@ static void
 tsch_rx_process_pending()
 {
   int16_t input_index;
+#if TSCH_WITH_RX_BATCH
+  linkaddr_t batch_sender;
+  uint8_t batch_len = 0;
+#endif
 
   /* Loop on accessing (without removing) a pending input packet */
   while((input_index = ringbufindex_peek_get(&input_ringbuf)) != -1) {
@@ -1513,6 +1857,10 @@ tsch_rx_process_pending()
       } else {
         sla_record_uc_frame_len(current_input->len);
       }
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+      sla_record_bc_sf_frame(current_input->sla_bc_sf, current_input->sla_is_broadcast,
+                             current_input->len);
+#endif
     }
 #endif
 
@@ -1533,6 +1881,27 @@ tsch_rx_process_pending()
       && frame.fcf.frame_version == FRAME802154_IEEE802154_2015
       && frame.fcf.frame_type == FRAME802154_BEACONFRAME;
 
+#if TSCH_WITH_RX_BATCH
+    if(is_data) {
+      /* Frames from the same sender as the previous one form a batch
+         (e.g. the frames of a UPA batch) */
+      if(batch_len > 0 && linkaddr_cmp(&batch_sender, (linkaddr_t *)&frame.src_addr)) {
+        if(++batch_len == 2) {
+          tsch_rx_batch_count++;
+          tsch_rx_batch_frame_count++;
+        }
+        tsch_rx_batch_frame_count++;
+      } else {
+        linkaddr_copy(&batch_sender, (linkaddr_t *)&frame.src_addr);
+        batch_len = 1;
+      }
+      /* Pass to upper layers, reusing the parsed frame */
+      packet_input_parsed(current_input, &frame, ret);
+    } else if(is_eb) {
+      batch_len = 0;
+      eb_input(current_input);
+    }
+#else /* TSCH_WITH_RX_BATCH */
     if(is_data) {
       /* Skip EBs and other control messages */
       /* Copy to packetbuf for processing */
@@ -1547,6 +1916,7 @@ tsch_rx_process_pending()
     } else if(is_eb) {
       eb_input(current_input);
     }
+#endif /* TSCH_WITH_RX_BATCH */
 
     /* Remove input from ringbuf */
     ringbufindex_get(&input_ringbuf);
@@ -1569,6 +1939,10 @@ tsch_tx_process_pending(void)
       } else {
         sla_record_uc_frame_len(queuebuf_datalen(p->qb));
       }
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+      sla_record_bc_sf_frame(p->sla_bc_sf, p->sla_is_broadcast,
+                             queuebuf_datalen(p->qb));
+#endif
     }
 #endif
 
@@ -1590,6 +1964,14 @@ tsch_tx_process_pending(void)
     LOG_INFO_(", seqno %u, status %d, tx %d\n",
       packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO), p->ret, p->transmissions);
 
+#if TSCH_QUEUE_WITH_CLASSES
+    if(p->ret == MAC_TX_OK) {
+      tsch_queue_class_stats[p->tx_class].tx_ok++;
+    } else {
+      tsch_queue_class_stats[p->tx_class].tx_err++;
+    }
+#endif
+
     if(p->sent == NULL) { // EB
       if(p->ret == MAC_TX_NOACK) {
         ++tsch_eb_packet_noack_count;
@@ -1789,6 +2171,14 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
   /* Update tsch_next_timing_us */
   sla_next_timeslot_length = ies.ie_sla_next_timeslot_len;
 
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+  for(i = 0; i < SLA_BC_SF_COUNT; i++) {
+    tsch_bc_sf_timing_us[i] = ies.ie_sla_curr_bc_sf_timeslot_len[i];
+    tsch_bc_sf_timing[i] = US_TO_RTIMERTICKS(tsch_bc_sf_timing_us[i]);
+    sla_next_bc_sf_timeslot_length[i] = ies.ie_sla_next_bc_sf_timeslot_len[i];
+  }
+#endif
+
 
 #if SLA_DBG_ESSENTIAL
         LOG_HK_SLA("asso c_ts %u n_ts %u t_asn %llx\n",
@@ -2245,6 +2635,12 @@ tsch_init(void)
   LOG_INFO("nbr_tbl_reg: sync_stats %d\n", sync_stats->index);
 #endif /* TSCH_AUTOSELECT_TIME_SOURCE */
 
+#if WITH_SLA && SLA_QUANTILE_ESTIMATOR
+  sla_quantile_init(&sla_bc_frame_len_estimator, SLA_K_TH_PERCENTILE);
+  sla_quantile_init(&sla_uc_frame_len_estimator, SLA_K_TH_PERCENTILE);
+  sla_quantile_init(&sla_ack_len_estimator, SLA_K_TH_PERCENTILE);
+#endif
+
   tsch_packet_seqno = random_rand();
   tsch_is_initialized = 1;
 
@@ -2409,6 +2805,37 @@ send_packet(mac_callback_t sent, void *ptr)
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Drops duplicates of the parsed frame in packetbuf, passes it up otherwise */
+static void
+input_parsed_packet(void)
+{
+  int duplicate = 0;
+
+  /* Seqno of 0xffff means no seqno */
+  if(packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO) != 0xffff) {
+    /* Check for duplicates */
+    duplicate = mac_sequence_is_duplicate();
+    if(duplicate) {
+      /* Drop the packet. */
+      LOG_WARN("! drop dup ll from ");
+      LOG_WARN_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+      LOG_WARN_(" seqno %u\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+    } else {
+      mac_sequence_register_seqno();
+    }
+  }
+
+  if(!duplicate) {
+    LOG_INFO("received from ");
+    LOG_INFO_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    LOG_INFO_(" with seqno %u\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+#if TSCH_WITH_SIXTOP
+    sixtop_input();
+#endif /* TSCH_WITH_SIXTOP */
+    NETSTACK_NETWORK.input();
+  }
+}
+/*---------------------------------------------------------------------------*/
 static void
 packet_input(void)
 {
@@ -2419,33 +2846,27 @@ packet_input(void)
   if(frame_parsed < 0) {
     LOG_ERR("! failed to parse %u\n", packetbuf_datalen());
   } else {
-    int duplicate = 0;
-
-    /* Seqno of 0xffff means no seqno */
-    if(packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO) != 0xffff) {
-      /* Check for duplicates */
-      duplicate = mac_sequence_is_duplicate();
-      if(duplicate) {
-        /* Drop the packet. */
-        LOG_WARN("! drop dup ll from ");
-        LOG_WARN_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
-        LOG_WARN_(" seqno %u\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
-      } else {
-        mac_sequence_register_seqno();
-      }
-    }
+    input_parsed_packet();
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if TSCH_WITH_RX_BATCH
+/* Passes a data frame already parsed by tsch_rx_process_pending up: only
+   the MAC payload is copied to packetbuf and the frame is not parsed again */
+static void
+packet_input_parsed(struct input_packet *input, frame802154_t *frame, int hdr_len)
+{
+  packetbuf_copyfrom(input->payload + hdr_len, input->len - hdr_len);
+  packetbuf_set_attr(PACKETBUF_ATTR_RSSI, input->rssi);
+  packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, input->channel);
 
-    if(!duplicate) {
-      LOG_INFO("received from ");
-      LOG_INFO_LLADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER));
-      LOG_INFO_(" with seqno %u\n", packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
-#if TSCH_WITH_SIXTOP
-      sixtop_input();
-#endif /* TSCH_WITH_SIXTOP */
-      NETSTACK_NETWORK.input();
-    }
+  if(!framer_802154_set_packetbuf_attr(frame)) {
+    LOG_ERR("! failed to parse %u\n", input->len);
+  } else {
+    input_parsed_packet();
   }
 }
+#endif /* TSCH_WITH_RX_BATCH */
 /*---------------------------------------------------------------------------*/
 static int
 turn_on(void)
@@ -61,6 +61,8 @@ frequency hopping for enhanced reliability.
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-stats.h"
+#include "net/mac/tsch/tsch-slot-profiler.h"
+#include "net/mac/tsch/tsch-metrics.h"
 #if UIP_CONF_IPV6_RPL
 #include "net/mac/tsch/tsch-rpl.h"
 #endif /* UIP_CONF_IPV6_RPL */
@@ -69,11 +71,46 @@ frequency hopping for enhanced reliability.
 extern uint16_t alice_early_packet_drop_count;
 #endif
 
+#if WITH_ALICE && ALICE_DBG_PCM_CYCLES
+extern uint32_t alice_pcm_call_count;
+extern uint32_t alice_pcm_miss_count;
+extern uint32_t alice_pcm_cycles_sum;
+extern uint32_t alice_pcm_cycles_max;
+#endif
+
+#if WITH_ALICE && defined(ALICE_DEFERRED_RESCHEDULING)
+extern uint32_t alice_resched_swap_count;
+extern uint32_t alice_resched_sync_count;
+extern uint32_t alice_resched_late_count;
+#endif
+
+#if TSCH_QUEUE_WITH_SHARED_POOL
+extern uint32_t tsch_queue_pool_borrow_count;
+extern uint32_t tsch_queue_pool_quota_drop_count;
+#endif
+
+#if TSCH_WITH_RX_BATCH
+extern uint32_t tsch_rx_batch_count;
+extern uint32_t tsch_rx_batch_frame_count;
+#endif
+
 extern uint16_t tsch_input_ringbuf_full_count;
 extern uint16_t tsch_input_ringbuf_available_count;
 extern uint16_t tsch_dequeued_ringbuf_full_count;
 extern uint16_t tsch_dequeued_ringbuf_available_count;
 
+extern uint32_t tsch_lock_count;
+extern uint32_t tsch_lock_wait_count;
+extern uint32_t tsch_lock_fail_count;
+extern uint32_t tsch_lock_skip_count;
+
+#if TSCH_SCHEDULE_WITH_CMD_RING
+extern uint32_t tsch_schedule_cmd_queued_count;
+extern uint32_t tsch_schedule_cmd_applied_count;
+extern uint32_t tsch_schedule_cmd_full_count;
+extern uint32_t tsch_schedule_cmd_failed_count;
+#endif
+
 /* hckim measure cell utilization during association */
 extern uint32_t tsch_scheduled_eb_sf_cell_count;
 extern uint32_t tsch_scheduled_common_sf_cell_count;
@@ -290,6 +327,13 @@ extern const tsch_timeslot_timing_usec tsch_timeslot_timing_us_10000;
 #if WITH_SLA /* Variables */
 extern struct tsch_asn_t sla_triggering_asn;
 extern uint16_t sla_next_timeslot_length;
+#if SLA_PER_SLOTFRAME_TIMESLOT_LENGTH
+extern uint16_t sla_next_bc_sf_timeslot_length[SLA_BC_SF_COUNT];
+/* Timeslot length of the network-wide cells of the broadcast slotframes (in micro-second) */
+extern uint16_t tsch_bc_sf_timing_us[SLA_BC_SF_COUNT];
+/* Timeslot length of the network-wide cells of the broadcast slotframes (in rtimer ticks) */
+extern rtimer_clock_t tsch_bc_sf_timing[SLA_BC_SF_COUNT];
+#endif
 #endif
 
 #if WITH_UPA
@@ -376,6 +420,7 @@ void tsch_disassociate(void);
 void sla_record_ack_len(int ack_len);
 void sla_record_max_hop_distance(uint8_t hops);
 void sla_apply_next_timeslot_length();
+int sla_timeslot_length_changes();
 void sla_finish_rapid_eb_broadcasting();
 #endif
 
@@ -83,6 +83,35 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH_INDEX
+/* Hash index of the keys of nbr_table_keys: linear probing over a power of
+ * two number of slots, at least twice the number of neighbors. A slot holds
+ * the neighbor index + 1, 0 if empty. */
+#if NBR_TABLE_MAX_NEIGHBORS <= 8
+#define NBR_TABLE_HASH_SIZE 16
+#elif NBR_TABLE_MAX_NEIGHBORS <= 16
+#define NBR_TABLE_HASH_SIZE 32
+#elif NBR_TABLE_MAX_NEIGHBORS <= 32
+#define NBR_TABLE_HASH_SIZE 64
+#elif NBR_TABLE_MAX_NEIGHBORS <= 64
+#define NBR_TABLE_HASH_SIZE 128
+#elif NBR_TABLE_MAX_NEIGHBORS <= 128
+#define NBR_TABLE_HASH_SIZE 256
+#elif NBR_TABLE_MAX_NEIGHBORS <= 256
+#define NBR_TABLE_HASH_SIZE 512
+#else
+#error NBR_TABLE_WITH_HASH_INDEX supports up to 256 neighbors
+#endif
+
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t nbr_table_hash_slot_t;
+#else
+typedef uint16_t nbr_table_hash_slot_t;
+#endif
+
+static nbr_table_hash_slot_t hash_index[NBR_TABLE_HASH_SIZE];
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -125,6 +154,65 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
 {
   return key_from_index(index_from_item(table, item));
 }
+#if NBR_TABLE_WITH_HASH_INDEX
+/*---------------------------------------------------------------------------*/
+/* Home slot of a link-layer address in the hash index */
+static unsigned
+hash_slot_of(const linkaddr_t *lladdr)
+{
+  unsigned h = 0;
+  uint8_t i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = h * 31 + lladdr->u8[i];
+  }
+  return (h ^ (h >> 7)) & (NBR_TABLE_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Add a key to the hash index, once its link-layer address is set */
+static void
+hash_add(int index)
+{
+  unsigned slot = hash_slot_of(&key_from_index(index)->lladdr);
+  while(hash_index[slot] != 0) {
+    slot = (slot + 1) & (NBR_TABLE_HASH_SIZE - 1);
+  }
+  hash_index[slot] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash index, before its link-layer address changes */
+static void
+hash_remove(int index)
+{
+  unsigned hole = hash_slot_of(&key_from_index(index)->lladdr);
+  unsigned slot;
+  unsigned home;
+
+  while(hash_index[hole] != index + 1) {
+    if(hash_index[hole] == 0) {
+      return;
+    }
+    hole = (hole + 1) & (NBR_TABLE_HASH_SIZE - 1);
+  }
+  hash_index[hole] = 0;
+
+  /* Move back the following entries of the probe sequence that can no
+   * longer be reached through the hole */
+  slot = hole;
+  while(1) {
+    slot = (slot + 1) & (NBR_TABLE_HASH_SIZE - 1);
+    if(hash_index[slot] == 0) {
+      return;
+    }
+    home = hash_slot_of(&key_from_index(hash_index[slot] - 1)->lladdr);
+    if(((slot - home) & (NBR_TABLE_HASH_SIZE - 1))
+       >= ((slot - hole) & (NBR_TABLE_HASH_SIZE - 1))) {
+      hash_index[hole] = hash_index[slot];
+      hash_index[slot] = 0;
+      hole = slot;
+    }
+  }
+}
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 /*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
@@ -136,6 +224,19 @@ index_from_lladdr(const linkaddr_t *lladdr)
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH_INDEX
+  {
+    unsigned slot = hash_slot_of(lladdr);
+    while(hash_index[slot] != 0) {
+      key = key_from_index(hash_index[slot] - 1);
+      if(linkaddr_cmp(lladdr, &key->lladdr)) {
+        return hash_index[slot] - 1;
+      }
+      slot = (slot + 1) & (NBR_TABLE_HASH_SIZE - 1);
+    }
+    return -1;
+  }
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -195,6 +296,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_remove(index_from_key(least_used_key));
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -381,6 +485,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH_INDEX
+    hash_add(index);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   }
 
   /* Get item in the current table */
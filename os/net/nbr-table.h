@@ -46,6 +46,15 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Index the neighbors by link-layer address with an open-addressing hash
+ * table of twice NBR_TABLE_MAX_NEIGHBORS slots, instead of walking the list
+ * of neighbors at each lookup */
+#ifdef NBR_TABLE_CONF_WITH_HASH_INDEX
+#define NBR_TABLE_WITH_HASH_INDEX NBR_TABLE_CONF_WITH_HASH_INDEX
+#else /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+#define NBR_TABLE_WITH_HASH_INDEX 0
+#endif /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
@@ -87,6 +96,7 @@ typedef enum {
 	NBR_TABLE_REASON_LLSEC,
 	NBR_TABLE_REASON_LINK_STATS,
   NBR_TABLE_REASON_SIXTOP,
+  NBR_TABLE_REASON_SICSLOWPAN,
 } nbr_table_reason_t;
 
 /** \name Neighbor tables: register and loop through table elements */
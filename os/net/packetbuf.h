@@ -249,6 +249,10 @@ enum {
   PACKETBUF_ATTR_RPL_NO_PATH_DAO,
 #endif
 
+#if SICSLOWPAN_CONF_FLOW_CTX
+  PACKETBUF_ATTR_FLOW_CTX,
+#endif
+
   /* Scope 2 attributes: used between end-to-end nodes. */
   /* These must be last */
   PACKETBUF_ADDR_SENDER,
@@ -300,6 +300,14 @@ queuebuf_numfree(void)
   return memb_numfree(&bufmem);
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_WITH_STATS
+int
+queuebuf_high_water(void)
+{
+  return memb_high_water(&bufmem);
+}
+#endif /* MEMB_WITH_STATS */
+/*---------------------------------------------------------------------------*/
 #if QUEUEBUF_DEBUG
 struct queuebuf *
 queuebuf_new_from_packetbuf_debug(const char *file, int line)
@@ -117,6 +117,10 @@ void queuebuf_debug_print(void);
 
 int queuebuf_numfree(void);
 
+#if MEMB_WITH_STATS
+int queuebuf_high_water(void);
+#endif /* MEMB_WITH_STATS */
+
 #if HCK_ORCHESTRA_PACKET_OFFLOADING
 void queuebuf_update_attr(struct queuebuf *b, uint8_t type, packetbuf_attr_t val);
 #endif
@@ -315,6 +315,17 @@
 #define RPL_DIO_REFRESH_DAO_ROUTES 1
 #endif /* RPL_CONF_DIO_REFRESH_DAO_ROUTES */
 
+/*
+ * RFC 8138 compression. When enabled, the root sets the T flag of the DAG
+ * configuration option (RFC 9035) and the nodes of its DODAG send the RPL
+ * option as an RPI 6LoRH, with the 6LoRH compression of 6LoWPAN.
+ */
+#ifdef RPL_CONF_WITH_RFC8138
+#define RPL_WITH_RFC8138 RPL_CONF_WITH_RFC8138
+#else
+#define RPL_WITH_RFC8138 0
+#endif
+
 /*
  * RPL probing. When enabled, probes will be sent periodically to keep
  * parent link estimates up to date.
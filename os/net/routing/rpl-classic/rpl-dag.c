@@ -481,6 +481,7 @@ rpl_set_root(uint8_t instance_id, uip_ipaddr_t *dag_id)
   instance->min_hoprankinc = RPL_MIN_HOPRANKINC;
   instance->default_lifetime = RPL_DEFAULT_LIFETIME;
   instance->lifetime_unit = RPL_DEFAULT_LIFETIME_UNIT;
+  instance->rfc8138 = RPL_WITH_RFC8138;
 
   dag->rank = ROOT_RANK(instance);
 
@@ -1258,6 +1259,7 @@ rpl_join_instance(uip_ipaddr_t *from, rpl_dio_t *dio)
   instance->dio_redundancy = dio->dag_redund;
   instance->default_lifetime = dio->default_lifetime;
   instance->lifetime_unit = dio->lifetime_unit;
+  instance->rfc8138 = dio->dag_rfc8138;
 
   memcpy(&dag->dag_id, &dio->dag_id, sizeof(dio->dag_id));
 
@@ -1394,6 +1396,7 @@ global_repair(uip_ipaddr_t *from, rpl_dag_t *dag, rpl_dio_t *dio)
   dag->instance->dio_redundancy = dio->dag_redund;
   dag->instance->default_lifetime = dio->default_lifetime;
   dag->instance->lifetime_unit = dio->lifetime_unit;
+  dag->instance->rfc8138 = dio->dag_rfc8138;
 
   dag->instance->of->reset(dag);
   dag->min_rank = RPL_INFINITE_RANK;
@@ -453,6 +453,15 @@ update_hbh_header(void)
     rpl_opt->senderrank = UIP_HTONS(instance->current_dag->rank);
     rpl_opt->instance = instance->instance_id;
 
+#if RPL_WITH_RFC8138
+    /* Let 6LoWPAN send the option as an RPI 6LoRH if the DODAG allows it */
+    if(instance->rfc8138) {
+      uipbuf_set_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_RPI_6LORH);
+    } else {
+      uipbuf_clr_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_RPI_6LORH);
+    }
+#endif /* RPL_WITH_RFC8138 */
+
     if(RPL_IS_STORING(instance)) { /* In non-storing mode, downwards traffic does not have the HBH option */
       /* Check the direction of the down flag, as per Section 11.2.2.3,
             which states that if a packet is going down it should in
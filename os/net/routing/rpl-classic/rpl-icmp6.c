@@ -482,6 +482,7 @@ dio_input(void)
         }
 
         /* Path control field not yet implemented - at i + 2 */
+        dio.dag_rfc8138 = (buffer[i + 2] & RPL_DAG_CONF_T_FLAG) != 0;
         dio.dag_intdoubl = buffer[i + 3];
         dio.dag_intmin = buffer[i + 4];
         dio.dag_redund = buffer[i + 5];
@@ -627,7 +628,7 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
   /* Always add a DAG configuration option. */
   buffer[pos++] = RPL_OPTION_DAG_CONF;
   buffer[pos++] = 14;
-  buffer[pos++] = 0; /* No Auth, PCS = 0 */
+  buffer[pos++] = instance->rfc8138 ? RPL_DAG_CONF_T_FLAG : 0; /* No Auth, PCS = 0 */
   buffer[pos++] = instance->dio_intdoubl;
   buffer[pos++] = instance->dio_intmin;
   buffer[pos++] = instance->dio_redundancy;
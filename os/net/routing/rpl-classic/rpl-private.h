@@ -97,6 +97,8 @@ extern uint8_t fixed_parent_id[NODE_NUM];
 #define RPL_DAO_K_FLAG                   0x80 /* DAO ACK requested */
 #define RPL_DAO_D_FLAG                   0x40 /* DODAG ID present */
 
+#define RPL_DAG_CONF_T_FLAG              0x20 /* RFC 8138 compression on (RFC 9035) */
+
 #define RPL_DAO_ACK_UNCONDITIONAL_ACCEPT 0
 #define RPL_DAO_ACK_ACCEPT               1   /* 1 - 127 is OK but not good */
 #define RPL_DAO_ACK_UNABLE_TO_ACCEPT     128 /* >127 is fail */
@@ -239,6 +241,7 @@ struct rpl_dio {
   uint8_t dag_intdoubl;
   uint8_t dag_intmin;
   uint8_t dag_redund;
+  uint8_t dag_rfc8138;
   uint8_t default_lifetime;
   uint16_t lifetime_unit;
   rpl_rank_t dag_max_rankinc;
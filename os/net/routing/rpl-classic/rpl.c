@@ -65,6 +65,10 @@
 rpl_stats_t rpl_stats;
 #endif
 
+#if WITH_A3
+struct tsch_a3_state a3_p;
+#endif
+
 /*---------------------------------------------------------------------------*/
 static uint16_t first_subtree_measure;
 static uint16_t next_subtree_measure;
@@ -390,22 +394,7 @@ init(void)
   default_instance = NULL;
 
 #if WITH_A3
-  a3_p_num_tx_slot = A3_INITIAL_NUM_OF_SLOTS;
-  a3_p_num_rx_slot = A3_INITIAL_NUM_OF_SLOTS;
-
-  a3_p_num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-  a3_p_num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-
-  a3_p_num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-  a3_p_num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-  a3_p_num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
-  a3_p_num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
-  a3_p_num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
-
-  a3_p_tx_attempt_rate_ewma = A3_INITIAL_TX_ATTEMPT_RATE_EWMA;
-  a3_p_rx_attempt_rate_ewma = A3_INITIAL_RX_ATTEMPT_RATE_EWMA;
-
-  a3_p_tx_success_rate_ewma = A3_INITIAL_TX_SUCCESS_RATE_EWMA;
+  tsch_a3_init(&a3_p);
 #endif
 
   rpl_dag_init();
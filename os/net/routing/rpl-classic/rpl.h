@@ -44,6 +44,9 @@
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-ds6.h"
 #include "sys/ctimer.h"
+#if WITH_A3
+#include "net/mac/tsch/tsch-a3.h"
+#endif
 
 void print_log_rpl_timers();
 void print_log_rpl();
@@ -55,23 +58,8 @@ void reset_log_rpl();
 void reset_log_rpl_ext_header();
 
 #if WITH_A3
-// HCK-A3: should these be here???
-uint8_t a3_p_num_tx_pkt_success;
-uint8_t a3_p_num_tx_pkt_collision;
-
-uint8_t a3_p_num_rx_pkt_success;
-uint8_t a3_p_num_rx_pkt_collision;
-uint8_t a3_p_num_rx_pkt_idle;
-uint8_t a3_p_num_rx_pkt_unscheduled;
-uint8_t a3_p_num_rx_pkt_others;
-
-double a3_p_tx_attempt_rate_ewma;
-double a3_p_rx_attempt_rate_ewma;
-
-double a3_p_tx_success_rate_ewma;
-
-uint8_t a3_p_num_tx_slot;
-uint8_t a3_p_num_rx_slot;
+/* A3 state of the cells with the parent */
+extern struct tsch_a3_state a3_p;
 #endif
 
 /*---------------------------------------------------------------------------*/
@@ -261,6 +249,7 @@ struct rpl_instance {
   uint8_t dio_intdoubl;
   uint8_t dio_intmin;
   uint8_t dio_redundancy;
+  uint8_t rfc8138; /* RPL option sent as a 6LoRH in this instance */
   uint8_t default_lifetime;
   uint8_t dio_intcurrent;
   uint8_t dio_send; /* for keeping track of which mode the timer is in */
@@ -89,77 +89,68 @@ uint8_t A3_SHIFT[8] = {0, 4, 2, 6, 1, 5, 3, 7};
 
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
 static struct tsch_slotframe *sf_unicast_after_lastly_scheduled_asfn;
-static uint8_t scheduling_sf_unicast_after_lastly_scheduled_asfn = 0;
+#endif
+
+#if ALICE_INCREMENTAL_RESCHEDULING && !WITH_A3
+/* Whether the unicast slotframe was lastly rebuilt as root (without parent links) */
+static uint8_t alice_scheduled_as_root = 0;
+#endif
+
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+/* Changed whenever the RPL neighbor set changes, invalidating the cells cached per neighbor */
+static uint16_t alice_pcm_cache_epoch = 1;
 #endif
 
 /*---------------------------------------------------------------------------*/
+/* Timeslot of a link from addr1 to addr2 in the given ASFN */
 static uint16_t
 #if WITH_A3
-get_node_timeslot(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id)
+get_node_timeslot_in_asfn(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id,
+                          uint64_t asfn)
 #else
-get_node_timeslot(const linkaddr_t *addr1, const linkaddr_t *addr2)
+get_node_timeslot_in_asfn(const linkaddr_t *addr1, const linkaddr_t *addr2, uint64_t asfn)
 #endif
 {
   if(addr1 != NULL && addr2 != NULL && ORCHESTRA_UNICAST_PERIOD > 0) {
     /* ALICE: link-based timeslot determination */
-#if !WITH_TSCH_DEFAULT_BURST_TRANSMISSION
 #if WITH_A3
     uint16_t a3_primary_zone = alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-                                                 + (uint32_t)alice_lastly_scheduled_asfn), 
+                                                 + (uint32_t)asfn), 
                                                 A3_MAX_ZONE);
     uint16_t a3_shifted_zone = (a3_primary_zone + A3_SHIFT[a3_slot_id]) % A3_MAX_ZONE;
     return (A3_ZONE_PERIOD) * a3_shifted_zone 
           + alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-                              + (uint32_t)alice_lastly_scheduled_asfn), (A3_ZONE_PERIOD)); 
+                              + (uint32_t)asfn), (A3_ZONE_PERIOD)); 
 #else /* WITH_A3 */
     return alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2) 
-                             + (uint32_t)alice_lastly_scheduled_asfn), 
+                             + (uint32_t)asfn), 
                             (ORCHESTRA_UNICAST_PERIOD));
 #endif /* WITH_A3 */
-#else /* WITH_TSCH_DEFAULT_BURST_TRANSMISSION */
-    if(scheduling_sf_unicast_after_lastly_scheduled_asfn == 1) {
-      return alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2) 
-                              + (uint32_t)alice_next_asfn_of_lastly_scheduled_asfn), 
-                              (ORCHESTRA_UNICAST_PERIOD));
-    } else {
-      return alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2) 
-                              + (uint32_t)alice_lastly_scheduled_asfn), 
-                              (ORCHESTRA_UNICAST_PERIOD));
-    }
-#endif
   } else {
     return 0xffff;
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Channel offset of a link from addr1 to addr2 in the given ASFN */
 static uint16_t
 #if WITH_A3
-get_node_channel_offset(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id)
+get_node_channel_offset_in_asfn(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id,
+                                uint64_t asfn)
 #else
-get_node_channel_offset(const linkaddr_t *addr1, const linkaddr_t *addr2)
+get_node_channel_offset_in_asfn(const linkaddr_t *addr1, const linkaddr_t *addr2, uint64_t asfn)
 #endif
 {
   /* ALICE: except for EB channel offset (1) */
   int num_ch = (sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE) / sizeof(uint8_t)) - 1;
   if(addr1 != NULL && addr2 != NULL && num_ch > 0) {
     /* ALICE: link-based, except for EB channel offset (1) */
-#if !WITH_TSCH_DEFAULT_BURST_TRANSMISSION
 #if WITH_A3
     return 1 + alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-                                 + (uint32_t)alice_lastly_scheduled_asfn + (uint32_t)a3_slot_id), 
+                                 + (uint32_t)asfn + (uint32_t)a3_slot_id), 
                                 num_ch);
 #else
     return 1 + alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-            + (uint32_t)alice_lastly_scheduled_asfn), num_ch); 
-#endif
-#else /* WITH_TSCH_DEFAULT_BURST_TRANSMISSION */
-    if(scheduling_sf_unicast_after_lastly_scheduled_asfn == 1) {
-      return 1 + alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-              + (uint32_t)alice_next_asfn_of_lastly_scheduled_asfn), num_ch); 
-    } else {
-      return 1 + alice_real_hash5(((uint32_t)ORCHESTRA_LINKADDR_HASH2(addr1, addr2)
-              + (uint32_t)alice_lastly_scheduled_asfn), num_ch); 
-    }
+            + (uint32_t)asfn), num_ch); 
 #endif
   } else {
     /* alice final check: should this be 0xffff ???? */
@@ -167,6 +158,34 @@ get_node_channel_offset(const linkaddr_t *addr1, const linkaddr_t *addr2)
   }
 }
 /*---------------------------------------------------------------------------*/
+/* Timeslot of a link from addr1 to addr2 in the lastly scheduled ASFN */
+static uint16_t
+#if WITH_A3
+get_node_timeslot(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id)
+{
+  return get_node_timeslot_in_asfn(addr1, addr2, a3_slot_id, alice_lastly_scheduled_asfn);
+}
+#else
+get_node_timeslot(const linkaddr_t *addr1, const linkaddr_t *addr2)
+{
+  return get_node_timeslot_in_asfn(addr1, addr2, alice_lastly_scheduled_asfn);
+}
+#endif
+/*---------------------------------------------------------------------------*/
+/* Channel offset of a link from addr1 to addr2 in the lastly scheduled ASFN */
+static uint16_t
+#if WITH_A3
+get_node_channel_offset(const linkaddr_t *addr1, const linkaddr_t *addr2, uint8_t a3_slot_id)
+{
+  return get_node_channel_offset_in_asfn(addr1, addr2, a3_slot_id, alice_lastly_scheduled_asfn);
+}
+#else
+get_node_channel_offset(const linkaddr_t *addr1, const linkaddr_t *addr2)
+{
+  return get_node_channel_offset_in_asfn(addr1, addr2, alice_lastly_scheduled_asfn);
+}
+#endif
+/*---------------------------------------------------------------------------*/
 static uint16_t
 alice_is_root() /* alice final check: can be replaced with rpl_dag_root_is_root() function */
 {
@@ -181,9 +200,9 @@ alice_is_root() /* alice final check: can be replaced with rpl_dag_root_is_root(
   return 0;
 }
 /*---------------------------------------------------------------------------*/
-/* Remove current slotframe scheduling and re-schedule this slotframe. */
+/* Add the links with the parent and the child nodes in the given ASFN to an empty slotframe. */
 static void
-alice_schedule_unicast_slotframe(void)
+alice_add_unicast_links(struct tsch_slotframe *sf, uint64_t asfn)
 {
   /* schedule for parent node */
   uint16_t upward_timeslot_for_parent, downward_timeslot_for_parent;
@@ -200,78 +219,41 @@ alice_schedule_unicast_slotframe(void)
   uint8_t a3_slot_id = 0;
 #endif
 
-  /* Remove the whole links scheduled in the unicast slotframe */
-  struct tsch_link *l;
-  l = list_head(sf_unicast->links_list);
-  while(l != NULL) {
-    tsch_schedule_remove_link(sf_unicast, l);
-    l = list_head(sf_unicast->links_list);
-  }
-
-#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
-  l = list_head(sf_unicast_after_lastly_scheduled_asfn->links_list);
-  while(l != NULL) {
-    tsch_schedule_remove_link(sf_unicast_after_lastly_scheduled_asfn, l);
-    l = list_head(sf_unicast_after_lastly_scheduled_asfn->links_list);
-  }
-#endif
-
   /* NO ROOT ONLY: Schedule the links for parent node */
   if(alice_is_root() != 1) {
 
 #if WITH_A3
-    for(a3_slot_id = 0; a3_slot_id < a3_p_num_tx_slot; a3_slot_id++) {
-      upward_timeslot_for_parent = get_node_timeslot(&linkaddr_node_addr, &orchestra_parent_linkaddr, a3_slot_id);
-      upward_channel_offset_for_parent = get_node_channel_offset(&linkaddr_node_addr, &orchestra_parent_linkaddr, a3_slot_id);
+    for(a3_slot_id = 0; a3_slot_id < a3_p.num_tx_slot; a3_slot_id++) {
+      upward_timeslot_for_parent = get_node_timeslot_in_asfn(&linkaddr_node_addr, &orchestra_parent_linkaddr, a3_slot_id, asfn);
+      upward_channel_offset_for_parent = get_node_channel_offset_in_asfn(&linkaddr_node_addr, &orchestra_parent_linkaddr, a3_slot_id, asfn);
       upward_link_option = alice_tx_link_option;
-      alice_tsch_schedule_add_link(sf_unicast, upward_link_option, LINK_TYPE_NORMAL, 
+      alice_tsch_schedule_add_link(sf, upward_link_option, LINK_TYPE_NORMAL, 
                                   &tsch_broadcast_address, upward_timeslot_for_parent, upward_channel_offset_for_parent,
                                   &orchestra_parent_linkaddr);
     }
-    for(a3_slot_id = 0; a3_slot_id < a3_p_num_rx_slot; a3_slot_id++) {
-      downward_timeslot_for_parent = get_node_timeslot(&orchestra_parent_linkaddr, &linkaddr_node_addr, a3_slot_id);
-      downward_channel_offset_for_parent = get_node_channel_offset(&orchestra_parent_linkaddr, &linkaddr_node_addr, a3_slot_id);
+    for(a3_slot_id = 0; a3_slot_id < a3_p.num_rx_slot; a3_slot_id++) {
+      downward_timeslot_for_parent = get_node_timeslot_in_asfn(&orchestra_parent_linkaddr, &linkaddr_node_addr, a3_slot_id, asfn);
+      downward_channel_offset_for_parent = get_node_channel_offset_in_asfn(&orchestra_parent_linkaddr, &linkaddr_node_addr, a3_slot_id, asfn);
       downward_link_option = alice_rx_link_option;
-      alice_tsch_schedule_add_link(sf_unicast, downward_link_option, LINK_TYPE_NORMAL, 
+      alice_tsch_schedule_add_link(sf, downward_link_option, LINK_TYPE_NORMAL, 
                                   &tsch_broadcast_address, downward_timeslot_for_parent, downward_channel_offset_for_parent,
                                   &orchestra_parent_linkaddr);
     }
 #else /* WITH_A3 */
-    upward_timeslot_for_parent = get_node_timeslot(&linkaddr_node_addr, &orchestra_parent_linkaddr);
-    upward_channel_offset_for_parent = get_node_channel_offset(&linkaddr_node_addr, &orchestra_parent_linkaddr);
+    upward_timeslot_for_parent = get_node_timeslot_in_asfn(&linkaddr_node_addr, &orchestra_parent_linkaddr, asfn);
+    upward_channel_offset_for_parent = get_node_channel_offset_in_asfn(&linkaddr_node_addr, &orchestra_parent_linkaddr, asfn);
     upward_link_option = alice_tx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast, upward_link_option, LINK_TYPE_NORMAL, 
+    alice_tsch_schedule_add_link(sf, upward_link_option, LINK_TYPE_NORMAL, 
                                 &tsch_broadcast_address, upward_timeslot_for_parent, upward_channel_offset_for_parent,
                                 &orchestra_parent_linkaddr);
 
-    downward_timeslot_for_parent = get_node_timeslot(&orchestra_parent_linkaddr, &linkaddr_node_addr);
-    downward_channel_offset_for_parent = get_node_channel_offset(&orchestra_parent_linkaddr, &linkaddr_node_addr);
+    downward_timeslot_for_parent = get_node_timeslot_in_asfn(&orchestra_parent_linkaddr, &linkaddr_node_addr, asfn);
+    downward_channel_offset_for_parent = get_node_channel_offset_in_asfn(&orchestra_parent_linkaddr, &linkaddr_node_addr, asfn);
     downward_link_option = alice_rx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast, downward_link_option, LINK_TYPE_NORMAL, 
+    alice_tsch_schedule_add_link(sf, downward_link_option, LINK_TYPE_NORMAL, 
                                 &tsch_broadcast_address, downward_timeslot_for_parent, downward_channel_offset_for_parent,
                                 &orchestra_parent_linkaddr);
 #endif /* WITH_A3 */
-
-#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
-    scheduling_sf_unicast_after_lastly_scheduled_asfn = 1;
-
-    upward_timeslot_for_parent = get_node_timeslot(&linkaddr_node_addr, &orchestra_parent_linkaddr);
-    upward_channel_offset_for_parent = get_node_channel_offset(&linkaddr_node_addr, &orchestra_parent_linkaddr);
-    upward_link_option = alice_tx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast_after_lastly_scheduled_asfn, upward_link_option, LINK_TYPE_NORMAL, 
-                                &tsch_broadcast_address, upward_timeslot_for_parent, upward_channel_offset_for_parent,
-                                &orchestra_parent_linkaddr);
-
-    downward_timeslot_for_parent = get_node_timeslot(&orchestra_parent_linkaddr, &linkaddr_node_addr);
-    downward_channel_offset_for_parent = get_node_channel_offset(&orchestra_parent_linkaddr, &linkaddr_node_addr);
-    downward_link_option = alice_rx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast_after_lastly_scheduled_asfn, downward_link_option, LINK_TYPE_NORMAL, 
-                                &tsch_broadcast_address, downward_timeslot_for_parent, downward_channel_offset_for_parent,
-                                &orchestra_parent_linkaddr);
-
-    scheduling_sf_unicast_after_lastly_scheduled_asfn = 0;
-#endif
-
   }
 
   /* Schedule the links for child nodes */
@@ -284,64 +266,74 @@ alice_schedule_unicast_slotframe(void)
     uint8_t a3_c_num_rx_slot = A3_INITIAL_NUM_OF_SLOTS;
     uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)addr);
     if(it != NULL) {
-      a3_c_num_tx_slot = it->a3_c_num_tx_slot;
-      a3_c_num_rx_slot = it->a3_c_num_rx_slot;
+      a3_c_num_tx_slot = it->a3_c.num_tx_slot;
+      a3_c_num_rx_slot = it->a3_c.num_rx_slot;
     }
     for(a3_slot_id = 0; a3_slot_id < a3_c_num_rx_slot; a3_slot_id++) {
-      upward_timeslot_for_child = get_node_timeslot(addr, &linkaddr_node_addr, a3_slot_id);
-      upward_channel_offset_for_child = get_node_channel_offset(addr, &linkaddr_node_addr, a3_slot_id);
+      upward_timeslot_for_child = get_node_timeslot_in_asfn(addr, &linkaddr_node_addr, a3_slot_id, asfn);
+      upward_channel_offset_for_child = get_node_channel_offset_in_asfn(addr, &linkaddr_node_addr, a3_slot_id, asfn);
       upward_link_option = alice_rx_link_option;
-      alice_tsch_schedule_add_link(sf_unicast, upward_link_option, LINK_TYPE_NORMAL, 
+      alice_tsch_schedule_add_link(sf, upward_link_option, LINK_TYPE_NORMAL, 
                                   &tsch_broadcast_address, upward_timeslot_for_child, upward_channel_offset_for_child,
                                   addr);
     }
     for(a3_slot_id = 0; a3_slot_id < a3_c_num_tx_slot; a3_slot_id++) {
-      downward_timeslot_for_child = get_node_timeslot(&linkaddr_node_addr, addr, a3_slot_id);
-      downward_channel_offset_for_child = get_node_channel_offset(&linkaddr_node_addr, addr, a3_slot_id);
+      downward_timeslot_for_child = get_node_timeslot_in_asfn(&linkaddr_node_addr, addr, a3_slot_id, asfn);
+      downward_channel_offset_for_child = get_node_channel_offset_in_asfn(&linkaddr_node_addr, addr, a3_slot_id, asfn);
       downward_link_option = alice_tx_link_option;
-      alice_tsch_schedule_add_link(sf_unicast, downward_link_option, LINK_TYPE_NORMAL, 
+      alice_tsch_schedule_add_link(sf, downward_link_option, LINK_TYPE_NORMAL, 
                                   &tsch_broadcast_address, downward_timeslot_for_child, downward_channel_offset_for_child,
                                   addr);
     }
 #else /* WITH_A3 */
-    upward_timeslot_for_child = get_node_timeslot(addr, &linkaddr_node_addr);
-    upward_channel_offset_for_child = get_node_channel_offset(addr, &linkaddr_node_addr);
+    upward_timeslot_for_child = get_node_timeslot_in_asfn(addr, &linkaddr_node_addr, asfn);
+    upward_channel_offset_for_child = get_node_channel_offset_in_asfn(addr, &linkaddr_node_addr, asfn);
     upward_link_option = alice_rx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast, upward_link_option, LINK_TYPE_NORMAL, 
+    alice_tsch_schedule_add_link(sf, upward_link_option, LINK_TYPE_NORMAL, 
                                 &tsch_broadcast_address, upward_timeslot_for_child, upward_channel_offset_for_child,
                                 addr);
 
-    downward_timeslot_for_child = get_node_timeslot(&linkaddr_node_addr, addr); 
-    downward_channel_offset_for_child = get_node_channel_offset(&linkaddr_node_addr, addr);
+    downward_timeslot_for_child = get_node_timeslot_in_asfn(&linkaddr_node_addr, addr, asfn); 
+    downward_channel_offset_for_child = get_node_channel_offset_in_asfn(&linkaddr_node_addr, addr, asfn);
     downward_link_option = alice_tx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast, downward_link_option, LINK_TYPE_NORMAL, 
+    alice_tsch_schedule_add_link(sf, downward_link_option, LINK_TYPE_NORMAL, 
                                 &tsch_broadcast_address, downward_timeslot_for_child, downward_channel_offset_for_child,
                                 addr);
 #endif /* WITH_A3 */
 
-#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
-    scheduling_sf_unicast_after_lastly_scheduled_asfn = 1;
-
-    upward_timeslot_for_child = get_node_timeslot(addr, &linkaddr_node_addr);
-    upward_channel_offset_for_child = get_node_channel_offset(addr, &linkaddr_node_addr);
-    upward_link_option = alice_rx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast_after_lastly_scheduled_asfn, upward_link_option, LINK_TYPE_NORMAL, 
-                                &tsch_broadcast_address, upward_timeslot_for_child, upward_channel_offset_for_child,
-                                addr);
+    /* move to the next item for while loop. */
+    item = nbr_table_next(nbr_routes, item);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Remove current slotframe scheduling and re-schedule this slotframe. */
+static void
+alice_schedule_unicast_slotframe(void)
+{
+#if ALICE_INCREMENTAL_RESCHEDULING && !WITH_A3
+  alice_scheduled_as_root = alice_is_root();
+#endif
 
-    downward_timeslot_for_child = get_node_timeslot(&linkaddr_node_addr, addr); 
-    downward_channel_offset_for_child = get_node_channel_offset(&linkaddr_node_addr, addr);
-    downward_link_option = alice_tx_link_option;
-    alice_tsch_schedule_add_link(sf_unicast_after_lastly_scheduled_asfn, downward_link_option, LINK_TYPE_NORMAL, 
-                                &tsch_broadcast_address, downward_timeslot_for_child, downward_channel_offset_for_child,
-                                addr);
+  /* Remove the whole links scheduled in the unicast slotframe */
+  struct tsch_link *l;
+  l = list_head(sf_unicast->links_list);
+  while(l != NULL) {
+    tsch_schedule_remove_link(sf_unicast, l);
+    l = list_head(sf_unicast->links_list);
+  }
 
-    scheduling_sf_unicast_after_lastly_scheduled_asfn = 0;
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+  l = list_head(sf_unicast_after_lastly_scheduled_asfn->links_list);
+  while(l != NULL) {
+    tsch_schedule_remove_link(sf_unicast_after_lastly_scheduled_asfn, l);
+    l = list_head(sf_unicast_after_lastly_scheduled_asfn->links_list);
+  }
 #endif
 
-    /* move to the next item for while loop. */
-    item = nbr_table_next(nbr_routes, item);
-  }
+  alice_add_unicast_links(sf_unicast, alice_lastly_scheduled_asfn);
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+  alice_add_unicast_links(sf_unicast_after_lastly_scheduled_asfn, alice_next_asfn_of_lastly_scheduled_asfn);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static int
@@ -382,7 +374,7 @@ alice_packet_cell_matching_on_the_fly(uint16_t *timeslot, uint16_t *channel_offs
 
 #if WITH_A3
     uint8_t a3_slot_id = 0;
-    for(a3_slot_id = 0; a3_slot_id < a3_p_num_tx_slot; a3_slot_id++) {
+    for(a3_slot_id = 0; a3_slot_id < a3_p.num_tx_slot; a3_slot_id++) {
       *timeslot = get_node_timeslot(&linkaddr_node_addr, rx_linkaddr, a3_slot_id);
       *channel_offset = get_node_channel_offset(&linkaddr_node_addr, rx_linkaddr, a3_slot_id);
 
@@ -409,7 +401,7 @@ alice_packet_cell_matching_on_the_fly(uint16_t *timeslot, uint16_t *channel_offs
     uint8_t a3_c_num_tx_slot = 1;
     uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)rx_linkaddr);
     if(it != NULL) {
-      a3_c_num_tx_slot = it->a3_c_num_tx_slot;
+      a3_c_num_tx_slot = it->a3_c.num_tx_slot;
     }
 
     uint8_t a3_slot_id = 0;
@@ -440,16 +432,235 @@ alice_packet_cell_matching_on_the_fly(uint16_t *timeslot, uint16_t *channel_offs
 
   return is_rpl_neighbor; // returns 0 -> triggers ALICE_EARLY_PACKET_DROP
 }
+/*---------------------------------------------------------------------------*/
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+static void
+alice_pcm_cache_invalidate(void)
+{
+  /* Neighbor entries are zeroed when added: never use epoch 0 */
+  if(++alice_pcm_cache_epoch == 0) {
+    alice_pcm_cache_epoch = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Computes the Tx cells to a neighbor in the lastly scheduled ASFN, as
+ * alice_packet_cell_matching_on_the_fly() does, and caches them in the neighbor */
+static void
+alice_pcm_cache_fill(struct tsch_neighbor *n, const linkaddr_t *rx_linkaddr)
+{
+  uint8_t num_cells = 0;
+  uint8_t i;
+
+#if ALICE_DBG_PCM_CYCLES
+  alice_pcm_miss_count++;
 #endif
+
+  n->alice_pcm_is_rpl_nbr = 0;
+  if(linkaddr_cmp(&orchestra_parent_linkaddr, rx_linkaddr)) {
+    n->alice_pcm_is_rpl_nbr = 1;
+#if WITH_A3
+    num_cells = a3_p.num_tx_slot;
+#else
+    num_cells = 1;
+#endif
+  } else if(nbr_table_get_from_lladdr(nbr_routes, rx_linkaddr) != NULL) {
+    n->alice_pcm_is_rpl_nbr = 1;
+#if WITH_A3
+    uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)rx_linkaddr);
+    num_cells = it != NULL ? it->a3_c.num_tx_slot : 1;
+#else
+    num_cells = 1;
+#endif
+  }
+
+  if(num_cells > ALICE_PCM_CACHE_MAX_CELLS) {
+    num_cells = ALICE_PCM_CACHE_MAX_CELLS;
+  }
+  for(i = 0; i < num_cells; i++) {
+#if WITH_A3
+    n->alice_pcm_timeslot[i] = get_node_timeslot(&linkaddr_node_addr, rx_linkaddr, i);
+    n->alice_pcm_channel_offset[i] = get_node_channel_offset(&linkaddr_node_addr, rx_linkaddr, i);
+#else
+    n->alice_pcm_timeslot[i] = get_node_timeslot(&linkaddr_node_addr, rx_linkaddr);
+    n->alice_pcm_channel_offset[i] = get_node_channel_offset(&linkaddr_node_addr, rx_linkaddr);
+#endif
+  }
+  n->alice_pcm_num_cells = num_cells;
+  n->alice_pcm_asfn = alice_lastly_scheduled_asfn;
+  n->alice_pcm_epoch = alice_pcm_cache_epoch;
+}
+/*---------------------------------------------------------------------------*/
+/* Same as alice_packet_cell_matching_on_the_fly(), using the cells cached in the neighbor */
+int
+alice_packet_cell_matching_cached(struct tsch_neighbor *n, uint16_t *timeslot, uint16_t *channel_offset, const linkaddr_t *rx_linkaddr)
+{
+  uint8_t i;
+
+  if(n->alice_pcm_asfn != alice_lastly_scheduled_asfn
+     || n->alice_pcm_epoch != alice_pcm_cache_epoch) {
+    alice_pcm_cache_fill(n, rx_linkaddr);
+  }
+
+  if(!n->alice_pcm_is_rpl_nbr) {
+    *timeslot = 0;
+    *channel_offset = ALICE_COMMON_SF_HANDLE;
+    return 0;
+  }
+
+  /* Keep the current cell if it is one of the cells to this neighbor, otherwise the last one */
+  for(i = 0; i < n->alice_pcm_num_cells; i++) {
+    if(n->alice_pcm_timeslot[i] == *timeslot && n->alice_pcm_channel_offset[i] == *channel_offset) {
+      return 1;
+    }
+  }
+  if(n->alice_pcm_num_cells > 0) {
+    *timeslot = n->alice_pcm_timeslot[n->alice_pcm_num_cells - 1];
+    *channel_offset = n->alice_pcm_channel_offset[n->alice_pcm_num_cells - 1];
+  }
+  return 1;
+}
+#endif /* ALICE_PACKET_CELL_MATCHING_CACHE */
+#endif
+/*---------------------------------------------------------------------------*/
+#if ALICE_INCREMENTAL_RESCHEDULING && !WITH_A3
+/* Set link options of a link scheduled in place, keeping tx link counters in sync */
+static void
+alice_set_link_options(struct tsch_link *l, uint8_t link_options)
+{
+  uint8_t changed = l->link_options ^ link_options;
+
+  if(changed & (LINK_OPTION_TX | LINK_OPTION_SHARED)) {
+    struct tsch_neighbor *n = tsch_queue_get_nbr(&l->addr);
+    if(n != NULL) {
+      if(l->link_options & LINK_OPTION_TX) {
+        n->tx_links_count--;
+        if(!(l->link_options & LINK_OPTION_SHARED)) {
+          n->dedicated_tx_links_count--;
+        }
+      }
+      if(link_options & LINK_OPTION_TX) {
+        n->tx_links_count++;
+        if(!(link_options & LINK_OPTION_SHARED)) {
+          n->dedicated_tx_links_count++;
+        }
+      }
+    }
+  }
+  l->link_options = link_options;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Move the links of the unicast slotframe to their cells in the given ASFN.
+ * Links are neither removed nor added: only timeslot and channel offset are
+ * rewritten from the hash precomputed in alice_tsch_schedule_add_link().
+ * Link options of links sharing a cell are merged as alice_tsch_schedule_add_link() does.
+ */
+static void
+alice_reschedule_unicast_slotframe_in_place(struct tsch_slotframe *sf, uint64_t asfn)
+{
+  /* Bitmaps of used and overlapped channel offsets per timeslot */
+  static uint32_t used_cells[ORCHESTRA_UNICAST_PERIOD];
+  static uint32_t overlapped_cells[ORCHESTRA_UNICAST_PERIOD];
+  int num_ch = (sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE) / sizeof(uint8_t)) - 1;
+  uint8_t overlapped = 0;
+  struct tsch_link *l;
+  struct tsch_link *m;
+
+  memset(used_cells, 0, sizeof(used_cells));
+  memset(overlapped_cells, 0, sizeof(overlapped_cells));
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    uint32_t seed = l->alice_link_hash + (uint32_t)asfn;
+    uint32_t cell_bit;
+
+    l->timeslot = alice_real_hash5(seed, ORCHESTRA_UNICAST_PERIOD);
+    l->channel_offset = 1 + alice_real_hash5(seed, num_ch);
+
+    cell_bit = (uint32_t)1 << l->channel_offset;
+    if(used_cells[l->timeslot] & cell_bit) {
+      overlapped_cells[l->timeslot] |= cell_bit;
+      overlapped = 1;
+    }
+    used_cells[l->timeslot] |= cell_bit;
+  }
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    uint8_t link_options = l->alice_link_options;
+
+    if(overlapped && (overlapped_cells[l->timeslot] & ((uint32_t)1 << l->channel_offset))) {
+      for(m = list_head(sf->links_list); m != NULL; m = list_item_next(m)) {
+        if(m->timeslot == l->timeslot && m->channel_offset == l->channel_offset) {
+          link_options |= m->alice_link_options;
+        }
+      }
+    }
+    alice_set_link_options(l, link_options);
+  }
+
+#if TSCH_SCHEDULE_WITH_INDEX
+  tsch_schedule_index_sort_slotframe(sf);
+#endif
+}
+#endif /* ALICE_INCREMENTAL_RESCHEDULING && !WITH_A3 */
 /*---------------------------------------------------------------------------*/
 /* slotframe_callback. */
 #ifdef ALICE_TIME_VARYING_SCHEDULING
 void
 alice_time_varying_scheduling()
 {  
+#if ALICE_INCREMENTAL_RESCHEDULING && !WITH_A3
+  if(alice_is_root() == alice_scheduled_as_root) {
+    alice_reschedule_unicast_slotframe_in_place(sf_unicast, alice_lastly_scheduled_asfn);
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+    alice_reschedule_unicast_slotframe_in_place(sf_unicast_after_lastly_scheduled_asfn,
+                                                alice_next_asfn_of_lastly_scheduled_asfn);
+#endif
+  } else {
+    alice_schedule_unicast_slotframe();
+  }
+#else
   alice_schedule_unicast_slotframe();
+#endif
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#ifdef ALICE_DEFERRED_RESCHEDULING
+PROCESS(alice_rescheduling_process, "ALICE rescheduling");
+/*---------------------------------------------------------------------------*/
+/* Called by TSCH when the schedule moved to a new ASFN, or when the links
+   prepared for the next ASFN are outdated */
+void
+alice_deferred_rescheduling(void)
+{
+  process_poll(&alice_rescheduling_process);
 }
+/*---------------------------------------------------------------------------*/
+/* Updates A3 with the results of the ASFN that ended and adds the links of
+   the next ASFN to the shadow slotframe, out of the slot operation */
+PROCESS_THREAD(alice_rescheduling_process, ev, data)
+{
+  struct tsch_slotframe *shadow;
+  uint64_t asfn;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+#if WITH_A3
+    alice_a3_update();
 #endif
+    shadow = alice_shadow_slotframe_begin();
+    if(shadow != NULL) {
+      asfn = alice_lastly_scheduled_asfn + 1;
+      alice_add_unicast_links(shadow, asfn);
+      alice_shadow_slotframe_commit(asfn);
+    }
+  }
+
+  PROCESS_END();
+}
+#endif /* ALICE_DEFERRED_RESCHEDULING */
 /*---------------------------------------------------------------------------*/
 static void
 child_added(const linkaddr_t *linkaddr)
@@ -460,28 +671,19 @@ child_added(const linkaddr_t *linkaddr)
     if(item != NULL) {
       uip_ds6_nbr_t *it = uip_ds6_nbr_ll_lookup((uip_lladdr_t *)linkaddr);
       if(it != NULL) {
-        it->a3_c_num_tx_slot = A3_INITIAL_NUM_OF_SLOTS; // WITH_A3;
-        it->a3_c_num_rx_slot = A3_INITIAL_NUM_OF_SLOTS; // WITH_A3;
-
-        it->a3_c_num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-        it->a3_c_num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-
-        it->a3_c_num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-        it->a3_c_num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-        it->a3_c_num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
-        it->a3_c_num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
-        it->a3_c_num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
-
-        it->a3_c_tx_attempt_rate_ewma = A3_INITIAL_TX_ATTEMPT_RATE_EWMA;
-        it->a3_c_rx_attempt_rate_ewma = A3_INITIAL_RX_ATTEMPT_RATE_EWMA;
-
-        it->a3_c_tx_success_rate_ewma = A3_INITIAL_TX_SUCCESS_RATE_EWMA;
+        tsch_a3_init(&it->a3_c);
       }
     }
   }
 #endif
 
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+  alice_pcm_cache_invalidate();
+#endif
   alice_schedule_unicast_slotframe();
+#ifdef ALICE_DEFERRED_RESCHEDULING
+  alice_shadow_slotframe_invalidate();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -493,8 +695,14 @@ child_removed(const linkaddr_t *linkaddr)
 #elif HCK_ORCHESTRA_PACKET_OFFLOADING
   const struct tsch_neighbor *removed_child = tsch_queue_get_nbr(linkaddr);
   tsch_queue_change_attr_of_packets_in_queue(removed_child, ALICE_COMMON_SF_HANDLE, 0);
+#endif
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+  alice_pcm_cache_invalidate();
 #endif
   alice_schedule_unicast_slotframe();
+#ifdef ALICE_DEFERRED_RESCHEDULING
+  alice_shadow_slotframe_invalidate();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static int
@@ -534,22 +742,7 @@ new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new
       linkaddr_copy(&orchestra_parent_linkaddr, new_addr);    
 
 #if WITH_A3
-      a3_p_num_tx_slot = A3_INITIAL_NUM_OF_SLOTS; // WITH_A3;
-      a3_p_num_rx_slot = A3_INITIAL_NUM_OF_SLOTS; // WITH_A3;
-
-      a3_p_num_tx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-      a3_p_num_tx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-
-      a3_p_num_rx_pkt_success = A3_INITIAL_NUM_OF_PKTS;
-      a3_p_num_rx_pkt_collision = A3_INITIAL_NUM_OF_PKTS;
-      a3_p_num_rx_pkt_idle = A3_INITIAL_NUM_OF_PKTS;
-      a3_p_num_rx_pkt_unscheduled = A3_INITIAL_NUM_OF_PKTS;
-      a3_p_num_rx_pkt_others = A3_INITIAL_NUM_OF_PKTS;
-
-      a3_p_tx_attempt_rate_ewma = A3_INITIAL_TX_ATTEMPT_RATE_EWMA;
-      a3_p_rx_attempt_rate_ewma = A3_INITIAL_RX_ATTEMPT_RATE_EWMA;
-
-      a3_p_tx_success_rate_ewma = A3_INITIAL_TX_SUCCESS_RATE_EWMA;
+      tsch_a3_init(&a3_p);
 #endif
 
     } else {
@@ -564,7 +757,13 @@ new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new
     tsch_queue_change_attr_of_packets_in_queue(old, ALICE_COMMON_SF_HANDLE, 0);
 #endif
 
+#if ALICE_PACKET_CELL_MATCHING_CACHE
+    alice_pcm_cache_invalidate();
+#endif
     alice_schedule_unicast_slotframe(); 
+#ifdef ALICE_DEFERRED_RESCHEDULING
+    alice_shadow_slotframe_invalidate();
+#endif
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -584,6 +783,10 @@ init(uint16_t sf_handle)
   sf_unicast_after_lastly_scheduled_asfn 
     = tsch_schedule_add_slotframe(ALICE_AFTER_LASTLY_SCHEDULED_ASFN_SF_HANDLE, ORCHESTRA_UNICAST_PERIOD);
 #endif
+
+#ifdef ALICE_DEFERRED_RESCHEDULING
+  process_start(&alice_rescheduling_process, NULL);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 struct orchestra_rule unicast_per_neighbor_rpl_storing = {
@@ -120,6 +120,7 @@ ost_reset_nbr(const linkaddr_t *addr, uint8_t newly_added, uint8_t rx_no_path)
       nbr->ost_nbr_t_offset = 0xffff;
 
       nbr->ost_num_tx = 0;
+      nbr->ost_tx_load = OST_TX_LOAD_NONE;
 
       if(newly_added == 1) {
         nbr->ost_newly_added = 1;
@@ -193,21 +194,25 @@ change_attr_in_tx_queue(const linkaddr_t * dest)
 
     tsch_queue_backoff_reset(dest_nbr);
 
-    get_index = ringbufindex_peek_get(&dest_nbr->tx_ringbuf);
-    num_elements = ringbufindex_elements(&dest_nbr->tx_ringbuf);
-    
-    uint8_t i;
-    for(i = get_index; i < get_index + num_elements; i++) {
-      int16_t index;
+    uint8_t c;
+    for(c = 0; c < TSCH_QUEUE_NUM_CLASSES; c++) {
+      struct ringbufindex *ringbuf = TSCH_QUEUE_RINGBUF(dest_nbr, c);
+      get_index = ringbufindex_peek_get(ringbuf);
+      num_elements = ringbufindex_elements(ringbuf);
 
-      if(i >= ringbufindex_size(&dest_nbr->tx_ringbuf)) { /* default size: 16 */
-        index = i - ringbufindex_size(&dest_nbr->tx_ringbuf);
-      } else {
-        index = i;  
-      }
+      uint8_t i;
+      for(i = get_index; i < get_index + num_elements; i++) {
+        int16_t index;
+
+        if(i >= ringbufindex_size(ringbuf)) { /* default size: 16 */
+          index = i - ringbufindex_size(ringbuf);
+        } else {
+          index = i;
+        }
 
-      ost_set_queuebuf_attr(dest_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
-      ost_set_queuebuf_attr(dest_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+        ost_set_queuebuf_attr(TSCH_QUEUE_PACKET(dest_nbr, c, index)->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
+        ost_set_queuebuf_attr(TSCH_QUEUE_PACKET(dest_nbr, c, index)->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+      }
     }
   }
 }
@@ -276,7 +281,10 @@ add_uc_link(const linkaddr_t *linkaddr)
      * If this is an Rx link, that is what the node needs to use.
      * If this is a Tx link, packet's channel offset will override the link's channel offset.
      */
-#if WITH_OST
+#if WITH_OST && TSCH_SCHEDULE_WITH_CMD_RING
+    tsch_schedule_cmd_add_link(sf_unicast->handle, link_options, LINK_TYPE_NORMAL,
+          &tsch_broadcast_address, timeslot, channel_offset);
+#elif WITH_OST
     tsch_schedule_add_link(sf_unicast, link_options, LINK_TYPE_NORMAL, &tsch_broadcast_address,
           timeslot, channel_offset, 1);
 #else
@@ -290,21 +298,30 @@ static void
 remove_uc_link(const linkaddr_t *linkaddr)
 {
   uint16_t timeslot;
+#if !(WITH_OST && TSCH_SCHEDULE_WITH_CMD_RING)
   struct tsch_link *l;
+#endif
 
   if(linkaddr == NULL) {
     return;
   }
 
   timeslot = get_node_timeslot(linkaddr);
-#if WITH_OST
+#if WITH_OST && TSCH_SCHEDULE_WITH_CMD_RING
+  /* The schedule is behind by the pending commands, an add among them
+   * included: the remove is queued anyway, and does nothing if the link is
+   * not there once they are applied */
+#elif WITH_OST
   l = tsch_schedule_get_link_by_timeslot(sf_unicast, timeslot, channel_offset);
+  if(l == NULL) {
+    return;
+  }
 #else
   l = tsch_schedule_get_link_by_timeslot(sf_unicast, timeslot, local_channel_offset);
-#endif
   if(l == NULL) {
     return;
   }
+#endif
   /* Does our current parent need this timeslot? */
   if(timeslot == get_node_timeslot(&orchestra_parent_linkaddr)) {
     /* Yes, this timeslot is being used, return */
@@ -326,7 +343,10 @@ remove_uc_link(const linkaddr_t *linkaddr)
   if(timeslot == get_node_timeslot(&linkaddr_node_addr)) {
     /* This is our link, keep it but update the link options */
     uint8_t link_options = ORCHESTRA_UNICAST_SENDER_BASED ? LINK_OPTION_TX | UNICAST_SLOT_SHARED_FLAG: LINK_OPTION_RX;
-#if WITH_OST
+#if WITH_OST && TSCH_SCHEDULE_WITH_CMD_RING
+    tsch_schedule_cmd_modify_link(sf_unicast->handle, link_options, LINK_TYPE_NORMAL,
+          &tsch_broadcast_address, timeslot, channel_offset);
+#elif WITH_OST
     tsch_schedule_add_link(sf_unicast, link_options, LINK_TYPE_NORMAL, &tsch_broadcast_address,
               timeslot, channel_offset, 1);
 #else
@@ -335,7 +355,11 @@ remove_uc_link(const linkaddr_t *linkaddr)
 #endif
   } else {
     /* Remove link */
+#if WITH_OST && TSCH_SCHEDULE_WITH_CMD_RING
+    tsch_schedule_cmd_remove_link(sf_unicast->handle, timeslot, channel_offset);
+#else
     tsch_schedule_remove_link(sf_unicast, l);
+#endif
   }
 }
 /*---------------------------------------------------------------------------*/
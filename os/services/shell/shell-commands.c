@@ -833,6 +833,71 @@ PT_THREAD(cmd_tsch_schedule(struct pt *pt, shell_output_func output, char *args)
   }
   PT_END(pt);
 }
+#if TSCH_SLOT_PROFILER
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  struct tsch_slot_profiler_summary s;
+  uint8_t i;
+
+  PT_BEGIN(pt);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    tsch_slot_profiler_reset();
+    SHELL_OUTPUT(output, "TSCH slot profile reset\n");
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "TSCH slot profile (us from slot start), overruns %lu:\n",
+               (unsigned long)tsch_slot_profiler_total_overruns());
+  for(i = 0; i < TSCH_SLOT_PROF_PHASE_NUM; i++) {
+    if(tsch_slot_profiler_get(i, &s)) {
+      SHELL_OUTPUT(output, "-- %s: n %lu, min %u, avg %u, max %u, p99 %u, overruns %u\n",
+                   tsch_slot_profiler_phase_name(i), (unsigned long)s.count,
+                   s.min, s.mean, s.max, s.p99, s.overruns);
+    }
+  }
+  PT_END(pt);
+}
+#endif /* TSCH_SLOT_PROFILER */
+#if TSCH_METRICS
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_metrics(struct pt *pt, shell_output_func output, char *args))
+{
+  struct tsch_metric_summary s;
+  uint8_t i;
+  uint8_t b;
+
+  PT_BEGIN(pt);
+
+  if(args != NULL && !strcmp(args, "reset")) {
+    tsch_metrics_reset();
+    SHELL_OUTPUT(output, "TSCH metrics reset\n");
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "TSCH metrics:\n");
+  for(i = 0; i < TSCH_METRIC_NUM; i++) {
+    tsch_metrics_get(i, &s);
+    if(s.type != TSCH_METRIC_HISTOGRAM) {
+      SHELL_OUTPUT(output, "-- %s: %lu\n", tsch_metrics_name(i), (unsigned long)s.value);
+    } else {
+      SHELL_OUTPUT(output, "-- %s: n %lu, sum %lu, min %lu, max %lu\n",
+                   tsch_metrics_name(i), (unsigned long)s.value, (unsigned long)s.sum,
+                   (unsigned long)s.min, (unsigned long)s.max);
+      for(b = 0; b < TSCH_METRICS_HIST_BUCKETS; b++) {
+        if(s.buckets[b] != 0) {
+          SHELL_OUTPUT(output, "   >= %lu: %u\n",
+                       (unsigned long)tsch_metrics_bucket_lower_bound(i, b), s.buckets[b]);
+        }
+      }
+    }
+  }
+  PT_END(pt);
+}
+#endif /* TSCH_METRICS */
 #endif /* MAC_CONF_WITH_TSCH */
 /*---------------------------------------------------------------------------*/
 #if TSCH_WITH_SIXTOP
@@ -1007,6 +1072,12 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if TSCH_SLOT_PROFILER
+  { "tsch-profile",         cmd_tsch_profile,         "'> tsch-profile [reset]': Shows (or clears) the TSCH slot profile" },
+#endif /* TSCH_SLOT_PROFILER */
+#if TSCH_METRICS
+  { "tsch-metrics",         cmd_tsch_metrics,         "'> tsch-metrics [reset]': Shows (or clears) the UPA and SLA efficiency metrics" },
+#endif /* TSCH_METRICS */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
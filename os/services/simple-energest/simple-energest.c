@@ -44,6 +44,9 @@
 #include "contiki.h"
 #include "sys/energest.h"
 #include "simple-energest.h"
+#if MAC_CONF_WITH_TSCH
+#include "net/mac/tsch/tsch.h"
+#endif /* MAC_CONF_WITH_TSCH */
 #include <stdio.h>
 #include <limits.h>
 
@@ -133,6 +136,10 @@ simple_energest_step(void)
   dc_tx_sum += to_per_ten_thousand(delta_tx, delta_time);
   dc_rx_sum += to_per_ten_thousand(delta_rx, delta_time);
   dc_total_sum += to_per_ten_thousand(delta_tx+delta_rx, delta_time);
+
+#if MAC_CONF_WITH_TSCH && TSCH_METRICS
+  tsch_metrics_print();
+#endif /* MAC_CONF_WITH_TSCH && TSCH_METRICS */
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(simple_energest_process, ev, data)
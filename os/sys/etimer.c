@@ -50,10 +50,212 @@
 #include "sys/process.h"
 
 static struct etimer *timerlist;
+#if !ETIMER_WITH_HEAP
 static clock_time_t next_expiration;
+#endif
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_HEAP
+/* timerlist is the root of a pairing heap ordered by expiration time */
+
+/* True if a expires before b, for expiration times less than half the
+   range of clock_time_t apart */
+#define EXPIRES_BEFORE(a, b) \
+  ((clock_time_t)(etimer_expiration_time(a) - etimer_expiration_time(b)) \
+   > ((clock_time_t)-1) / 2)
+/*---------------------------------------------------------------------------*/
+/* Melds two heaps, a and b being roots without siblings */
+static struct etimer *
+meld(struct etimer *a, struct etimer *b)
+{
+  struct etimer *t;
+
+  if(EXPIRES_BEFORE(b, a)) {
+    t = a;
+    a = b;
+    b = t;
+  }
+  b->next = a->child;
+  if(a->child != NULL) {
+    a->child->prev = b;
+  }
+  b->prev = a;
+  a->child = b;
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+/* Melds a list of siblings into one heap, with the usual two passes */
+static struct etimer *
+merge_pairs(struct etimer *first)
+{
+  struct etimer *a, *b, *pairs;
+
+  /* Left to right: meld the siblings two by two, the pairs are
+     chained in reverse order */
+  pairs = NULL;
+  while(first != NULL) {
+    a = first;
+    b = a->next;
+    first = b != NULL ? b->next : NULL;
+    a->next = a->prev = NULL;
+    if(b != NULL) {
+      b->next = b->prev = NULL;
+      a = meld(a, b);
+    }
+    a->next = pairs;
+    pairs = a;
+  }
+
+  /* Right to left: meld each pair into the accumulated heap */
+  while(pairs != NULL) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    first = first != NULL ? meld(first, a) : a;
+  }
+  return first;
+}
+/*---------------------------------------------------------------------------*/
+static int
+heap_contains(struct etimer *t)
+{
+  return t->p != PROCESS_NONE && (t == timerlist || t->prev != NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_insert(struct etimer *t)
+{
+  t->next = t->child = t->prev = NULL;
+  timerlist = timerlist != NULL ? meld(timerlist, t) : t;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(struct etimer *t)
+{
+  struct etimer *sub;
+
+  if(t == timerlist) {
+    timerlist = merge_pairs(t->child);
+  } else {
+    /* Cut the subtree of t from its parent or left sibling, then meld
+       the children of t back into the heap */
+    if(t->prev->child == t) {
+      t->prev->child = t->next;
+    } else {
+      t->prev->next = t->next;
+    }
+    if(t->next != NULL) {
+      t->next->prev = t->prev;
+    }
+    sub = merge_pairs(t->child);
+    if(sub != NULL) {
+      timerlist = meld(timerlist, sub);
+    }
+  }
+  t->next = t->child = t->prev = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Depth-first walk of the heap, without stack */
+static struct etimer *
+heap_find_process(struct process *p)
+{
+  struct etimer *t;
+
+  t = timerlist;
+  while(t != NULL) {
+    if(t->p == p) {
+      return t;
+    }
+    if(t->child != NULL) {
+      t = t->child;
+      continue;
+    }
+    /* Climb up to the first ancestor with a right sibling */
+    while(t != NULL && t->next == NULL) {
+      while(t->prev != NULL && t->prev->child != t) {
+        t = t->prev;
+      }
+      t = t->prev;
+    }
+    if(t != NULL) {
+      t = t->next;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_process_timers(struct process *p)
+{
+  struct etimer *t;
+
+  /* Process exits are rare and a process has few timers: a walk of
+     the heap for each of them is fine */
+  while((t = heap_find_process(p)) != NULL) {
+    heap_remove(t);
+    t->p = PROCESS_NONE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+post_expired_timers(void)
+{
+  struct etimer *t;
+
+  /* No timer expires before the root of the heap */
+  while(timerlist != NULL && timer_expired(&timerlist->timer)) {
+    t = timerlist;
+    if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+      /* Event queue full, try again later */
+      etimer_request_poll();
+      return;
+    }
+    heap_remove(t);
+    /* Reset the process ID of the event timer, to signal that the
+       etimer has expired. This is later checked in the
+       etimer_expired() function. */
+    t->p = PROCESS_NONE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_timer(struct etimer *timer)
+{
+  etimer_request_poll();
+
+  if(heap_contains(timer)) {
+    /* Timer already on the heap, its expiration time has changed */
+    heap_remove(timer);
+  }
+  timer->p = PROCESS_CURRENT();
+  heap_insert(timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_timer(struct etimer *timer)
+{
+  if(heap_contains(timer)) {
+    heap_remove(timer);
+    heap_insert(timer);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_timer(struct etimer *et)
+{
+  if(heap_contains(et)) {
+    heap_remove(et);
+  }
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+etimer_next_expiration_time(void)
+{
+  return etimer_pending() ? etimer_expiration_time(timerlist) : 0;
+}
+/*---------------------------------------------------------------------------*/
+#else /* ETIMER_WITH_HEAP */
 static void
 update_time(void)
 {
@@ -77,74 +279,58 @@ update_time(void)
   }
 }
 /*---------------------------------------------------------------------------*/
-PROCESS_THREAD(etimer_process, ev, data)
+static void
+remove_process_timers(struct process *p)
 {
-  struct etimer *t, *u;
-
-  PROCESS_BEGIN();
-
-  timerlist = NULL;
-
-  while(1) {
-    PROCESS_YIELD();
-
-    if(ev == PROCESS_EVENT_EXITED) {
-      struct process *p = data;
+  struct etimer *t;
 
-      while(timerlist != NULL && timerlist->p == p) {
-        timerlist = timerlist->next;
-      }
+  while(timerlist != NULL && timerlist->p == p) {
+    timerlist = timerlist->next;
+  }
 
-      if(timerlist != NULL) {
-        t = timerlist;
-        while(t->next != NULL) {
-          if(t->next->p == p) {
-            t->next = t->next->next;
-          } else {
-            t = t->next;
-          }
-        }
+  if(timerlist != NULL) {
+    t = timerlist;
+    while(t->next != NULL) {
+      if(t->next->p == p) {
+        t->next = t->next->next;
+      } else {
+        t = t->next;
       }
-      continue;
-    } else if(ev != PROCESS_EVENT_POLL) {
-      continue;
     }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+post_expired_timers(void)
+{
+  struct etimer *t, *u;
 
 again:
 
-    u = NULL;
+  u = NULL;
 
-    for(t = timerlist; t != NULL; t = t->next) {
-      if(timer_expired(&t->timer)) {
-        if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
-
-          /* Reset the process ID of the event timer, to signal that the
-             etimer has expired. This is later checked in the
-             etimer_expired() function. */
-          t->p = PROCESS_NONE;
-          if(u != NULL) {
-            u->next = t->next;
-          } else {
-            timerlist = t->next;
-          }
-          t->next = NULL;
-          update_time();
-          goto again;
+  for(t = timerlist; t != NULL; t = t->next) {
+    if(timer_expired(&t->timer)) {
+      if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+
+        /* Reset the process ID of the event timer, to signal that the
+           etimer has expired. This is later checked in the
+           etimer_expired() function. */
+        t->p = PROCESS_NONE;
+        if(u != NULL) {
+          u->next = t->next;
         } else {
-          etimer_request_poll();
+          timerlist = t->next;
         }
+        t->next = NULL;
+        update_time();
+        goto again;
+      } else {
+        etimer_request_poll();
       }
-      u = t;
     }
+    u = t;
   }
-
-  PROCESS_END();
-}
-/*---------------------------------------------------------------------------*/
-void
-etimer_request_poll(void)
-{
-  process_poll(&etimer_process);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -173,6 +359,70 @@ add_timer(struct etimer *timer)
   update_time();
 }
 /*---------------------------------------------------------------------------*/
+static void
+update_timer(struct etimer *timer)
+{
+  update_time();
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_timer(struct etimer *et)
+{
+  struct etimer *t;
+
+  /* First check if et is the first event timer on the list. */
+  if(et == timerlist) {
+    timerlist = timerlist->next;
+    update_time();
+  } else {
+    /* Else walk through the list and try to find the item before the
+       et timer. */
+    for(t = timerlist; t != NULL && t->next != et; t = t->next) {
+    }
+
+    if(t != NULL) {
+      /* We've found the item before the event timer that we are about
+         to remove. We point the items next pointer to the event after
+         the removed item. */
+      t->next = et->next;
+
+      update_time();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+etimer_next_expiration_time(void)
+{
+  return etimer_pending() ? next_expiration : 0;
+}
+#endif /* ETIMER_WITH_HEAP */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  timerlist = NULL;
+
+  while(1) {
+    PROCESS_YIELD();
+
+    if(ev == PROCESS_EVENT_EXITED) {
+      remove_process_timers(data);
+    } else if(ev == PROCESS_EVENT_POLL) {
+      post_expired_timers();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_request_poll(void)
+{
+  process_poll(&etimer_process);
+}
+/*---------------------------------------------------------------------------*/
 void
 etimer_set(struct etimer *et, clock_time_t interval)
 {
@@ -206,7 +456,7 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
-  update_time();
+  update_timer(et);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -233,36 +483,10 @@ etimer_pending(void)
   return timerlist != NULL;
 }
 /*---------------------------------------------------------------------------*/
-clock_time_t
-etimer_next_expiration_time(void)
-{
-  return etimer_pending() ? next_expiration : 0;
-}
-/*---------------------------------------------------------------------------*/
 void
 etimer_stop(struct etimer *et)
 {
-  struct etimer *t;
-
-  /* First check if et is the first event timer on the list. */
-  if(et == timerlist) {
-    timerlist = timerlist->next;
-    update_time();
-  } else {
-    /* Else walk through the list and try to find the item before the
-       et timer. */
-    for(t = timerlist; t != NULL && t->next != et; t = t->next) {
-    }
-
-    if(t != NULL) {
-      /* We've found the item before the event timer that we are about
-         to remove. We point the items next pointer to the event after
-         the removed item. */
-      t->next = et->next;
-
-      update_time();
-    }
-  }
+  remove_timer(et);
 
   /* Remove the next pointer from the item to be removed. */
   et->next = NULL;
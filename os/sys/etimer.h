@@ -57,6 +57,16 @@
  * \sa \ref clock "Clock library" (used by the timer library)
  *
  * It is \e not safe to manipulate event timers within an interrupt context.
+ *
+ * By default, pending event timers are kept in an unsorted list that
+ * is walked on every poll of the event timer process. With
+ * ETIMER_CONF_WITH_HEAP set, they are kept in a pairing heap ordered
+ * by expiration time instead: setting a timer is O(1), stopping it
+ * and handling an expiration are O(log n) amortized, and the next
+ * expiration time is read from the root of the heap. Pending timers
+ * must then expire within half the range of clock_time_t of each
+ * other, and an event timer must be in zero-initialized memory before
+ * it is set for the first time (as static timers are).
  * @{
  */
 
@@ -65,6 +75,12 @@
 
 #include "contiki.h"
 
+#ifdef ETIMER_CONF_WITH_HEAP
+#define ETIMER_WITH_HEAP ETIMER_CONF_WITH_HEAP
+#else
+#define ETIMER_WITH_HEAP 0
+#endif
+
 /**
  * A timer.
  *
@@ -77,6 +93,12 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WITH_HEAP
+  /* Heap links: next is the right sibling, child the leftmost child and
+     prev the left sibling, or the parent for a leftmost child */
+  struct etimer *child;
+  struct etimer *prev;
+#endif
 };
 
 /**
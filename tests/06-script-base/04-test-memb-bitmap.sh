@@ -0,0 +1,19 @@
+#!/bin/sh
+
+TESTNAME=04-test-memb-bitmap
+TEST_CODE_DIR=code-test-memb
+TARGET=test-memb
+MEMB_CFLAGS="-DMEMB_CONF_WITH_BITMAP=1 -DMEMB_CONF_WITH_STATS=1"
+
+make -C ${TEST_CODE_DIR} clean
+make -C ${TEST_CODE_DIR} ${TARGET} MEMB_CFLAGS="${MEMB_CFLAGS}"
+${TEST_CODE_DIR}/${TARGET} > ${TESTNAME}.log
+
+if [ $? -eq 0 ]; then
+    echo "${TESTNAME} TEST OK" > ${TESTNAME}.testlog
+    make -C ${TEST_CODE_DIR} clean
+    exit 0
+else
+    echo "${TESTNAME} TEST FAIL" > ${TESTNAME}.testlog
+    exit 1
+fi
@@ -98,6 +98,17 @@ main(void)
     printf("- memb_alloc is OK: we cannot get any more memory block\n");
   }
 
+#if MEMB_WITH_STATS
+  /* all the blocks have been used at the same time */
+  if((ret = memb_high_water(&memb_pool)) != NUM_MEMB_BLOCKS) {
+    printf("test failed: memb_high_water() returns %d, which should be %d\n",
+           ret, NUM_MEMB_BLOCKS);
+    return -1;
+  } else {
+    printf("- memb_high_water is OK\n");
+  }
+#endif /* MEMB_WITH_STATS */
+
   /* free the allocated memory blocks */
   for(int i = 0; i < NUM_MEMB_BLOCKS; i++) {
     memb_block_p = memb_block_list[i];
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests of the event timer backend (list or heap, see the Makefile) and
+ * benchmark of its overhead with 10, 100 and 1000 pending timers: cost of
+ * a stop and set of one timer, and cost of a clock tick where one timer
+ * expires and its event is delivered. Run both backends with 'make run'.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "unit-test/unit-test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_TIMERS 1000
+#define SET_STOP_OPS 20000UL
+#define TICKS 20000UL
+/* Never expires during the test */
+#define LONG_INTERVAL (3600 * CLOCK_SECOND)
+
+PROCESS(test_process, "etimer test");
+PROCESS(sink_process, "etimer sink");
+AUTOSTART_PROCESSES(&test_process);
+
+static struct etimer timers[MAX_TIMERS];
+static struct etimer tick_timer;
+static unsigned long sink_events;
+static uint8_t sink_fired[MAX_TIMERS];
+
+static const int timer_counts[] = { 10, 100, 1000 };
+/*---------------------------------------------------------------------------*/
+void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(sink_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+    if(ev == PROCESS_EVENT_TIMER) {
+      struct etimer *et = data;
+      sink_events++;
+      if(et >= timers && et < timers + MAX_TIMERS) {
+        sink_fired[et - timers]++;
+      }
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Timers are owned by the sink process, so that their events are
+   delivered while the test process runs */
+static void
+sink_set(struct etimer *et, clock_time_t interval)
+{
+  PROCESS_CONTEXT_BEGIN(&sink_process);
+  etimer_set(et, interval);
+  PROCESS_CONTEXT_END(&sink_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+stop_all(void)
+{
+  int i;
+  for(i = 0; i < MAX_TIMERS; i++) {
+    etimer_stop(&timers[i]);
+  }
+  etimer_stop(&tick_timer);
+}
+/*---------------------------------------------------------------------------*/
+static clock_time_t
+random_interval(void)
+{
+  return LONG_INTERVAL + random_rand() % LONG_INTERVAL;
+}
+/*---------------------------------------------------------------------------*/
+/* Earliest expiration time of the pending timers, by brute force */
+static int
+check_next_expiration(int count)
+{
+  clock_time_t now = clock_time();
+  clock_time_t next = 0;
+  int found = 0;
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if(!etimer_expired(&timers[i])) {
+      clock_time_t exp = etimer_expiration_time(&timers[i]);
+      if(!found || exp - now < next - now) {
+        next = exp;
+      }
+      found = 1;
+    }
+  }
+  return etimer_pending() == found
+         && (!found || etimer_next_expiration_time() == next);
+}
+/*---------------------------------------------------------------------------*/
+/* Runs the processes until the sink has received count events */
+static int
+run_until_events(unsigned long count)
+{
+  unsigned long rounds = 0;
+
+  while(sink_events < count) {
+    if(++rounds > 100000UL) {
+      return 0;
+    }
+    process_run();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(etimer_order, "Next expiration time");
+UNIT_TEST(etimer_order)
+{
+  unsigned long op;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  stop_all();
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  /* Random sets, resets, stops and adjustments */
+  for(op = 0; op < 20000; op++) {
+    i = random_rand() % MAX_TIMERS;
+    switch(random_rand() % 5) {
+    case 0:
+    case 1:
+      sink_set(&timers[i], random_interval());
+      break;
+    case 2:
+      if(!etimer_expired(&timers[i])) {
+        PROCESS_CONTEXT_BEGIN(&sink_process);
+        etimer_reset_with_new_interval(&timers[i], random_interval());
+        PROCESS_CONTEXT_END(&sink_process);
+      }
+      break;
+    case 3:
+      etimer_stop(&timers[i]);
+      break;
+    case 4:
+      etimer_adjust(&timers[i], (int)(random_rand() % 200) - 100);
+      break;
+    }
+    if(op % 97 == 0) {
+      UNIT_TEST_ASSERT(check_next_expiration(MAX_TIMERS));
+    }
+  }
+  UNIT_TEST_ASSERT(check_next_expiration(MAX_TIMERS));
+
+  stop_all();
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(etimer_expire, "Expiration of all timers");
+UNIT_TEST(etimer_expire)
+{
+  unsigned long events;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  stop_all();
+  memset(sink_fired, 0, sizeof(sink_fired));
+
+  /* Half of the timers in the past, in random order, the other half
+     pending: more events than the event queue holds */
+  for(i = 0; i < MAX_TIMERS; i++) {
+    if(i % 2 == 0) {
+      sink_set(&timers[i], 0);
+      etimer_adjust(&timers[i], -(int)(random_rand() % 1000));
+    } else {
+      sink_set(&timers[i], random_interval());
+    }
+  }
+  events = sink_events;
+  UNIT_TEST_ASSERT(run_until_events(events + MAX_TIMERS / 2));
+
+  for(i = 0; i < MAX_TIMERS; i++) {
+    UNIT_TEST_ASSERT(sink_fired[i] == (i % 2 == 0));
+    UNIT_TEST_ASSERT(etimer_expired(&timers[i]) == (i % 2 == 0));
+  }
+  UNIT_TEST_ASSERT(check_next_expiration(MAX_TIMERS));
+
+  /* Timers of an exiting process are removed */
+  process_exit(&sink_process);
+  UNIT_TEST_ASSERT(!etimer_pending());
+  process_start(&sink_process, NULL);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(etimer_bench, "Overhead with 10, 100, 1000 timers");
+UNIT_TEST(etimer_bench)
+{
+  unsigned long op;
+  uint64_t start;
+  double set_stop_ns;
+  double tick_ns;
+  unsigned i;
+  int j;
+
+  UNIT_TEST_BEGIN();
+
+  printf("etimer overhead, heap %u\n", ETIMER_WITH_HEAP);
+  printf("timers\tset_stop_ns\ttick_ns\n");
+  for(i = 0; i < sizeof(timer_counts) / sizeof(timer_counts[0]); i++) {
+    int count = timer_counts[i];
+
+    stop_all();
+    for(j = 0; j < count; j++) {
+      sink_set(&timers[j], random_interval());
+    }
+
+    start = now_ns();
+    for(op = 0; op < SET_STOP_OPS; op++) {
+      struct etimer *et = &timers[(op * 97) % count];
+      etimer_stop(et);
+      sink_set(et, random_interval());
+    }
+    set_stop_ns = (double)(now_ns() - start) / SET_STOP_OPS;
+
+    /* One tick: a timer expires, the event timer process is polled and
+       the event is delivered */
+    start = now_ns();
+    for(op = 0; op < TICKS; op++) {
+      unsigned long events = sink_events;
+      sink_set(&tick_timer, 0);
+      UNIT_TEST_ASSERT(run_until_events(events + 1));
+    }
+    tick_ns = (double)(now_ns() - start) / TICKS;
+
+    UNIT_TEST_ASSERT(check_next_expiration(count));
+    printf("%d\t%.1f\t%.1f\n", count, set_stop_ns, tick_ns);
+  }
+  stop_all();
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  process_start(&sink_process, NULL);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(etimer_order);
+  UNIT_TEST_RUN(etimer_expire);
+  UNIT_TEST_RUN(etimer_bench);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  /* Lets 'make run' go on with the other backend */
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
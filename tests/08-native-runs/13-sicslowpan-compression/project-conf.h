@@ -0,0 +1,18 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+
+/* Frames go to the MAC driver of the test, not to the tun interface */
+#define NETSTACK_CONF_NETWORK sicslowpan_driver
+#define NETSTACK_CONF_MAC     test_mac_driver
+
+/* The compression extensions examples/ASAP leaves off. The test sets the
+   RPI 6LoRH flag that RPL sets with RPL_CONF_WITH_RFC8138 */
+#define SICSLOWPAN_CONF_COMPRESSION SICSLOWPAN_COMPRESSION_6LORH
+#define SICSLOWPAN_CONF_FLOW_CTX    1
+
+/* The IPv6 stack logs its housekeeping counters */
+#define LOG_HK_ENABLED 1
+
+#endif /* PROJECT_CONF_H_ */
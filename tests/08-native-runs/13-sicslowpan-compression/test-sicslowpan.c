@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Round trips of routed UDP packets through 6LoWPAN with the extensions
+ * examples/ASAP leaves off (see project-conf.h): the RPI 6LoRH of RFC 8138
+ * after the paging dispatch, and the flow contexts of sicslowpan.h. The
+ * frames are captured by the MAC driver of the test and given back to
+ * 6LoWPAN, and the decompressed packets are compared with the sent ones.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "net/ipv6/sicslowpan.h"
+#include "unit-test/unit-test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAYLOAD_LEN 16
+#define PACKET_LEN (UIP_IPH_LEN + 8 + UIP_UDPH_LEN + PAYLOAD_LEN)
+
+PROCESS(test_process, "6LoWPAN compression test");
+AUTOSTART_PROCESSES(&test_process);
+
+static const linkaddr_t peer_addr = { { 0x02, 0, 0, 0, 0, 0, 0, 0x02 } };
+static const linkaddr_t other_addr = { { 0x02, 0, 0, 0, 0, 0, 0, 0x03 } };
+
+/* Last unicast frame sent */
+static uint8_t frame[PACKETBUF_SIZE];
+static uint16_t frame_len;
+static linkaddr_t frame_dest;
+static unsigned long frame_count;
+static int tx_status;
+
+/* Last packet given to the IP stack */
+static uint8_t rx_packet[UIP_BUFSIZE];
+static uint16_t rx_len;
+static unsigned long rx_count;
+
+static uint8_t tx_packet[PACKET_LEN];
+/*---------------------------------------------------------------------------*/
+void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_mac_init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_mac_send(mac_callback_t sent, void *ptr)
+{
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+
+  /* Keeps the multicasts of the IPv6 stack out of the way */
+  if(!linkaddr_cmp(dest, &linkaddr_null)) {
+    memcpy(frame, packetbuf_dataptr(), packetbuf_datalen());
+    frame_len = packetbuf_datalen();
+    linkaddr_copy(&frame_dest, dest);
+    frame_count++;
+  }
+  mac_call_sent_callback(sent, ptr, tx_status, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+test_mac_input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+test_mac_on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+test_mac_off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+test_mac_max_payload(void)
+{
+  return 102;
+}
+/*---------------------------------------------------------------------------*/
+const struct mac_driver test_mac_driver = {
+  "test-mac",
+  test_mac_init,
+  test_mac_send,
+  test_mac_input,
+  test_mac_on,
+  test_mac_off,
+  test_mac_max_payload,
+};
+/*---------------------------------------------------------------------------*/
+static enum netstack_ip_action
+capture_input(void)
+{
+  memcpy(rx_packet, uip_buf, uip_len);
+  rx_len = uip_len;
+  rx_count++;
+  return NETSTACK_IP_DROP;
+}
+/*---------------------------------------------------------------------------*/
+static struct netstack_ip_packet_processor capture_processor = {
+  .process_input = capture_input,
+};
+/*---------------------------------------------------------------------------*/
+/* A UDP packet from fd00::1 to fd00::2 with a hop-by-hop header that only
+   has the RPL option */
+static void
+build_packet(uint16_t rank, uint8_t fill)
+{
+  uint8_t *hbh = UIP_IP_PAYLOAD(0);
+  uint8_t *udp = UIP_IP_PAYLOAD(8);
+
+  uipbuf_clear();
+  memset(uip_buf, 0, PACKET_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_HBHO;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, 0xfd00, 0, 0, 0, 0, 0, 0, 2);
+
+  hbh[0] = UIP_PROTO_UDP;
+  hbh[1] = 0;
+  hbh[2] = UIP_EXT_HDR_OPT_RPL;
+  hbh[3] = 4;
+  hbh[4] = 0x80; /* down */
+  hbh[5] = 0x1e; /* instance */
+  hbh[6] = rank >> 8;
+  hbh[7] = rank & 0xff;
+
+  udp[0] = 0x16;
+  udp[1] = 0x33;
+  udp[2] = 0x16;
+  udp[3] = 0x34;
+  udp[5] = UIP_UDPH_LEN + PAYLOAD_LEN;
+  udp[6] = 0xbe;
+  udp[7] = 0xef;
+  memset(&udp[UIP_UDPH_LEN], fill, PAYLOAD_LEN);
+
+  uip_len = PACKET_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+  memcpy(tx_packet, uip_buf, PACKET_LEN);
+}
+/*---------------------------------------------------------------------------*/
+/* Sends the packet in uip_buf to the peer, returns 1 if a frame was sent */
+static int
+send_packet(int with_rpi)
+{
+  unsigned long count = frame_count;
+
+  /* As RPL does with RPL_CONF_WITH_RFC8138 */
+  if(with_rpi) {
+    uipbuf_set_attr_flag(UIPBUF_ATTR_FLAGS_6LOWPAN_RPI_6LORH);
+  }
+  NETSTACK_NETWORK.output(&peer_addr);
+  return frame_count == count + 1 && linkaddr_cmp(&frame_dest, &peer_addr);
+}
+/*---------------------------------------------------------------------------*/
+/* Gives a frame to 6LoWPAN, returns 1 if a packet came out of it */
+static int
+receive_frame(const uint8_t *data, uint16_t len, const linkaddr_t *sender)
+{
+  unsigned long count = rx_count;
+
+  packetbuf_clear();
+  packetbuf_copyfrom(data, len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &peer_addr);
+  NETSTACK_NETWORK.input();
+  return rx_count == count + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Sends the last frame back to 6LoWPAN, as if this node was the peer */
+static int
+round_trip(void)
+{
+  return receive_frame(frame, frame_len, &linkaddr_node_addr)
+    && rx_len == PACKET_LEN && memcmp(rx_packet, tx_packet, PACKET_LEN) == 0;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(rpi_6lorh, "RPI 6LoRH");
+UNIT_TEST(rpi_6lorh)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Not acknowledged: the flow context is set again with each packet */
+  tx_status = MAC_TX_NOACK;
+
+  build_packet(0x0123, 1);
+  UNIT_TEST_ASSERT(send_packet(1));
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_SET);
+  UNIT_TEST_ASSERT(frame[5] == (SICSLOWPAN_DISPATCH_PAGING | 1));
+  UNIT_TEST_ASSERT((frame[6] & 0xe0) == SICSLOWPAN_6LORH_CRITICAL);
+  UNIT_TEST_ASSERT((frame[6] & SICSLOWPAN_6LORH_RPI_ORF_MASK) == 0x10);
+  UNIT_TEST_ASSERT(frame[7] == SICSLOWPAN_6LORH_TYPE_RPI);
+  UNIT_TEST_ASSERT(round_trip());
+
+  /* Without the RPL flag, the hop-by-hop header is compressed by IPHC */
+  build_packet(0x0123, 2);
+  UNIT_TEST_ASSERT(send_packet(0));
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_SET);
+  UNIT_TEST_ASSERT(frame[5] == (SICSLOWPAN_DISPATCH_PAGING | 1));
+  UNIT_TEST_ASSERT((frame[6] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC);
+  UNIT_TEST_ASSERT(round_trip());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t use_frame[PACKETBUF_SIZE];
+static uint16_t use_frame_len;
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(flow_ctx, "Flow context set and use");
+UNIT_TEST(flow_ctx)
+{
+  uint16_t set_len;
+  uint8_t id;
+
+  UNIT_TEST_BEGIN();
+
+  tx_status = MAC_TX_OK;
+
+  build_packet(0x0123, 3);
+  UNIT_TEST_ASSERT(send_packet(1));
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_SET);
+  id = frame[1];
+  set_len = frame_len;
+  UNIT_TEST_ASSERT(round_trip());
+
+  /* Acknowledged: only the RPL option changes */
+  build_packet(0x0145, 4);
+  UNIT_TEST_ASSERT(send_packet(1));
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX);
+  UNIT_TEST_ASSERT(frame[1] == id);
+  UNIT_TEST_ASSERT(frame_len + 5 < set_len);
+  memcpy(use_frame, frame, frame_len);
+  use_frame_len = frame_len;
+  UNIT_TEST_ASSERT(round_trip());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(flow_ctx_nack, "Unknown flow context");
+UNIT_TEST(flow_ctx_nack)
+{
+  unsigned long count;
+  uint8_t nack[3];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* A neighbor that was never set the context drops the packet and
+     answers with a NACK, sent from a callback timer */
+  count = frame_count;
+  UNIT_TEST_ASSERT(!receive_frame(use_frame, use_frame_len, &other_addr));
+  for(i = 0; i < 100 && frame_count == count; i++) {
+    process_run();
+  }
+  UNIT_TEST_ASSERT(frame_count == count + 1);
+  UNIT_TEST_ASSERT(linkaddr_cmp(&frame_dest, &other_addr));
+  UNIT_TEST_ASSERT(frame_len == 3);
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_NACK);
+  UNIT_TEST_ASSERT(frame[1] == use_frame[1]);
+  UNIT_TEST_ASSERT(frame[2] == 0);
+
+  /* The same NACK from the peer: the context is set again */
+  memcpy(nack, frame, sizeof(nack));
+  UNIT_TEST_ASSERT(!receive_frame(nack, sizeof(nack), &peer_addr));
+  build_packet(0x0167, 5);
+  UNIT_TEST_ASSERT(send_packet(1));
+  UNIT_TEST_ASSERT(frame[0] == SICSLOWPAN_DISPATCH_FLOW_CTX_SET);
+  UNIT_TEST_ASSERT(frame[1] == use_frame[1]);
+  UNIT_TEST_ASSERT(round_trip());
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  netstack_ip_packet_processor_add(&capture_processor);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(rpi_6lorh);
+  UNIT_TEST_RUN(flow_ctx);
+  UNIT_TEST_RUN(flow_ctx_nack);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
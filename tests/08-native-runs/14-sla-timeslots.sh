@@ -0,0 +1,3 @@
+#!/bin/bash
+
+./run-one.sh 14-sla-timeslots
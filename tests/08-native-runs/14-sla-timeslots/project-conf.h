@@ -0,0 +1,50 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+
+/* TSCH never associates: no radio */
+#define NETSTACK_CONF_RADIO nullradio_driver
+
+/* Slotframes of examples/ASAP, used by the SLA code, which takes the hop
+   distance from RPL */
+#define ORCHESTRA_CONF_EBSF_PERIOD        397
+#define TSCH_SCHED_EB_SF_HANDLE           0
+#define TSCH_SCHED_COMMON_SF_HANDLE       1
+#define TSCH_SCHED_UNICAST_SF_HANDLE      2
+
+/* Adaptive timeslot length as in examples/ASAP, with a short common
+   slotframe for the test */
+#define WITH_SLA                          1
+#define SLA_K_TH_PERCENTILE               90
+#define SLA_GUARD_TIME_TIMESLOTS          2
+#define SLA_CALCULATE_DURATION(len)       (32 * (5 + len))
+#define SLA_START_DELAY                   (5 * 60 * CLOCK_SECOND)
+#define SLA_DETERMINATION_PERIOD          (5 * 60 * CLOCK_SECOND)
+#define SLA_RAPID_EB_PERIOD               (3 * CLOCK_SECOND)
+#define SLA_MAX_FRAME_LEN                 128
+#define SLA_MAX_ACK_LEN                   70
+#define HCK_TSCH_MAX_ACK                  SLA_CALCULATE_DURATION(SLA_MAX_ACK_LEN)
+#define SLA_SHIFT_BITS                    3
+#define SLA_OBSERVATION_WINDOWS           1
+#define SLA_QUANTILE_ESTIMATOR            1
+#define SLA_QUANTILE_DECAY                50
+#define SLA_PER_SLOTFRAME_TIMESLOT_LENGTH 1
+#define SLA_COMMON_SF_PERIOD              7
+#define SLA_COMMON_SF_TIMESLOT            0
+#define SLA_FRAME_LEN_QUANTIZED_LEVELS    ((((SLA_MAX_FRAME_LEN - 1) >> SLA_SHIFT_BITS) + 1) + 1)
+#define SLA_ACK_LEN_QUANTIZED_LEVELS      ((((SLA_MAX_ACK_LEN - 1) >> SLA_SHIFT_BITS) + 1) + 1)
+#define SLA_INITIAL_HOP_DISTANCE          10
+#define SLA_ZERO_HOP_DISTANCE_OFFSET      1
+#define SLA_TRIGGERING_ASN_INCREMENT      1
+#define SLA_TRIGGERING_ASN_MULTIPLIER     1
+
+#define HCK_GET_NODE_ID_FROM_LINKADDR(addr) \
+  ((((addr)->u8[LINKADDR_SIZE - 2]) << 8) | (addr)->u8[LINKADDR_SIZE - 1])
+#define RPL_FIRST_MEASURE_PERIOD          (1 * 60)
+#define RPL_NEXT_MEASURE_PERIOD           (1 * 60)
+
+/* The IPv6 stack logs its housekeeping counters */
+#define LOG_HK_ENABLED 1
+
+#endif /* PROJECT_CONF_H_ */
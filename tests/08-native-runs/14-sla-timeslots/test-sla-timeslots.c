@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * ASN-to-time accounting of the adaptive timeslot length with
+ * SLA_PER_SLOTFRAME_TIMESLOT_LENGTH: the common shared cell has its own
+ * timeslot length, all other timeslots the global one. The wakeup, UPA and
+ * tsch_calculate_current_asn() count timeslots and durations from an ASN
+ * with tsch_timeslots_of_duration() and tsch_duration_of_timeslots(), which
+ * are checked here against a plain count of the common cells, including
+ * across the 32-bit boundary of the ASN.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "unit-test/unit-test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_LENGTH 10000
+#define SHORT_LENGTH   6000
+#define LONG_LENGTH    12000
+
+PROCESS(test_process, "SLA timeslot accounting test");
+AUTOSTART_PROCESSES(&test_process);
+/*---------------------------------------------------------------------------*/
+void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_lengths(rtimer_clock_t common_length)
+{
+  tsch_timing[tsch_ts_timeslot_length] = DEFAULT_LENGTH;
+  tsch_bc_sf_timing[SLA_BC_SF_COMMON] = common_length;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_asn_t
+asn_of(uint64_t val)
+{
+  struct tsch_asn_t asn;
+  asn.ls4b = (uint32_t)val;
+  asn.ms1b = (uint8_t)(val >> 32);
+  return asn;
+}
+/*---------------------------------------------------------------------------*/
+/* Duration of the timeslots from an ASN, counting the common cells without TSCH_ASN_MOD */
+static rtimer_clock_t
+expected_duration(uint64_t asn, uint16_t timeslots, rtimer_clock_t common_length)
+{
+  rtimer_clock_t duration = 0;
+  for(; timeslots > 0; timeslots--, asn++) {
+    duration += asn % SLA_COMMON_SF_PERIOD == SLA_COMMON_SF_TIMESLOT ? common_length : DEFAULT_LENGTH;
+  }
+  return duration;
+}
+/*---------------------------------------------------------------------------*/
+/* Checks both conversions from the ASNs around start, returns 1 if they all match */
+static int
+check_round_trips(uint64_t start, rtimer_clock_t common_length)
+{
+  uint64_t val;
+  uint16_t n;
+
+  for(val = start; val < start + 2 * SLA_COMMON_SF_PERIOD; val++) {
+    struct tsch_asn_t asn = asn_of(val);
+    for(n = 0; n <= 3 * SLA_COMMON_SF_PERIOD; n++) {
+      rtimer_clock_t duration = tsch_duration_of_timeslots(&asn, n);
+      if(duration != expected_duration(val, n, common_length)) {
+        printf("duration of %u timeslots from ASN %llu: %lu\n",
+               n, (unsigned long long)val, (unsigned long)duration);
+        return 0;
+      }
+      if(tsch_timeslots_of_duration(&asn, duration) != n
+         || (n > 0 && tsch_timeslots_of_duration(&asn, duration - 1) != n)
+         || tsch_timeslots_of_duration(&asn, duration + 1) != n + 1) {
+        printf("timeslots of %lu us from ASN %llu\n",
+               (unsigned long)duration, (unsigned long long)val);
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(common_cell, "Common cell of an ASN");
+UNIT_TEST(common_cell)
+{
+  struct tsch_asn_t asn;
+
+  UNIT_TEST_BEGIN();
+
+  asn = asn_of(0);
+  UNIT_TEST_ASSERT(sla_get_bc_sf_of_asn(&asn) == SLA_BC_SF_COMMON);
+  asn = asn_of(3);
+  UNIT_TEST_ASSERT(sla_get_bc_sf_of_asn(&asn) == SLA_BC_SF_NONE);
+  asn = asn_of(SLA_COMMON_SF_PERIOD);
+  UNIT_TEST_ASSERT(sla_get_bc_sf_of_asn(&asn) == SLA_BC_SF_COMMON);
+  /* 2^32 is not a multiple of the period */
+  asn = asn_of(0x100000000ULL);
+  UNIT_TEST_ASSERT(sla_get_bc_sf_of_asn(&asn) == SLA_BC_SF_NONE);
+  asn = asn_of(0x100000000ULL + SLA_COMMON_SF_PERIOD - 0x100000000ULL % SLA_COMMON_SF_PERIOD);
+  UNIT_TEST_ASSERT(sla_get_bc_sf_of_asn(&asn) == SLA_BC_SF_COMMON);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(mixed_lengths, "Timeslots and durations with a shorter common cell");
+UNIT_TEST(mixed_lengths)
+{
+  struct tsch_asn_t asn;
+
+  UNIT_TEST_BEGIN();
+
+  set_lengths(SHORT_LENGTH);
+
+  asn = asn_of(0);
+  UNIT_TEST_ASSERT(tsch_duration_of_timeslots(&asn, 1) == SHORT_LENGTH);
+  UNIT_TEST_ASSERT(tsch_duration_of_timeslots(&asn, SLA_COMMON_SF_PERIOD)
+                   == SHORT_LENGTH + (SLA_COMMON_SF_PERIOD - 1) * DEFAULT_LENGTH);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, 0) == 0);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, SHORT_LENGTH) == 1);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, SHORT_LENGTH + 1) == 2);
+
+  /* Six default timeslots, then the common cell of the next slotframe */
+  asn = asn_of(1);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, 6 * DEFAULT_LENGTH) == 6);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, 6 * DEFAULT_LENGTH + 1) == 7);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, 6 * DEFAULT_LENGTH + SHORT_LENGTH) == 7);
+  UNIT_TEST_ASSERT(tsch_timeslots_of_duration(&asn, 6 * DEFAULT_LENGTH + SHORT_LENGTH + 1) == 8);
+
+  UNIT_TEST_ASSERT(check_round_trips(0, SHORT_LENGTH));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(longer_common_cell, "Timeslots and durations with a longer common cell");
+UNIT_TEST(longer_common_cell)
+{
+  UNIT_TEST_BEGIN();
+
+  set_lengths(LONG_LENGTH);
+  UNIT_TEST_ASSERT(check_round_trips(0, LONG_LENGTH));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(asn_wrap, "Timeslots and durations across 2^32 ASNs");
+UNIT_TEST(asn_wrap)
+{
+  UNIT_TEST_BEGIN();
+
+  set_lengths(SHORT_LENGTH);
+  UNIT_TEST_ASSERT(check_round_trips(0x100000000ULL - 2 * SLA_COMMON_SF_PERIOD, SHORT_LENGTH));
+  UNIT_TEST_ASSERT(check_round_trips(0xffffffffffULL - 3 * SLA_COMMON_SF_PERIOD, SHORT_LENGTH));
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(common_cell);
+  UNIT_TEST_RUN(mixed_lengths);
+  UNIT_TEST_RUN(longer_common_cell);
+  UNIT_TEST_RUN(asn_wrap);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Replays the per-ASFN results of A3 neighbors through the double and
+ *         the Q15 fixed-point builds of os/net/mac/tsch/tsch-a3.c, and
+ *         reports where their decisions diverge, the largest gap between
+ *         their rates and the cost of an update on this host.
+ *
+ *         The results are read from node logs built with A3_DBG_VALUE (the
+ *         "A3-v x_t_a" and "A3-v x_r_a" lines), or drawn at random when no
+ *         log is given. Note that the host has an FPU: the cost of the
+ *         double build on targets with soft-float is much higher.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#include "a3-replay.h"
+
+#define MAX_LINE 1024
+
+struct record {
+  int nbr;
+  struct a3_replay_counts counts;
+};
+
+struct nbr_key {
+  int file;
+  int node;
+  char who;
+  unsigned id;
+  /* Tx results of the ASFN, until its Rx results */
+  int pending;
+  uint8_t tx_success;
+  uint8_t tx_collision;
+};
+
+static struct record *records;
+static int num_records;
+static int max_records;
+
+static struct nbr_key nbrs[A3_REPLAY_MAX_NBRS];
+static int num_nbrs;
+/*---------------------------------------------------------------------------*/
+static void
+add_record(int nbr, const struct a3_replay_counts *c)
+{
+  if(num_records == max_records) {
+    max_records = max_records ? max_records * 2 : 4096;
+    records = realloc(records, max_records * sizeof(struct record));
+    if(records == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  records[num_records].nbr = nbr;
+  records[num_records].counts = *c;
+  num_records++;
+}
+/*---------------------------------------------------------------------------*/
+static int
+get_nbr(int file, int node, char who, unsigned id)
+{
+  int i;
+
+  for(i = 0; i < num_nbrs; i++) {
+    if(nbrs[i].file == file && nbrs[i].node == node
+       && nbrs[i].who == who && nbrs[i].id == id) {
+      return i;
+    }
+  }
+  if(num_nbrs == A3_REPLAY_MAX_NBRS) {
+    return -1;
+  }
+  memset(&nbrs[num_nbrs], 0, sizeof(struct nbr_key));
+  nbrs[num_nbrs].file = file;
+  nbrs[num_nbrs].node = node;
+  nbrs[num_nbrs].who = who;
+  nbrs[num_nbrs].id = id;
+  return num_nbrs++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_log(int file, const char *path)
+{
+  FILE *f;
+  char line[MAX_LINE];
+  const char *p;
+  int node;
+  int nbr;
+  char who;
+  unsigned id;
+  unsigned v[6];
+  unsigned sum;
+  struct a3_replay_counts c;
+
+  f = fopen(path, "r");
+  if(f == NULL) {
+    perror(path);
+    exit(1);
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    p = strstr(line, "A3-v ");
+    if(p == NULL) {
+      continue;
+    }
+    /* Simulator logs with the nodes of a network in one file */
+    node = 0;
+    if(strstr(line, "ID:") != NULL) {
+      node = atoi(strstr(line, "ID:") + 3);
+    }
+    p += 5;
+    if(sscanf(p, "%c_t_a %u | %u %u %u", &who, &id, &v[0], &v[1], &v[2]) == 5) {
+      nbr = get_nbr(file, node, who, id);
+      if(nbr >= 0) {
+        nbrs[nbr].pending = 1;
+        nbrs[nbr].tx_success = v[0];
+        nbrs[nbr].tx_collision = v[1];
+      }
+    } else if(sscanf(p, "%c_r_a %u | %u %u %u %u %u | %u", &who, &id,
+                     &v[0], &v[1], &v[2], &v[3], &v[4], &sum) == 8) {
+      nbr = get_nbr(file, node, who, id);
+      if(nbr >= 0 && nbrs[nbr].pending) {
+        nbrs[nbr].pending = 0;
+        c.tx_success = nbrs[nbr].tx_success;
+        c.tx_collision = nbrs[nbr].tx_collision;
+        c.rx_success = v[0];
+        c.rx_collision = v[1];
+        c.rx_idle = v[2];
+        c.rx_others = v[3];
+        add_record(nbr, &c);
+      }
+    }
+  }
+  fclose(f);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t rng_state = 1;
+
+static uint32_t
+rng(void)
+{
+  /* xorshift32 */
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static double
+rng_uniform(void)
+{
+  return (rng() >> 8) / (double)(1 << 24);
+}
+/*---------------------------------------------------------------------------*/
+/* Neighbors with slowly varying Tx and Rx loads (packets per ASFN) and
+ * collision probabilities, whose cells follow the double build */
+static void
+make_synthetic(int n_nbrs, int n_asfns)
+{
+  double tx_load[A3_REPLAY_MAX_NBRS];
+  double rx_load[A3_REPLAY_MAX_NBRS];
+  double coll[A3_REPLAY_MAX_NBRS];
+  struct a3_replay_counts c;
+  struct a3_replay_result r;
+  uint8_t tx_slots, rx_slots;
+  double p;
+  int i, n, k;
+
+  for(n = 0; n < n_nbrs; n++) {
+    tx_load[n] = rng_uniform() * 3;
+    rx_load[n] = rng_uniform() * 3;
+    coll[n] = rng_uniform() * 0.5;
+  }
+  a3_replay_reset_double();
+  for(i = 0; i < n_asfns; i++) {
+    for(n = 0; n < n_nbrs; n++) {
+      tx_load[n] = fmin(4, fmax(0, tx_load[n] + (rng_uniform() - 0.5) * 0.2));
+      rx_load[n] = fmin(4, fmax(0, rx_load[n] + (rng_uniform() - 0.5) * 0.2));
+      a3_replay_slots_double(n, &tx_slots, &rx_slots);
+      memset(&c, 0, sizeof(c));
+      p = fmin(1, tx_load[n] / tx_slots);
+      for(k = 0; k < tx_slots; k++) {
+        if(rng_uniform() < p) {
+          if(rng_uniform() < coll[n]) {
+            c.tx_collision++;
+          } else {
+            c.tx_success++;
+          }
+        }
+      }
+      p = fmin(1, rx_load[n] / rx_slots);
+      for(k = 0; k < rx_slots; k++) {
+        double u = rng_uniform();
+        if(u < 0.1) {
+          /* Not scheduled, e.g. overlapped by another cell */
+        } else if(u < 0.12) {
+          c.rx_others++;
+        } else if(rng_uniform() < p) {
+          if(rng_uniform() < coll[n]) {
+            c.rx_collision++;
+          } else {
+            c.rx_success++;
+          }
+        } else {
+          c.rx_idle++;
+        }
+      }
+      add_record(n, &c);
+      a3_replay_step_double(n, &c, &r);
+    }
+  }
+  num_nbrs = n_nbrs;
+}
+/*---------------------------------------------------------------------------*/
+static void
+compare(void)
+{
+  struct a3_replay_result d, f;
+  static uint8_t diverged[A3_REPLAY_MAX_NBRS];
+  int action_diffs = 0;
+  int slot_diffs = 0;
+  int first_diff = -1;
+  int nbrs_diverged = 0;
+  int in_sync = 0;
+  double max_gap = 0;
+  double sum_gap = 0;
+  double gap;
+  int i;
+
+  a3_replay_reset_double();
+  a3_replay_reset_fixed();
+  for(i = 0; i < num_records; i++) {
+    a3_replay_step_double(records[i].nbr, &records[i].counts, &d);
+    a3_replay_step_fixed(records[i].nbr, &records[i].counts, &f);
+    if(d.actions != f.actions) {
+      action_diffs++;
+      if(first_diff < 0) {
+        first_diff = i;
+      }
+    }
+    if(d.num_tx_slot != f.num_tx_slot || d.num_rx_slot != f.num_rx_slot) {
+      slot_diffs++;
+      if(!diverged[records[i].nbr]) {
+        diverged[records[i].nbr] = 1;
+        nbrs_diverged++;
+      }
+    } else if(!diverged[records[i].nbr]) {
+      gap = fmax(fabs(d.tx_attempt_ewma - f.tx_attempt_ewma),
+                 fmax(fabs(d.tx_success_ewma - f.tx_success_ewma),
+                      fabs(d.rx_attempt_ewma - f.rx_attempt_ewma)));
+      max_gap = fmax(max_gap, gap);
+      sum_gap += gap;
+      in_sync++;
+    }
+  }
+  printf("updates %d, neighbors %d\n", num_records, num_nbrs);
+  printf("decision divergences %d (%.4f%%), first at update %d\n",
+         action_diffs, num_records ? 100.0 * action_diffs / num_records : 0,
+         first_diff);
+  printf("updates with different number of cells %d (%.4f%%), neighbors %d\n",
+         slot_diffs, num_records ? 100.0 * slot_diffs / num_records : 0,
+         nbrs_diverged);
+  printf("rate gap before divergence: max %.6f, mean %.6f (Q15 step %.6f)\n",
+         max_gap, in_sync ? sum_gap / in_sync : 0, 1.0 / 32768);
+}
+/*---------------------------------------------------------------------------*/
+static double
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+time_variant(const char *name, void (*reset)(void),
+             uint8_t (*update)(int, const struct a3_replay_counts *), int repeat)
+{
+  volatile uint8_t sink = 0;
+  double start;
+  double ns;
+#if HAVE_RDTSC
+  uint64_t tsc;
+#endif
+  int i, n;
+
+  reset();
+  start = now_ns();
+#if HAVE_RDTSC
+  tsc = __rdtsc();
+#endif
+  for(n = 0; n < repeat; n++) {
+    for(i = 0; i < num_records; i++) {
+      sink += update(records[i].nbr, &records[i].counts);
+    }
+  }
+  ns = (now_ns() - start) / ((double)repeat * num_records);
+#if HAVE_RDTSC
+  printf("%-6s %.1f ns/update, %.1f TSC cycles/update\n", name, ns,
+         (double)(__rdtsc() - tsc) / ((double)repeat * num_records));
+#else
+  printf("%-6s %.1f ns/update\n", name, ns);
+#endif
+  (void)sink;
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-s seed] [-n neighbors] [-a asfns] [-r repeat] [log...]\n"
+          "  log      node logs with A3_DBG_VALUE, random results if none\n"
+          "  -s       seed of the random results (default 1)\n"
+          "  -n, -a   number of neighbors and of ASFNs (default 64, 10000)\n"
+          "  -r       number of replays timed (default 20)\n", prog);
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  int n_nbrs = 64;
+  int n_asfns = 10000;
+  int repeat = 20;
+  int opt;
+  int i;
+
+  while((opt = getopt(argc, argv, "s:n:a:r:h")) != -1) {
+    switch(opt) {
+    case 's':
+      rng_state = strtoul(optarg, NULL, 0);
+      if(rng_state == 0) {
+        rng_state = 1;
+      }
+      break;
+    case 'n':
+      n_nbrs = atoi(optarg);
+      if(n_nbrs < 1 || n_nbrs > A3_REPLAY_MAX_NBRS) {
+        usage(argv[0]);
+      }
+      break;
+    case 'a':
+      n_asfns = atoi(optarg);
+      break;
+    case 'r':
+      repeat = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+
+  if(optind < argc) {
+    for(i = optind; i < argc; i++) {
+      read_log(i - optind, argv[i]);
+    }
+  } else {
+    make_synthetic(n_nbrs, n_asfns);
+  }
+  if(num_records == 0) {
+    fprintf(stderr, "no A3 updates found (logs need A3_DBG_VALUE)\n");
+    return 1;
+  }
+
+  compare();
+  if(repeat > 0) {
+    time_variant("double", a3_replay_reset_double, a3_replay_update_double, repeat);
+    time_variant("fixed", a3_replay_reset_fixed, a3_replay_update_fixed, repeat);
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Interface of the two builds of the A3 estimator (see a3-variant.c) */
+#ifndef A3_REPLAY_H_
+#define A3_REPLAY_H_
+
+#include <stdint.h>
+
+#define A3_REPLAY_MAX_NBRS 4096
+
+/* Results of the cells with a neighbor during one ASFN */
+struct a3_replay_counts {
+  uint8_t tx_success;
+  uint8_t tx_collision;
+  uint8_t rx_success;
+  uint8_t rx_collision;
+  uint8_t rx_idle;
+  uint8_t rx_others;
+};
+
+/* State after an update */
+struct a3_replay_result {
+  uint8_t actions;
+  uint8_t num_tx_slot;
+  uint8_t num_rx_slot;
+  double tx_attempt_ewma;
+  double tx_success_ewma;
+  double rx_attempt_ewma;
+};
+
+void a3_replay_reset_double(void);
+void a3_replay_reset_fixed(void);
+void a3_replay_slots_double(int nbr, uint8_t *num_tx_slot, uint8_t *num_rx_slot);
+void a3_replay_slots_fixed(int nbr, uint8_t *num_tx_slot, uint8_t *num_rx_slot);
+void a3_replay_step_double(int nbr, const struct a3_replay_counts *c,
+                           struct a3_replay_result *r);
+void a3_replay_step_fixed(int nbr, const struct a3_replay_counts *c,
+                          struct a3_replay_result *r);
+/* Update without reading back the state, for timing */
+uint8_t a3_replay_update_double(int nbr, const struct a3_replay_counts *c);
+uint8_t a3_replay_update_fixed(int nbr, const struct a3_replay_counts *c);
+
+#endif /* A3_REPLAY_H_ */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Wrapper around one build of os/net/mac/tsch/tsch-a3.c, compiled with the
+ * same flags as it (double or fixed point, see Makefile), so that the replay
+ * only sees plain types.
+ */
+#include "contiki.h"
+#include "net/mac/tsch/tsch-a3.h"
+#include "a3-replay.h"
+
+#define CONCAT2(a, b) a##_##b
+#define CONCAT(a, b) CONCAT2(a, b)
+#define VARIANT(name) CONCAT(name, A3_REPLAY_VARIANT)
+
+static struct tsch_a3_state states[A3_REPLAY_MAX_NBRS];
+/*---------------------------------------------------------------------------*/
+static void
+set_counts(struct tsch_a3_state *s, const struct a3_replay_counts *c)
+{
+  s->num_tx_pkt_success = c->tx_success;
+  s->num_tx_pkt_collision = c->tx_collision;
+  s->num_rx_pkt_success = c->rx_success;
+  s->num_rx_pkt_collision = c->rx_collision;
+  s->num_rx_pkt_idle = c->rx_idle;
+  s->num_rx_pkt_others = c->rx_others;
+}
+/*---------------------------------------------------------------------------*/
+void
+VARIANT(a3_replay_reset)(void)
+{
+  int i;
+
+  for(i = 0; i < A3_REPLAY_MAX_NBRS; i++) {
+    tsch_a3_init(&states[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+VARIANT(a3_replay_slots)(int nbr, uint8_t *num_tx_slot, uint8_t *num_rx_slot)
+{
+  *num_tx_slot = states[nbr].num_tx_slot;
+  *num_rx_slot = states[nbr].num_rx_slot;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+VARIANT(a3_replay_update)(int nbr, const struct a3_replay_counts *c)
+{
+  set_counts(&states[nbr], c);
+  return tsch_a3_update(&states[nbr], NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+VARIANT(a3_replay_step)(int nbr, const struct a3_replay_counts *c,
+                        struct a3_replay_result *r)
+{
+  struct tsch_a3_state *s = &states[nbr];
+
+  set_counts(s, c);
+  r->actions = tsch_a3_update(s, NULL);
+  r->num_tx_slot = s->num_tx_slot;
+  r->num_rx_slot = s->num_rx_slot;
+  r->tx_attempt_ewma = TSCH_A3_RATE_TO_DOUBLE(s->tx_attempt_rate_ewma);
+  r->tx_success_ewma = TSCH_A3_RATE_TO_DOUBLE(s->tx_success_rate_ewma);
+  r->rx_attempt_ewma = TSCH_A3_RATE_TO_DOUBLE(s->rx_attempt_rate_ewma);
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,27 @@
+/* Host build of the A3 estimator: the A3 configuration of examples/ASAP */
+#ifndef CONTIKI_H_
+#define CONTIKI_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WITH_A3                                    1
+#define ORCHESTRA_CONF_UNICAST_PERIOD              20
+
+#define A3_ALICE1_ORB2_OSB3                        1
+#define A3_MAX_ZONE                                4
+
+#define A3_INITIAL_NUM_OF_SLOTS                    1
+#define A3_INITIAL_NUM_OF_PKTS                     0
+
+#define A3_INITIAL_TX_ATTEMPT_RATE_EWMA            (0.5)
+#define A3_INITIAL_RX_ATTEMPT_RATE_EWMA            (0.5)
+#define A3_INITIAL_TX_SUCCESS_RATE_EWMA            (0.4)
+
+#define A3_TX_INCREASE_THRESH                      (0.75)
+#define A3_TX_DECREASE_THRESH                      (0.34)
+#define A3_RX_INCREASE_THRESH                      (0.65)
+#define A3_RX_DECREASE_THRESH                      (0.29)
+#define A3_MAX_ERR_PROB                            (0.5)
+
+#endif /* CONTIKI_H_ */
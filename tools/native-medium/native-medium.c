@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2026
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Shared 802.15.4 radio medium for native nodes built with
+ *         NATIVE_MEDIUM=1. Each node process registers over a UNIX datagram
+ *         socket and sends every frame it transmits; the medium forwards it
+ *         to the nodes that hear the sender, drawing losses from the per-link
+ *         PRR of the topology, and reports overlapping frames on the same
+ *         channel at a receiver as collisions. All processes share the host
+ *         monotonic clock: the network runs in real time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "native-medium-proto.h"
+
+#define MAX_NODES 1024
+/* Same PHY as the node driver: 3 bytes of overhead, 32 us per byte */
+#define FRAME_AIR_TIME(len) (((uint64_t)(len) + 3) * 32)
+
+struct node {
+  int registered;
+  struct sockaddr_un addr;
+  uint32_t rx_frame_id; /* last frame forwarded to this node */
+  uint8_t rx_channel;
+  uint64_t rx_end;
+};
+
+static struct node nodes[MAX_NODES];
+/* Link table: PRR in 1/10000 (0: no link) and RSSI, indexed [src][dst] */
+static uint16_t *link_prr;
+static int8_t *link_rssi;
+
+static int verbose;
+static const char *socket_path = NATIVE_MEDIUM_SOCKET_DEFAULT;
+static int medium_fd = -1;
+
+static unsigned long stats_tx;
+static unsigned long stats_rx;
+static unsigned long stats_lost;
+static unsigned long stats_collisions;
+
+#define LINK(src, dst) ((size_t)(src) * MAX_NODES + (dst))
+/*---------------------------------------------------------------------------*/
+static void
+usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-s socket] [-t topology] "
+          "[-a prr] [-r rssi] [-S seed] [-v]\n", prog);
+  fprintf(stderr, "  -s socket   UNIX socket of the medium (default %s)\n",
+          NATIVE_MEDIUM_SOCKET_DEFAULT);
+  fprintf(stderr, "  -t file     links, one per line: <src> <dst> <prr 0..1> [rssi dBm]\n");
+  fprintf(stderr, "  -a prr      PRR of the links missing from the topology (default 0: none)\n");
+  fprintf(stderr, "  -r rssi     RSSI of the links without one (default -70)\n");
+  fprintf(stderr, "  -S seed     seed of the loss draws\n");
+  fprintf(stderr, "  -v          print every frame\n");
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+static int
+load_topology(const char *file, int default_rssi)
+{
+  char line[256];
+  int count = 0;
+  FILE *f = fopen(file, "r");
+
+  if(f == NULL) {
+    perror(file);
+    return -1;
+  }
+  while(fgets(line, sizeof(line), f) != NULL) {
+    unsigned src, dst;
+    double prr;
+    int rssi = default_rssi;
+    char *hash = strchr(line, '#');
+
+    if(hash != NULL) {
+      *hash = '\0';
+    }
+    if(sscanf(line, "%u %u %lf %d", &src, &dst, &prr, &rssi) < 3) {
+      continue;
+    }
+    if(src >= MAX_NODES || dst >= MAX_NODES || prr < 0 || prr > 1) {
+      fprintf(stderr, "%s: invalid link %s", file, line);
+      continue;
+    }
+    link_prr[LINK(src, dst)] = (uint16_t)(prr * 10000 + 0.5);
+    link_rssi[LINK(src, dst)] = rssi;
+    count++;
+  }
+  fclose(f);
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_to_node(uint16_t id, struct native_medium_msg *msg)
+{
+  if(sendto(medium_fd, msg, NATIVE_MEDIUM_MSG_LEN(msg->len), MSG_DONTWAIT,
+            (struct sockaddr *)&nodes[id].addr, sizeof(nodes[id].addr)) < 0) {
+    if(errno == ECONNREFUSED || errno == ENOENT) {
+      /* The node process is gone */
+      nodes[id].registered = 0;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_corrupt(uint16_t id, uint32_t frame_id)
+{
+  struct native_medium_msg msg;
+
+  memset(&msg, 0, NATIVE_MEDIUM_MSG_LEN(0));
+  msg.type = NATIVE_MEDIUM_CORRUPT;
+  msg.frame_id = frame_id;
+  send_to_node(id, &msg);
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_hello(struct native_medium_msg *msg, struct sockaddr_un *from)
+{
+  struct native_medium_msg reply;
+
+  if(msg->node_id >= MAX_NODES) {
+    fprintf(stderr, "node %u: id out of range\n", msg->node_id);
+    return;
+  }
+  nodes[msg->node_id].registered = 1;
+  nodes[msg->node_id].addr = *from;
+  nodes[msg->node_id].rx_end = 0;
+
+  memset(&reply, 0, NATIVE_MEDIUM_MSG_LEN(0));
+  reply.type = NATIVE_MEDIUM_WELCOME;
+  reply.node_id = msg->node_id;
+  send_to_node(msg->node_id, &reply);
+
+  if(verbose) {
+    printf("join %u\n", msg->node_id);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_tx(struct native_medium_msg *msg)
+{
+  uint16_t src = msg->node_id;
+  uint64_t end = msg->start_us + FRAME_AIR_TIME(msg->len);
+  static uint32_t frame_id;
+  unsigned dst;
+
+  if(src >= MAX_NODES || msg->len > NATIVE_MEDIUM_MAX_FRAME_LEN) {
+    return;
+  }
+  stats_tx++;
+  msg->type = NATIVE_MEDIUM_RX;
+  msg->frame_id = ++frame_id;
+
+  if(verbose) {
+    printf("tx %llu %u ch %u len %u\n", (unsigned long long)msg->start_us,
+           src, msg->channel, msg->len);
+  }
+
+  for(dst = 0; dst < MAX_NODES; dst++) {
+    uint16_t prr;
+    struct node *n = &nodes[dst];
+
+    if(dst == src || !n->registered) {
+      continue;
+    }
+    prr = link_prr[LINK(src, dst)];
+    if(prr == 0) {
+      continue;
+    }
+    if((uint32_t)(random() % 10000) >= prr) {
+      stats_lost++;
+      continue;
+    }
+
+    msg->rssi = link_rssi[LINK(src, dst)];
+    send_to_node(dst, msg);
+    stats_rx++;
+
+    /* Overlap with the previous frame heard on this channel: both are lost */
+    if(n->rx_channel == msg->channel && n->rx_end > msg->start_us) {
+      send_corrupt(dst, n->rx_frame_id);
+      send_corrupt(dst, msg->frame_id);
+      stats_collisions++;
+    }
+    if(n->rx_channel != msg->channel || end > n->rx_end) {
+      n->rx_end = end;
+      n->rx_channel = msg->channel;
+    }
+    n->rx_frame_id = msg->frame_id;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_exit(int sig)
+{
+  fprintf(stderr, "tx %lu rx %lu lost %lu collisions %lu\n",
+          stats_tx, stats_rx, stats_lost, stats_collisions);
+  unlink(socket_path);
+  exit(0);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  struct sockaddr_un addr;
+  const char *topology = NULL;
+  double default_prr = 0;
+  int default_rssi = -70;
+  unsigned seed = 1;
+  unsigned src, dst;
+  int opt;
+
+  while((opt = getopt(argc, argv, "s:t:a:r:S:vh")) != -1) {
+    switch(opt) {
+    case 's': socket_path = optarg; break;
+    case 't': topology = optarg; break;
+    case 'a': default_prr = atof(optarg); break;
+    case 'r': default_rssi = atoi(optarg); break;
+    case 'S': seed = strtoul(optarg, NULL, 10); break;
+    case 'v': verbose = 1; break;
+    default: usage(argv[0]);
+    }
+  }
+  if(default_prr < 0 || default_prr > 1) {
+    usage(argv[0]);
+  }
+  srandom(seed);
+
+  link_prr = calloc((size_t)MAX_NODES * MAX_NODES, sizeof(*link_prr));
+  link_rssi = calloc((size_t)MAX_NODES * MAX_NODES, sizeof(*link_rssi));
+  if(link_prr == NULL || link_rssi == NULL) {
+    perror("calloc");
+    return 1;
+  }
+  for(src = 0; src < MAX_NODES; src++) {
+    for(dst = 0; dst < MAX_NODES; dst++) {
+      link_prr[LINK(src, dst)] = (uint16_t)(default_prr * 10000 + 0.5);
+      link_rssi[LINK(src, dst)] = default_rssi;
+    }
+  }
+  if(topology != NULL) {
+    int links = load_topology(topology, default_rssi);
+    if(links < 0) {
+      return 1;
+    }
+    fprintf(stderr, "%s: %d links\n", topology, links);
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+  unlink(socket_path);
+  medium_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if(medium_fd < 0 || bind(medium_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    perror(socket_path);
+    return 1;
+  }
+
+  signal(SIGINT, handle_exit);
+  signal(SIGTERM, handle_exit);
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  fprintf(stderr, "medium on %s\n", socket_path);
+
+  while(1) {
+    struct native_medium_msg msg;
+    struct sockaddr_un from;
+    socklen_t from_len = sizeof(from);
+    ssize_t n = recvfrom(medium_fd, &msg, sizeof(msg), 0,
+                         (struct sockaddr *)&from, &from_len);
+
+    if(n < 0) {
+      if(errno != EINTR) {
+        perror("recvfrom");
+      }
+      continue;
+    }
+    if(n < (ssize_t)NATIVE_MEDIUM_MSG_LEN(0)) {
+      continue;
+    }
+    switch(msg.type) {
+    case NATIVE_MEDIUM_HELLO:
+      handle_hello(&msg, &from);
+      break;
+    case NATIVE_MEDIUM_TX:
+      if(n >= (ssize_t)NATIVE_MEDIUM_MSG_LEN(msg.len)) {
+        handle_tx(&msg);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return 0;
+}
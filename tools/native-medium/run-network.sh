@@ -0,0 +1,48 @@
+#!/bin/bash
+# Runs a multi-node network of native nodes on top of native-medium.
+# Node 1 runs the server (RPL root), nodes 2..N run the client, and the
+# output of each node goes to log-<iter>-<id>.txt as the parsing scripts
+# in examples/ASAP/ASAP-parsing-files expect.
+#
+# usage: run-network.sh <example dir> <nodes> <seconds> [iter] [topology]
+# The example must be built with 'make TARGET=native NATIVE_MEDIUM=1'.
+# The network runs in real time on the host clock.
+
+EXAMPLE=${1:?example directory}
+NODES=${2:?number of nodes}
+DURATION=${3:?duration in seconds}
+ITER=${4:-0}
+TOPOLOGY=$5
+
+MEDIUM=$(dirname $0)/native-medium
+SOCKET=/tmp/native-medium-$$.sock
+
+if [ -n "$TOPOLOGY" ]; then
+  MEDIUM_ARGS="-t $TOPOLOGY"
+else
+  MEDIUM_ARGS="-a 1"
+fi
+
+$MEDIUM -s $SOCKET $MEDIUM_ARGS > medium-$ITER.txt 2>&1 &
+MPID=$!
+sleep 0.5
+
+PIDS=""
+for ID in $(seq 1 $NODES); do
+  if [ $ID -eq 1 ]; then
+    BIN=$EXAMPLE/udp-server.native
+  else
+    BIN=$EXAMPLE/udp-client.native
+  fi
+  NATIVE_MEDIUM_SOCKET=$SOCKET NATIVE_MEDIUM_NODE_ID=$ID \
+    $BIN < /dev/null > log-$ITER-$ID.txt 2>&1 &
+  PIDS="$PIDS $!"
+done
+
+sleep $DURATION
+
+kill $PIDS 2> /dev/null
+wait $PIDS 2> /dev/null
+kill -INT $MPID
+wait $MPID
+cat medium-$ITER.txt